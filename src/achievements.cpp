@@ -1,23 +1,14 @@
 #include "achievements.h"
 
-#include <sstream>
-
 void AchievementSystem::unlock(ReactorState& state, Achievement ach) {
-    if (state.unlockedAchievements.find(ach) == state.unlockedAchievements.end()) {
-        state.unlockedAchievements.insert(ach);
+    if (state.unlockedAchievements.insert(ach)) {
         state.sessionAchievements.insert(ach);
-        const auto& info = getAchievementInfoTable()[static_cast<int>(ach)];
-        std::ostringstream oss;
-        oss << "\n" << Color::BG_MAGENTA << Color::WHITE << Color::BOLD
-            << " " << info.icon << " ACHIEVEMENT UNLOCKED: " << info.name << "! "
-            << Color::RESET << "\n";
-        oss << Color::MAGENTA << "   " << info.description << Color::RESET << "\n\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::ACHIEVEMENT_UNLOCKED, Severity::INFO, 0.0, static_cast<int>(ach));
     }
 }
 
 bool AchievementSystem::check(ReactorState& state) {
-    size_t before = state.unlockedAchievements.size();
+    int before = state.unlockedAchievements.size();
 
     // Turn-based achievements
     if (state.turns >= 10) unlock(state, Achievement::FIRST_STEPS);
@@ -37,7 +28,7 @@ bool AchievementSystem::check(ReactorState& state) {
     if (state.xenonHandledCount >= 5) unlock(state, Achievement::XENON_MASTER);
 
     // Nightmare achievement
-    if (state.currentDifficulty.name == "Nightmare" && state.turns >= 25) {
+    if (state.currentDifficulty.level == Difficulty::NIGHTMARE && state.turns >= 25) {
         unlock(state, Achievement::NIGHTMARE_SURVIVOR);
     }
 
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation counter for the allocation guard. Built with
+// -DREACTOR_COUNT_ALLOCATIONS, alloc_counter.cpp replaces the global operator
+// new/delete so each allocation bumps a relaxed atomic and otherwise goes
+// straight to malloc. Only the check-alloc binary is built that way; every
+// other binary keeps the standard allocator and counts nothing.
+namespace AllocCounter {
+    bool available();  // False without the replaced operator new
+    uint64_t count();  // Allocations since program start
+}
@@ -0,0 +1,110 @@
+#include "autopilot.h"
+#include "grid.h"
+#include "perf.h"
+
+#include <algorithm>
+#include <chrono>
+
+Autopilot::Autopilot()
+    : candidates(AP::CANDIDATES),
+      satisfaction(AP::CANDIDATES),
+      peakTemperature(AP::CANDIDATES),
+      peakPressure(AP::CANDIDATES),
+      peakXenon(AP::CANDIDATES),
+      plan(AutopilotPlan{0.0, 0.0, 0.0, true, 0.0}),
+      decisionCount(0),
+      totalMicros(0.0),
+      slowest(0.0) {}
+
+bool Autopilot::supports(const ReactorState& state) {
+    return !state.kinetics.enabled && !state.spatial && !state.channels && !state.depletion;
+}
+
+void Autopilot::steer(ReactorState& state) {
+    if (!state.autoRods || !state.autopilot || !state.running) return;
+    PERF_SCOPE(AUTOPILOT);
+    state.controlRods = state.autopilot->decide(state);
+}
+
+double Autopilot::decide(const ReactorState& state) {
+    auto start = std::chrono::steady_clock::now();
+    const int n = AP::CANDIDATES;
+
+    // Clone the plant into every candidate; the operator's turbine, coolant
+    // and reset choices are held as they are
+    candidates.loadMember(0, state);
+    for (int f = 0; f < static_cast<int>(EnsembleField::FIELD_COUNT); ++f) {
+        double* values = candidates.field(static_cast<EnsembleField>(f));
+        std::fill(values + 1, values + n, values[0]);
+    }
+    std::fill_n(candidates.field(EnsembleField::TURBINE_SETPOINT), n, 0.0);
+    std::fill_n(candidates.field(EnsembleField::REFILL_BELOW), n, 0.0);
+    std::fill_n(candidates.field(EnsembleField::AUTO_RESET), n, 0.0);
+    std::fill(satisfaction.begin(), satisfaction.end(), 0.0);
+    std::fill(peakTemperature.begin(), peakTemperature.end(), state.temperature);
+    std::fill(peakPressure.begin(), peakPressure.end(), state.steamPressure);
+    std::fill(peakXenon.begin(), peakXenon.end(), state.xenonLevel);
+
+    double* rods = candidates.field(EnsembleField::ROD_SETPOINT);
+    const double* electricity = candidates.field(EnsembleField::ELECTRICITY);
+    const double* diesel = candidates.field(EnsembleField::DIESEL_RUNNING);
+    const double* temperature = candidates.field(EnsembleField::TEMPERATURE);
+    const double* pressure = candidates.field(EnsembleField::STEAM_PRESSURE);
+    const double* xenon = candidates.field(EnsembleField::XENON);
+    const double* outcome = candidates.field(EnsembleField::OUTCOME);
+
+    for (int t = 0; t < AP::HORIZON; ++t) {
+        if (t == 0 || t == AP::HOLD_TURNS) {
+            for (int c = 0; c < n; ++c) {
+                rods[c] = t == 0 ? (c / AP::SECOND_SETTINGS) / (AP::FIRST_SETTINGS - 1.0)
+                                 : (c % AP::SECOND_SETTINGS) / (AP::SECOND_SETTINGS - 1.0);
+            }
+        }
+        EnsembleEngine::step(candidates);
+
+        // Demand as GridSystem::update sets it, without its fluctuation;
+        // a member stopped by a SCRAM or meltdown supplies nothing
+        double demand = std::max(200.0, std::min(1000.0, GridSystem::baseDemand(state.turns + t, state.currentWeather)));
+        for (int c = 0; c < n; ++c) {
+            double output = electricity[c] + (diesel[c] > 0.5 ? RC::DIESEL_POWER_OUTPUT : 0.0);
+            satisfaction[c] += outcome[c] == 0.0 ? std::min(100.0, output / demand * 100.0) : 0.0;
+            peakTemperature[c] = std::max(peakTemperature[c], temperature[c]);
+            peakPressure[c] = std::max(peakPressure[c], pressure[c]);
+            peakXenon[c] = std::max(peakXenon[c], xenon[c]);
+        }
+    }
+
+    // Margins are soft so that a plant already past one still gets the plan
+    // that brings it back fastest
+    const double scram = state.currentDifficulty.scramTemperature;
+    const double temperatureLimit = scram * AP::TEMPERATURE_MARGIN;
+    const double xenonLimit = RC::MAX_XENON * AP::XENON_MARGIN;
+    int best = 0;
+    double bestCost = 0.0, bestViolation = 0.0;
+    for (int c = 0; c < n; ++c) {
+        double violation = std::max(0.0, peakTemperature[c] - temperatureLimit) / temperatureLimit
+                         + std::max(0.0, peakPressure[c] - RC::CRITICAL_PRESSURE) / RC::CRITICAL_PRESSURE
+                         + std::max(0.0, peakXenon[c] - xenonLimit) / xenonLimit
+                         + (outcome[c] != 0.0 ? 1.0 : 0.0);
+        // Among equally good plans, the cooler one
+        double cost = -satisfaction[c] / AP::HORIZON + peakTemperature[c] / scram + AP::VIOLATION_COST * violation;
+        if (c == 0 || cost < bestCost) {
+            best = c;
+            bestCost = cost;
+            bestViolation = violation;
+        }
+    }
+
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    plan = AutopilotPlan{(best / AP::SECOND_SETTINGS) / (AP::FIRST_SETTINGS - 1.0),
+                         satisfaction[best] / AP::HORIZON, peakTemperature[best], bestViolation == 0.0, micros};
+    decisionCount++;
+    totalMicros += micros;
+    slowest = std::max(slowest, micros);
+    return plan.rods;
+}
+
+void AutopilotPolicy::act(ReactorState& state) {
+    base.act(state);
+    state.controlRods = autopilot.decide(state);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "reactor_state.h"
+#include "policy.h"
+#include "ensemble.h"
+
+#include <vector>
+
+// Model-predictive rod control. Every turn the plant is cloned into one
+// ensemble member per candidate rod plan: a first setting held for
+// AP::HOLD_TURNS, then a second one to the end of AP::HORIZON. The SIMD
+// engine advances all of them without events, logs or messages; the plan
+// with the best mean grid satisfaction that keeps temperature, pressure and
+// xenon inside their margins wins, and only its first setting is applied.
+namespace AP {
+    static constexpr int HORIZON = 40;
+    static constexpr int HOLD_TURNS = 8;
+    static constexpr int FIRST_SETTINGS = 51;   // 0-100% in 2% steps
+    static constexpr int SECOND_SETTINGS = 21;  // 0-100% in 5% steps
+    static constexpr int CANDIDATES = FIRST_SETTINGS * SECOND_SETTINGS;
+
+    static constexpr double TEMPERATURE_MARGIN = 0.9;  // Of the SCRAM temperature
+    static constexpr double XENON_MARGIN = 0.8;        // Of RC::MAX_XENON; pressure stays below RC::CRITICAL_PRESSURE
+    static constexpr double VIOLATION_COST = 1000.0;   // Per unit of margin exceeded, in satisfaction points
+}
+
+struct AutopilotPlan {
+    double rods;             // First setting of the chosen plan, 0-1
+    double satisfaction;     // Its mean predicted grid satisfaction, %
+    double peakTemperature;
+    bool withinMargins;      // False when every plan breaks a margin and the least bad was taken
+    double micros;           // Time the decision took
+};
+
+class Autopilot {
+public:
+    Autopilot();
+
+    // Rod setting for the coming turn; allocation-free
+    double decide(const ReactorState& state);
+
+    // Apply decide() before a turn when the operator has engaged auto mode
+    static void steer(ReactorState& state);
+
+    // The lookahead uses the basic core, so the optional models rule it out
+    static bool supports(const ReactorState& state);
+
+    const AutopilotPlan& lastPlan() const { return plan; }
+    long decisions() const { return decisionCount; }
+    double meanMicros() const { return decisionCount ? totalMicros / decisionCount : 0.0; }
+    double maxMicros() const { return slowest; }
+
+private:
+    EnsembleState candidates;
+    std::vector<double> satisfaction;  // Per candidate, summed over the horizon
+    std::vector<double> peakTemperature;
+    std::vector<double> peakPressure;
+    std::vector<double> peakXenon;
+    AutopilotPlan plan;
+    long decisionCount;
+    double totalMicros;
+    double slowest;
+};
+
+// Batch baseline: the scripted policy's turbine, refill and reset choices,
+// with the rods left to the autopilot
+class AutopilotPolicy : public OperatorPolicy {
+public:
+    explicit AutopilotPolicy(ScriptedPolicy& base) : base(base) {}
+
+    void act(ReactorState& state) override;
+    bool resetAfterScram(const ReactorState& state) override { return base.resetAfterScram(state); }
+
+    Autopilot& pilot() { return autopilot; }
+
+private:
+    ScriptedPolicy& base;
+    Autopilot autopilot;
+};
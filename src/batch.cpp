@@ -0,0 +1,128 @@
+#include "batch.h"
+#include "physics.h"
+#include "events.h"
+#include "safety.h"
+#include "spatial.h"
+#include "subchannel.h"
+#include "depletion.h"
+#include "perf.h"
+#include "telemetry.h"
+#include "quantiles.h"
+#include "autopilot.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+BatchResult BatchRunner::run(ReactorState& state, OperatorPolicy& policy, int maxTurns,
+                             TelemetryPublisher* telemetry) {
+    state.headless = true;
+    BatchResult result{BatchOutcome::SURVIVED, 0, 0, 0, 0.0};
+
+    auto start = std::chrono::steady_clock::now();
+    while (state.turns < maxTurns) {
+        policy.act(state);
+
+        {
+            PERF_SCOPE(TURN);
+            CorePhysics::update(state);
+            RandomEventSystem::process(state);
+            SafetySystem::check(state);
+        }
+        Perf::turnCompleted(state.messages.size());
+        state.clearMessages();
+        if (telemetry) telemetry->publish(state);
+
+        if (!state.running) {
+            if (SafetySystem::isMeltdown(state)) {
+                result.outcome = BatchOutcome::MELTDOWN;
+                break;
+            }
+            if (!policy.resetAfterScram(state)) {
+                result.outcome = BatchOutcome::SHUTDOWN;
+                break;
+            }
+            SafetySystem::restartAfterScram(state);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    result.turns = state.turns;
+    result.score = state.score;
+    result.scramCount = state.scramCount;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+const char* BatchRunner::outcomeName(BatchOutcome outcome) {
+    switch (outcome) {
+        case BatchOutcome::SURVIVED: return "SURVIVED";
+        case BatchOutcome::MELTDOWN: return "MELTDOWN";
+        case BatchOutcome::SHUTDOWN: return "SHUTDOWN";
+        default:                     return "UNKNOWN";
+    }
+}
+
+void BatchRunner::printSummary(const ReactorState& state, const BatchResult& result) {
+    double turnsPerSec = result.seconds > 0.0 ? result.turns / result.seconds : 0.0;
+    std::cout << "difficulty=" << state.currentDifficulty.name
+              << " outcome=" << outcomeName(result.outcome)
+              << " turns=" << result.turns
+              << " score=" << result.score
+              << " scrams=" << result.scramCount
+              << std::fixed << std::setprecision(3)
+              << " seconds=" << result.seconds
+              << std::setprecision(0)
+              << " turns_per_sec=" << turnsPerSec;
+    if (state.autopilot) {
+        const Autopilot& pilot = *state.autopilot;
+        std::cout << " autopilot_decisions=" << pilot.decisions()
+                  << " autopilot_us_mean=" << pilot.meanMicros()
+                  << " autopilot_us_max=" << pilot.maxMicros();
+    }
+    if (state.kinetics.enabled) {
+        const KineticsStats& ks = state.kinetics.stats;
+        std::cout << std::setprecision(2)
+                  << " kinetics_steps_per_turn=" << (ks.turns > 0 ? static_cast<double>(ks.steps) / ks.turns : 0.0)
+                  << " kinetics_rejected=" << ks.rejected
+                  << " kinetics_budget_hits=" << ks.budgetHits;
+    }
+    if (state.spatial) {
+        const SpatialStats& ss = state.spatial->stats();
+        double solves = std::max(1L, ss.solves);
+        std::cout << std::setprecision(2)
+                  << " spatial_outer_per_solve=" << ss.outerIterations / solves
+                  << " spatial_ms_per_solve=" << 1000.0 * ss.seconds / solves
+                  << std::setprecision(4) << " keff=" << state.spatial->keff();
+    }
+    if (state.depletion) {
+        std::cout << std::setprecision(0)
+                  << " depletion_ns_per_turn=" << state.depletion->nanosPerUpdate()
+                  << std::setprecision(2)
+                  << " xenon_rel=" << state.depletion->xenonRelative()
+                  << " samarium_rel=" << state.depletion->samariumRelative()
+                  << " fuel=" << state.fuel;
+    }
+    if (state.channels) {
+        const SubchannelModel& ch = *state.channels;
+        std::cout << std::setprecision(0)
+                  << " channels=" << ch.channelCount()
+                  << " peak_clad=" << ch.sessionPeakClad()
+                  << " channel_ns_per_turn=" << ch.nanosPerUpdate();
+    }
+    if (state.distributions) {
+        const double ranks[3] = {0.5, 0.95, 0.99};
+        for (int i = 0; i < static_cast<int>(Distribution::DISTRIBUTION_COUNT); ++i) {
+            Distribution series = static_cast<Distribution>(i);
+            const char* key = getDistributionInfo(series).key;
+            double values[3];
+            state.distributions->sketch(series).quantiles(ranks, values, 3);
+            std::cout << std::setprecision(1)
+                      << " " << key << "_p50=" << values[0]
+                      << " " << key << "_p95=" << values[1]
+                      << " " << key << "_p99=" << values[2]
+                      << " " << key << "_past_pct=" << state.distributions->pastShare(series) * 100.0;
+        }
+    }
+    std::cout << "\n";
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "reactor_state.h"
+#include "policy.h"
+
+class TelemetryPublisher;
+
+enum class BatchOutcome {
+    SURVIVED,   // Reached the turn limit
+    MELTDOWN,
+    SHUTDOWN    // Policy declined to restart after a SCRAM
+};
+
+struct BatchResult {
+    BatchOutcome outcome;
+    int turns;
+    int score;
+    int scramCount;
+    double seconds;
+};
+
+class BatchRunner {
+public:
+    // Advance the simulation under a policy until meltdown, shutdown or
+    // maxTurns, publishing every turn to `telemetry` when given
+    static BatchResult run(ReactorState& state, OperatorPolicy& policy, int maxTurns,
+                           TelemetryPublisher* telemetry = nullptr);
+
+    static const char* outcomeName(BatchOutcome outcome);
+    static void printSummary(const ReactorState& state, const BatchResult& result);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+// Append plain values to a byte buffer and read them back with bounds
+// checks, for the model sections of save files. Values are stored in host
+// byte order like the rest of the save.
+inline void putBytes(std::vector<unsigned char>& out, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+template <typename T>
+inline void putValue(std::vector<unsigned char>& out, const T& value) {
+    putBytes(out, &value, sizeof(value));
+}
+
+class ByteReader {
+public:
+    ByteReader(const unsigned char* data, size_t size) : at(data), end(data + size) {}
+
+    // False, leaving the destination alone, once the data runs out
+    bool bytes(void* data, size_t size) {
+        if (static_cast<size_t>(end - at) < size) return false;
+        std::memcpy(data, at, size);
+        at += size;
+        return true;
+    }
+    template <typename T>
+    bool value(T& value) { return bytes(&value, sizeof(value)); }
+    bool skip(size_t size) {
+        if (static_cast<size_t>(end - at) < size) return false;
+        at += size;
+        return true;
+    }
+
+    bool finished() const { return at == end; }
+
+private:
+    const unsigned char* at;
+    const unsigned char* end;
+};
@@ -64,8 +64,14 @@ namespace RC {
     // File paths
     static constexpr const char* HIGH_SCORE_FILE    = ".reactor_highscore";
     static constexpr const char* ACHIEVEMENTS_FILE  = ".reactor_achievements";
-    static constexpr const char* SAVE_FILE          = ".reactor_save";
+    static constexpr const char* SAVE_FILE          = ".reactor_save";  // Slot n in SAVE_FILE_n
+    static constexpr const char* JOURNAL_FILE       = ".reactor_journal";  // Index in JOURNAL_FILE.idx
 
     // Misc
     static constexpr int MAX_LOG_ENTRIES = 100;
+    static constexpr int MESSAGE_QUEUE_CAPACITY = 64;  // Events kept between renderer drains
+    static constexpr int ALLOC_GUARD_WARMUP_TURNS = 100;
+    static constexpr int HISTORY_TURNS = 4096;  // Snapshots kept for rewind
+    static constexpr int SAVE_SLOTS = 10;       // Slot 0 is the autosave
+    static constexpr int AUTOSAVE_SLOT = 0;
 }
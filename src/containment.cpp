@@ -1,7 +1,5 @@
 #include "containment.h"
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
 void ContainmentSystem::update(ReactorState& state) {
@@ -34,31 +32,19 @@ void ContainmentSystem::update(ReactorState& state) {
     // Containment warnings
     if (state.containmentIntegrity < RC::CONTAINMENT_CRITICAL && !state.containmentBreach) {
         state.containmentBreach = true;
-        {
-            std::ostringstream oss;
-            oss << Color::BG_RED << Color::WHITE << Color::BOLD
-                << " \xe2\x9a\xa0 CONTAINMENT BREACH! Structural integrity critical! "
-                << Color::RESET << "\n";
-            state.addAlertMessage(oss.str());
-        }
-        state.addLogEntry("CRITICAL", "Containment breach detected");
+        state.post(MessageCode::CONTAINMENT_BREACH, Severity::ALARM);
+        state.addLogEntry(LogType::CRITICAL, LogCode::CONTAINMENT_BREACH);
 
         // Breach increases radiation significantly
         state.radiationLevel *= 2.0;
     } else if (state.containmentIntegrity < RC::CONTAINMENT_WARNING) {
-        std::ostringstream oss;
-        oss << Color::RED << "\xe2\x9a\xa0 CONTAINMENT WARNING: Integrity at "
-            << std::fixed << std::setprecision(1) << state.containmentIntegrity << "%"
-            << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::CONTAINMENT_WARNING, Severity::WARNING, state.containmentIntegrity);
     }
 
     // Recovery from breach
     if (state.containmentBreach && state.containmentIntegrity > RC::CONTAINMENT_WARNING) {
         state.containmentBreach = false;
-        std::ostringstream oss;
-        oss << Color::GREEN << "\xe2\x9c\x93 Containment integrity restored!" << Color::RESET << "\n";
-        state.addMessage(oss.str());
-        state.addLogEntry("EVENT", "Containment integrity restored");
+        state.post(MessageCode::CONTAINMENT_RESTORED, Severity::INFO);
+        state.addLogEntry(LogType::EVENT, LogCode::CONTAINMENT_RESTORED);
     }
 }
@@ -0,0 +1,60 @@
+#include "crc32.h"
+
+#include <cstring>
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define CRC32C_HARDWARE 1
+#endif
+
+namespace {
+#ifndef CRC32C_HARDWARE
+struct SliceTables {
+    uint32_t t[8][256];
+
+    SliceTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0x82f63b78u & (0u - (c & 1u)));
+            t[0][i] = c;
+        }
+        for (int s = 1; s < 8; ++s) {
+            for (int i = 0; i < 256; ++i) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xff];
+        }
+    }
+};
+
+const SliceTables& tables() {
+    static const SliceTables tables;
+    return tables;
+}
+#endif
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef CRC32C_HARDWARE
+    uint64_t c = crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+    }
+    crc = static_cast<uint32_t>(c);
+    for (; size > 0; --size) crc = _mm_crc32_u8(crc, *p++);
+#else
+    // Little-endian word loads
+    const SliceTables& s = tables();
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        word ^= crc;
+        crc = s.t[7][word & 0xff] ^ s.t[6][(word >> 8) & 0xff] ^ s.t[5][(word >> 16) & 0xff] ^
+              s.t[4][(word >> 24) & 0xff] ^ s.t[3][(word >> 32) & 0xff] ^ s.t[2][(word >> 40) & 0xff] ^
+              s.t[1][(word >> 48) & 0xff] ^ s.t[0][word >> 56];
+    }
+    for (; size > 0; --size) crc = s.t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+#endif
+    return ~crc;
+}
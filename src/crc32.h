@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32C (Castagnoli) for save-file sections. Builds targeting SSE4.2 use
+// the crc32 instruction, others a slice-by-8 table; both give the same value.
+// Pass a previous result as `crc` to continue over more data.
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
@@ -0,0 +1,320 @@
+#include "depletion.h"
+#include "simd.h"
+#include "byte_stream.h"
+
+#include <cmath>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+// CRAM order 16: e^z ~ a0 + 2 Re sum_j a_j / (z - theta_j) on z <= 0, with
+// a maximum error of about 2e-14 on the whole negative real axis
+const double ALPHA0 = 2.1248537104952237488e-16;
+const double THETA_RE[DP::POLES] = {
+    -1.0843917078696988026e1, -5.2649713434426468895e0, 5.9481522689511774808e0,
+    3.5091036084149180974e0, 6.4161776990994341923e0, 1.4193758971856659786e0,
+    4.9931747377179963991e0, -1.4139284624888862114e0};
+const double THETA_IM[DP::POLES] = {
+    1.9277446167181652284e1, 1.6220221473167927305e1, 3.5874573620183222829e0,
+    8.4361989858843750826e0, 1.1941223933701386874e0, 1.0925363484496722585e1,
+    5.9968817136039422260e0, 1.3497725698892745389e1};
+const double ALPHA_RE[DP::POLES] = {
+    -5.0901521865224915650e-7, 2.1151742182466030907e-4, 1.1339775178483930527e2,
+    1.5059585270023467528e1, -6.4500878025539646595e1, -1.4793007113557999718e0,
+    -6.2518392463207918892e1, 4.1023136835410021273e-2};
+const double ALPHA_IM[DP::POLES] = {
+    -2.4220017652852287970e-5, 4.3892969647380673918e-3, 1.0194721704215856450e2,
+    -5.7514052776421819979e0, -2.2459440762652096056e2, 1.7686588323782937906e0,
+    -1.1190391094283228480e1, -1.5743466173455468191e-1};
+
+const double SECONDS_PER_TURN = DP::HOURS_PER_TURN * 3600.0;
+}
+
+int DepletionChain::addNuclide(const std::string& name, double halfLifeHours, double absorption,
+                               double fission, bool heavyMetal, double freshDensity) {
+    double decay = halfLifeHours > 0.0 ? std::log(2.0) / (halfLifeHours * 3600.0) : 0.0;
+    nuclides.push_back(Nuclide{name, decay, absorption, fission, heavyMetal, freshDensity});
+    rows.push_back(std::vector<Entry>());
+    return size() - 1;
+}
+
+int DepletionChain::index(const std::string& name) const {
+    for (int i = 0; i < size(); ++i) {
+        if (nuclides[i].name == name) return i;
+    }
+    return -1;
+}
+
+int DepletionChain::ordered(const std::string& parent, const std::string& daughter) const {
+    int p = index(parent), d = index(daughter);
+    if (p < 0 || d < 0 || p >= d) {
+        throw std::invalid_argument("depletion chain: " + parent + " must precede " + daughter);
+    }
+    return p;
+}
+
+double DepletionChain::rateScale(int parent) const {
+    return nuclides[parent].heavyMetal ? acceleration : 1.0;
+}
+
+void DepletionChain::addDecay(const std::string& parent, const std::string& daughter, double branching) {
+    int p = ordered(parent, daughter);
+    rows[index(daughter)].push_back(Entry{p, branching * nuclides[p].decay, 0.0});
+}
+
+void DepletionChain::addCapture(const std::string& parent, const std::string& daughter) {
+    int p = ordered(parent, daughter);
+    double capture = (nuclides[p].absorption - nuclides[p].fission) * DP::BARN * rateScale(p);
+    rows[index(daughter)].push_back(Entry{p, 0.0, capture});
+}
+
+void DepletionChain::addYield(const std::string& parent, const std::string& daughter, double yield) {
+    // Fission products come from the real fission rate, not the accelerated burnup
+    int p = ordered(parent, daughter);
+    rows[index(daughter)].push_back(Entry{p, 0.0, yield * nuclides[p].fission * DP::BARN});
+}
+
+double DepletionChain::diagonalPerFlux(int i) const {
+    return -nuclides[i].absorption * DP::BARN * rateScale(i);
+}
+
+double DepletionChain::fissionRate(const double* densities) const {
+    double rate = 0.0;
+    for (int i = 0; i < size(); ++i) rate += densities[i] * nuclides[i].fission;
+    return rate;
+}
+
+void DepletionChain::equilibrium(double flux, double* densities) const {
+    for (int i = 0; i < size(); ++i) {
+        if (nuclides[i].heavyMetal) continue;
+        double source = 0.0;
+        for (const Entry& e : rows[i]) source += (e.constant + flux * e.perFlux) * densities[e.column];
+        double diagonal = diagonalConstant(i) + flux * diagonalPerFlux(i);
+        densities[i] = diagonal < 0.0 ? -source / diagonal : 0.0;
+    }
+}
+
+DepletionChain DepletionChain::standard(double fuelPercentPerTurn) {
+    // One-group thermal cross sections (barn); U-238 capture includes the
+    // resonance region and stands for U-239/Np-239 decaying straight to Pu-239
+    struct Build {
+        static DepletionChain chain(double acceleration) {
+            DepletionChain c(acceleration);
+            c.addNuclide("U235", 0.0, 680.9, 582.6, true, 6.9e-4);
+            c.addNuclide("U238", 0.0, 6.0, 0.0, true, 2.2e-2);
+            c.addNuclide("Pu239", 0.0, 1011.3, 742.5, true);
+            c.addNuclide("I135", 6.57, 7.0, 0.0, false);
+            c.addNuclide("Xe135", 9.14, 2.65e6, 0.0, false);
+            c.addNuclide("Pm149", 53.08, 1400.0, 0.0, false);
+            c.addNuclide("Sm149", 0.0, 4.01e4, 0.0, false);
+
+            c.addCapture("U238", "Pu239");
+            c.addYield("U235", "I135", 0.0639);
+            c.addYield("Pu239", "I135", 0.0648);
+            c.addYield("U235", "Xe135", 0.00237);
+            c.addYield("Pu239", "Xe135", 0.0105);
+            c.addDecay("I135", "Xe135");
+            c.addYield("U235", "Pm149", 0.0108);
+            c.addYield("Pu239", "Pm149", 0.0124);
+            c.addDecay("Pm149", "Sm149");
+            return c;
+        }
+    };
+
+    // Scale the heavy-metal rates so the fresh fission rate falls by the
+    // requested fraction per turn at nominal flux (net of Pu-239 breeding)
+    DepletionChain unit = Build::chain(1.0);
+    std::vector<double> fresh(unit.size()), change(unit.size(), 0.0);
+    for (int i = 0; i < unit.size(); ++i) fresh[i] = unit.freshDensity(i);
+    for (int i = 0; i < unit.size(); ++i) {
+        if (!unit.heavyMetal(i)) continue;
+        change[i] = unit.diagonalPerFlux(i) * fresh[i];
+        for (const Entry& e : unit.row(i)) change[i] += e.perFlux * fresh[e.column];
+    }
+    double perTurn = -unit.fissionRate(&change[0]) * DP::NOMINAL_FLUX * SECONDS_PER_TURN
+                   / unit.fissionRate(&fresh[0]);
+    return Build::chain(fuelPercentPerTurn / 100.0 / perTurn);
+}
+
+DepletionBatch::DepletionBatch(const DepletionChain& chain, size_t cells, double seconds)
+    : nuclideChain(chain),
+      count(cells),
+      padded((cells + 7) / 8 * 8),
+      n(static_cast<size_t>(chain.size()) * padded, 0.0),
+      phi(padded, 0.0),
+      scratch(static_cast<size_t>(chain.size()) * 2 * DP::POLES * simd::WIDTH, 0.0) {
+    for (int i = 0; i < chain.size(); ++i) {
+        std::fill(density(i), density(i) + count, chain.freshDensity(i));
+    }
+    setTimestep(seconds);
+}
+
+void DepletionBatch::setTimestep(double seconds) {
+    const DepletionChain& c = nuclideChain;
+    const int size = c.size();
+    shiftedRe.assign(static_cast<size_t>(DP::POLES) * size, 0.0);
+    shiftedIm.assign(static_cast<size_t>(DP::POLES) * size, 0.0);
+    diagonalFlux.assign(size, 0.0);
+    for (int i = 0; i < size; ++i) {
+        diagonalFlux[i] = seconds * c.diagonalPerFlux(i);
+        for (int j = 0; j < DP::POLES; ++j) {
+            shiftedRe[j * size + i] = seconds * c.diagonalConstant(i) - THETA_RE[j];
+            shiftedIm[j * size + i] = -THETA_IM[j];
+        }
+    }
+
+    rowStart.assign(1, 0);
+    columns.clear();
+    constants.clear();
+    perFlux.clear();
+    for (int i = 0; i < size; ++i) {
+        for (const DepletionChain::Entry& e : c.row(i)) {
+            columns.push_back(e.column);
+            constants.push_back(seconds * e.constant);
+            perFlux.push_back(seconds * e.perFlux);
+        }
+        rowStart.push_back(static_cast<int>(columns.size()));
+    }
+}
+
+double DepletionBatch::fissionRate(size_t cell) const {
+    double rate = 0.0;
+    for (int i = 0; i < nuclideChain.size(); ++i) rate += density(i)[cell] * nuclideChain.fission(i);
+    return rate;
+}
+
+void DepletionBatch::advance() {
+    using namespace simd;
+    const int size = nuclideChain.size();
+    const size_t lanes = static_cast<size_t>(DP::POLES) * WIDTH;
+    double* xRe = &scratch[0];                       // [nuclide][pole][lane]
+    double* xIm = xRe + static_cast<size_t>(size) * lanes;
+    const Vec zero = set1(0.0);
+
+    for (size_t c = 0; c < padded; c += WIDTH) {
+        const Vec flux = load(&phi[c]);
+
+        // Forward substitution of (A t - theta_j) x_j = N0 for all poles at
+        // once: rows in chain order, the eight independent poles innermost
+        // so their divisions overlap
+        for (int i = 0; i < size; ++i) {
+            const Vec start = load(density(i) + c);
+            const Vec diagonal = flux * set1(diagonalFlux[i]);
+            Vec result = set1(ALPHA0) * start;
+            for (int j = 0; j < DP::POLES; ++j) {
+                Vec re = start;
+                Vec im = zero;
+                for (int e = rowStart[i]; e < rowStart[i + 1]; ++e) {
+                    const size_t k = static_cast<size_t>(columns[e]) * lanes + j * WIDTH;
+                    Vec a = set1(constants[e]) + flux * set1(perFlux[e]);
+                    re = re - a * load(xRe + k);
+                    im = im - a * load(xIm + k);
+                }
+                Vec dRe = set1(shiftedRe[j * size + i]) + diagonal;
+                Vec dIm = set1(shiftedIm[j * size + i]);
+                Vec inv = set1(1.0) / (dRe * dRe + dIm * dIm);
+                Vec solRe = (re * dRe + im * dIm) * inv;
+                Vec solIm = (im * dRe - re * dIm) * inv;
+                const size_t k = static_cast<size_t>(i) * lanes + j * WIDTH;
+                store(xRe + k, solRe);
+                store(xIm + k, solIm);
+
+                // N(t) += 2 Re(alpha_j x_j)
+                result = result + set1(2.0 * ALPHA_RE[j]) * solRe - set1(2.0 * ALPHA_IM[j]) * solIm;
+            }
+            // Clip the ~1e-16 relative undershoot of the rational approximation
+            store(density(i) + c, vmax(zero, result));
+        }
+    }
+}
+
+DepletionCore::DepletionCore(const DepletionChain& chain)
+    : batch(chain, 1, SECONDS_PER_TURN),
+      xe135(chain.index("Xe135")),
+      sm149(chain.index("Sm149")),
+      initialWorth(0.0),
+      xenonEquilibrium(1.0),
+      samariumEquilibrium(1.0),
+      reportedXenon(0.0),
+      updates(0),
+      seconds(0.0) {
+    std::vector<double> fresh(chain.size());
+    for (int i = 0; i < chain.size(); ++i) fresh[i] = chain.freshDensity(i);
+    initialWorth = chain.fissionRate(&fresh[0]);
+    chain.equilibrium(DP::NOMINAL_FLUX, &fresh[0]);
+    if (xe135 >= 0 && fresh[xe135] > 0.0) xenonEquilibrium = fresh[xe135];
+    if (sm149 >= 0 && fresh[sm149] > 0.0) samariumEquilibrium = fresh[sm149];
+}
+
+double DepletionCore::fissileWorth() const {
+    return batch.fissionRate(0) / initialWorth;
+}
+
+double DepletionCore::xenonRelative() const {
+    return xe135 >= 0 ? batch.density(xe135)[0] / xenonEquilibrium : 0.0;
+}
+
+double DepletionCore::samariumRelative() const {
+    return sm149 >= 0 ? batch.density(sm149)[0] / samariumEquilibrium : 0.0;
+}
+
+double DepletionCore::samariumFactor() const {
+    return 1.0 - DP::SAMARIUM_WORTH * samariumRelative();
+}
+
+void DepletionCore::reset(const ReactorState& state) {
+    const DepletionChain& chain = batch.chain();
+    std::vector<double> densities(chain.size());
+    double fuelScale = std::max(0.0, state.fuel) / 100.0;
+    for (int i = 0; i < chain.size(); ++i) densities[i] = chain.freshDensity(i) * fuelScale;
+    chain.equilibrium(DP::NOMINAL_FLUX * std::max(0.0, state.neutrons) / RC::INITIAL_NEUTRONS, &densities[0]);
+    if (xe135 >= 0) {
+        densities[xe135] = state.xenonLevel / DP::XENON_LEVEL_AT_EQUILIBRIUM * xenonEquilibrium;
+    }
+    for (int i = 0; i < chain.size(); ++i) batch.density(i)[0] = densities[i];
+    reportedXenon = state.xenonLevel;
+}
+
+void DepletionCore::update(ReactorState& state) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Events that add or purge xenon act on the Xe-135 inventory
+    if (xe135 >= 0 && state.xenonLevel != reportedXenon) {
+        batch.density(xe135)[0] = std::max(0.0, batch.density(xe135)[0]
+            + (state.xenonLevel - reportedXenon) / DP::XENON_LEVEL_AT_EQUILIBRIUM * xenonEquilibrium);
+    }
+
+    batch.flux()[0] = DP::NOMINAL_FLUX * std::max(0.0, state.neutrons) / RC::INITIAL_NEUTRONS;
+    batch.advance();
+
+    state.fuel = std::max(0.0, std::min(RC::INITIAL_FUEL, 100.0 * fissileWorth()));
+    state.xenonLevel = std::min(RC::MAX_XENON, DP::XENON_LEVEL_AT_EQUILIBRIUM * xenonRelative());
+    reportedXenon = state.xenonLevel;
+
+    updates++;
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void DepletionCore::saveState(std::vector<unsigned char>& out) const {
+    int32_t nuclides = batch.chain().size();
+    putValue(out, nuclides);
+    putValue(out, reportedXenon);
+    for (int i = 0; i < nuclides; ++i) putValue(out, batch.density(i)[0]);
+}
+
+bool DepletionCore::loadState(const unsigned char* data, size_t size) {
+    int32_t nuclides;
+    ByteReader in(data, size);
+    if (!in.value(nuclides) || nuclides != batch.chain().size() ||
+        size != sizeof(nuclides) + (1 + static_cast<size_t>(nuclides)) * sizeof(double)) {
+        return false;
+    }
+    in.value(reportedXenon);
+    for (int i = 0; i < nuclides; ++i) in.value(batch.density(i)[0]);
+    return true;
+}
+
+double DepletionCore::nanosPerUpdate() const {
+    return updates > 0 ? 1.0e9 * seconds / updates : 0.0;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "reactor_state.h"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+// Nuclide depletion (opt-in with --depletion). A chain of nuclides evolves as
+// dN/dt = A(phi) N, where A holds decay constants and flux-proportional
+// absorption, capture and fission-yield rates. With parents ordered before
+// their daughters A is lower triangular, and one turn is advanced with
+// 16th-order CRAM (Chebyshev rational approximation of the matrix
+// exponential):
+//
+//   N(t) = a0 N0 + 2 Re sum_j a_j (A t - theta_j I)^-1 N0
+//
+// Each shifted system is a forward substitution over the sparse rows. Batches
+// hold many cells (core nodes) with their own flux in SoA arrays and solve
+// them together with the simd.h kernels.
+namespace DP {
+    static constexpr double BARN = 1.0e-24;            // cm^2
+    static constexpr double NOMINAL_FLUX = 3.0e13;     // n/(cm^2 s) at 100 power
+    static constexpr double HOURS_PER_TURN = 0.25;     // Same clock as the spatial xenon
+
+    // Single-node core: xenon level shown at nominal equilibrium, and k lost
+    // to samarium at its equilibrium
+    static constexpr double XENON_LEVEL_AT_EQUILIBRIUM = 10.0;
+    static constexpr double SAMARIUM_WORTH = 0.01;
+
+    // CRAM order 16 partial-fraction coefficients (Pusa 2011)
+    static constexpr int POLES = 8;
+}
+
+class DepletionChain {
+public:
+    // Nuclides must be added parents first. Cross sections are one-group
+    // thermal values in barns, densities in atoms/(barn cm). Heavy-metal
+    // rates are multiplied by the chain's burnup acceleration so fuel lasts a
+    // game rather than years. halfLifeHours <= 0 means stable.
+    int addNuclide(const std::string& name, double halfLifeHours, double absorption,
+                   double fission, bool heavyMetal, double freshDensity = 0.0);
+    void addDecay(const std::string& parent, const std::string& daughter, double branching = 1.0);
+    void addCapture(const std::string& parent, const std::string& daughter);
+    void addYield(const std::string& parent, const std::string& daughter, double yield);
+
+    // U-235/U-238/Pu-239 fuel with the I-135 -> Xe-135 and Pm-149 -> Sm-149
+    // poisons, accelerated so fresh fuel loses fuelPercentPerTurn of its
+    // worth per turn at nominal flux
+    static DepletionChain standard(double fuelPercentPerTurn);
+
+    explicit DepletionChain(double burnupAcceleration = 1.0) : acceleration(burnupAcceleration) {}
+
+    int size() const { return static_cast<int>(nuclides.size()); }
+    int index(const std::string& name) const;  // -1 when absent
+    const std::string& name(int i) const { return nuclides[i].name; }
+    bool heavyMetal(int i) const { return nuclides[i].heavyMetal; }
+    double freshDensity(int i) const { return nuclides[i].fresh; }
+    double fission(int i) const { return nuclides[i].fission; }
+
+    // sum N sigma_f, proportional to the fission rate per unit flux
+    double fissionRate(const double* densities) const;
+
+    // Matrix A at a given flux: diagonal a_ii = diagonal + flux * diagonalPerFlux,
+    // row entries a_ik = constant + flux * perFlux
+    struct Entry {
+        int column;
+        double constant;
+        double perFlux;
+    };
+    double diagonalConstant(int i) const { return -nuclides[i].decay; }
+    double diagonalPerFlux(int i) const;
+    const std::vector<Entry>& row(int i) const { return rows[i]; }
+
+    // Fission products in equilibrium with the given heavy metal at constant
+    // flux; heavy-metal entries of densities are inputs, the others outputs
+    void equilibrium(double flux, double* densities) const;
+
+private:
+    struct Nuclide {
+        std::string name;
+        double decay;       // 1/s
+        double absorption;  // barn
+        double fission;     // barn
+        bool heavyMetal;
+        double fresh;
+    };
+    std::vector<Nuclide> nuclides;
+    std::vector<std::vector<Entry> > rows;
+    double acceleration;
+
+    int ordered(const std::string& parent, const std::string& daughter) const;
+    double rateScale(int parent) const;
+};
+
+class DepletionBatch {
+public:
+    DepletionBatch(const DepletionChain& chain, size_t cells, double seconds);
+
+    // Precompute the pole-shifted diagonals for a new step length
+    void setTimestep(double seconds);
+
+    // Advance every cell one step at its flux()
+    void advance();
+
+    size_t cells() const { return count; }
+    const DepletionChain& chain() const { return nuclideChain; }
+    double* flux() { return &phi[0]; }
+    double* density(int nuclide) { return &n[static_cast<size_t>(nuclide) * padded]; }
+    const double* density(int nuclide) const { return &n[static_cast<size_t>(nuclide) * padded]; }
+
+    // DepletionChain::fissionRate of one cell's densities
+    double fissionRate(size_t cell) const;
+
+private:
+    DepletionChain nuclideChain;
+    size_t count;
+    size_t padded;
+    std::vector<double> n;    // nuclide-major SoA densities
+    std::vector<double> phi;
+
+    // Per pole and nuclide: t a_ii(0) - theta_j, and t * d a_ii / d phi
+    std::vector<double> shiftedRe, shiftedIm, diagonalFlux;
+    // Row entries scaled by t, flattened in row order
+    std::vector<int> rowStart, columns;
+    std::vector<double> constants, perFlux;
+    std::vector<double> scratch;  // Shifted-system solutions per nuclide, pole and lane
+};
+
+// Single-node core: one depletion cell driven by the neutron population, in
+// place of the linear xenon and fixed fuel bookkeeping
+class DepletionCore {
+public:
+    // Starts with fresh fuel and no fission products
+    explicit DepletionCore(const DepletionChain& chain);
+
+    // Rebuild the inventory from a restored state: fuel scaled to state.fuel,
+    // fission products in equilibrium with the current flux and xenon matching
+    // state.xenonLevel
+    void reset(const ReactorState& state);
+
+    // Advance one turn; sets state.fuel and state.xenonLevel
+    void update(ReactorState& state);
+
+    // Nuclide inventory for save files; loadState() is false, changing
+    // nothing, for data from another chain
+    void saveState(std::vector<unsigned char>& out) const;
+    bool loadState(const unsigned char* data, size_t size);
+
+    // k multiplier from samarium
+    double samariumFactor() const;
+    double xenonRelative() const;     // Xe-135 / nominal equilibrium
+    double samariumRelative() const;  // Sm-149 / equilibrium
+    double nanosPerUpdate() const;
+
+private:
+    DepletionBatch batch;
+    int xe135, sm149;
+    double initialWorth;
+    double xenonEquilibrium;
+    double samariumEquilibrium;
+    double reportedXenon;
+    long updates;
+    double seconds;
+
+    double fissileWorth() const;  // Relative to fresh fuel
+};
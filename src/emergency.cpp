@@ -1,7 +1,5 @@
 #include "emergency.h"
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
 void EmergencySystem::updateECCS(ReactorState& state) {
@@ -9,18 +7,14 @@ void EmergencySystem::updateECCS(ReactorState& state) {
         state.eccsCooldownTimer--;
         if (state.eccsCooldownTimer == 0) {
             state.eccsAvailable = true;
-            std::ostringstream oss;
-            oss << Color::GREEN << "\xe2\x9c\x93 ECCS recharged and ready!" << Color::RESET << "\n";
-            state.addMessage(oss.str());
+            state.post(MessageCode::ECCS_RECHARGED, Severity::INFO);
         }
     }
 }
 
 void EmergencySystem::activateECCS(ReactorState& state) {
     if (!state.eccsAvailable) {
-        std::ostringstream oss;
-        oss << Color::RED << "\xe2\x9c\x97 ECCS on cooldown! " << state.eccsCooldownTimer << " turns remaining." << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::ECCS_COOLDOWN, Severity::WARNING, 0.0, state.eccsCooldownTimer);
         return;
     }
 
@@ -31,31 +25,17 @@ void EmergencySystem::activateECCS(ReactorState& state) {
     state.temperature = std::max(RC::INITIAL_TEMPERATURE, state.temperature - RC::ECCS_TEMP_REDUCTION);
     state.score = std::max(0, state.score - RC::ECCS_PENALTY);
 
-    {
-        std::ostringstream oss;
-        oss << Color::BG_BLUE << Color::WHITE << Color::BOLD
-            << " \xf0\x9f\x9a\xa8 ECCS ACTIVATED! +" << RC::ECCS_COOLANT_BOOST << "% coolant, -" << RC::ECCS_TEMP_REDUCTION << "\xc2\xb0""C "
-            << Color::RESET << "\n";
-        state.addMessage(oss.str());
-    }
-    {
-        std::ostringstream oss;
-        oss << Color::RED << "(-" << RC::ECCS_PENALTY << " points)" << Color::RESET << "\n";
-        state.addMessage(oss.str());
-    }
-    state.addLogEntry("CRITICAL", "ECCS activated - emergency cooling");
+    state.post(MessageCode::ECCS_ACTIVATED, Severity::INFO);
+    state.post(MessageCode::ECCS_PENALTY, Severity::WARNING, RC::ECCS_PENALTY);
+    state.addLogEntry(LogType::CRITICAL, LogCode::ECCS_ACTIVATED);
 }
 
 void EmergencySystem::updateDiesel(ReactorState& state) {
     // Auto-start logic - starts when turbine output drops below 50 MW
     if (state.dieselAutoStart && !state.dieselRunning && state.electricityOutput < 50.0 && state.dieselFuel > 0) {
         state.dieselRunning = true;
-        std::ostringstream oss;
-        oss << Color::YELLOW << Color::BOLD
-            << "\xf0\x9f\x94\x8c DIESEL GENERATOR auto-started! Low power detected."
-            << Color::RESET << "\n";
-        state.addMessage(oss.str());
-        state.addLogEntry("EVENT", "Diesel generator auto-started");
+        state.post(MessageCode::DIESEL_AUTO_START, Severity::WARNING);
+        state.addLogEntry(LogType::EVENT, LogCode::DIESEL_AUTO_START);
     }
 
     if (state.dieselRunning) {
@@ -70,55 +50,38 @@ void EmergencySystem::updateDiesel(ReactorState& state) {
 
             // Low fuel warning
             if (state.dieselFuel < 20.0 && state.dieselFuel > 0) {
-                std::ostringstream oss;
-                oss << Color::YELLOW << "\xe2\x9a\xa0 Diesel fuel low: "
-                    << std::fixed << std::setprecision(1) << state.dieselFuel << "%" << Color::RESET << "\n";
-                state.addMessage(oss.str());
+                state.post(MessageCode::DIESEL_FUEL_LOW, Severity::WARNING, state.dieselFuel);
             }
         } else {
             state.dieselRunning = false;
-            std::ostringstream oss;
-            oss << Color::RED << Color::BOLD
-                << "\xe2\x9a\xa0 DIESEL GENERATOR stopped - OUT OF FUEL!"
-                << Color::RESET << "\n";
-            state.addMessage(oss.str());
-            state.addLogEntry("WARNING", "Diesel generator stopped - fuel depleted");
+            state.post(MessageCode::DIESEL_OUT_OF_FUEL, Severity::WARNING);
+            state.addLogEntry(LogType::WARNING, LogCode::DIESEL_OUT_OF_FUEL);
         }
     }
 }
 
 void EmergencySystem::toggleDiesel(ReactorState& state) {
     if (!state.dieselRunning && state.dieselFuel <= 0) {
-        std::ostringstream oss;
-        oss << Color::RED << "\xe2\x9c\x97 Cannot start diesel generator - no fuel!" << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::DIESEL_NO_FUEL, Severity::WARNING);
         return;
     }
 
     state.dieselRunning = !state.dieselRunning;
     if (state.dieselRunning) {
-        std::ostringstream oss;
-        oss << Color::GREEN << "\xf0\x9f\x94\x8c Diesel generator started manually." << Color::RESET << "\n";
-        state.addMessage(oss.str());
-        state.addLogEntry("ACTION", "Diesel generator started manually");
+        state.post(MessageCode::DIESEL_STARTED, Severity::INFO);
+        state.addLogEntry(LogType::ACTION, LogCode::DIESEL_STARTED);
     } else {
-        std::ostringstream oss;
-        oss << Color::YELLOW << "\xf0\x9f\x94\x8c Diesel generator stopped." << Color::RESET << "\n";
-        state.addMessage(oss.str());
-        state.addLogEntry("ACTION", "Diesel generator stopped");
+        state.post(MessageCode::DIESEL_STOPPED, Severity::INFO);
+        state.addLogEntry(LogType::ACTION, LogCode::DIESEL_STOPPED);
     }
 }
 
 void EmergencySystem::refillDiesel(ReactorState& state) {
     if (state.dieselFuel >= RC::DIESEL_FUEL_CAPACITY) {
-        std::ostringstream oss;
-        oss << Color::YELLOW << "Diesel tank already full." << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::DIESEL_TANK_FULL, Severity::INFO);
         return;
     }
     state.dieselFuel = RC::DIESEL_FUEL_CAPACITY;
-    std::ostringstream oss;
-    oss << Color::GREEN << "\xe2\x9b\xbd Diesel tank refilled!" << Color::RESET << "\n";
-    state.addMessage(oss.str());
-    state.addLogEntry("ACTION", "Diesel fuel tank refilled");
+    state.post(MessageCode::DIESEL_REFILLED, Severity::INFO);
+    state.addLogEntry(LogType::ACTION, LogCode::DIESEL_REFILLED);
 }
@@ -0,0 +1,320 @@
+#include "ensemble.h"
+#include "events.h"
+#include "event_catalog.h"
+#include "simd.h"
+
+EnsembleState::EnsembleState(size_t count)
+    : count(count),
+      padded((count + 7) / 8 * 8),
+      data(static_cast<size_t>(EnsembleField::FIELD_COUNT) * padded, 0.0)
+{
+    // Padding lanes are parked as shut down so they never advance
+    double* outcome = field(EnsembleField::OUTCOME);
+    for (size_t i = count; i < padded; ++i) outcome[i] = 2.0;
+}
+
+void EnsembleState::initMember(size_t i, const DifficultySettings& diff, double controlRods) {
+    ReactorState fresh(Difficulty::NORMAL);
+    fresh.currentDifficulty = diff;
+    fresh.controlRods = controlRods;
+    loadMember(i, fresh);
+
+    field(EnsembleField::ROD_SETPOINT)[i] = controlRods;
+    field(EnsembleField::TURBINE_SETPOINT)[i] = 1.0;
+    field(EnsembleField::REFILL_BELOW)[i] = 0.0;
+    field(EnsembleField::AUTO_RESET)[i] = 1.0;
+    field(EnsembleField::COOLING_MODIFIER)[i] = getWeatherInfo(Weather::CLEAR).coolingModifier;
+}
+
+void EnsembleState::loadMember(size_t i, const ReactorState& s) {
+    field(EnsembleField::NEUTRONS)[i]           = s.neutrons;
+    field(EnsembleField::CONTROL_RODS)[i]       = s.controlRods;
+    field(EnsembleField::TEMPERATURE)[i]        = s.temperature;
+    field(EnsembleField::COOLANT)[i]            = s.coolant;
+    field(EnsembleField::POWER)[i]              = s.power;
+    field(EnsembleField::FUEL)[i]               = s.fuel;
+    field(EnsembleField::XENON)[i]              = s.xenonLevel;
+    field(EnsembleField::TURBINE_RPM)[i]        = s.turbineRPM;
+    field(EnsembleField::STEAM_PRESSURE)[i]     = s.steamPressure;
+    field(EnsembleField::ELECTRICITY)[i]        = s.electricityOutput;
+    field(EnsembleField::TOTAL_ELECTRICITY)[i]  = s.totalElectricityGenerated;
+    field(EnsembleField::TURBINE_ONLINE)[i]     = s.turbineOnline ? 1.0 : 0.0;
+    field(EnsembleField::RELIEF_OPEN)[i]        = s.pressureReliefOpen ? 1.0 : 0.0;
+    field(EnsembleField::DIESEL_FUEL)[i]        = s.dieselFuel;
+    field(EnsembleField::DIESEL_RUNNING)[i]     = s.dieselRunning ? 1.0 : 0.0;
+    field(EnsembleField::RADIATION)[i]          = s.radiationLevel;
+    field(EnsembleField::TOTAL_EXPOSURE)[i]     = s.totalRadiationExposure;
+    field(EnsembleField::CONTAINMENT)[i]        = s.containmentIntegrity;
+    field(EnsembleField::BREACH)[i]             = s.containmentBreach ? 1.0 : 0.0;
+    field(EnsembleField::RUNNING)[i]            = s.running ? 1.0 : 0.0;
+    field(EnsembleField::TURNS)[i]              = s.turns;
+    field(EnsembleField::SCORE)[i]              = s.score;
+    field(EnsembleField::SCRAMS)[i]             = s.scramCount;
+    field(EnsembleField::EVENTS)[i]             = s.eventsExperienced;
+    field(EnsembleField::OUTCOME)[i]            = 0.0;
+
+    field(EnsembleField::FUEL_DEPLETION)[i]     = s.currentDifficulty.fuelDepletionRate;
+    field(EnsembleField::COOLANT_LOSS)[i]       = s.currentDifficulty.coolantLossRate;
+    field(EnsembleField::SCRAM_TEMP)[i]         = s.currentDifficulty.scramTemperature;
+    field(EnsembleField::MELTDOWN_TEMP)[i]      = s.currentDifficulty.meltdownTemperature;
+    field(EnsembleField::SCORE_MULTIPLIER)[i]   = s.currentDifficulty.scoreMultiplier;
+    field(EnsembleField::TURBINE_EFFICIENCY)[i] = s.currentDifficulty.turbineEfficiency;
+    field(EnsembleField::XENON_BUILDUP)[i]      = s.currentDifficulty.xenonBuildupRate;
+    field(EnsembleField::COOLING_MODIFIER)[i]   = getWeatherInfo(s.currentWeather).coolingModifier;
+    field(EnsembleField::EVENT_CHANCE)[i]       = s.currentDifficulty.eventChance;
+    field(EnsembleField::EVENT_TABLE)[i]        = EventCatalog::tableIndex(s.currentDifficulty.level, s.currentWeather);
+}
+
+void EnsembleState::storeMember(size_t i, ReactorState& s) const {
+    s.neutrons                  = field(EnsembleField::NEUTRONS)[i];
+    s.controlRods               = field(EnsembleField::CONTROL_RODS)[i];
+    s.temperature               = field(EnsembleField::TEMPERATURE)[i];
+    s.coolant                   = field(EnsembleField::COOLANT)[i];
+    s.power                     = field(EnsembleField::POWER)[i];
+    s.fuel                      = field(EnsembleField::FUEL)[i];
+    s.xenonLevel                = field(EnsembleField::XENON)[i];
+    s.turbineRPM                = field(EnsembleField::TURBINE_RPM)[i];
+    s.steamPressure             = field(EnsembleField::STEAM_PRESSURE)[i];
+    s.electricityOutput         = field(EnsembleField::ELECTRICITY)[i];
+    s.totalElectricityGenerated = field(EnsembleField::TOTAL_ELECTRICITY)[i];
+    s.turbineOnline             = field(EnsembleField::TURBINE_ONLINE)[i] > 0.5;
+    s.pressureReliefOpen        = field(EnsembleField::RELIEF_OPEN)[i] > 0.5;
+    s.dieselFuel                = field(EnsembleField::DIESEL_FUEL)[i];
+    s.dieselRunning             = field(EnsembleField::DIESEL_RUNNING)[i] > 0.5;
+    s.radiationLevel            = field(EnsembleField::RADIATION)[i];
+    s.totalRadiationExposure    = field(EnsembleField::TOTAL_EXPOSURE)[i];
+    s.containmentIntegrity      = field(EnsembleField::CONTAINMENT)[i];
+    s.containmentBreach         = field(EnsembleField::BREACH)[i] > 0.5;
+    s.running                   = field(EnsembleField::RUNNING)[i] > 0.5;
+    s.turns                     = static_cast<int>(field(EnsembleField::TURNS)[i]);
+    s.score                     = static_cast<int>(field(EnsembleField::SCORE)[i]);
+    s.scramCount                = static_cast<int>(field(EnsembleField::SCRAMS)[i]);
+    s.eventsExperienced         = static_cast<int>(field(EnsembleField::EVENTS)[i]);
+}
+
+size_t EnsembleState::activeCount() const {
+    const double* outcome = field(EnsembleField::OUTCOME);
+    size_t active = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (outcome[i] == 0.0) ++active;
+    }
+    return active;
+}
+
+const char* EnsembleEngine::kernelName() {
+    return simd::NAME;
+}
+
+void EnsembleEngine::step(EnsembleState& ens) {
+    using namespace simd;
+
+    double* f[static_cast<int>(EnsembleField::FIELD_COUNT)];
+    for (int k = 0; k < static_cast<int>(EnsembleField::FIELD_COUNT); ++k) {
+        f[k] = ens.field(static_cast<EnsembleField>(k));
+    }
+#define F(name) f[static_cast<int>(EnsembleField::name)]
+
+    const Vec zero = set1(0.0);
+    const Vec one  = set1(1.0);
+
+    for (size_t i = 0; i < ens.paddedSize(); i += WIDTH) {
+        const Vec outcome = load(F(OUTCOME) + i);
+        const Mask active = mnot(gt(outcome, zero));
+        if (!any(active)) continue;
+
+        Vec neutrons  = load(F(NEUTRONS) + i);
+        Vec rods      = load(F(CONTROL_RODS) + i);
+        Vec temp      = load(F(TEMPERATURE) + i);
+        Vec coolant   = load(F(COOLANT) + i);
+        Vec power     = load(F(POWER) + i);
+        Vec fuel      = load(F(FUEL) + i);
+        Vec xenon     = load(F(XENON) + i);
+        Vec rpm       = load(F(TURBINE_RPM) + i);
+        Vec pressure  = load(F(STEAM_PRESSURE) + i);
+        Vec elec      = load(F(ELECTRICITY) + i);
+        Vec totalElec = load(F(TOTAL_ELECTRICITY) + i);
+        Vec online    = load(F(TURBINE_ONLINE) + i);
+        Vec relief    = load(F(RELIEF_OPEN) + i);
+        Vec diesel    = load(F(DIESEL_FUEL) + i);
+        Vec dieselOn  = load(F(DIESEL_RUNNING) + i);
+        Vec rad       = load(F(RADIATION) + i);
+        Vec exposure  = load(F(TOTAL_EXPOSURE) + i);
+        Vec integrity = load(F(CONTAINMENT) + i);
+        Vec breach    = load(F(BREACH) + i);
+        Vec running   = load(F(RUNNING) + i);
+        Vec turns     = load(F(TURNS) + i);
+        Vec score     = load(F(SCORE) + i);
+        Vec scrams    = load(F(SCRAMS) + i);
+
+        const Vec fuelRate    = load(F(FUEL_DEPLETION) + i);
+        const Vec coolantLoss = load(F(COOLANT_LOSS) + i);
+        const Vec scramTemp   = load(F(SCRAM_TEMP) + i);
+        const Vec meltTemp    = load(F(MELTDOWN_TEMP) + i);
+        const Vec multiplier  = load(F(SCORE_MULTIPLIER) + i);
+        const Vec turbineEff  = load(F(TURBINE_EFFICIENCY) + i);
+        const Vec xenonRate   = load(F(XENON_BUILDUP) + i);
+        const Vec coolingMod  = load(F(COOLING_MODIFIER) + i);
+        const Vec rodSet      = load(F(ROD_SETPOINT) + i);
+        const Vec turbineSet  = load(F(TURBINE_SETPOINT) + i);
+        const Vec refillBelow = load(F(REFILL_BELOW) + i);
+        const Vec autoReset   = load(F(AUTO_RESET) + i);
+
+        // --- ScriptedPolicy::act ---
+        rods = rodSet;
+        online = select(isSet(turbineSet), one, online);
+        Mask refill = lt(coolant, refillBelow);
+        coolant = select(refill, set1(RC::INITIAL_COOLANT), coolant);
+        score = select(refill, vmax(zero, score - set1(RC::REFILL_PENALTY)), score);
+
+        // --- CorePhysics::update: core ---
+        Vec xenonFactor = one - (xenon / set1(RC::MAX_XENON)) * set1(0.3);
+        Vec kEff = (set1(1.05) - rods * set1(1.1)) * xenonFactor;
+        kEff = vmax(set1(0.7), kEff);
+        neutrons = neutrons * kEff;
+        power = neutrons * set1(RC::NEUTRON_TO_POWER_RATIO);
+        neutrons = neutrons * (fuel / set1(100.0));
+        fuel = vmax(zero, fuel - fuelRate);
+        temp = temp + power * set1(RC::POWER_TO_HEAT_RATIO);
+        coolant = vmax(zero, coolant - coolantLoss);
+        temp = vmax(zero, temp - set1(RC::NATURAL_COOLING_RATE) * coolingMod);
+        temp = select(lt(coolant, set1(RC::CRITICAL_COOLANT)), temp + set1(5.0), temp);
+
+        // --- XenonSystem::update ---
+        xenon = xenon + (power / set1(100.0)) * xenonRate;
+        xenon = vmax(zero, xenon - set1(RC::XENON_DECAY_RATE));
+        xenon = vmin(set1(RC::MAX_XENON), xenon);
+
+        // --- TurbineSystem::update ---
+        Mask hot = gt(temp, set1(RC::MIN_TURBINE_TEMP));
+        Vec targetPressure = ((temp - set1(RC::MIN_TURBINE_TEMP)) / (meltTemp - set1(RC::MIN_TURBINE_TEMP)))
+                             * set1(RC::MAX_STEAM_PRESSURE);
+        pressure = select(hot, pressure * set1(0.7) + targetPressure * set1(0.3),
+                               vmax(zero, pressure - set1(5.0)));
+
+        Mask reliefOpen = mor(isSet(relief), gt(pressure, set1(RC::CRITICAL_PRESSURE)));
+        pressure = select(reliefOpen, vmax(zero, pressure - set1(10.0)), pressure);
+        reliefOpen = mand(reliefOpen, mnot(lt(pressure, set1(RC::CRITICAL_PRESSURE * 0.8))));
+        relief = flag(reliefOpen);
+
+        Mask rupture = gt(pressure, set1(RC::RUPTURE_PRESSURE));
+        coolant = select(rupture, vmax(zero, coolant - set1(25.0)), coolant);
+        temp = select(rupture, temp + set1(50.0), temp);
+        online = select(rupture, zero, online);
+        pressure = select(rupture, set1(50.0), pressure);
+
+        Mask turbineOn = isSet(online);
+        Mask generating = mand(turbineOn, mnot(lt(temp, set1(RC::MIN_TURBINE_TEMP))));
+        Vec targetRPM = vmin(one, pressure / set1(RC::MAX_STEAM_PRESSURE)) * set1(RC::MAX_TURBINE_RPM);
+        Vec rpmRun = select(lt(rpm, targetRPM), vmin(targetRPM, rpm + set1(200.0)),
+                                                vmax(targetRPM, rpm - set1(200.0)));
+        Vec tempEfficiency = one - vabs(temp - set1(RC::OPTIMAL_STEAM_TEMP)) / set1(1000.0);
+        tempEfficiency = vmax(set1(0.3), vmin(one, tempEfficiency));
+        Vec elecRun = (rpmRun / set1(RC::MAX_TURBINE_RPM)) * set1(1000.0) * tempEfficiency * turbineEff;
+        rpm = select(generating, rpmRun,
+              select(turbineOn, vmax(zero, rpm - set1(50.0)), vmax(zero, rpm - set1(100.0))));
+        elec = select(generating, elecRun, zero);
+        totalElec = select(generating, totalElec + elec / set1(60.0), totalElec);
+
+        // --- EmergencySystem::updateDiesel (auto-start enabled) ---
+        Mask dieselHasFuel = gt(diesel, zero);
+        Mask dieselRun = mor(isSet(dieselOn), mand(lt(elec, set1(50.0)), dieselHasFuel));
+        Mask burning = mand(dieselRun, dieselHasFuel);
+        diesel = select(burning, vmax(zero, diesel - set1(RC::DIESEL_FUEL_CONSUMPTION)), diesel);
+        temp = select(mand(burning, gt(temp, set1(RC::INITIAL_TEMPERATURE))), temp - set1(2.0), temp);
+        dieselOn = flag(burning);
+
+        // --- RadiationSystem::update ---
+        Vec scramBand = scramTemp * set1(0.8);
+        Vec tempFactor = select(gt(temp, scramBand),
+                                ((temp - scramBand) / (meltTemp - scramBand)) * set1(50.0), zero);
+        Vec coolantFactor = select(lt(coolant, set1(30.0)),
+                                   ((set1(30.0) - coolant) / set1(30.0)) * set1(100.0), zero);
+        Vec targetRad = set1(RC::BACKGROUND_RADIATION) + (power / set1(100.0)) * set1(5.0)
+                        + tempFactor + coolantFactor;
+        rad = rad * set1(0.7) + targetRad * set1(0.3);
+        exposure = exposure + rad / set1(60.0);
+
+        // --- ContainmentSystem::update ---
+        Vec stressBand = scramTemp * set1(0.7);
+        Vec stress = zero;
+        stress = stress + select(gt(temp, stressBand), (temp - stressBand) / set1(500.0), zero);
+        stress = stress + select(gt(pressure, set1(RC::MAX_STEAM_PRESSURE * 0.8)),
+                                 (pressure - set1(RC::MAX_STEAM_PRESSURE * 0.8)) / set1(100.0), zero);
+        stress = stress + select(gt(rad, set1(RC::WARNING_RADIATION)),
+                                 (rad - set1(RC::WARNING_RADIATION)) / set1(1000.0), zero);
+        integrity = select(gt(stress, zero), vmax(zero, integrity - stress * set1(0.1)),
+                                             vmin(set1(RC::MAX_CONTAINMENT), integrity + set1(0.05)));
+        Mask newBreach = mand(lt(integrity, set1(RC::CONTAINMENT_CRITICAL)), mnot(isSet(breach)));
+        rad = select(newBreach, rad * set1(2.0), rad);
+        Mask breached = mor(isSet(breach), newBreach);
+        breached = mand(breached, mnot(gt(integrity, set1(RC::CONTAINMENT_WARNING))));
+        breach = flag(breached);
+
+        // --- CorePhysics::update: turn score ---
+        turns = turns + one;
+        score = score + set1(RC::POINTS_PER_TURN) * multiplier;
+        score = score + vtrunc(power * set1(RC::POINTS_PER_POWER_UNIT) * multiplier);
+        score = score + vtrunc(elec / set1(100.0) * set1(RC::POINTS_PER_MW) * multiplier);
+
+        // --- SafetySystem::check ---
+        Mask trip = mand(mor(gt(temp, scramTemp), gt(neutrons, set1(RC::SCRAM_NEUTRONS))), isSet(running));
+        rods = select(trip, one, rods);
+        neutrons = select(trip, neutrons * set1(0.05), neutrons);
+        temp = select(trip, vmax(zero, temp - set1(200.0)), temp);
+        online = select(trip, zero, online);
+        running = select(trip, zero, running);
+        scrams = select(trip, scrams + one, scrams);
+        score = select(trip, vmax(zero, score - set1(RC::SCRAM_PENALTY)), score);
+
+        Mask meltdown = gt(temp, meltTemp);
+        running = select(meltdown, zero, running);
+
+        // --- BatchRunner: meltdown ends the run, otherwise auto-reset or shut down ---
+        Mask stopped = mnot(isSet(running));
+        Mask restart = mand(mand(stopped, mnot(meltdown)), isSet(autoReset));
+        running = select(restart, one, running);
+        temp = select(restart, set1(RC::INITIAL_TEMPERATURE), temp);
+        rods = select(restart, one, rods);
+        Vec newOutcome = select(meltdown, one, select(mand(stopped, mnot(restart)), set1(2.0), zero));
+
+#define STORE(name, value) store(F(name) + i, select(active, value, load(F(name) + i)))
+        STORE(NEUTRONS, neutrons);
+        STORE(CONTROL_RODS, rods);
+        STORE(TEMPERATURE, temp);
+        STORE(COOLANT, coolant);
+        STORE(POWER, power);
+        STORE(FUEL, fuel);
+        STORE(XENON, xenon);
+        STORE(TURBINE_RPM, rpm);
+        STORE(STEAM_PRESSURE, pressure);
+        STORE(ELECTRICITY, elec);
+        STORE(TOTAL_ELECTRICITY, totalElec);
+        STORE(TURBINE_ONLINE, online);
+        STORE(RELIEF_OPEN, relief);
+        STORE(DIESEL_FUEL, diesel);
+        STORE(DIESEL_RUNNING, dieselOn);
+        STORE(RADIATION, rad);
+        STORE(TOTAL_EXPOSURE, exposure);
+        STORE(CONTAINMENT, integrity);
+        STORE(BREACH, breach);
+        STORE(RUNNING, running);
+        STORE(TURNS, turns);
+        STORE(SCORE, score);
+        STORE(SCRAMS, scrams);
+        STORE(OUTCOME, newOutcome);
+#undef STORE
+    }
+#undef F
+}
+
+int EnsembleEngine::run(EnsembleState& ens, int maxTurns, bool events, uint64_t seed) {
+    int turn = 0;
+    while (turn < maxTurns) {
+        step(ens);
+        if (events) RandomEventSystem::process(ens, seed);
+        ++turn;
+        // Checking for survivors costs a pass over OUTCOME, so only do it periodically
+        if ((turn & 63) == 0 && ens.activeCount() == 0) break;
+    }
+    return turn;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "reactor_state.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Per-member fields of the ensemble, one SoA array each. Flags are 0.0 / 1.0.
+enum class EnsembleField {
+    // Physics state
+    NEUTRONS,
+    CONTROL_RODS,
+    TEMPERATURE,
+    COOLANT,
+    POWER,
+    FUEL,
+    XENON,
+    TURBINE_RPM,
+    STEAM_PRESSURE,
+    ELECTRICITY,
+    TOTAL_ELECTRICITY,
+    TURBINE_ONLINE,
+    RELIEF_OPEN,
+    DIESEL_FUEL,
+    DIESEL_RUNNING,
+    RADIATION,
+    TOTAL_EXPOSURE,
+    CONTAINMENT,
+    BREACH,
+    RUNNING,
+
+    // Bookkeeping
+    TURNS,
+    SCORE,
+    SCRAMS,
+    EVENTS,
+    OUTCOME,            // 0 = active, 1 = meltdown, 2 = shutdown
+
+    // Difficulty parameters (per member so what-if studies can vary them)
+    FUEL_DEPLETION,
+    COOLANT_LOSS,
+    SCRAM_TEMP,
+    MELTDOWN_TEMP,
+    SCORE_MULTIPLIER,
+    TURBINE_EFFICIENCY,
+    XENON_BUILDUP,
+    COOLING_MODIFIER,   // Weather is held fixed per member
+    EVENT_CHANCE,       // One turn in this many has a random event
+    EVENT_TABLE,        // EventCatalog::tableIndex of the difficulty and weather
+
+    // Operator policy (constant-rod ScriptedPolicy equivalent)
+    ROD_SETPOINT,
+    TURBINE_SETPOINT,
+    REFILL_BELOW,
+    AUTO_RESET,
+
+    FIELD_COUNT
+};
+
+// Structure-of-arrays storage for N reactors. Arrays are padded to a multiple
+// of 8 lanes; padding members are inactive and never change.
+class EnsembleState {
+public:
+    explicit EnsembleState(size_t count);
+
+    size_t size() const { return count; }
+    size_t paddedSize() const { return padded; }
+
+    double* field(EnsembleField f) { return &data[static_cast<size_t>(f) * padded]; }
+    const double* field(EnsembleField f) const { return &data[static_cast<size_t>(f) * padded]; }
+
+    // Fresh reactor with the given difficulty, rods held at controlRods
+    void initMember(size_t i, const DifficultySettings& diff, double controlRods);
+
+    // Copy physics fields to/from a scalar ReactorState
+    void loadMember(size_t i, const ReactorState& state);
+    void storeMember(size_t i, ReactorState& state) const;
+
+    size_t activeCount() const;
+
+private:
+    size_t count;
+    size_t padded;
+    std::vector<double> data;
+};
+
+// Vectorized mirror of the deterministic part of a headless turn:
+// ScriptedPolicy::act, CorePhysics::update (core, xenon, turbine, diesel,
+// radiation, containment, turn score) and SafetySystem::check with
+// auto-reset. Weather is fixed per member and grid demand and achievements
+// are not simulated, so scores exclude grid bonuses. Random events are
+// optional and come after the step (see RandomEventSystem).
+class EnsembleEngine {
+public:
+    // Advance every active member by one turn
+    static void step(EnsembleState& ens);
+
+    // Advance up to maxTurns turns, stopping early once no member is active;
+    // with `events`, every turn ends with the catalog's random events drawn
+    // from `seed`
+    static int run(EnsembleState& ens, int maxTurns, bool events = false, uint64_t seed = 0);
+
+    // Instruction set the kernel was compiled for
+    static const char* kernelName();
+};
@@ -0,0 +1,650 @@
+#include "event_catalog.h"
+#include "reactor_state.h"
+#include "ensemble.h"
+#include "crc32.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Escapes are decoded by the catalog parser, so this reads the same pasted
+// into a catalog file
+const char* const BUILT_IN = R"(# Built-in random events. A turn has an event with a chance of one in the
+# difficulty's eventChance; the weights then pick which one.
+
+event coolant_leak
+    weight 18
+    roll 10 19
+    sub coolant value
+    atleast coolant 0
+    message warning yellow "\xe2\x9a\xa0 COOLANT LEAK: Lost {value.1}% coolant!"
+    log warning "Coolant leak detected - {value}% lost"
+end
+
+event power_surge
+    weight 14
+    roll 30 69
+    add temperature value
+    message warning red "\xe2\x9a\xa1 POWER SURGE: Temperature +{value.1}\xc2\xb0C!"
+    log warning "Power surge - temperature spike"
+end
+
+event pump_failure
+    weight 10
+    sub coolant 15
+    atleast coolant 0
+    add temperature 20
+    message warning red "\xf0\x9f\x94\xa7 PUMP FAILURE: -15% coolant, +20\xc2\xb0C!"
+    log warning "Coolant pump failure"
+end
+
+event xenon_spike
+    weight 10
+    add xenon 20
+    atmost xenon 100
+    message warning magenta "\xe2\x98\xa2 XENON SPIKE: Xe-135 levels surged! +20%"
+    log event "Xenon-135 spike detected"
+end
+
+event steam_leak
+    weight 10
+    if turbine_online == 1
+        sub turbine_rpm 500
+        atleast turbine_rpm 0
+        message warning yellow "\xf0\x9f\x92\xa8 STEAM LEAK: Turbine -500 RPM"
+        log warning "Steam leak in turbine hall"
+    else
+        add temperature 15
+        message warning yellow "\xf0\x9f\x92\xa8 STEAM LEAK: +15\xc2\xb0C"
+        log warning "Steam leak in reactor building"
+    endif
+end
+
+event turbine_trip
+    weight 8
+    if turbine_online == 1
+        set turbine_online 0
+        scale turbine_rpm 0.5
+        message warning red "\xe2\x9a\x99 TURBINE TRIP: Emergency shutdown!"
+        log warning "Turbine trip - emergency shutdown"
+    endif
+end
+
+event efficiency_boost
+    weight 10
+    roll 50 99
+    add score value
+    message info green "\xe2\x9c\xa8 EFFICIENCY BOOST: +{value} points!"
+    log event "Efficiency improvement bonus"
+end
+
+event coolant_delivery
+    weight 10
+    roll 10 24
+    add coolant value
+    atmost coolant 100
+    message info green "\xf0\x9f\x92\xa7 COOLANT DELIVERY: +{value.1}% coolant!"
+    log event "Coolant delivery received"
+end
+
+event maintenance_crew
+    weight 10
+    sub temperature 30
+    atleast temperature 300
+    sub xenon 10
+    atleast xenon 0
+    message info green "\xf0\x9f\x91\xb7 MAINTENANCE CREW: -30\xc2\xb0C, -10% xenon"
+    log event "Maintenance crew performed repairs"
+end
+)";
+
+const char* const FIELD_NAMES[] = {
+    "temperature", "coolant", "xenon", "neutrons", "fuel", "rods", "turbine_rpm",
+    "steam_pressure", "turbine_online", "diesel_fuel", "radiation", "containment", "score",
+};
+static_assert(sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]) == static_cast<size_t>(EventField::FIELD_COUNT),
+              "one name per EventField");
+
+const EnsembleField ENSEMBLE_FIELDS[] = {
+    EnsembleField::TEMPERATURE, EnsembleField::COOLANT, EnsembleField::XENON, EnsembleField::NEUTRONS,
+    EnsembleField::FUEL, EnsembleField::CONTROL_RODS, EnsembleField::TURBINE_RPM,
+    EnsembleField::STEAM_PRESSURE, EnsembleField::TURBINE_ONLINE, EnsembleField::DIESEL_FUEL,
+    EnsembleField::RADIATION, EnsembleField::CONTAINMENT, EnsembleField::SCORE,
+};
+static_assert(sizeof(ENSEMBLE_FIELDS) / sizeof(ENSEMBLE_FIELDS[0]) == static_cast<size_t>(EventField::FIELD_COUNT),
+              "one EnsembleField per EventField");
+
+const char* const LEVEL_NAMES[] = {"easy", "normal", "hard", "nightmare"};
+const char* const WEATHER_NAMES[] = {"clear", "cloudy", "rain", "storm", "heatwave", "cold_snap"};
+const char* const COMPARE_NAMES[] = {"<", "<=", ">", ">=", "==", "!="};
+const char* const SEVERITY_NAMES[] = {"info", "warning", "critical", "alarm"};
+const char* const LOG_TYPE_NAMES[] = {"action", "event", "warning", "critical"};
+
+struct ColorName {
+    const char* name;
+    const char* code;
+};
+const ColorName COLORS[] = {
+    {"red", Color::RED}, {"green", Color::GREEN}, {"yellow", Color::YELLOW}, {"blue", Color::BLUE},
+    {"magenta", Color::MAGENTA}, {"cyan", Color::CYAN}, {"white", Color::WHITE},
+};
+
+template <size_t N>
+int lookup(const char* const (&table)[N], const std::string& name) {
+    for (size_t i = 0; i < N; ++i) {
+        if (name == table[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool parseNumber(const std::string& word, double& number) {
+    if (word.empty()) return false;
+    char* end = nullptr;
+    number = std::strtod(word.c_str(), &end);
+    return *end == '\0' && std::isfinite(number);
+}
+
+// Words of a line, and the quoted text that may end it with its escapes
+// (\xHH, \" and \\) decoded; false on an unterminated quote or bad escape
+bool tokenize(const std::string& line, std::vector<std::string>& words, std::string& text, bool& quoted) {
+    words.clear();
+    text.clear();
+    quoted = false;
+    size_t i = 0;
+    while (i < line.size()) {
+        char c = line[i];
+        if (c == '#') break;
+        if (c == ' ' || c == '\t' || c == '\r') {
+            i++;
+            continue;
+        }
+        if (c != '"') {
+            size_t start = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r' && line[i] != '#') i++;
+            words.push_back(line.substr(start, i - start));
+            continue;
+        }
+        for (i++; i < line.size() && line[i] != '"'; i++) {
+            if (line[i] != '\\') {
+                text += line[i];
+            } else if (i + 1 < line.size() && (line[i + 1] == '"' || line[i + 1] == '\\')) {
+                text += line[++i];
+            } else if (i + 3 < line.size() && line[i + 1] == 'x' &&
+                       std::isxdigit(static_cast<unsigned char>(line[i + 2])) &&
+                       std::isxdigit(static_cast<unsigned char>(line[i + 3]))) {
+                text += static_cast<char>(std::strtol(line.substr(i + 2, 2).c_str(), nullptr, 16));
+                i += 3;
+            } else {
+                return false;
+            }
+        }
+        if (i == line.size()) return false;
+        quoted = true;
+        i++;
+        // Only a comment may follow the text
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+        return i == line.size() || line[i] == '#';
+    }
+    return true;
+}
+
+bool holds(double field, uint8_t compare, double operand) {
+    switch (static_cast<EventCompare>(compare)) {
+        case EventCompare::LESS:          return field < operand;
+        case EventCompare::LESS_EQUAL:    return field <= operand;
+        case EventCompare::GREATER:       return field > operand;
+        case EventCompare::GREATER_EQUAL: return field >= operand;
+        case EventCompare::EQUAL:         return field == operand;
+        case EventCompare::NOT_EQUAL:     return field != operand;
+    }
+    return false;
+}
+
+// The VM reads and writes the reactor through a target, so the same
+// bytecode runs on a ReactorState and on one ensemble member
+class StateTarget {
+public:
+    explicit StateTarget(ReactorState& state) : s(state) {}
+
+    double load(EventField field) const {
+        switch (field) {
+            case EventField::TEMPERATURE:    return s.temperature;
+            case EventField::COOLANT:        return s.coolant;
+            case EventField::XENON:          return s.xenonLevel;
+            case EventField::NEUTRONS:       return s.neutrons;
+            case EventField::FUEL:           return s.fuel;
+            case EventField::CONTROL_RODS:   return s.controlRods;
+            case EventField::TURBINE_RPM:    return s.turbineRPM;
+            case EventField::STEAM_PRESSURE: return s.steamPressure;
+            case EventField::TURBINE_ONLINE: return s.turbineOnline ? 1.0 : 0.0;
+            case EventField::DIESEL_FUEL:    return s.dieselFuel;
+            case EventField::RADIATION:      return s.radiationLevel;
+            case EventField::CONTAINMENT:    return s.containmentIntegrity;
+            case EventField::SCORE:          return s.score;
+            case EventField::FIELD_COUNT:    break;
+        }
+        return 0.0;
+    }
+
+    void store(EventField field, double value) {
+        switch (field) {
+            case EventField::TEMPERATURE:    s.temperature = value; break;
+            case EventField::COOLANT:        s.coolant = value; break;
+            case EventField::XENON:          s.xenonLevel = value; break;
+            case EventField::NEUTRONS:       s.neutrons = value; break;
+            case EventField::FUEL:           s.fuel = value; break;
+            case EventField::CONTROL_RODS:   s.controlRods = value; break;
+            case EventField::TURBINE_RPM:    s.turbineRPM = value; break;
+            case EventField::STEAM_PRESSURE: s.steamPressure = value; break;
+            case EventField::TURBINE_ONLINE: s.turbineOnline = value > 0.5; break;
+            case EventField::DIESEL_FUEL:    s.dieselFuel = value; break;
+            case EventField::RADIATION:      s.radiationLevel = value; break;
+            case EventField::CONTAINMENT:    s.containmentIntegrity = value; break;
+            case EventField::SCORE:          s.score = static_cast<int>(value); break;
+            case EventField::FIELD_COUNT:    break;
+        }
+    }
+
+    void message(uint32_t text, uint8_t severity, double value) {
+        s.post(MessageCode::CATALOG_EVENT, static_cast<Severity>(severity), value, static_cast<int>(text));
+    }
+
+    void log(uint32_t text, uint8_t type, double value) {
+        s.addLogEntry(static_cast<LogType>(type),
+                      static_cast<LogCode>(static_cast<uint32_t>(LogCode::CATALOG_TEXT) + text), value);
+    }
+
+private:
+    ReactorState& s;
+};
+
+// Ensemble members keep no messages or log
+class MemberTarget {
+public:
+    MemberTarget(EnsembleState& ens, size_t member) : ens(ens), member(member) {}
+
+    double load(EventField field) const {
+        return ens.field(ENSEMBLE_FIELDS[static_cast<int>(field)])[member];
+    }
+    void store(EventField field, double value) {
+        if (field == EventField::TURBINE_ONLINE) value = value > 0.5 ? 1.0 : 0.0;
+        if (field == EventField::SCORE) value = std::trunc(value);
+        ens.field(ENSEMBLE_FIELDS[static_cast<int>(field)])[member] = value;
+    }
+    void message(uint32_t, uint8_t, double) {}
+    void log(uint32_t, uint8_t, double) {}
+
+private:
+    EnsembleState& ens;
+    size_t member;
+};
+
+template <class Target>
+bool execute(const EventInstruction* code, uint32_t entry, Target& target, CounterRng& rng) {
+    double value = 0.0;
+    for (uint32_t pc = entry;; ++pc) {
+        const EventInstruction& in = code[pc];
+        double operand = in.fromValue ? in.operand * value : in.operand;
+        switch (in.op) {
+            case EventOp::REQUIRE:
+                if (!holds(target.load(in.field), in.compare, operand)) return false;
+                break;
+            case EventOp::ROLL:
+                value = in.operand + uniformBelow(rng, in.target);
+                break;
+            case EventOp::SET:      target.store(in.field, operand); break;
+            case EventOp::ADD:      target.store(in.field, target.load(in.field) + operand); break;
+            case EventOp::SCALE:    target.store(in.field, target.load(in.field) * operand); break;
+            case EventOp::AT_LEAST: target.store(in.field, std::max(operand, target.load(in.field))); break;
+            case EventOp::AT_MOST:  target.store(in.field, std::min(operand, target.load(in.field))); break;
+            case EventOp::BRANCH:
+                if (!holds(target.load(in.field), in.compare, operand)) pc = in.target - 1;
+                break;
+            case EventOp::JUMP:
+                pc = in.target - 1;
+                break;
+            case EventOp::MESSAGE: target.message(in.target, in.compare, value); break;
+            case EventOp::LOG:     target.log(in.target, in.compare, value); break;
+            case EventOp::END:     return true;
+        }
+    }
+}
+
+EventCatalog& current() {
+    static EventCatalog catalog;
+    return catalog;
+}
+
+}  // namespace
+
+EventCatalog::EventCatalog() : sourceCrc(0) {
+    std::fill(std::begin(weighted), std::end(weighted), false);
+    std::string error;
+    if (!parse(BUILT_IN, error)) {
+        std::cerr << "Built-in event catalog: " << error << "\n";
+        std::abort();
+    }
+}
+
+const char* EventCatalog::builtInSource() {
+    return BUILT_IN;
+}
+
+const EventCatalog& EventCatalog::active() {
+    return current();
+}
+
+void EventCatalog::install(const EventCatalog& catalog) {
+    current() = catalog;
+}
+
+bool EventCatalog::load(const std::string& path, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::ostringstream source;
+    source << file.rdbuf();
+    return parse(source.str(), error);
+}
+
+bool EventCatalog::parse(const std::string& source, std::string& error) {
+    // Per event while it is read
+    struct Pending {
+        double weight;
+        double levelWeights[EC::LEVELS];  // Negative: the base weight
+        double weatherFactors[EC::WEATHERS];
+        bool effects;                     // An effect has been compiled
+        std::vector<std::pair<uint32_t, bool>> open;  // if/else to patch: instruction, seen else
+    };
+
+    std::vector<std::string> newNames;
+    std::vector<uint32_t> newEntries;
+    std::vector<EventInstruction> newCode;
+    std::vector<EventText> newTexts;
+    std::vector<double> weights;  // EC::TABLES per event
+    Pending event;
+    bool inEvent = false;
+
+    std::istringstream lines(source);
+    std::string line, text;
+    std::vector<std::string> words;
+    int number = 0;
+    auto fail = [&](const std::string& problem) {
+        error = "line " + std::to_string(number) + ": " + problem;
+        return false;
+    };
+
+    while (std::getline(lines, line)) {
+        number++;
+        bool quoted = false;
+        if (!tokenize(line, words, text, quoted)) return fail("unterminated text or bad escape");
+        if (words.empty()) {
+            if (quoted) return fail("text without a statement");
+            continue;
+        }
+        const std::string& keyword = words[0];
+        size_t args = words.size() - 1;
+        bool wantsText = keyword == "message" || keyword == "log";
+        if (quoted != wantsText) return fail(wantsText ? keyword + " needs quoted text" : "unexpected text");
+
+        if (keyword == "event") {
+            if (inEvent) return fail("event " + newNames.back() + " has no end");
+            if (args != 1) return fail("event needs a name");
+            if (std::find(newNames.begin(), newNames.end(), words[1]) != newNames.end()) {
+                return fail("duplicate event " + words[1]);
+            }
+            newNames.push_back(words[1]);
+            newEntries.push_back(static_cast<uint32_t>(newCode.size()));
+            event.weight = -1.0;
+            std::fill(std::begin(event.levelWeights), std::end(event.levelWeights), -1.0);
+            std::fill(std::begin(event.weatherFactors), std::end(event.weatherFactors), 1.0);
+            event.effects = false;
+            event.open.clear();
+            inEvent = true;
+            continue;
+        }
+        if (!inEvent) return fail(keyword + " outside an event");
+
+        if (keyword == "end") {
+            if (args != 0) return fail("end takes nothing");
+            if (!event.open.empty()) return fail("if without endif");
+            bool anyWeight = event.weight >= 0.0;
+            for (double w : event.levelWeights) anyWeight = anyWeight || w >= 0.0;
+            if (!anyWeight) return fail("event " + newNames.back() + " has no weight");
+            for (int level = 0; level < EC::LEVELS; ++level) {
+                double base = event.levelWeights[level] >= 0.0 ? event.levelWeights[level]
+                                                               : std::max(0.0, event.weight);
+                for (int weather = 0; weather < EC::WEATHERS; ++weather) {
+                    weights.push_back(base * event.weatherFactors[weather]);
+                }
+            }
+            newCode.push_back(EventInstruction{EventOp::END, EventField::TEMPERATURE, 0, 0, 0, 0.0});
+            inEvent = false;
+            continue;
+        }
+
+        if (keyword == "weight") {
+            double w = 0.0;
+            if (args < 1 || args > 2 || !parseNumber(words[args], w) || w < 0.0) {
+                return fail("weight needs [LEVEL] WEIGHT >= 0");
+            }
+            if (args == 1) {
+                event.weight = w;
+            } else {
+                int level = lookup(LEVEL_NAMES, words[1]);
+                if (level < 0) return fail("unknown difficulty " + words[1]);
+                event.levelWeights[level] = w;
+            }
+            continue;
+        }
+        if (keyword == "weather") {
+            double factor = 0.0;
+            int weather = args == 2 ? lookup(WEATHER_NAMES, words[1]) : -1;
+            if (weather < 0 || !parseNumber(words[2], factor) || factor < 0.0) {
+                return fail("weather needs WEATHER FACTOR >= 0");
+            }
+            event.weatherFactors[weather] = factor;
+            continue;
+        }
+
+        EventInstruction in{EventOp::END, EventField::TEMPERATURE, 0, 0, 0, 0.0};
+        // FIELD, then OPERAND, which is a number or `value`
+        auto field = [&](size_t at) {
+            int f = at < words.size() ? lookup(FIELD_NAMES, words[at]) : -1;
+            in.field = static_cast<EventField>(std::max(0, f));
+            return f >= 0;
+        };
+        auto operand = [&](size_t at) {
+            if (at >= words.size()) return false;
+            if (words[at] == "value") {
+                in.fromValue = 1;
+                in.operand = 1.0;
+                return true;
+            }
+            return parseNumber(words[at], in.operand);
+        };
+        auto condition = [&]() {
+            int compare = args == 3 ? lookup(COMPARE_NAMES, words[2]) : -1;
+            in.compare = static_cast<uint8_t>(std::max(0, compare));
+            return compare >= 0 && field(1) && operand(3);
+        };
+
+        if (keyword == "when") {
+            if (event.effects || !event.open.empty()) return fail("when must come before the effects");
+            if (!condition()) return fail("when needs FIELD OP NUMBER");
+            in.op = EventOp::REQUIRE;
+        } else if (keyword == "if") {
+            if (!condition()) return fail("if needs FIELD OP NUMBER");
+            in.op = EventOp::BRANCH;
+            event.open.push_back(std::make_pair(static_cast<uint32_t>(newCode.size()), false));
+        } else if (keyword == "else") {
+            if (args != 0) return fail("else takes nothing");
+            if (event.open.empty() || event.open.back().second) return fail("else without if");
+            // The if's branch lands after this jump, which skips the else part
+            in.op = EventOp::JUMP;
+            newCode[event.open.back().first].target = static_cast<uint32_t>(newCode.size() + 1);
+            event.open.back() = std::make_pair(static_cast<uint32_t>(newCode.size()), true);
+        } else if (keyword == "endif") {
+            if (args != 0) return fail("endif takes nothing");
+            if (event.open.empty()) return fail("endif without if");
+            newCode[event.open.back().first].target = static_cast<uint32_t>(newCode.size());
+            event.open.pop_back();
+            continue;
+        } else if (keyword == "roll") {
+            double lo = 0.0, hi = 0.0;
+            if (args != 2 || !parseNumber(words[1], lo) || !parseNumber(words[2], hi) || lo != std::floor(lo) ||
+                hi != std::floor(hi) || hi < lo || hi - lo >= 4294967295.0) {
+                return fail("roll needs whole numbers LOW HIGH");
+            }
+            in.op = EventOp::ROLL;
+            in.operand = lo;
+            in.target = static_cast<uint32_t>(hi - lo + 1.0);
+        } else if (keyword == "set" || keyword == "add" || keyword == "sub" || keyword == "scale" ||
+                   keyword == "atleast" || keyword == "atmost") {
+            if (args != 2 || !field(1) || !operand(2)) return fail(keyword + " needs FIELD NUMBER or FIELD value");
+            in.op = keyword == "set" ? EventOp::SET
+                  : keyword == "scale" ? EventOp::SCALE
+                  : keyword == "atleast" ? EventOp::AT_LEAST
+                  : keyword == "atmost" ? EventOp::AT_MOST : EventOp::ADD;
+            if (keyword == "sub") in.operand = -in.operand;
+        } else if (keyword == "message") {
+            int severity = args >= 1 ? lookup(SEVERITY_NAMES, words[1]) : -1;
+            if (severity < 0 || args > 2) return fail("message needs SEVERITY [COLOR] \"TEXT\"");
+            const char* color = severity == static_cast<int>(Severity::INFO) ? Color::GREEN
+                              : severity == static_cast<int>(Severity::WARNING) ? Color::YELLOW : Color::RED;
+            if (args == 2) {
+                color = nullptr;
+                for (const ColorName& c : COLORS) {
+                    if (words[2] == c.name) color = c.code;
+                }
+                if (!color) return fail("unknown color " + words[2]);
+            }
+            in.op = EventOp::MESSAGE;
+            in.compare = static_cast<uint8_t>(severity);
+            in.target = static_cast<uint32_t>(newTexts.size());
+            newTexts.push_back(EventText{text, color});
+        } else if (keyword == "log") {
+            int type = args == 1 ? lookup(LOG_TYPE_NAMES, words[1]) : -1;
+            if (type < 0) return fail("log needs TYPE \"TEXT\"");
+            in.op = EventOp::LOG;
+            in.compare = static_cast<uint8_t>(type);
+            in.target = static_cast<uint32_t>(newTexts.size());
+            newTexts.push_back(EventText{text, Color::RESET});
+        } else {
+            return fail("unknown statement " + keyword);
+        }
+        if (newTexts.size() > static_cast<size_t>(EC::MAX_TEXTS)) return fail("more than 32768 texts");
+        if (in.op != EventOp::REQUIRE) event.effects = true;
+        newCode.push_back(in);
+    }
+
+    number++;
+    if (inEvent) return fail("event " + newNames.back() + " has no end");
+    if (newNames.empty()) return fail("no events");
+
+    names.swap(newNames);
+    entries.swap(newEntries);
+    code.swap(newCode);
+    texts.swap(newTexts);
+    sourceCrc = crc32c(source.data(), source.size());
+    buildTables(weights);
+    return true;
+}
+
+// Vose's alias method: scaled to a mean of 1, every weight under 1 is topped
+// up from one over 1, which becomes its alias
+void EventCatalog::buildTables(const std::vector<double>& weights) {
+    const size_t n = names.size();
+    slots.assign(static_cast<size_t>(EC::TABLES) * n, AliasSlot{0, 0});
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (int t = 0; t < EC::TABLES; ++t) {
+        double total = 0.0;
+        for (size_t e = 0; e < n; ++e) total += weights[e * EC::TABLES + t];
+        weighted[t] = total > 0.0;
+        if (!weighted[t]) continue;
+
+        small.clear();
+        large.clear();
+        for (size_t e = 0; e < n; ++e) {
+            scaled[e] = weights[e * EC::TABLES + t] * n / total;
+            (scaled[e] < 1.0 ? small : large).push_back(static_cast<uint32_t>(e));
+        }
+        AliasSlot* table = &slots[static_cast<size_t>(t) * n];
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            table[s] = AliasSlot{static_cast<uint64_t>(std::ldexp(scaled[s], 32)), l};
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // What is left is 1 up to rounding
+        for (uint32_t e : large) table[e] = AliasSlot{uint64_t(1) << 32, e};
+        for (uint32_t e : small) table[e] = AliasSlot{uint64_t(1) << 32, e};
+    }
+}
+
+bool EventCatalog::run(int event, ReactorState& state, CounterRng& rng) const {
+    StateTarget target(state);
+    return execute(code.data(), entries[event], target, rng);
+}
+
+bool EventCatalog::run(int event, EnsembleState& ens, size_t member, CounterRng& rng) const {
+    MemberTarget target(ens, member);
+    return execute(code.data(), entries[event], target, rng);
+}
+
+void EventCatalog::forgetTexts(LogEntry* entries, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (static_cast<uint16_t>(entries[i].code) >= static_cast<uint16_t>(LogCode::CATALOG_TEXT)) {
+            entries[i].code = LogCode::CATALOG_EVENT;
+        }
+    }
+}
+
+void EventCatalog::formatText(int text, double value, char* out, size_t size) const {
+    if (size == 0) return;
+    if (text < 0 || static_cast<size_t>(text) >= texts.size()) {
+        std::snprintf(out, size, "Catalog event");
+        return;
+    }
+    const std::string& source = texts[text].text;
+    size_t used = 0;
+    for (size_t i = 0; i < source.size() && used + 1 < size;) {
+        // {value} as a whole number, {value.N} with N decimals
+        if (source.compare(i, 6, "{value") == 0) {
+            size_t close = source.find('}', i);
+            int decimals = -1;
+            if (close == i + 6) {
+                decimals = 0;
+            } else if (close == i + 8 && source[i + 6] == '.' && source[i + 7] >= '0' && source[i + 7] <= '9') {
+                decimals = source[i + 7] - '0';
+            }
+            if (decimals >= 0) {
+                int written = std::snprintf(out + used, size - used, "%.*f", decimals, value);
+                used = std::min(size - 1, used + static_cast<size_t>(std::max(0, written)));
+                i = close + 1;
+                continue;
+            }
+        }
+        out[used++] = source[i++];
+    }
+    out[used] = '\0';
+}
+
+const char* EventCatalog::textColor(int text) const {
+    return text >= 0 && static_cast<size_t>(text) < texts.size() ? texts[text].color : Color::RESET;
+}
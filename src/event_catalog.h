@@ -0,0 +1,144 @@
+#pragma once
+
+#include "types.h"
+#include "rng.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct ReactorState;
+class EnsembleState;
+
+// Random events as data. A catalog (the built-in one, or a file passed with
+// --events) defines each event's weight per difficulty and weather, its
+// preconditions, its effects on the reactor and its message and log text.
+// Loading compiles it into one alias table per difficulty and weather, so
+// picking an event is two draws and two lookups however many there are,
+// and into a flat bytecode that every event's effects run from.
+namespace EC {
+    static constexpr int LEVELS = 4;    // Difficulty values
+    static constexpr int WEATHERS = 6;  // Weather values
+    static constexpr int TABLES = LEVELS * WEATHERS;
+    static constexpr int MAX_TEXTS = 0x8000;  // Log codes from LogCode::CATALOG_TEXT up
+    static constexpr size_t TEXT_SIZE = 160;  // Longest expanded message or log line
+}
+
+// Reactor fields the catalog can read and change; each maps to a
+// ReactorState member and an EnsembleField
+enum class EventField : uint8_t {
+    TEMPERATURE,
+    COOLANT,
+    XENON,
+    NEUTRONS,
+    FUEL,
+    CONTROL_RODS,
+    TURBINE_RPM,
+    STEAM_PRESSURE,
+    TURBINE_ONLINE,   // 0 or 1
+    DIESEL_FUEL,
+    RADIATION,
+    CONTAINMENT,
+    SCORE,
+    FIELD_COUNT
+};
+
+enum class EventOp : uint8_t {
+    REQUIRE,   // Precondition: the event does not happen unless it holds
+    ROLL,      // value = operand + uniform integer below target
+    SET,
+    ADD,
+    SCALE,
+    AT_LEAST,  // field = max(field, operand)
+    AT_MOST,
+    BRANCH,    // Jump to target unless the condition holds
+    JUMP,
+    MESSAGE,   // Text target; compare holds the Severity
+    LOG,       // Text target; compare holds the LogType
+    END
+};
+
+enum class EventCompare : uint8_t { LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL };
+
+struct EventInstruction {
+    EventOp op;
+    EventField field;
+    uint8_t compare;    // EventCompare, Severity or LogType
+    uint8_t fromValue;  // The operand is a factor of the rolled value
+    uint32_t target;    // Jump target, text index or roll span
+    double operand;
+};
+
+struct EventText {
+    std::string text;   // {value} and {value.N} stand for the event's value
+    const char* color;  // Messages only
+};
+
+// One alias table slot: keep `column` with probability threshold / 2^32,
+// otherwise take `alias`
+struct AliasSlot {
+    uint64_t threshold;
+    uint32_t alias;
+};
+
+class EventCatalog {
+public:
+    EventCatalog();
+
+    // Compile catalog source; on failure `error` names the line and problem
+    bool parse(const std::string& source, std::string& error);
+    bool load(const std::string& path, std::string& error);
+
+    // The catalog the simulation draws from: the built-in one unless another
+    // was installed (before any simulation thread starts)
+    static const EventCatalog& active();
+    static void install(const EventCatalog& catalog);
+    static const char* builtInSource();
+
+    // Event for a turn that has one, from the table of tableIndex(), or -1
+    // when no event has weight there
+    template <class Generator>
+    int pick(Generator& rng, int table) const {
+        if (!weighted[table]) return -1;
+        uint32_t column = uniformBelow(rng, static_cast<uint32_t>(names.size()));
+        const AliasSlot& slot = slots[static_cast<size_t>(table) * names.size() + column];
+        return rng() < slot.threshold ? static_cast<int>(column) : static_cast<int>(slot.alias);
+    }
+
+    // Run an event's bytecode; false when a precondition kept it from
+    // happening. Allocation-free.
+    bool run(int event, ReactorState& state, CounterRng& rng) const;
+    bool run(int event, EnsembleState& ens, size_t member, CounterRng& rng) const;
+
+    static int tableIndex(Difficulty level, Weather weather) {
+        return static_cast<int>(level) * EC::WEATHERS + static_cast<int>(weather);
+    }
+
+    size_t eventCount() const { return names.size(); }
+    const std::string& eventName(int event) const { return names[event]; }
+    size_t codeSize() const { return code.size(); }
+    uint32_t checksum() const { return sourceCrc; }
+
+    // Catalog text with its value filled in; "Catalog event" for an index
+    // this catalog does not have
+    void formatText(int text, double value, char* out, size_t size) const;
+    const char* textColor(int text) const;
+
+    // Log codes index the texts of the catalog that wrote them. Entries kept
+    // from a session with another catalog (its checksum differs) have their
+    // text codes replaced by LogCode::CATALOG_EVENT, so they show a generic
+    // label instead of whatever text the loaded catalog has at that index.
+    static void forgetTexts(LogEntry* entries, size_t count);
+
+private:
+    std::vector<std::string> names;
+    std::vector<uint32_t> entries;  // First instruction of each event
+    std::vector<EventInstruction> code;
+    std::vector<EventText> texts;
+    std::vector<AliasSlot> slots;   // EC::TABLES tables of names.size() slots
+    bool weighted[EC::TABLES];      // Some event has weight in the table
+    uint32_t sourceCrc;
+
+    void buildTables(const std::vector<double>& weights);
+};
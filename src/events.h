@@ -2,8 +2,18 @@
 
 #include "reactor_state.h"
 
+#include <cstdint>
+
+class EnsembleState;
+
+// Random events, drawn from the active EventCatalog
 class RandomEventSystem {
 public:
     // Process random events for the current turn; mutates state directly
     static void process(ReactorState& state);
+
+    // The same for every active ensemble member, after a step. Member i
+    // draws from the counter-based stream (seed, i, its turn), so a member's
+    // events do not depend on the ensemble's size or order.
+    static void process(EnsembleState& ens, uint64_t seed);
 };
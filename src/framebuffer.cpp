@@ -0,0 +1,240 @@
+#include "framebuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+// Cell attributes: foreground and background colour (0 for the default,
+// else 1 + the ANSI colour number), bold and dim
+const uint16_t FG_MASK = 0x000F;
+const uint16_t BG_SHIFT = 4;
+const uint16_t BG_MASK = 0x00F0;
+const uint16_t BOLD = 0x0100;
+const uint16_t DIM = 0x0200;
+const uint16_t UNKNOWN_ATTR = 0xFFFF;  // Terminal attributes not yet set by this frame
+
+// Unchanged cells a diff span may cover rather than moving the cursor past
+// them (a cursor move costs 6-8 bytes)
+const int MERGE_GAP = 4;
+
+uint16_t applySgr(uint16_t attr, int code) {
+    if (code == 0) return 0;
+    if (code == 1) return attr | BOLD;
+    if (code == 2) return attr | DIM;
+    if (code == 22) return attr & ~(BOLD | DIM);
+    if (code >= 30 && code <= 37) return (attr & ~FG_MASK) | static_cast<uint16_t>(code - 30 + 1);
+    if (code == 39) return attr & ~FG_MASK;
+    if (code >= 40 && code <= 47) return (attr & ~BG_MASK) | static_cast<uint16_t>((code - 40 + 1) << BG_SHIFT);
+    if (code == 49) return attr & ~BG_MASK;
+    return attr;
+}
+
+// Terminals give these one or two columns depending on font and version
+bool ambiguousWidth(uint32_t codepoint) {
+    return (codepoint >= 0x2600 && codepoint < 0x2800) || codepoint == 0xFE0F || codepoint == 0x200D;
+}
+}
+
+FrameBuffer::FrameBuffer() : height(0), width(0), used(0) {}
+
+void FrameBuffer::resize(int rows, int cols) {
+    height = rows;
+    width = cols;
+    used = 0;
+    Cell blank;
+    std::memset(&blank, 0, sizeof(blank));
+    blank.glyph[0] = ' ';
+    blank.size = 1;
+    cells.assign(static_cast<size_t>(rows) * cols, blank);
+    ambiguous.assign(static_cast<size_t>(rows), 0);
+}
+
+void FrameBuffer::put(int& r, int& c, const char* glyph, int size, int cellWidth, uint16_t attr) {
+    if (c + cellWidth > width) {
+        r++;
+        c = 0;
+    }
+    if (r < height) {
+        Cell& cell = cells[static_cast<size_t>(r) * width + c];
+        std::memset(&cell, 0, sizeof(cell));
+        std::memcpy(cell.glyph, glyph, static_cast<size_t>(size));
+        cell.size = static_cast<uint8_t>(size);
+        cell.attr = attr;
+        if (cellWidth == 2) {
+            Cell& right = cells[static_cast<size_t>(r) * width + c + 1];
+            std::memset(&right, 0, sizeof(right));
+            right.attr = attr;
+        }
+    }
+    c += cellWidth;
+}
+
+void FrameBuffer::compose(const std::string& text) {
+    resize(height, width);
+    if (width <= 1) return;
+
+    int r = 0, c = 0;
+    uint16_t attr = 0;
+    size_t i = 0, n = text.size();
+    while (i < n) {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        if (ch == '\033') {
+            // CSI: parameters, then a final byte; only SGR (m) matters here
+            if (i + 1 >= n || text[i + 1] != '[') {
+                i++;
+                continue;
+            }
+            size_t end = i + 2;
+            while (end < n && (text[end] < 0x40 || text[end] > 0x7E)) end++;
+            if (end < n && text[end] == 'm') {
+                int code = 0;
+                for (size_t k = i + 2; k <= end; ++k) {
+                    if (text[k] >= '0' && text[k] <= '9') {
+                        code = code * 10 + (text[k] - '0');
+                    } else {
+                        attr = applySgr(attr, code);
+                        code = 0;
+                    }
+                }
+            }
+            i = end + 1;
+            continue;
+        }
+        if (ch == '\n') {
+            r++;
+            c = 0;
+            i++;
+            continue;
+        }
+        if (ch < 0x20) {
+            i++;
+            continue;
+        }
+
+        int size = ch < 0x80 ? 1 : ch < 0xE0 ? 2 : ch < 0xF0 ? 3 : 4;
+        if (i + size > n) break;
+        uint32_t codepoint = size == 1 ? ch : ch & (0x3F >> (size - 1));
+        for (int k = 1; k < size; ++k) codepoint = (codepoint << 6) | (text[i + k] & 0x3F);
+
+        if (ambiguousWidth(codepoint) && r < height) ambiguous[r] = 1;
+        if (codepoint == 0xFE0F || codepoint == 0x200D) {
+            // Joins the previous glyph
+            if (c > 0 && r < height) {
+                Cell* cell = &cells[static_cast<size_t>(r) * width + c - 1];
+                if (cell->size == 0 && c > 1) cell--;
+                if (cell->size + size <= static_cast<int>(sizeof(cell->glyph))) {
+                    std::memcpy(cell->glyph + cell->size, text.data() + i, static_cast<size_t>(size));
+                    cell->size = static_cast<uint8_t>(cell->size + size);
+                }
+            }
+        } else {
+            put(r, c, text.data() + i, size, codepoint >= 0x1F000 ? 2 : 1, attr);
+        }
+        i += static_cast<size_t>(size);
+    }
+    used = r + (c > 0 ? 1 : 0);
+}
+
+void FrameBuffer::moveTo(std::string& out, int row, int col) {
+    char text[24];
+    int length = std::snprintf(text, sizeof(text), "\033[%d;%dH", row + 1, col + 1);
+    out.append(text, static_cast<size_t>(length));
+}
+
+void FrameBuffer::setAttr(std::string& out, uint16_t attr) {
+    char text[24];
+    int length = std::snprintf(text, sizeof(text), "\033[0");
+    if (attr & BOLD) length += std::snprintf(text + length, sizeof(text) - length, ";1");
+    if (attr & DIM) length += std::snprintf(text + length, sizeof(text) - length, ";2");
+    if (attr & FG_MASK) length += std::snprintf(text + length, sizeof(text) - length, ";%d", 30 + (attr & FG_MASK) - 1);
+    if (attr & BG_MASK) {
+        length += std::snprintf(text + length, sizeof(text) - length, ";%d", 40 + ((attr & BG_MASK) >> BG_SHIFT) - 1);
+    }
+    out.append(text, static_cast<size_t>(length));
+    out += 'm';
+}
+
+void FrameBuffer::drawSpan(std::string& out, int r, int from, int to, uint16_t& attr) const {
+    const Cell* cells = row(r);
+    for (int c = from; c < to; ++c) {
+        if (cells[c].size == 0) continue;
+        if (cells[c].attr != attr) {
+            attr = cells[c].attr;
+            setAttr(out, attr);
+        }
+        out.append(cells[c].glyph, cells[c].size);
+    }
+}
+
+int FrameBuffer::contentEnd(int r) const {
+    const Cell* cells = row(r);
+    int end = width;
+    while (end > 0 && cells[end - 1].size == 1 && cells[end - 1].glyph[0] == ' ' &&
+           !(cells[end - 1].attr & BG_MASK)) {
+        end--;
+    }
+    return end;
+}
+
+void FrameBuffer::paint(int top, std::string& out) const {
+    uint16_t attr = UNKNOWN_ATTR;
+    for (int r = 0; r < height; ++r) {
+        // Blank cells at the end of the row are already clear
+        int end = contentEnd(r);
+        if (end == 0) continue;
+        moveTo(out, top + r, 0);
+        drawSpan(out, r, 0, end, attr);
+    }
+    if (attr != UNKNOWN_ATTR && attr != 0) setAttr(out, 0);
+}
+
+void FrameBuffer::diff(const FrameBuffer& before, int top, std::string& out) const {
+    uint16_t attr = UNKNOWN_ATTR;
+    for (int r = 0; r < height; ++r) {
+        const Cell* now = row(r);
+        const Cell* old = before.row(r);
+        if (std::memcmp(now, old, sizeof(Cell) * width) == 0) continue;
+
+        if (ambiguous[r] || before.ambiguous[r]) {
+            moveTo(out, top + r, 0);
+            drawSpan(out, r, 0, contentEnd(r), attr);
+            if (attr != 0) {
+                attr = 0;
+                setAttr(out, attr);
+            }
+            out += "\033[K";  // Clear to the end of the line
+            continue;
+        }
+
+        int content = contentEnd(r);
+        int c = 0;
+        while (c < width) {
+            if (std::memcmp(&now[c], &old[c], sizeof(Cell)) == 0) {
+                c++;
+                continue;
+            }
+            int start = c;
+            if (now[start].size == 0 && start > 0) start--;
+            int end = c + 1;
+            for (int k = end; k < width && k - end < MERGE_GAP; ++k) {
+                if (std::memcmp(&now[k], &old[k], sizeof(Cell)) != 0) end = k + 1;
+            }
+            if (end < width && now[end].size == 0) end++;
+            moveTo(out, top + r, start);
+            if (end > content) {
+                // Everything changed past the content is blank
+                drawSpan(out, r, start, std::max(start, content), attr);
+                if (attr != 0) {
+                    attr = 0;
+                    setAttr(out, attr);
+                }
+                out += "\033[K";
+                break;
+            }
+            drawSpan(out, r, start, end, attr);
+            c = end;
+        }
+    }
+    if (attr != UNKNOWN_ATTR && attr != 0) setAttr(out, 0);
+}
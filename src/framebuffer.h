@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Grid of terminal cells holding one frame of the dashboard. compose() lays
+// out text as the renderer prints it (UTF-8 with ANSI colour codes), and
+// diff() appends the escape sequences that turn the previous frame, as the
+// terminal shows it, into this one. Emoji take two cells. Rows holding
+// glyphs whose width terminals disagree on (dingbats, variation selectors)
+// are repainted whole when they change, so a mismatch cannot shift the
+// cursor addressing of other cells.
+class FrameBuffer {
+public:
+    FrameBuffer();
+
+    // Blank `rows` x `cols` grid
+    void resize(int rows, int cols);
+    int rows() const { return height; }
+    int cols() const { return width; }
+
+    // Replace the contents with `text`, wrapping at the right edge. Rows
+    // past the bottom are dropped but still counted by lines().
+    void compose(const std::string& text);
+    int lines() const { return used; }
+
+    // Append the whole frame, drawn from screen row `top` (0-based) on a
+    // cleared screen
+    void paint(int top, std::string& out) const;
+    // Append what turns `before` (same size) into this frame
+    void diff(const FrameBuffer& before, int top, std::string& out) const;
+
+private:
+    struct Cell {
+        char glyph[7];   // UTF-8, not terminated
+        uint8_t size;    // Bytes in glyph; 0 for the right half of a wide glyph
+        uint16_t attr;   // Attribute bits below
+    };
+
+    int height;
+    int width;
+    int used;
+    std::vector<Cell> cells;
+    std::vector<uint8_t> ambiguous;  // Per row
+
+    const Cell* row(int r) const { return &cells[static_cast<size_t>(r) * width]; }
+    // Cells of row r up to the trailing blanks
+    int contentEnd(int r) const;
+    void put(int& r, int& c, const char* glyph, int size, int cellWidth, uint16_t attr);
+    static void moveTo(std::string& out, int row, int col);
+    static void setAttr(std::string& out, uint16_t attr);
+    // Draw cells [from, to) of row r, leaving the cursor after them
+    void drawSpan(std::string& out, int r, int from, int to, uint16_t& attr) const;
+};
@@ -1,35 +1,38 @@
 #include "grid.h"
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
-void GridSystem::update(ReactorState& state) {
-    // Demand fluctuates over time
-    std::uniform_int_distribution<int> fluctDist(-50, 50);
-    double fluctuation = fluctDist(state.rng);
-
+double GridSystem::baseDemand(int turn, Weather weather) {
     // Base demand varies by time of day simulation (every 10 turns is an "hour")
-    int hourOfDay = (state.turns / 10) % 24;
-    double baseDemand;
+    int hourOfDay = (turn / 10) % 24;
+    double demand;
     if (hourOfDay >= 7 && hourOfDay <= 9) {
-        baseDemand = 700.0;  // Morning peak
+        demand = 700.0;  // Morning peak
     } else if (hourOfDay >= 17 && hourOfDay <= 21) {
-        baseDemand = 800.0;  // Evening peak
+        demand = 800.0;  // Evening peak
     } else if (hourOfDay >= 0 && hourOfDay <= 5) {
-        baseDemand = 300.0;  // Night low
+        demand = 300.0;  // Night low
     } else {
-        baseDemand = 500.0;  // Normal
+        demand = 500.0;  // Normal
     }
 
     // Weather affects demand
-    if (state.currentWeather == Weather::HEATWAVE) {
-        baseDemand *= 1.3;  // AC usage
-    } else if (state.currentWeather == Weather::COLD_SNAP) {
-        baseDemand *= 1.2;  // Heating
+    if (weather == Weather::HEATWAVE) {
+        demand *= 1.3;  // AC usage
+    } else if (weather == Weather::COLD_SNAP) {
+        demand *= 1.2;  // Heating
     }
+    return demand;
+}
+
+void GridSystem::update(ReactorState& state) {
+    // Demand fluctuates over time
+    CounterRng rng = state.rngStream(RngStream::GRID);
+    std::uniform_int_distribution<int> fluctDist(-50, 50);
+    double fluctuation = fluctDist(rng);
 
-    state.gridDemand = std::max(200.0, std::min(1000.0, baseDemand + fluctuation));
+    double demand = baseDemand(state.turns, state.currentWeather) + fluctuation;
+    state.gridDemand = std::max(200.0, std::min(1000.0, demand));
 
     // Calculate satisfaction
     double effectiveOutput = state.electricityOutput;
@@ -52,17 +55,8 @@ void GridSystem::update(ReactorState& state) {
 
     // Warnings
     if (state.demandSatisfaction < 30.0) {
-        std::ostringstream oss;
-        oss << Color::RED << Color::BOLD
-            << "\xe2\x9a\xa0 GRID ALERT: Power output critically below demand! ("
-            << std::fixed << std::setprecision(0) << state.demandSatisfaction << "%)"
-            << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::GRID_CRITICAL, Severity::WARNING, state.demandSatisfaction);
     } else if (state.demandSatisfaction < 60.0) {
-        std::ostringstream oss;
-        oss << Color::YELLOW
-            << "\xe2\x9a\xa0 Low grid satisfaction: " << std::fixed << std::setprecision(0) << state.demandSatisfaction << "%"
-            << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::GRID_LOW, Severity::WARNING, state.demandSatisfaction);
     }
 }
@@ -5,4 +5,6 @@
 class GridSystem {
 public:
     static void update(ReactorState& state);
+    // Demand before its random fluctuation, by hour of the day and weather
+    static double baseDemand(int turn, Weather weather);
 };
@@ -0,0 +1,441 @@
+#include "history.h"
+#include "reactor_state.h"
+#include "models.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<StateSnapshot>::value, "snapshots are copied as bytes");
+// Fixed-width fields in size order leave no padding; a new field that breaks
+// this needs a reserved slot, and SH::SNAPSHOT_VERSION bumped either way
+static_assert(sizeof(StateSnapshot) == 424, "StateSnapshot layout changed");
+
+namespace {
+const size_t SNAPSHOT_BYTES = sizeof(StateSnapshot);
+const size_t SNAPSHOT_WORDS = SNAPSHOT_BYTES / 8;
+
+void putVarint(std::vector<unsigned char>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// False if the varint runs past `end` or overflows
+bool getVarint(const unsigned char*& in, const unsigned char* end, size_t& value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        unsigned char byte = *in++;
+        value |= static_cast<size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t loadWord(const unsigned char* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+// Delta: varint word count, then per changed word a varint index gap, a byte
+// with the leading (high nibble) and trailing (low nibble) zero byte counts
+// of the XOR, and the bytes between them
+void encodeDelta(const unsigned char* previous, const unsigned char* current, std::vector<unsigned char>& out) {
+    size_t changed = 0;
+    for (size_t w = 0; w < SNAPSHOT_WORDS; ++w) {
+        if (loadWord(previous + w * 8) != loadWord(current + w * 8)) changed++;
+    }
+    putVarint(out, changed);
+
+    size_t last = 0;
+    for (size_t w = 0; w < SNAPSHOT_WORDS; ++w) {
+        uint64_t x = loadWord(previous + w * 8) ^ loadWord(current + w * 8);
+        if (!x) continue;
+        int trailing = 0, leading = 0;
+        while (!(x >> (trailing * 8) & 0xff)) trailing++;
+        while (!(x >> ((7 - leading) * 8) & 0xff)) leading++;
+        putVarint(out, w - last);
+        out.push_back(static_cast<unsigned char>(leading << 4 | trailing));
+        for (int b = trailing; b < 8 - leading; ++b) out.push_back(static_cast<unsigned char>(x >> (b * 8)));
+        last = w;
+    }
+}
+}
+
+StateHistory::StateHistory(size_t turns)
+    : segments(turns / SH::KEYFRAME_INTERVAL + 2),
+      first(0),
+      used(0),
+      retained(0),
+      newest(SNAPSHOT_BYTES)
+{
+    for (Segment& s : segments) {
+        s.keyframe.resize(SNAPSHOT_BYTES);
+        s.loggedBefore = 0;
+        s.turns = 0;
+    }
+}
+
+void StateHistory::clear() {
+    first = used = retained = 0;
+    baseLog.clear();
+}
+
+size_t StateHistory::bytes() const {
+    size_t total = baseLog.size() * sizeof(LogEntry);
+    for (size_t i = 0; i < used; ++i) {
+        const Segment& s = segments[(first + i) % segments.size()];
+        total += SNAPSHOT_BYTES + s.deltas.size() + s.log.size() * sizeof(LogEntry);
+    }
+    return total;
+}
+
+uint64_t StateHistory::loggedEntries(const unsigned char* snapshot) {
+    uint64_t logged;
+    std::memcpy(&logged, snapshot + offsetof(StateSnapshot, loggedEntries), sizeof(logged));
+    return logged;
+}
+
+size_t StateHistory::added(uint64_t logged, uint64_t loggedBefore) {
+    uint64_t count = logged - loggedBefore;
+    return count < RC::MAX_LOG_ENTRIES ? static_cast<size_t>(count) : RC::MAX_LOG_ENTRIES;
+}
+
+void StateHistory::record(const ReactorState& state) {
+    capture(state, this->current);
+    const unsigned char* current = reinterpret_cast<const unsigned char*>(&this->current);
+
+    Segment* s;
+    uint64_t loggedBefore = used == 0 ? this->current.loggedEntries : loggedEntries(&newest[0]);
+    if (used == 0 || segment(used - 1).turns == static_cast<size_t>(SH::KEYFRAME_INTERVAL)) {
+        if (used == segments.size()) {
+            Segment& oldest = segment(0);
+            for (const LogEntry& entry : oldest.log) baseLog.push(entry);
+            retained -= oldest.turns;
+            first = (first + 1) % segments.size();
+            used--;
+        }
+        // A new history starts from the log as it stands
+        if (used == 0) baseLog = state.operatorLog;
+        s = &segment(used++);
+        std::memcpy(&s->keyframe[0], current, SNAPSHOT_BYTES);
+        s->deltas.clear();  // Keeps its capacity for the next pass round the ring
+        s->log.clear();
+        s->loggedBefore = loggedBefore;
+        s->turns = 1;
+    } else {
+        s = &segment(used - 1);
+        encodeDelta(&newest[0], current, s->deltas);
+        s->turns++;
+    }
+    // The entries added since the previous turn are the newest in the log
+    size_t count = std::min(added(this->current.loggedEntries, loggedBefore), state.operatorLog.size());
+    for (size_t i = state.operatorLog.size() - count; i < state.operatorLog.size(); ++i) {
+        s->log.push_back(state.operatorLog[i]);
+    }
+    std::memcpy(&newest[0], current, SNAPSHOT_BYTES);
+    retained++;
+}
+
+size_t StateHistory::applyDelta(const unsigned char* delta, size_t size, unsigned char* snapshot) {
+    const unsigned char* in = delta;
+    const unsigned char* end = delta + size;
+    size_t changed;
+    if (!getVarint(in, end, changed) || changed > SNAPSHOT_WORDS) return 0;
+    size_t w = 0;
+    for (size_t i = 0; i < changed; ++i) {
+        size_t gap;
+        if (!getVarint(in, end, gap) || gap >= SNAPSHOT_WORDS - w || in == end) return 0;
+        w += gap;
+        int leading = *in >> 4, trailing = *in & 0x0f;
+        in++;
+        // Each run is one word of at most 8 bytes, all inside the delta
+        if (leading + trailing > 8 || end - in < 8 - leading - trailing) return 0;
+        uint64_t x = 0;
+        for (int b = trailing; b < 8 - leading; ++b) x |= static_cast<uint64_t>(*in++) << (b * 8);
+        uint64_t word = loadWord(snapshot + w * 8) ^ x;
+        std::memcpy(snapshot + w * 8, &word, sizeof(word));
+    }
+    return static_cast<size_t>(in - delta);
+}
+
+bool StateHistory::rewind(ReactorState& state, size_t steps) {
+    if (steps == 0 || steps >= retained) return false;
+
+    // Every segment but the newest is full, so the target's position is direct
+    size_t target = retained - 1 - steps;
+    size_t index = target / SH::KEYFRAME_INTERVAL;
+    size_t offset = target % SH::KEYFRAME_INTERVAL;
+    Segment& s = segment(index);
+
+    std::memcpy(&newest[0], &s.keyframe[0], SNAPSHOT_BYTES);
+    size_t position = 0;
+    size_t logged = added(loggedEntries(&newest[0]), s.loggedBefore);
+    for (size_t t = 0; t < offset; ++t) {
+        uint64_t before = loggedEntries(&newest[0]);
+        position += applyDelta(s.deltas.data() + position, s.deltas.size() - position, &newest[0]);
+        logged += added(loggedEntries(&newest[0]), before);
+    }
+
+    // Later turns become unreachable
+    retained -= steps;
+    s.deltas.resize(position);
+    s.log.resize(std::min(logged, s.log.size()));
+    s.turns = offset + 1;
+    used = index + 1;
+
+    StateSnapshot snapshot;
+    std::memcpy(&snapshot, &newest[0], SNAPSHOT_BYTES);
+    restoreSnapshot(state, snapshot);
+    state.operatorLog = baseLog;
+    for (size_t i = 0; i < used; ++i) {
+        for (const LogEntry& entry : segment(i).log) state.operatorLog.push(entry);
+    }
+    CoreModels::reset(state);
+    return true;
+}
+
+void StateHistory::capture(const ReactorState& state, StateSnapshot& s) {
+    std::memset(&s, 0, sizeof(s));
+    s.neutrons = state.neutrons;
+    s.controlRods = state.controlRods;
+    s.temperature = state.temperature;
+    s.coolant = state.coolant;
+    s.power = state.power;
+    s.fuel = state.fuel;
+    for (int g = 0; g < PK::GROUPS; ++g) s.precursors[g] = state.kinetics.precursors[g];
+    s.kineticsStep = state.kinetics.step;
+    s.kineticsReactivity = state.kinetics.reactivity;
+    s.xenonLevel = state.xenonLevel;
+    s.turbineRPM = state.turbineRPM;
+    s.steamPressure = state.steamPressure;
+    s.electricityOutput = state.electricityOutput;
+    s.totalElectricityGenerated = state.totalElectricityGenerated;
+    s.dieselFuel = state.dieselFuel;
+    s.radiationLevel = state.radiationLevel;
+    s.totalRadiationExposure = state.totalRadiationExposure;
+    s.gridDemand = state.gridDemand;
+    s.demandSatisfaction = state.demandSatisfaction;
+    s.containmentIntegrity = state.containmentIntegrity;
+    s.peakTemperature = state.peakTemperature;
+    s.peakPower = state.peakPower;
+    s.peakElectricity = state.peakElectricity;
+    s.totalPowerGenerated = state.totalPowerGenerated;
+    s.averageTemperature = state.averageTemperature;
+    s.temperatureSum = state.temperatureSum;
+    s.lowestCoolant = state.lowestCoolant;
+    s.highestXenon = state.highestXenon;
+    s.rngSeed = state.rng.seed;
+    s.loggedEntries = state.loggedEntries;
+
+    s.difficulty = static_cast<int32_t>(state.currentDifficulty.level);
+    s.xenonHandledCount = state.xenonHandledCount;
+    s.maxTurbineTurns = state.maxTurbineTurns;
+    s.pressureWarnings = state.pressureWarnings;
+    s.eccsCooldownTimer = state.eccsCooldownTimer;
+    s.dieselRuntime = state.dieselRuntime;
+    s.radiationAlarms = state.radiationAlarms;
+    s.weather = static_cast<int32_t>(state.currentWeather);
+    s.weatherDuration = state.weatherDuration;
+    s.weatherChangeCooldown = state.weatherChangeCooldown;
+    s.demandBonus = state.demandBonus;
+    s.demandPenalty = state.demandPenalty;
+    s.lastTipTurn = state.lastTipTurn;
+    s.highSatisfactionTurns = state.highSatisfactionTurns;
+    s.stormsSurvived = state.stormsSurvived;
+    s.turnsWithoutPressureRelief = state.turnsWithoutPressureRelief;
+    s.safeRadiationTurns = state.safeRadiationTurns;
+    s.score = state.score;
+    s.turns = state.turns;
+    s.scramCount = state.scramCount;
+    s.eventsExperienced = state.eventsExperienced;
+    s.turnsWithoutScram = state.turnsWithoutScram;
+    s.scramRecoveries = state.scramRecoveries;
+    s.criticalEvents = state.criticalEvents;
+    s.unlockedAchievements = state.unlockedAchievements.mask();
+    s.sessionAchievements = state.sessionAchievements.mask();
+    s.rngRunId = state.rng.runId;
+    s.rngTurn = state.rng.turn;
+    for (int i = 0; i < static_cast<int>(RngStream::STREAM_COUNT); ++i) s.rngDraws[i] = state.rng.draws[i];
+
+    s.running = state.running;
+    s.kineticsEnabled = state.kinetics.enabled;
+    s.turbineOnline = state.turbineOnline;
+    s.pressureReliefOpen = state.pressureReliefOpen;
+    s.eccsAvailable = state.eccsAvailable;
+    s.dieselRunning = state.dieselRunning;
+    s.dieselAutoStart = state.dieselAutoStart;
+    s.containmentBreach = state.containmentBreach;
+    s.paused = state.paused;
+    s.autoRods = state.autoRods;
+}
+
+void StateHistory::restoreSnapshot(ReactorState& state, const StateSnapshot& s) {
+    state.neutrons = s.neutrons;
+    state.controlRods = s.controlRods;
+    state.temperature = s.temperature;
+    state.coolant = s.coolant;
+    state.power = s.power;
+    state.fuel = s.fuel;
+    for (int g = 0; g < PK::GROUPS; ++g) state.kinetics.precursors[g] = s.precursors[g];
+    state.kinetics.step = s.kineticsStep;
+    state.kinetics.reactivity = s.kineticsReactivity;
+    state.xenonLevel = s.xenonLevel;
+    state.turbineRPM = s.turbineRPM;
+    state.steamPressure = s.steamPressure;
+    state.electricityOutput = s.electricityOutput;
+    state.totalElectricityGenerated = s.totalElectricityGenerated;
+    state.dieselFuel = s.dieselFuel;
+    state.radiationLevel = s.radiationLevel;
+    state.totalRadiationExposure = s.totalRadiationExposure;
+    state.gridDemand = s.gridDemand;
+    state.demandSatisfaction = s.demandSatisfaction;
+    state.containmentIntegrity = s.containmentIntegrity;
+    state.peakTemperature = s.peakTemperature;
+    state.peakPower = s.peakPower;
+    state.peakElectricity = s.peakElectricity;
+    state.totalPowerGenerated = s.totalPowerGenerated;
+    state.averageTemperature = s.averageTemperature;
+    state.temperatureSum = s.temperatureSum;
+    state.lowestCoolant = s.lowestCoolant;
+    state.highestXenon = s.highestXenon;
+    state.rng.seed = s.rngSeed;
+    state.loggedEntries = s.loggedEntries;
+
+    state.xenonHandledCount = s.xenonHandledCount;
+    state.maxTurbineTurns = s.maxTurbineTurns;
+    state.pressureWarnings = s.pressureWarnings;
+    state.eccsCooldownTimer = s.eccsCooldownTimer;
+    state.dieselRuntime = s.dieselRuntime;
+    state.radiationAlarms = s.radiationAlarms;
+    state.currentWeather = static_cast<Weather>(s.weather);
+    state.weatherDuration = s.weatherDuration;
+    state.weatherChangeCooldown = s.weatherChangeCooldown;
+    state.demandBonus = s.demandBonus;
+    state.demandPenalty = s.demandPenalty;
+    state.lastTipTurn = s.lastTipTurn;
+    state.highSatisfactionTurns = s.highSatisfactionTurns;
+    state.stormsSurvived = s.stormsSurvived;
+    state.turnsWithoutPressureRelief = s.turnsWithoutPressureRelief;
+    state.safeRadiationTurns = s.safeRadiationTurns;
+    state.score = s.score;
+    state.turns = s.turns;
+    state.scramCount = s.scramCount;
+    state.eventsExperienced = s.eventsExperienced;
+    state.turnsWithoutScram = s.turnsWithoutScram;
+    state.scramRecoveries = s.scramRecoveries;
+    state.criticalEvents = s.criticalEvents;
+    state.rng.runId = s.rngRunId;
+    state.rng.turn = s.rngTurn;
+    for (int i = 0; i < static_cast<int>(RngStream::STREAM_COUNT); ++i) state.rng.draws[i] = s.rngDraws[i];
+
+    state.running = s.running != 0;
+    state.turbineOnline = s.turbineOnline != 0;
+    state.pressureReliefOpen = s.pressureReliefOpen != 0;
+    state.eccsAvailable = s.eccsAvailable != 0;
+    state.dieselRunning = s.dieselRunning != 0;
+    state.dieselAutoStart = s.dieselAutoStart != 0;
+    state.containmentBreach = s.containmentBreach != 0;
+    state.autoRods = s.autoRods != 0;
+
+    state.clearMessages();
+
+    // The models in use are the ones chosen for this session
+    if (state.kinetics.enabled && !s.kineticsEnabled) PointKinetics::reset(state.kinetics, state.neutrons);
+}
+
+void StateHistory::serialize(std::vector<unsigned char>& out) const {
+    // Header: snapshot version, segment count and base log entry count, then
+    // the base log oldest first, then per segment its turn count, delta byte
+    // count, log entry count and loggedBefore, keyframe, deltas and log
+    uint32_t header[3] = {SH::SNAPSHOT_VERSION, static_cast<uint32_t>(used), static_cast<uint32_t>(baseLog.size())};
+    out.clear();
+    out.reserve(sizeof(header) + bytes() + used * (3 * sizeof(uint32_t) + sizeof(uint64_t)));
+    const unsigned char* h = reinterpret_cast<const unsigned char*>(header);
+    out.insert(out.end(), h, h + sizeof(header));
+    for (size_t i = 0; i < baseLog.size(); ++i) {
+        const unsigned char* e = reinterpret_cast<const unsigned char*>(&baseLog[i]);
+        out.insert(out.end(), e, e + sizeof(LogEntry));
+    }
+    for (size_t i = 0; i < used; ++i) {
+        const Segment& s = segments[(first + i) % segments.size()];
+        uint32_t sizes[3] = {static_cast<uint32_t>(s.turns), static_cast<uint32_t>(s.deltas.size()),
+                             static_cast<uint32_t>(s.log.size())};
+        const unsigned char* z = reinterpret_cast<const unsigned char*>(sizes);
+        out.insert(out.end(), z, z + sizeof(sizes));
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(&s.loggedBefore);
+        out.insert(out.end(), b, b + sizeof(s.loggedBefore));
+        out.insert(out.end(), s.keyframe.begin(), s.keyframe.end());
+        out.insert(out.end(), s.deltas.begin(), s.deltas.end());
+        const unsigned char* l = reinterpret_cast<const unsigned char*>(s.log.data());
+        out.insert(out.end(), l, l + s.log.size() * sizeof(LogEntry));
+    }
+}
+
+bool StateHistory::restore(const unsigned char* data, size_t size) {
+    clear();
+    const unsigned char* end = data + size;
+    uint32_t header[3];
+    if (size < sizeof(header)) return false;
+    std::memcpy(header, data, sizeof(header));
+    data += sizeof(header);
+    if (header[0] != SH::SNAPSHOT_VERSION || header[1] > segments.size() || header[1] == 0 ||
+        header[2] > RC::MAX_LOG_ENTRIES || static_cast<size_t>(end - data) < header[2] * sizeof(LogEntry)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header[2]; ++i) {
+        LogEntry entry;
+        std::memcpy(&entry, data, sizeof(entry));
+        baseLog.push(entry);
+        data += sizeof(entry);
+    }
+
+    for (uint32_t i = 0; i < header[1]; ++i) {
+        uint32_t sizes[3];
+        uint64_t loggedBefore;
+        if (static_cast<size_t>(end - data) < sizeof(sizes) + sizeof(loggedBefore)) break;
+        std::memcpy(sizes, data, sizeof(sizes));
+        std::memcpy(&loggedBefore, data + sizeof(sizes), sizeof(loggedBefore));
+        data += sizeof(sizes) + sizeof(loggedBefore);
+        size_t logBytes = static_cast<size_t>(sizes[2]) * sizeof(LogEntry);
+        if (sizes[0] < 1 || sizes[0] > static_cast<uint32_t>(SH::KEYFRAME_INTERVAL) ||
+            sizes[2] > sizes[0] * static_cast<size_t>(RC::MAX_LOG_ENTRIES) ||
+            static_cast<size_t>(end - data) < SNAPSHOT_BYTES + sizes[1] + logBytes) {
+            break;
+        }
+        Segment& s = segments[i];
+        std::memcpy(&s.keyframe[0], data, SNAPSHOT_BYTES);
+        data += SNAPSHOT_BYTES;
+        s.deltas.assign(data, data + sizes[1]);
+        data += sizes[1];
+        // Every delta must decode inside the snapshot and the segment's
+        // bytes, or restoring a turn would write out of bounds
+        std::memcpy(&newest[0], &s.keyframe[0], SNAPSHOT_BYTES);
+        size_t position = 0, read = 1;
+        for (size_t t = 1; read && t < sizes[0]; ++t) {
+            read = applyDelta(s.deltas.data() + position, s.deltas.size() - position, &newest[0]);
+            position += read;
+        }
+        if (!read || position != s.deltas.size()) break;
+        s.log.resize(sizes[2]);
+        if (logBytes) std::memcpy(&s.log[0], data, logBytes);
+        data += logBytes;
+        s.loggedBefore = loggedBefore;
+        s.turns = sizes[0];
+        used++;
+        retained += s.turns;
+        // Only the newest segment may be partial
+        if (s.turns < static_cast<size_t>(SH::KEYFRAME_INTERVAL)) break;
+    }
+    if (used != header[1]) {
+        clear();
+        return false;
+    }
+    // Checking the newest segment left its last snapshot in `newest`, ready
+    // for the next delta
+    return true;
+}
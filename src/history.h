@@ -0,0 +1,169 @@
+#pragma once
+
+#include "types.h"
+#include "constants.h"
+#include "kinetics.h"
+#include "rng.h"
+#include "ring_buffer.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct ReactorState;
+
+// Per-turn snapshots of the simulation for `rewind` (interactive play only).
+// Snapshots are StateSnapshot records. Every SH::KEYFRAME_INTERVAL turns a
+// full keyframe is stored; the turns in between are XOR deltas against the
+// previous turn, keeping only the 8-byte words that changed with their zero
+// bytes trimmed. The achievement sets and other fields that did not change
+// cost nothing. The operator log is kept apart from the snapshots: each turn
+// stores only the entries it added, and the log as it was before the oldest
+// keyframe is kept once.
+// Restoring applies at most one keyframe and KEYFRAME_INTERVAL - 1 deltas.
+namespace SH {
+    static constexpr int KEYFRAME_INTERVAL = 64;
+    // Stored with serialized histories and recordings; bump on any change to StateSnapshot
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+}
+
+// The simulated part of ReactorState as fixed-width plain data: no pointers,
+// no difficulty table, no padding. Fields are copied one by one (see
+// StateHistory::capture), so ReactorState can change layout freely; adding a
+// gameplay field means adding it here and bumping SH::SNAPSHOT_VERSION.
+// Achievements are bit masks. The operator log is not part of it; only the
+// count of entries ever added is, which tells a history how many a turn added.
+struct StateSnapshot {
+    double neutrons;
+    double controlRods;
+    double temperature;
+    double coolant;
+    double power;
+    double fuel;
+    double precursors[PK::GROUPS];
+    double kineticsStep;
+    double kineticsReactivity;
+    double xenonLevel;
+    double turbineRPM;
+    double steamPressure;
+    double electricityOutput;
+    double totalElectricityGenerated;
+    double dieselFuel;
+    double radiationLevel;
+    double totalRadiationExposure;
+    double gridDemand;
+    double demandSatisfaction;
+    double containmentIntegrity;
+    double peakTemperature;
+    double peakPower;
+    double peakElectricity;
+    double totalPowerGenerated;
+    double averageTemperature;
+    double temperatureSum;
+    double lowestCoolant;
+    double highestXenon;
+    uint64_t rngSeed;
+    uint64_t loggedEntries;
+
+    int32_t difficulty;
+    int32_t xenonHandledCount;
+    int32_t maxTurbineTurns;
+    int32_t pressureWarnings;
+    int32_t eccsCooldownTimer;
+    int32_t dieselRuntime;
+    int32_t radiationAlarms;
+    int32_t weather;
+    int32_t weatherDuration;
+    int32_t weatherChangeCooldown;
+    int32_t demandBonus;
+    int32_t demandPenalty;
+    int32_t lastTipTurn;
+    int32_t highSatisfactionTurns;
+    int32_t stormsSurvived;
+    int32_t turnsWithoutPressureRelief;
+    int32_t safeRadiationTurns;
+    int32_t score;
+    int32_t turns;
+    int32_t scramCount;
+    int32_t eventsExperienced;
+    int32_t turnsWithoutScram;
+    int32_t scramRecoveries;
+    int32_t criticalEvents;
+    uint32_t unlockedAchievements;
+    uint32_t sessionAchievements;
+    uint32_t rngRunId;
+    int32_t rngTurn;
+    uint32_t rngDraws[static_cast<int>(RngStream::STREAM_COUNT)];
+
+    uint8_t running;
+    uint8_t kineticsEnabled;
+    uint8_t turbineOnline;
+    uint8_t pressureReliefOpen;
+    uint8_t eccsAvailable;
+    uint8_t dieselRunning;
+    uint8_t dieselAutoStart;
+    uint8_t containmentBreach;
+    uint8_t paused;
+    uint8_t autoRods;
+    uint8_t reserved[6];
+};
+
+class StateHistory {
+public:
+    // Retains at least `turns` snapshots, oldest dropped a keyframe at a time
+    explicit StateHistory(size_t turns = RC::HISTORY_TURNS);
+
+    // Snapshot the state after a completed turn
+    void record(const ReactorState& state);
+
+    // Restore the snapshot `steps` turns before the newest and drop the later
+    // ones. The attached models keep no history, so they restart from the
+    // restored core. False if fewer snapshots are retained.
+    bool rewind(ReactorState& state, size_t steps);
+
+    void clear();
+    size_t size() const { return retained; }
+    size_t bytes() const;  // Keyframes, deltas and log entries in use
+
+    // Retained snapshots as one buffer for save files, and back. restore()
+    // rejects data from another SH::SNAPSHOT_VERSION, or with a delta that
+    // does not decode inside its snapshot, and leaves the history empty.
+    void serialize(std::vector<unsigned char>& out) const;
+    bool restore(const unsigned char* data, size_t size);
+
+    // Copy the simulated fields of state; padding is zeroed
+    static void capture(const ReactorState& state, StateSnapshot& snapshot);
+
+    // Overwrite the simulated fields of state with a snapshot. The difficulty,
+    // achievements, high score and operator preferences keep their values;
+    // the operator log is the caller's to restore, and the spatial, channel
+    // and depletion models are left alone (see CoreModels::reset).
+    static void restoreSnapshot(ReactorState& state, const StateSnapshot& snapshot);
+
+private:
+    struct Segment {
+        std::vector<unsigned char> keyframe;
+        std::vector<unsigned char> deltas;  // Encoded turns after the keyframe
+        std::vector<LogEntry> log;          // Entries its turns added, keyframe included
+        uint64_t loggedBefore;              // loggedEntries of the turn before the keyframe
+        size_t turns;                       // Keyframe included
+    };
+
+    std::vector<Segment> segments;  // Ring, oldest at `first`
+    size_t first;
+    size_t used;
+    size_t retained;
+    std::vector<unsigned char> newest;  // Last recorded snapshot, for the next delta
+    StateSnapshot current;              // Capture buffer for record()
+    // The operator log as of the oldest segment's loggedBefore
+    RingBuffer<LogEntry, RC::MAX_LOG_ENTRIES> baseLog;
+
+    Segment& segment(size_t i) { return segments[(first + i) % segments.size()]; }
+    // Bytes of the delta read, or 0 if it is malformed: a word past the
+    // snapshot or bytes past `size`
+    static size_t applyDelta(const unsigned char* delta, size_t size, unsigned char* snapshot);
+    static uint64_t loggedEntries(const unsigned char* snapshot);
+    // Entries a turn added, of those kept: a turn that adds a full log's
+    // worth pushes out every earlier one
+    static size_t added(uint64_t logged, uint64_t loggedBefore);
+};
@@ -2,6 +2,11 @@
 #include "renderer.h"
 #include "emergency.h"
 #include "persistence.h"
+#include "history.h"
+#include "trends.h"
+#include "perf.h"
+#include "autopilot.h"
+#include "terminal.h"
 
 #include <iostream>
 #include <iomanip>
@@ -19,18 +24,40 @@ double InputHandler::parseControlRodInput(const std::string& input, double curre
     }
 }
 
-InputResult InputHandler::handleInput(ReactorState& state) {
+int InputHandler::parseSlot(const std::string& input) {
+    size_t space = input.find(' ');
+    if (space == std::string::npos) return 1;
+    try {
+        size_t used = 0;
+        std::string argument = input.substr(space + 1);
+        int slot = std::stoi(argument, &used);
+        if (used != argument.size() || slot < 0 || slot >= RC::SAVE_SLOTS) return -1;
+        return slot;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+bool InputHandler::readCommand(const ReactorState& state, std::string& input) {
     std::cout << Color::GREEN << "\nControl rods (0-100%, current "
               << static_cast<int>(state.controlRods * 100)
               << "%): " << Color::RESET;
+    return static_cast<bool>(std::getline(std::cin, input));
+}
 
-    std::string input;
-    if (!std::getline(std::cin, input)) {
-        return InputResult::QUIT;
-    }
+bool InputHandler::isScreen(const std::string& input) {
+    return input == "h" || input == "help" || input == "a" || input == "stats" ||
+           input == "log" || input.compare(0, 4, "log ") == 0;
+}
 
+InputResult InputHandler::execute(ReactorState& state, const std::string& input) {
     if (input == "q") return InputResult::QUIT;
 
+    // Screens wait for Enter, so headless runs skip them
+    bool screen = isScreen(input);
+    if (screen && state.headless) return InputResult::CONTINUE;
+    if (screen) Terminal::suspend();
+
     if (input == "h" || input == "help") {
         Renderer::displayHelp(state);
         return InputResult::CONTINUE;
@@ -43,8 +70,23 @@ InputResult InputHandler::handleInput(ReactorState& state) {
         Renderer::displayStatistics(state);
         return InputResult::CONTINUE;
     }
-    if (input == "log") {
-        Renderer::displayLog(state);
+    if (input == "log" || input.compare(0, 4, "log ") == 0) {
+        LogFilter filter;
+        if (!LogFilter::parse(input.substr(3), filter)) {
+            std::cout << Color::YELLOW << "Usage: log [action|event|warning|critical ...] [turn | first-last]"
+                      << Color::RESET << "\n";
+        } else {
+            Renderer::displayLog(state, filter);
+        }
+        return InputResult::CONTINUE;
+    }
+    if (input == "perf") {
+        Perf::report(std::cout);
+        return InputResult::CONTINUE;
+    }
+    if (input == "perf reset") {
+        Perf::reset();
+        std::cout << Color::GREEN << "Timing counters cleared." << Color::RESET << "\n";
         return InputResult::CONTINUE;
     }
 
@@ -53,7 +95,7 @@ InputResult InputHandler::handleInput(ReactorState& state) {
         state.score = std::max(0, state.score - RC::REFILL_PENALTY);
         std::cout << Color::GREEN << "Coolant refilled! " << Color::RESET
                   << Color::RED << "(-" << RC::REFILL_PENALTY << " pts)" << Color::RESET << "\n";
-        state.addLogEntry("ACTION", "Coolant system refilled to 100%");
+        state.addLogEntry(LogType::ACTION, LogCode::COOLANT_REFILLED);
         return InputResult::CONTINUE;
     }
 
@@ -63,7 +105,7 @@ InputResult InputHandler::handleInput(ReactorState& state) {
             ? std::string(Color::GREEN) + "Turbine starting..."
             : std::string(Color::YELLOW) + "Turbine stopping...")
             << Color::RESET << "\n";
-        state.addLogEntry("ACTION", state.turbineOnline ? "Turbine brought online" : "Turbine taken offline");
+        state.addLogEntry(LogType::ACTION, state.turbineOnline ? LogCode::TURBINE_ONLINE : LogCode::TURBINE_OFFLINE);
         return InputResult::CONTINUE;
     }
 
@@ -91,26 +133,145 @@ InputResult InputHandler::handleInput(ReactorState& state) {
             ? std::string(Color::GREEN) + "\xf0\x9f\x94\x8c Diesel auto-start ENABLED"
             : std::string(Color::YELLOW) + "\xf0\x9f\x94\x8c Diesel auto-start DISABLED")
             << Color::RESET << "\n";
-        state.addLogEntry("ACTION", state.dieselAutoStart ? "Diesel auto-start enabled" : "Diesel auto-start disabled");
+        state.addLogEntry(LogType::ACTION, state.dieselAutoStart ? LogCode::DIESEL_AUTO_ENABLED : LogCode::DIESEL_AUTO_DISABLED);
         return InputResult::CONTINUE;
     }
 
-    if (input == "save" || input == "s") {
-        if (PersistenceSystem::saveGame(state)) {
+    if (input == "auto") {
+        if (!state.autopilot) {
+            std::cout << Color::YELLOW << "The autopilot predicts with the basic core model, so it is not available "
+                      << "with --kinetics, --spatial, --channels or --depletion." << Color::RESET << "\n";
+            return InputResult::CONTINUE;
+        }
+        state.autoRods = !state.autoRods;
+        if (state.autoRods) {
+            // Plan once now so the operator sees where the rods are headed
+            state.autopilot->decide(state);
+            const AutopilotPlan& plan = state.autopilot->lastPlan();
+            std::cout << Color::GREEN << "\xf0\x9f\xa4\x96 Autopilot engaged: rods to " << static_cast<int>(plan.rods * 100 + 0.5)
+                      << "%, " << static_cast<int>(plan.satisfaction) << "% of demand expected over the next "
+                      << AP::HORIZON << " turns" << Color::RESET << "\n";
+            std::cout << Color::DIM << "Enter a rod setting to take over." << Color::RESET << "\n";
+        } else {
+            std::cout << Color::YELLOW << "\xf0\x9f\xa4\x96 Autopilot disengaged" << Color::RESET << "\n";
+        }
+        state.addLogEntry(LogType::ACTION, state.autoRods ? LogCode::AUTOPILOT_ENGAGED : LogCode::AUTOPILOT_DISENGAGED);
+        return InputResult::CONTINUE;
+    }
+
+    std::string command = input.substr(0, input.find(' '));
+    bool slotCommand = command == "save" || command == "s" || command == "load" || command == "l" ||
+                       input == "slots" || input == "autosave";
+    if (slotCommand && state.headless) {
+        std::cout << Color::YELLOW << "Save slots are not used in headless runs." << Color::RESET << "\n";
+        return InputResult::CONTINUE;
+    }
+
+    if (command == "save" || command == "s") {
+        int slot = parseSlot(input);
+        if (slot < 0) {
+            std::cout << Color::YELLOW << "Usage: save [slot 0-" << RC::SAVE_SLOTS - 1 << "]" << Color::RESET << "\n";
+        } else if (PersistenceSystem::saveGame(state, slot)) {
             if (state.soundEnabled) Sound::beep();
-            std::cout << Color::GREEN << "\xf0\x9f\x92\xbe Game saved successfully!" << Color::RESET << "\n";
+            std::cout << Color::GREEN << "\xf0\x9f\x92\xbe Game saved to slot " << slot << "!" << Color::RESET << "\n";
         } else {
             std::cout << Color::RED << "Failed to save game." << Color::RESET << "\n";
         }
         return InputResult::CONTINUE;
     }
 
-    if (input == "load" || input == "l") {
-        if (PersistenceSystem::loadGame(state)) {
+    if (command == "load" || command == "l") {
+        int slot = parseSlot(input);
+        LoadResult result = slot < 0 ? LoadResult::MISSING : PersistenceSystem::loadGame(state, slot);
+        if (slot < 0) {
+            std::cout << Color::YELLOW << "Usage: load [slot 0-" << RC::SAVE_SLOTS - 1 << "]" << Color::RESET << "\n";
+        } else if (result == LoadResult::OK) {
             if (state.soundEnabled) Sound::beep();
-            std::cout << Color::GREEN << "\xf0\x9f\x92\xbe Game loaded successfully!" << Color::RESET << "\n";
+            std::cout << Color::GREEN << "\xf0\x9f\x92\xbe Game loaded from slot " << slot << "!" << Color::RESET << "\n";
+            return InputResult::RESTORED;
+        } else if (result == LoadResult::MISSING) {
+            std::cout << Color::RED << "No save in slot " << slot << "." << Color::RESET << "\n";
+        } else if (result == LoadResult::DAMAGED) {
+            std::cout << Color::RED << "Save in slot " << slot << " is damaged (checksum mismatch or truncated)."
+                      << Color::RESET << "\n";
         } else {
-            std::cout << Color::RED << "No save file found." << Color::RESET << "\n";
+            std::cout << Color::RED << "Save in slot " << slot << " is from an incompatible version."
+                      << Color::RESET << "\n";
+        }
+        return InputResult::CONTINUE;
+    }
+
+    if (input == "slots") {
+        Renderer::displaySlots();
+        return InputResult::CONTINUE;
+    }
+
+    if (input == "autosave") {
+        state.autosave = !state.autosave;
+        std::cout << (state.autosave
+            ? std::string(Color::GREEN) + "\xf0\x9f\x92\xbe Autosave to slot " + std::to_string(RC::AUTOSAVE_SLOT) + " enabled"
+            : std::string(Color::YELLOW) + "\xf0\x9f\x92\xbe Autosave disabled")
+            << Color::RESET << "\n";
+        return InputResult::CONTINUE;
+    }
+
+    if (input == "rewind" || input.compare(0, 7, "rewind ") == 0) {
+        int steps = 1;
+        if (input.size() > 7) {
+            try {
+                steps = std::stoi(input.substr(7));
+            } catch (const std::exception&) {
+                steps = 0;
+            }
+        }
+        if (!state.history || steps <= 0) {
+            std::cout << Color::YELLOW << "Usage: rewind [turns]" << Color::RESET << "\n";
+        } else if (!state.history->rewind(state, static_cast<size_t>(steps))) {
+            size_t available = state.history->size() - 1;
+            std::cout << Color::RED << "Only " << available << (available == 1 ? " turn" : " turns")
+                      << " can be rewound." << Color::RESET << "\n";
+        } else {
+            std::cout << Color::CYAN << "\xe2\x8f\xaa Rewound " << steps << (steps == 1 ? " turn" : " turns")
+                      << " to turn " << state.turns
+                      << Color::RESET << "\n";
+            if (state.journal) state.journal->truncateToTurn(state.turns);
+            state.addLogEntry(LogType::ACTION, LogCode::REWOUND, steps);
+            return InputResult::RESTORED;
+        }
+        return InputResult::CONTINUE;
+    }
+
+    if (command == "trend") {
+        // Without an argument, step through the preset windows
+        static const int presets[] = {64, TR::DEFAULT_WINDOW, 1024, 4096, 0};
+        int window = -1;
+        std::string argument = input.size() > 6 ? input.substr(6) : "";
+        if (!state.trends) {
+            std::cout << Color::YELLOW << "Trends are only recorded in interactive play." << Color::RESET << "\n";
+            return InputResult::CONTINUE;
+        } else if (argument.empty()) {
+            int current = state.trends->window();
+            size_t i = 0;
+            while (i < 4 && presets[i] != current) ++i;
+            window = presets[(i + 1) % 5];
+        } else if (argument == "all") {
+            window = 0;
+        } else {
+            try {
+                size_t used = 0;
+                window = std::stoi(argument, &used);
+                if (used != argument.size() || window < TR::SPARK_WIDTH) window = -1;
+            } catch (const std::exception&) {
+                window = -1;
+            }
+        }
+        if (window < 0) {
+            std::cout << Color::YELLOW << "Usage: trend [turns >= " << TR::SPARK_WIDTH << " | all]" << Color::RESET << "\n";
+        } else {
+            state.trends->setWindow(window);
+            std::cout << Color::CYAN << "\xf0\x9f\x93\x88 Trends cover "
+                      << (window > 0 ? "the last " + std::to_string(window) + " turns" : std::string("the whole session"))
+                      << Color::RESET << "\n";
         }
         return InputResult::CONTINUE;
     }
@@ -140,10 +301,10 @@ InputResult InputHandler::handleInput(ReactorState& state) {
                       << " \xe2\x8f\xb8 SIMULATION PAUSED " << Color::RESET << "\n";
             std::cout << Color::DIM << "Use 'p' or 'pause' to resume. You can still view stats, log, and achievements."
                       << Color::RESET << "\n";
-            state.addLogEntry("ACTION", "Simulation paused by operator");
+            state.addLogEntry(LogType::ACTION, LogCode::PAUSED);
         } else {
             std::cout << Color::GREEN << Color::BOLD << "\xe2\x96\xb6 SIMULATION RESUMED" << Color::RESET << "\n";
-            state.addLogEntry("ACTION", "Simulation resumed");
+            state.addLogEntry(LogType::ACTION, LogCode::RESUMED);
         }
         return InputResult::CONTINUE;
     }
@@ -153,6 +314,15 @@ InputResult InputHandler::handleInput(ReactorState& state) {
         return InputResult::CONTINUE;
     }
 
-    state.controlRods = parseControlRodInput(input, state.controlRods);
+    // A rod setting typed in auto mode is the operator taking over
+    double rods = parseControlRodInput(input, -1.0);
+    if (rods >= 0.0) {
+        if (state.autoRods) {
+            state.autoRods = false;
+            std::cout << Color::YELLOW << "\xf0\x9f\xa4\x96 Autopilot disengaged, manual control" << Color::RESET << "\n";
+            state.addLogEntry(LogType::ACTION, LogCode::AUTOPILOT_DISENGAGED);
+        }
+        state.controlRods = rods;
+    }
     return InputResult::ADVANCE_TURN;
 }
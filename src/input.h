@@ -7,13 +7,24 @@
 enum class InputResult {
     CONTINUE,
     ADVANCE_TURN,
+    RESTORED,  // State replaced from a save slot or the rewind history
     QUIT
 };
 
 class InputHandler {
 public:
-    static InputResult handleInput(ReactorState& state);
+    // Prompt for one operator command; false at end of input
+    static bool readCommand(const ReactorState& state, std::string& input);
+
+    // Apply one command line. Headless runs (replays) skip the screens and
+    // the save slots.
+    static InputResult execute(ReactorState& state, const std::string& input);
+
+    // Commands that show a screen and wait for Enter
+    static bool isScreen(const std::string& input);
 
 private:
     static double parseControlRodInput(const std::string& input, double current);
+    // Slot after a save/load command, 1 if none is given, -1 if invalid
+    static int parseSlot(const std::string& input);
 };
@@ -0,0 +1,327 @@
+#include "journal.h"
+#include "mapped_file.h"
+#include "crc32.h"
+
+#include <algorithm>
+#include <climits>
+#include <cctype>
+#include <sstream>
+
+static_assert(sizeof(LogEntry) == 16, "journal records are 16 bytes");
+
+namespace {
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t blockRecords;
+    uint32_t catalog;  // EventCatalog::checksum of the records' texts
+    uint32_t crc;      // Save slot copies: CRC-32C of their records; otherwise zero
+};
+
+const char* const TYPE_NAMES[] = {"action", "event", "warning", "critical"};
+const unsigned ALL_TYPES = (1u << static_cast<int>(LogType::TYPE_COUNT)) - 1;
+
+// Records of type T after the file header, or nullptr if the header is not `magic`
+template <typename T>
+const T* mappedRecords(const MappedFile& file, uint32_t magic, size_t& count) {
+    count = 0;
+    if (file.size() < sizeof(FileHeader)) return nullptr;
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(file.data());
+    if (header->magic != magic || header->version != JN::VERSION || header->recordSize != sizeof(T)) {
+        return nullptr;
+    }
+    count = (file.size() - sizeof(FileHeader)) / sizeof(T);
+    return reinterpret_cast<const T*>(file.data() + sizeof(FileHeader));
+}
+
+bool writeHeader(std::FILE* file, uint32_t magic, uint32_t recordSize, uint32_t catalog, uint32_t crc = 0) {
+    FileHeader header{magic, JN::VERSION, recordSize, static_cast<uint32_t>(JN::BLOCK_RECORDS), catalog, crc};
+    return std::fwrite(&header, sizeof(header), 1, file) == 1;
+}
+}
+
+LogFilter::LogFilter() : types(ALL_TYPES), firstTurn(INT_MIN), lastTurn(INT_MAX) {}
+
+bool LogFilter::filtered() const {
+    return types != ALL_TYPES || firstTurn != INT_MIN || lastTurn != INT_MAX;
+}
+
+bool LogFilter::parse(const std::string& terms, LogFilter& filter) {
+    filter = LogFilter();
+    unsigned types = 0;
+    std::istringstream stream(terms);
+    std::string term;
+    while (stream >> term) {
+        std::transform(term.begin(), term.end(), term.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        bool named = false;
+        for (int t = 0; t < static_cast<int>(LogType::TYPE_COUNT); ++t) {
+            if (term == TYPE_NAMES[t]) {
+                types |= 1u << t;
+                named = true;
+            }
+        }
+        if (named) continue;
+
+        // Turn range: N, N-M, N- or -M
+        size_t dash = term.find('-');
+        std::string low = term.substr(0, dash);
+        std::string high = dash == std::string::npos ? low : term.substr(dash + 1);
+        if (low.empty() && high.empty()) return false;
+        for (const std::string* bound : {&low, &high}) {
+            if (bound->size() > 9 ||
+                !std::all_of(bound->begin(), bound->end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+                return false;
+            }
+        }
+        filter.firstTurn = low.empty() ? INT_MIN : std::stoi(low);
+        filter.lastTurn = high.empty() ? INT_MAX : std::stoi(high);
+        if (filter.firstTurn > filter.lastTurn) return false;
+    }
+    if (types) filter.types = types;
+    return true;
+}
+
+Journal::Journal() : data(nullptr), index(nullptr), catalogCrc(0), records(0), buffered(0), current() {
+    startBlock();
+}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::create(const std::string& path, uint32_t catalog) {
+    close();
+    catalogCrc = catalog;
+    dataPath = path;
+    indexPath = path + ".idx";
+    data = std::fopen(dataPath.c_str(), "wb");
+    index = std::fopen(indexPath.c_str(), "wb");
+    if (!data || !index ||
+        !writeHeader(data, JN::JOURNAL_MAGIC, sizeof(LogEntry), catalog) ||
+        !writeHeader(index, JN::INDEX_MAGIC, sizeof(BlockSummary), catalog)) {
+        close();
+        return false;
+    }
+    records = 0;
+    buffered = 0;
+    current.crc = 0;
+    startBlock();
+    return true;
+}
+
+void Journal::close() {
+    flush();
+    if (data) std::fclose(data);
+    if (index) std::fclose(index);
+    data = index = nullptr;
+}
+
+// The running CRC carries on into the next block
+void Journal::startBlock() {
+    current.firstTurn = INT_MAX;
+    current.lastTurn = INT_MIN;
+    std::fill(std::begin(current.counts), std::end(current.counts), 0);
+}
+
+void Journal::append(const LogEntry& entry) {
+    if (!data) return;
+    buffer[buffered++] = entry;
+    current.firstTurn = std::min(current.firstTurn, entry.turn);
+    current.lastTurn = std::max(current.lastTurn, entry.turn);
+    current.counts[static_cast<int>(entry.type)]++;
+    current.crc = crc32c(&entry, sizeof(entry), current.crc);
+    records++;
+
+    if (records % JN::BLOCK_RECORDS == 0) {
+        std::fwrite(buffer, sizeof(LogEntry), buffered, data);
+        std::fwrite(&current, sizeof(current), 1, index);
+        buffered = 0;
+        startBlock();
+    }
+}
+
+void Journal::flush() {
+    if (!data) return;
+    // A partial block goes to the data file but is indexed only once full
+    if (buffered > 0) std::fwrite(buffer, sizeof(LogEntry), buffered, data);
+    buffered = 0;
+    std::fflush(data);
+    std::fflush(index);
+}
+
+const LogEntry* Journal::map(MappedFile& file, size_t& count) {
+    count = 0;
+    if (!data) return nullptr;
+    flush();
+    if (!file.open(dataPath)) return nullptr;
+    return mappedRecords<LogEntry>(file, JN::JOURNAL_MAGIC, count);
+}
+
+bool Journal::replace(const LogEntry* entries, size_t count) {
+    if (!data) return false;
+    flush();
+
+    // Overwrite both files in place and cut them to length, which is much
+    // cheaper than recreating them when they are already cached
+    bool ok = std::fseek(data, sizeof(FileHeader), SEEK_SET) == 0 &&
+              std::fwrite(entries, sizeof(LogEntry), count, data) == count &&
+              truncateFile(data, sizeof(FileHeader) + count * sizeof(LogEntry));
+    return reindex(ok, entries, count, 0, 0);
+}
+
+bool Journal::truncateToTurn(int turn) {
+    if (!data) return false;
+    MappedFile file;
+    size_t count = 0;
+    const LogEntry* entries = map(file, count);
+    if (!entries) return false;
+
+    // Turns never decrease along the journal
+    size_t kept = static_cast<size_t>(
+        std::upper_bound(entries, entries + count, turn,
+                         [](int t, const LogEntry& entry) { return t < entry.turn; }) - entries);
+    if (kept == count) return true;
+
+    // Only the kept part of the last block needs summarizing again; copy it
+    // out so the file can be cut with no mapping open
+    size_t block = kept / JN::BLOCK_RECORDS;
+    size_t tail = kept % JN::BLOCK_RECORDS;
+    std::copy(entries + kept - tail, entries + kept, buffer);
+    file.close();
+    MappedFile indexFile(indexPath);
+    size_t blockCount = 0;
+    const BlockSummary* blocks = mappedRecords<BlockSummary>(indexFile, JN::INDEX_MAGIC, blockCount);
+    if (block > blockCount) return false;
+    uint32_t crc = block > 0 ? blocks[block - 1].crc : 0;
+    indexFile.close();
+    bool ok = truncateFile(data, sizeof(FileHeader) + kept * sizeof(LogEntry));
+    return reindex(ok, buffer, tail, block, crc);
+}
+
+bool Journal::reindex(bool ok, const LogEntry* entries, size_t count, size_t firstBlock, uint32_t crc) {
+    ok = ok && std::fseek(index, sizeof(FileHeader) + firstBlock * sizeof(BlockSummary), SEEK_SET) == 0;
+    records = firstBlock * JN::BLOCK_RECORDS;
+    buffered = 0;
+    current.crc = crc;
+    startBlock();
+    for (size_t i = 0; ok && i < count; ++i) {
+        const LogEntry& entry = entries[i];
+        current.firstTurn = std::min(current.firstTurn, entry.turn);
+        current.lastTurn = std::max(current.lastTurn, entry.turn);
+        current.counts[static_cast<int>(entry.type)]++;
+        current.crc = crc32c(&entry, sizeof(entry), current.crc);
+        if (++records % JN::BLOCK_RECORDS == 0) {
+            ok = std::fwrite(&current, sizeof(current), 1, index) == 1;
+            startBlock();
+        }
+    }
+    ok = ok && truncateFile(index, sizeof(FileHeader) + records / JN::BLOCK_RECORDS * sizeof(BlockSummary)) &&
+         std::fseek(data, 0, SEEK_END) == 0 && std::fseek(index, 0, SEEK_END) == 0;
+    if (!ok) close();
+    return ok;
+}
+
+bool Journal::saveCopy(const std::string& path) {
+    MappedFile dataFile, indexFile;
+    size_t count = 0, blockCount = 0;
+    const LogEntry* entries = map(dataFile, count);
+    if (!entries) return false;
+    indexFile.open(indexPath);
+    const BlockSummary* blocks = mappedRecords<BlockSummary>(indexFile, JN::INDEX_MAGIC, blockCount);
+    // CRC of the first n entries: the index covers whole blocks
+    auto prefixCrc = [&](size_t n) {
+        size_t block = std::min(n / JN::BLOCK_RECORDS, blockCount);
+        uint32_t crc = block > 0 ? blocks[block - 1].crc : 0;
+        size_t from = block * JN::BLOCK_RECORDS;
+        return crc32c(entries + from, (n - from) * sizeof(LogEntry), crc);
+    };
+
+    // Keep the copy's entries if this journal starts with them
+    size_t shared = 0;
+    bool prefix = false;
+    std::FILE* copy = std::fopen(path.c_str(), "r+b");
+    FileHeader header;
+    if (copy && std::fread(&header, sizeof(header), 1, copy) == 1 && header.magic == JN::JOURNAL_MAGIC &&
+        header.version == JN::VERSION && header.recordSize == sizeof(LogEntry) && header.catalog == catalogCrc &&
+        std::fseek(copy, 0, SEEK_END) == 0) {
+        long bytes = std::ftell(copy) - static_cast<long>(sizeof(header));
+        shared = bytes >= 0 ? static_cast<size_t>(bytes) / sizeof(LogEntry) : 0;
+        prefix = bytes >= 0 && bytes % sizeof(LogEntry) == 0 && shared <= count && prefixCrc(shared) == header.crc;
+    }
+    if (prefix && shared == count) return std::fclose(copy) == 0;
+    if (!prefix) {
+        if (copy) std::fclose(copy);
+        copy = std::fopen(path.c_str(), "wb");
+        shared = 0;
+        if (!copy || !writeHeader(copy, JN::JOURNAL_MAGIC, sizeof(LogEntry), catalogCrc)) {
+            if (copy) std::fclose(copy);
+            return false;
+        }
+    }
+
+    // New entries first, then the header's CRC for them all
+    size_t added = count - shared;
+    header = FileHeader{JN::JOURNAL_MAGIC, JN::VERSION, sizeof(LogEntry), static_cast<uint32_t>(JN::BLOCK_RECORDS),
+                        catalogCrc, checksum()};
+    bool ok = std::fseek(copy, static_cast<long>(sizeof(header) + shared * sizeof(LogEntry)), SEEK_SET) == 0 &&
+              std::fwrite(entries + shared, sizeof(LogEntry), added, copy) == added &&
+              std::fseek(copy, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header, sizeof(header), 1, copy) == 1 &&
+              syncFile(copy);
+    return std::fclose(copy) == 0 && ok;
+}
+
+const LogEntry* Journal::mapCopy(MappedFile& file, const std::string& path, size_t& count) {
+    count = 0;
+    if (!file.open(path)) return nullptr;
+    return mappedRecords<LogEntry>(file, JN::JOURNAL_MAGIC, count);
+}
+
+uint64_t Journal::query(const LogFilter& filter, size_t limit, std::vector<LogEntry>& latest) {
+    latest.clear();
+    if (!data) return 0;
+    flush();
+
+    MappedFile dataFile, indexFile(indexPath);
+    size_t entryCount = 0, blockCount = 0;
+    const LogEntry* entries = map(dataFile, entryCount);
+    const BlockSummary* blocks = mappedRecords<BlockSummary>(indexFile, JN::INDEX_MAGIC, blockCount);
+    if (!entries) return 0;
+    blockCount = std::min(blockCount, entryCount / JN::BLOCK_RECORDS);
+
+    // Newest first, so the scan can stop collecting once `limit` are found
+    uint64_t matches = 0;
+    auto scan = [&](size_t begin, size_t end) {
+        for (size_t i = end; i-- > begin;) {
+            if (!filter.matches(entries[i])) continue;
+            matches++;
+            if (latest.size() < limit) latest.push_back(entries[i]);
+        }
+    };
+
+    scan(blockCount * JN::BLOCK_RECORDS, entryCount);  // Unindexed tail
+    for (size_t b = blockCount; b-- > 0;) {
+        const BlockSummary& block = blocks[b];
+        if (block.lastTurn < filter.firstTurn || block.firstTurn > filter.lastTurn) continue;
+        uint64_t typed = 0;
+        for (int t = 0; t < static_cast<int>(LogType::TYPE_COUNT); ++t) {
+            if (filter.types >> t & 1u) typed += block.counts[t];
+        }
+        if (typed == 0) continue;
+
+        // Blocks wholly inside the turn range are counted from the index
+        // once enough entries have been collected
+        bool inside = block.firstTurn >= filter.firstTurn && block.lastTurn <= filter.lastTurn;
+        if (inside && latest.size() >= limit) {
+            matches += typed;
+            continue;
+        }
+        scan(b * JN::BLOCK_RECORDS, (b + 1) * JN::BLOCK_RECORDS);
+    }
+
+    std::reverse(latest.begin(), latest.end());
+    return matches;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+// Append-only operator journal for interactive play. Every log entry is
+// written as a fixed 16-byte LogEntry record through a block-sized buffer.
+// Each full block of JN::BLOCK_RECORDS records adds one entry to a sparse
+// index file (journal path + ".idx") holding the block's turn range and
+// per-type counts. Queries map both files read-only and read only the
+// blocks the index cannot settle, so they stay fast on journals with
+// millions of entries without loading them. The file headers hold the
+// checksum of the event catalog whose texts the records' codes refer to.
+// Each index entry also holds the CRC-32C of every record up to the end of
+// its block, so the checksum of any prefix takes at most one block to read.
+//
+// Save slots keep a copy of the journal next to the save (saveCopy). A save
+// made later in the same game appends only the records added since.
+namespace JN {
+    static constexpr uint32_t JOURNAL_MAGIC = 0x4c4e4a52;  // "RJNL"
+    static constexpr uint32_t INDEX_MAGIC = 0x58494a52;    // "RJIX"
+    static constexpr uint32_t VERSION = 3;
+    static constexpr int BLOCK_RECORDS = 256;
+}
+
+// Which entries a `log` query selects
+struct LogFilter {
+    unsigned types;  // Bit per LogType
+    int firstTurn;
+    int lastTurn;
+
+    LogFilter();
+    bool matches(const LogEntry& entry) const {
+        return (types >> static_cast<int>(entry.type) & 1u) &&
+               entry.turn >= firstTurn && entry.turn <= lastTurn;
+    }
+    bool filtered() const;
+
+    // Space-separated terms: type names (action, event, warning, critical)
+    // and a turn or turn range (500, 500-900, 500-, -900)
+    static bool parse(const std::string& terms, LogFilter& filter);
+};
+
+class Journal {
+public:
+    Journal();
+    ~Journal();
+
+    // Start an empty journal at path, replacing any previous one, for
+    // entries written under the event catalog with this checksum
+    bool create(const std::string& path, uint32_t catalog);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    // Never allocates; writes happen a block at a time
+    void append(const LogEntry& entry);
+    void flush();
+
+    uint64_t size() const { return records; }
+    uint32_t catalog() const { return catalogCrc; }
+    // CRC-32C of every entry, as stored in the records
+    uint32_t checksum() const { return current.crc; }
+
+    // All entries, read in place through `file`; valid while it stays open
+    const LogEntry* map(MappedFile& file, size_t& count);
+
+    // Start over at the same path holding `entries`, as when a game is loaded;
+    // their catalog texts must be this journal's (see EventCatalog::forgetTexts)
+    bool replace(const LogEntry* entries, size_t count);
+
+    // Drop every entry after `turn`, as when the game is rewound to it
+    bool truncateToTurn(int turn);
+
+    // Make the journal copy at `path` hold exactly this journal's entries.
+    // A copy whose entries are a prefix of them (by checksum) only has the
+    // rest appended; any other copy is rewritten. The copy is on disk when
+    // this returns true.
+    bool saveCopy(const std::string& path);
+
+    // Entries of a copy written by saveCopy, read in place through `file`
+    static const LogEntry* mapCopy(MappedFile& file, const std::string& path, size_t& count);
+
+    // Number of entries matching the filter; the last `limit` of them go to
+    // `latest`, oldest first
+    uint64_t query(const LogFilter& filter, size_t limit, std::vector<LogEntry>& latest);
+
+private:
+    // Index entry for one full block
+    struct BlockSummary {
+        int32_t firstTurn;  // Lowest turn in the block
+        int32_t lastTurn;   // Highest turn in the block
+        uint16_t counts[static_cast<int>(LogType::TYPE_COUNT)];
+        uint32_t crc;       // CRC-32C of every record up to the block's end
+    };
+
+    std::FILE* data;
+    std::FILE* index;
+    std::string dataPath, indexPath;
+    uint32_t catalogCrc;
+    uint64_t records;       // Appended so far, buffered ones included
+    int buffered;           // Records in the buffer not yet written
+    BlockSummary current;   // Summary of the block being filled; crc covers every record
+    LogEntry buffer[JN::BLOCK_RECORDS];
+
+    void startBlock();
+    // Index the `count` entries from the start of block `firstBlock` on,
+    // already in the data file, continuing from `crc` of the entries
+    // before; cuts the index after them, and closes the journal if `ok` is
+    // false or a write fails
+    bool reindex(bool ok, const LogEntry* entries, size_t count, size_t firstBlock, uint32_t crc);
+
+    Journal(const Journal&);
+    Journal& operator=(const Journal&);
+};
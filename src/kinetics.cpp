@@ -0,0 +1,173 @@
+#include "kinetics.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// Keepin's six-group data for thermal fission of U-235
+const double GROUP_BETA[PK::GROUPS] = {
+    0.000215, 0.001424, 0.001274, 0.002568, 0.000748, 0.000273
+};
+const double GROUP_LAMBDA[PK::GROUPS] = {
+    0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01
+};
+const double BETA = 0.006502;
+
+// Alexander's two-stage, stiffly accurate, L-stable SDIRK
+const double GAMMA = 1.0 - 0.70710678118654752440;
+
+// Solver for (I - c A) x = r. A is an arrowhead matrix (dense first row and
+// column plus a diagonal), so elimination of the precursor rows costs O(groups).
+struct StageSolver {
+    double c;
+    double rowScale[PK::GROUPS];  // 1 / (1 + c lambda_i)
+    double upper[PK::GROUPS];     // c lambda_i / (1 + c lambda_i), eliminates row i from row 0
+    double lower[PK::GROUPS];     // c beta_i / LAMBDA
+    double invPivot;
+    bool usable;                  // False when c exceeds the inverse of the positive eigenvalue
+
+    StageSolver(double c, double reactivity) : c(c) {
+        double pivot = 1.0 - c * (reactivity - BETA) / PK::GENERATION_TIME;
+        for (int i = 0; i < PK::GROUPS; ++i) {
+            rowScale[i] = 1.0 / (1.0 + c * GROUP_LAMBDA[i]);
+            upper[i] = c * GROUP_LAMBDA[i] * rowScale[i];
+            lower[i] = c * GROUP_BETA[i] / PK::GENERATION_TIME;
+            pivot -= upper[i] * lower[i];
+        }
+        usable = pivot > 1.0e-3;
+        invPivot = 1.0 / pivot;
+    }
+
+    void solve(const double r[PK::SIZE], double x[PK::SIZE]) const {
+        double rhs = r[0];
+        for (int i = 0; i < PK::GROUPS; ++i) {
+            rhs += upper[i] * r[i + 1];
+        }
+        x[0] = rhs * invPivot;
+        for (int i = 0; i < PK::GROUPS; ++i) {
+            x[i + 1] = (r[i + 1] + lower[i] * x[0]) * rowScale[i];
+        }
+    }
+};
+
+}  // namespace
+
+double PointKinetics::beta() {
+    return BETA;
+}
+
+void PointKinetics::reset(KineticsState& kinetics, double neutrons) {
+    kinetics.enabled = true;
+    for (int i = 0; i < PK::GROUPS; ++i) {
+        kinetics.precursors[i] = GROUP_BETA[i] / (PK::GENERATION_TIME * GROUP_LAMBDA[i]) * neutrons;
+    }
+    kinetics.step = 0.0;
+    kinetics.reactivity = 0.0;
+    kinetics.stats = KineticsStats{0, 0, 0, 0, 0, 0.0};
+}
+
+void PointKinetics::systemMatrix(double reactivity, double a[PK::SIZE][PK::SIZE]) {
+    for (int r = 0; r < PK::SIZE; ++r) {
+        for (int c = 0; c < PK::SIZE; ++c) a[r][c] = 0.0;
+    }
+    a[0][0] = (reactivity - BETA) / PK::GENERATION_TIME;
+    for (int i = 0; i < PK::GROUPS; ++i) {
+        a[0][i + 1] = GROUP_LAMBDA[i];
+        a[i + 1][0] = GROUP_BETA[i] / PK::GENERATION_TIME;
+        a[i + 1][i + 1] = -GROUP_LAMBDA[i];
+    }
+}
+
+void PointKinetics::advance(KineticsState& kinetics, double& neutrons, double reactivity,
+                            double dt, double rtol) {
+    double y[PK::SIZE];
+    y[0] = neutrons;
+    for (int i = 0; i < PK::GROUPS; ++i) y[i + 1] = kinetics.precursors[i];
+
+    // A reactivity step starts a prompt transient on the LAMBDA / (beta - rho)
+    // time scale with relative size ~ d(rho) / beta. Unless that is below the
+    // tolerance, restart from that time scale, within what the budget allows.
+    double h = kinetics.step;
+    if (h <= 0.0 || std::abs(reactivity - kinetics.reactivity) > rtol * BETA) {
+        double prompt = PK::GENERATION_TIME / std::abs(BETA - reactivity);
+        h = std::min(dt, std::max(dt / PK::MAX_SUBSTEPS, prompt));
+    }
+    kinetics.reactivity = reactivity;
+
+    KineticsStats& stats = kinetics.stats;
+    double t = 0.0;
+    int steps = 0;
+    while (t < dt) {
+        // Never plan more steps than the budget has left: at the floor a step
+        // is accepted whatever its error, so accuracy degrades to that of
+        // MAX_SUBSTEPS uniform steps instead of the turn overrunning
+        double floor = (dt - t) / std::max(1, PK::MAX_SUBSTEPS - steps);
+        bool forced = h <= floor;
+        if (forced) h = floor;
+        double hNext = h;
+        bool truncated = t + h >= dt;
+        if (truncated) {
+            h = dt - t;
+        }
+
+        StageSolver solver(GAMMA * h, reactivity);
+        while (!solver.usable) {
+            // Step too long for the growing mode of a supercritical core
+            stats.rejected++;
+            h *= 0.25;
+            hNext = h;
+            truncated = false;
+            forced = h <= floor;
+            solver = StageSolver(GAMMA * h, reactivity);
+        }
+
+        double y1[PK::SIZE], f1[PK::SIZE], r[PK::SIZE], y2[PK::SIZE], e[PK::SIZE];
+        solver.solve(y, y1);
+        double invC = 1.0 / solver.c;
+        for (int k = 0; k < PK::SIZE; ++k) {
+            f1[k] = (y1[k] - y[k]) * invC;
+            r[k] = y[k] + h * (1.0 - GAMMA) * f1[k];
+        }
+        solver.solve(r, y2);
+
+        // Difference from the embedded first-order result y + h A Y1, filtered
+        // through the stage matrix so stiff components don't inflate it
+        for (int k = 0; k < PK::SIZE; ++k) {
+            r[k] = y2[k] - y[k] - h * f1[k];
+        }
+        solver.solve(r, e);
+
+        double err = 0.0;
+        for (int k = 0; k < PK::SIZE; ++k) {
+            double scaled = e[k] / (PK::ABSOLUTE_TOLERANCE + rtol * std::max(std::abs(y[k]), std::abs(y2[k])));
+            err += scaled * scaled;
+        }
+        err = std::sqrt(err / PK::SIZE);
+
+        double factor = err > 0.0 ? 0.9 / std::sqrt(err) : 5.0;
+        factor = std::min(5.0, std::max(0.2, factor));
+
+        if (err > 1.0 && !forced) {
+            stats.rejected++;
+            h = std::max(h * factor, floor);
+            continue;
+        }
+
+        if (err > 1.0) stats.budgetHits++;
+        for (int k = 0; k < PK::SIZE; ++k) y[k] = y2[k];
+        t += h;
+        steps++;
+        stats.lastError = err;
+        // A step cut short at the end of the turn says little about the next one
+        h = truncated ? std::max(h * factor, std::min(hNext, dt)) : h * factor;
+    }
+
+    kinetics.step = h;
+    stats.turns++;
+    stats.steps += steps;
+    stats.lastTurnSteps = steps;
+
+    neutrons = std::max(0.0, y[0]);
+    for (int i = 0; i < PK::GROUPS; ++i) kinetics.precursors[i] = std::max(0.0, y[i + 1]);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// Point-kinetics core model (opt-in with --kinetics). Neutron population n
+// and six delayed-neutron precursor groups C_i obey
+//
+//   dn/dt   = (rho - beta) / LAMBDA * n + sum_i lambda_i C_i
+//   dC_i/dt = beta_i / LAMBDA * n - lambda_i C_i
+//
+// with reactivity rho held constant over a turn. The system is stiff (the
+// prompt mode decays ~10^4 times faster than the slowest precursor), so each
+// turn is integrated with an L-stable SDIRK2 scheme and adaptive sub-steps.
+
+namespace PK {
+    static constexpr int GROUPS = 6;
+    static constexpr int SIZE = GROUPS + 1;          // n plus precursors
+
+    static constexpr double GENERATION_TIME = 1.0e-4;  // LAMBDA, seconds
+    static constexpr double TURN_SECONDS = 1.0;
+
+    // Game k_eff excess maps to reactivity (dk/k); rods fully out gives ~1 $
+    static constexpr double REACTIVITY_SCALE = 0.13;
+    // Fuel temperature feedback per degree above INITIAL_TEMPERATURE
+    static constexpr double TEMPERATURE_COEFFICIENT = -1.0e-5;
+
+    static constexpr double RELATIVE_TOLERANCE = 1.0e-4;
+    static constexpr double ABSOLUTE_TOLERANCE = 1.0e-6;
+    static constexpr int MAX_SUBSTEPS = 64;          // Per-turn CPU budget
+}
+
+// Integrator bookkeeping, accumulated over the whole session
+struct KineticsStats {
+    long turns;
+    long steps;          // Accepted sub-steps
+    long rejected;       // Sub-steps redone with a smaller h
+    long budgetHits;     // Steps accepted over tolerance to stay within MAX_SUBSTEPS
+    int lastTurnSteps;
+    double lastError;    // Scaled error norm of the last accepted step
+};
+
+struct KineticsState {
+    bool enabled;
+    double precursors[PK::GROUPS];
+    double step;         // Last accepted sub-step, reused as the next guess
+    double reactivity;   // rho applied during the last turn
+    KineticsStats stats;
+};
+
+class PointKinetics {
+public:
+    // Enable the model with precursors in equilibrium with the given population
+    static void reset(KineticsState& kinetics, double neutrons);
+
+    // Advance n and the precursors by dt seconds at constant reactivity
+    static void advance(KineticsState& kinetics, double& neutrons, double reactivity,
+                        double dt, double rtol = PK::RELATIVE_TOLERANCE);
+
+    // Dense system matrix A of y' = A y, y = (n, C_1..C_6); for reference solutions
+    static void systemMatrix(double reactivity, double a[PK::SIZE][PK::SIZE]);
+
+    static double beta();
+};
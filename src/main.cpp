@@ -1,8 +1,22 @@
 #include "reactor.h"
+#include "batch.h"
+#include "policy.h"
+#include "ensemble.h"
+#include "event_catalog.h"
+#include "models.h"
+#include "alloc_counter.h"
+#include "replay.h"
+#include "perf.h"
+#include "telemetry.h"
+#include "autopilot.h"
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <stdexcept>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
 
 Difficulty selectDifficulty() {
     std::cout << Color::BOLD << Color::CYAN
@@ -40,9 +54,304 @@ Difficulty selectDifficulty() {
     }
 }
 
-int main() {
-    Difficulty diff = selectDifficulty();
-    ReactorSimulator simulator(diff);
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --headless           Run without terminal UI and print a summary\n"
+              << "  --difficulty LEVEL   easy|normal|hard|nightmare (or 1-4)\n"
+              << "  --seed N             Seed for reproducible runs (default: clock)\n"
+              << "  --turns N            Headless turn limit (default 10000)\n"
+              << "  --rods SCHEDULE      Rod schedule as turn:percent,... (default 0:5)\n"
+              << "  --refill PCT         Refill coolant when it drops below PCT\n"
+              << "  --no-reset           Stop at the first SCRAM instead of restarting\n"
+              << "  --no-turbine         Leave the turbine offline\n"
+              << "  --ensemble N         Headless: advance N reactors with the SIMD engine\n"
+              << "  --no-events          Ensemble: leave out random events\n"
+              << "  --kinetics           Point-kinetics core with delayed neutrons\n"
+              << "  --spatial NxMxK      Nodal two-group diffusion core (e.g. 50x50x30)\n"
+              << "  --channels N         Subchannel thermal-hydraulics with N coolant channels\n"
+              << "  --depletion          CRAM nuclide chain for fuel burnup, xenon and samarium\n"
+              << "  --alloc-guard        Headless: fail if the turn loop allocates after warm-up\n"
+              << "  --distributions      Headless: add per-turn p50/p95/p99 readings to the summary\n"
+              << "  --autopilot          Headless: the model-predictive autopilot sets the rods\n"
+              << "  --events FILE        Draw random events from this catalog instead of the built-in one\n"
+              << "  --record FILE        Record the interactive session for --replay\n"
+              << "  --replay FILE        Re-run a recording at full speed and verify its state hash\n"
+              << "                       (repeat for several recordings)\n"
+              << "  --seek TURN          Replay: stop after TURN session turns, starting from a keyframe\n"
+              << "  --realtime HZ        Advance HZ turns per second (1-1000) instead of one per command\n"
+              << "  --fps N              Real-time: redraw at most N times per second\n"
+              << "                       (default 10 on a terminal, 1 otherwise)\n"
+              << "  --sync-render        Real-time: draw on the simulation thread instead of a render thread\n"
+              << "  --telemetry NAME     Publish every turn to the shared-memory segment NAME (e.g. /reactor)\n";
+}
+
+int runEnsemble(Difficulty diff, int size, int maxTurns, const ScriptedPolicy& policy, bool events, uint64_t seed) {
+    if (policy.stepCount() != 1) {
+        std::cerr << "Ensemble runs need a constant rod setting (--rods PCT)\n";
+        return 1;
+    }
+    DifficultySettings settings = getDifficultySettings(diff);
+    EnsembleState ens(static_cast<size_t>(size));
+    for (size_t i = 0; i < ens.size(); ++i) {
+        ens.initMember(i, settings, policy.step(0).controlRods);
+        ens.field(EnsembleField::TURBINE_SETPOINT)[i] = policy.turbineEnabled() ? 1.0 : 0.0;
+        ens.field(EnsembleField::REFILL_BELOW)[i] = policy.refillThreshold();
+        ens.field(EnsembleField::AUTO_RESET)[i] = policy.autoResetEnabled() ? 1.0 : 0.0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    EnsembleEngine::run(ens, maxTurns, events, seed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int outcomes[3] = {0, 0, 0};
+    double memberTurns = 0.0;
+    double scoreSum = 0.0;
+    double eventSum = 0.0;
+    for (size_t i = 0; i < ens.size(); ++i) {
+        outcomes[static_cast<int>(ens.field(EnsembleField::OUTCOME)[i])]++;
+        memberTurns += ens.field(EnsembleField::TURNS)[i];
+        scoreSum += ens.field(EnsembleField::SCORE)[i];
+        eventSum += ens.field(EnsembleField::EVENTS)[i];
+    }
+    std::cout << "difficulty=" << settings.name
+              << " kernel=" << EnsembleEngine::kernelName()
+              << " members=" << ens.size()
+              << " survived=" << outcomes[0]
+              << " meltdown=" << outcomes[1]
+              << " shutdown=" << outcomes[2]
+              << std::fixed << std::setprecision(1)
+              << " mean_score=" << scoreSum / ens.size()
+              << " mean_events=" << eventSum / ens.size()
+              << std::setprecision(3)
+              << " seconds=" << seconds
+              << std::setprecision(0)
+              << " reactor_turns_per_sec=" << (seconds > 0.0 ? memberTurns / seconds : 0.0) << "\n";
+    return 0;
+}
+
+// Warm up (first-turn buffers, log and achievement fills), then require
+// maxTurns further turns to run without touching the heap
+int runAllocGuard(ReactorState& state, OperatorPolicy& policy, int maxTurns) {
+    if (!AllocCounter::available()) {
+        std::cout << "alloc_guard=FAIL reason=built without the allocation counter (use make check-alloc)\n";
+        return 1;
+    }
+    BatchResult warmup = BatchRunner::run(state, policy, RC::ALLOC_GUARD_WARMUP_TURNS);
+    if (warmup.outcome != BatchOutcome::SURVIVED) {
+        BatchRunner::printSummary(state, warmup);
+        std::cout << "alloc_guard=FAIL reason=warm-up ended in " << BatchRunner::outcomeName(warmup.outcome) << "\n";
+        return 1;
+    }
+    uint64_t before = AllocCounter::count();
+    BatchResult result = BatchRunner::run(state, policy, warmup.turns + maxTurns);
+    uint64_t allocations = AllocCounter::count() - before;
+    BatchRunner::printSummary(state, result);
+    std::cout << "alloc_guard=" << (allocations == 0 ? "PASS" : "FAIL")
+              << " turns=" << result.turns - warmup.turns
+              << " allocations=" << allocations << "\n";
+    return allocations == 0 ? 0 : 1;
+}
+
+static void telemetryError(const std::string& name, uint32_t owner) {
+    if (owner != 0) {
+        std::cerr << "Shared memory segment " << name << " is in use by process " << owner << "\n";
+    } else {
+        std::cerr << "Cannot create shared memory segment " << name << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool headless = false;
+    bool allocGuard = false;
+    bool distributions = false;
+    bool autopilot = false;
+    bool haveDifficulty = false;
+    Difficulty diff = Difficulty::NORMAL;
+    int maxTurns = 10000;
+    int ensembleSize = 0;
+    bool ensembleEvents = true;
+    std::string eventsPath;
+    uint64_t seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::string rods = "0:5";
+    std::string recordPath;
+    std::vector<std::string> replays;
+    long seekTurn = -1;
+    int realtimeHz = 0;
+    int fps = 0;
+    bool renderThread = true;
+    std::string telemetryName;
+    ScriptedPolicy policy;
+    ModelOptions models;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--headless") {
+                headless = true;
+            } else if (arg == "--difficulty" && hasValue) {
+                if (!parseDifficulty(argv[++i], diff)) throw std::invalid_argument(arg);
+                haveDifficulty = true;
+            } else if (arg == "--seed" && hasValue) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--turns" && hasValue) {
+                maxTurns = std::stoi(argv[++i]);
+            } else if (arg == "--rods" && hasValue) {
+                rods = argv[++i];
+            } else if (arg == "--refill" && hasValue) {
+                policy.setRefillThreshold(std::stod(argv[++i]));
+            } else if (arg == "--no-reset") {
+                policy.setAutoReset(false);
+            } else if (arg == "--no-turbine") {
+                policy.setTurbine(false);
+            } else if (arg == "--ensemble" && hasValue) {
+                ensembleSize = std::stoi(argv[++i]);
+            } else if (arg == "--no-events") {
+                ensembleEvents = false;
+            } else if (arg == "--events" && hasValue) {
+                eventsPath = argv[++i];
+            } else if (arg == "--kinetics") {
+                models.kinetics = true;
+            } else if (arg == "--spatial" && hasValue) {
+                if (!SpatialCore::parseGrid(argv[++i], models)) throw std::invalid_argument(arg);
+            } else if (arg == "--alloc-guard") {
+                allocGuard = true;
+            } else if (arg == "--distributions") {
+                distributions = true;
+            } else if (arg == "--autopilot") {
+                autopilot = true;
+            } else if (arg == "--depletion") {
+                models.depletion = true;
+            } else if (arg == "--channels" && hasValue) {
+                models.channels = std::stoi(argv[++i]);
+                if (models.channels < 1 || models.channels > 100000) throw std::invalid_argument(arg);
+            } else if (arg == "--record" && hasValue) {
+                recordPath = argv[++i];
+            } else if (arg == "--replay" && hasValue) {
+                replays.push_back(argv[++i]);
+            } else if (arg == "--seek" && hasValue) {
+                seekTurn = std::stol(argv[++i]);
+                if (seekTurn < 0) throw std::invalid_argument(arg);
+            } else if (arg == "--realtime" && hasValue) {
+                realtimeHz = std::stoi(argv[++i]);
+                if (realtimeHz < 1 || realtimeHz > 1000) throw std::invalid_argument(arg);
+            } else if (arg == "--fps" && hasValue) {
+                fps = std::stoi(argv[++i]);
+                if (fps < 1 || fps > 1000) throw std::invalid_argument(arg);
+            } else if (arg == "--telemetry" && hasValue) {
+                telemetryName = argv[++i];
+            } else if (arg == "--sync-render") {
+                renderThread = false;
+            } else if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (realtimeHz > 0 && (headless || !replays.empty() || !recordPath.empty())) {
+        // Recordings hold one turn per command, which real-time sessions do not keep
+        std::cerr << "--realtime cannot be combined with --headless, --record or --replay\n";
+        return 1;
+    }
+
+    if (!telemetryName.empty() && (!replays.empty() || ensembleSize > 0 || allocGuard)) {
+        std::cerr << "--telemetry cannot be combined with --replay, --ensemble or --alloc-guard\n";
+        return 1;
+    }
+
+    if (!eventsPath.empty()) {
+        EventCatalog catalog;
+        std::string error;
+        if (!catalog.load(eventsPath, error)) {
+            std::cerr << "Event catalog " << eventsPath << ": " << error << "\n";
+            return 1;
+        }
+        EventCatalog::install(catalog);
+    }
+
+    if (!replays.empty()) {
+        int failed = 0;
+        for (const std::string& path : replays) {
+            ReplayResult result = ReplayRunner::run(path, seekTurn);
+            ReplayRunner::printSummary(path, result);
+            if (result.outcome != ReplayOutcome::MATCH) failed++;
+        }
+        if (Perf::ENABLED) Perf::report(std::cerr);
+        return failed > 0 ? 1 : 0;
+    }
+
+    if (headless) {
+        if (!ScriptedPolicy::parse(rods, policy)) {
+            std::cerr << "Invalid rod schedule: " << rods << "\n";
+            return 1;
+        }
+        bool optionalModels = models.kinetics || models.spatialNx > 0 || models.channels > 0 || models.depletion;
+        if (autopilot && (optionalModels || ensembleSize > 0)) {
+            std::cerr << "The autopilot predicts with the basic core model; it cannot be combined with "
+                         "--ensemble or the optional models\n";
+            return 1;
+        }
+        if (ensembleSize > 0) {
+            if (optionalModels) {
+                std::cerr << "The ensemble engine only implements the basic core model\n";
+                return 1;
+            }
+            return runEnsemble(diff, ensembleSize, maxTurns, policy, ensembleEvents, seed);
+        }
+        ReactorState state(diff);
+        state.reseed(seed);
+        CoreModels engines;
+        engines.attach(state, models);
+        // Sketching costs about as much as the rest of a turn, so batch runs ask
+        // for it; the guard always does, keeping it allocation-free
+        TurnDistributions sketches;
+        if (distributions || allocGuard) state.distributions = &sketches;
+        AutopilotPolicy pilot(policy);
+        OperatorPolicy& driver = autopilot ? static_cast<OperatorPolicy&>(pilot) : policy;
+        if (autopilot) state.autopilot = &pilot.pilot();
+        int status = 0;
+        if (allocGuard) {
+            status = runAllocGuard(state, driver, maxTurns);
+        } else {
+            TelemetryPublisher telemetry;
+            uint32_t owner = 0;
+            if (!telemetryName.empty() && !telemetry.open(telemetryName, &owner)) {
+                telemetryError(telemetryName, owner);
+                return 1;
+            }
+            BatchResult result = BatchRunner::run(state, driver, maxTurns, telemetry.isOpen() ? &telemetry : nullptr);
+            BatchRunner::printSummary(state, result);
+        }
+        // Timing goes to stderr, leaving the summary line alone
+        if (Perf::ENABLED) Perf::report(std::cerr);
+        return status;
+    }
+
+    if (!haveDifficulty) diff = selectDifficulty();
+    ReactorSimulator simulator(diff, seed, models);
+    if (!recordPath.empty() && !simulator.record(recordPath, models)) {
+        std::cerr << "Cannot record to " << recordPath << "\n";
+        return 1;
+    }
+    uint32_t owner = 0;
+    if (!telemetryName.empty() && !simulator.publishTelemetry(telemetryName, &owner)) {
+        telemetryError(telemetryName, owner);
+        return 1;
+    }
+    if (realtimeHz > 0) {
+        if (!simulator.runRealtime(realtimeHz, fps, renderThread)) {
+            std::cerr << "Real-time mode needs poll(), which this platform lacks\n";
+            return 1;
+        }
+        return 0;
+    }
     simulator.run();
     return 0;
 }
@@ -0,0 +1,99 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : base(nullptr), length(0), mapping(nullptr) {}
+
+MappedFile::MappedFile(const std::string& path) : MappedFile() {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            base = static_cast<const unsigned char*>(MapViewOfFile(static_cast<HANDLE>(mapping), FILE_MAP_READ, 0, 0, 0));
+            if (base) length = static_cast<size_t>(size.QuadPart);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            base = static_cast<const unsigned char*>(p);
+            length = static_cast<size_t>(info.st_size);
+        }
+    }
+    ::close(fd);
+#endif
+    return base != nullptr;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle(static_cast<HANDLE>(mapping));
+#else
+    if (base) munmap(const_cast<unsigned char*>(base), length);
+#endif
+    base = nullptr;
+    length = 0;
+    mapping = nullptr;
+}
+
+bool truncateFile(std::FILE* file, uint64_t size) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _chsize_s(_fileno(file), static_cast<long long>(size)) == 0;
+#else
+    return ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0) return false;
+    // The rename lives in the directory, which needs its own sync; the move
+    // has happened either way
+    size_t slash = to.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : to.substr(0, slash + 1);
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd < 0) return true;
+    fsync(fd);
+    ::close(fd);
+    return true;
+#endif
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Read-only memory map of a whole file (mmap, or MapViewOfFile on Windows).
+// Empty files and files that cannot be opened map to nothing.
+class MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    const unsigned char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* base;
+    size_t length;
+    void* mapping;  // Windows file mapping handle
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+// Flush a stdio stream and cut its file to `size` bytes
+bool truncateFile(std::FILE* file, uint64_t size);
+
+// Flush a stdio stream and wait until the system has its file on disk
+bool syncFile(std::FILE* file);
+
+// Move `from` over `to` in one step, so `to` is always either the old file
+// or the whole new one, and make the move itself durable
+bool replaceFile(const std::string& from, const std::string& to);
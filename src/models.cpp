@@ -0,0 +1,30 @@
+#include "models.h"
+
+void CoreModels::attach(ReactorState& state, const ModelOptions& models) {
+    state.enableModels(models);
+
+    spatial = SpatialCore::create(models);
+    state.spatial = spatial.get();
+
+    if (models.depletion) {
+        DepletionChain chain = DepletionChain::standard(state.currentDifficulty.fuelDepletionRate);
+        if (spatial) {
+            spatial->enableDepletion(chain);
+        } else {
+            depletion.reset(new DepletionCore(chain));
+        }
+    }
+    state.depletion = depletion.get();
+
+    if (models.channels > 0) {
+        channels.reset(new SubchannelModel(models.channels));
+        channels->reset(state);
+    }
+    state.channels = channels.get();
+}
+
+void CoreModels::reset(ReactorState& state) {
+    if (state.spatial) state.spatial->reset(state);
+    if (state.depletion) state.depletion->reset(state);
+    if (state.channels) state.channels->reset(state);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "reactor_state.h"
+#include "spatial.h"
+#include "subchannel.h"
+#include "depletion.h"
+
+#include <memory>
+
+// Owns the optional model engines of one simulation and wires them into its
+// ReactorState, which only keeps non-owning pointers
+struct CoreModels {
+    std::unique_ptr<SpatialCore> spatial;
+    std::unique_ptr<SubchannelModel> channels;
+    std::unique_ptr<DepletionCore> depletion;
+
+    void attach(ReactorState& state, const ModelOptions& models);
+
+    // Restart the models attached to state from its core scalars, after the
+    // scalars were restored without them (rewind, a save without model data)
+    static void reset(ReactorState& state);
+};
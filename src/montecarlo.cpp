@@ -0,0 +1,303 @@
+#include "montecarlo.h"
+#include "models.h"
+#include "autopilot.h"
+
+#include <cmath>
+#include <algorithm>
+
+void RunningStats::add(double x) {
+    if (n == 0) {
+        lo = hi = x;
+    } else {
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+    }
+    ++n;
+    double delta = x - mu;
+    mu += delta / n;
+    m2 += delta * (x - mu);
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.n == 0) return;
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+    long total = n + other.n;
+    double delta = other.mu - mu;
+    mu += delta * other.n / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+    lo = std::min(lo, other.lo);
+    hi = std::max(hi, other.hi);
+    n = total;
+}
+
+double RunningStats::stddev() const {
+    return std::sqrt(variance());
+}
+
+void Histogram::add(double x) {
+    int bin = x <= 0.0 ? 0 : static_cast<int>(x / width);
+    bin = std::min(bin, bins() - 1);
+    counts[bin]++;
+    total++;
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (int i = 0; i < bins() && i < other.bins(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+}
+
+void Histogram::clear(double binWidth) {
+    width = binWidth;
+    std::fill(counts.begin(), counts.end(), 0L);
+    total = 0;
+}
+
+double Histogram::quantile(double q) const {
+    if (total == 0) return 0.0;
+    double target = q * total;
+    long seen = 0;
+    for (int i = 0; i < bins(); ++i) {
+        if (seen + counts[i] >= target && counts[i] > 0) {
+            double frac = (target - seen) / counts[i];
+            return (i + frac) * width;
+        }
+        seen += counts[i];
+    }
+    return bins() * width;
+}
+
+MonteCarloStats::MonteCarloStats(int horizon)
+    : runs(0), survived(0), meltdowns(0), shutdowns(0), scrams(0),
+      scramRate(0.25, 200),
+      meltdownTurn(std::max(1.0, horizon / 50.0), 50) {}
+
+void MonteCarloStats::add(const BatchResult& result) {
+    runs++;
+    switch (result.outcome) {
+        case BatchOutcome::SURVIVED: survived++; break;
+        case BatchOutcome::MELTDOWN:
+            meltdowns++;
+            meltdownTurn.add(result.turns);
+            break;
+        case BatchOutcome::SHUTDOWN: shutdowns++; break;
+    }
+    scrams += result.scramCount;
+    score.add(result.score);
+    turns.add(result.turns);
+    scramRate.add(1000.0 * result.scramCount / std::max(1, result.turns));
+}
+
+void MonteCarloStats::merge(const MonteCarloStats& other) {
+    runs += other.runs;
+    survived += other.survived;
+    meltdowns += other.meltdowns;
+    shutdowns += other.shutdowns;
+    scrams += other.scrams;
+    score.merge(other.score);
+    turns.merge(other.turns);
+    scramRate.merge(other.scramRate);
+    meltdownTurn.merge(other.meltdownTurn);
+    readings.merge(other.readings);
+}
+
+void MonteCarloStats::clear(int horizon) {
+    runs = survived = meltdowns = shutdowns = scrams = 0;
+    score.clear();
+    turns.clear();
+    scramRate.clear(0.25);
+    meltdownTurn.clear(std::max(1.0, horizon / 50.0));
+    readings.clear();
+}
+
+double MonteCarloStats::meanScramRate() const {
+    double played = turns.mean() * turns.count();
+    return played > 0.0 ? 1000.0 * scrams / played : 0.0;
+}
+
+void WorkStealingQueue::reset(uint32_t begin, uint32_t end) {
+    range.store((static_cast<uint64_t>(begin) << 32) | end, std::memory_order_release);
+}
+
+bool WorkStealingQueue::pop(uint32_t& index) {
+    uint64_t r = range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = static_cast<uint32_t>(r >> 32);
+        uint32_t end = static_cast<uint32_t>(r);
+        if (begin >= end) return false;
+        uint64_t next = (static_cast<uint64_t>(begin + 1) << 32) | end;
+        if (range.compare_exchange_weak(r, next, std::memory_order_acq_rel)) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingQueue::steal(WorkStealingQueue& victim) {
+    uint64_t r = victim.range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = static_cast<uint32_t>(r >> 32);
+        uint32_t end = static_cast<uint32_t>(r);
+        if (begin >= end) return false;
+        uint32_t half = (end - begin + 1) / 2;
+        uint64_t remaining = (static_cast<uint64_t>(begin) << 32) | (end - half);
+        if (victim.range.compare_exchange_weak(r, remaining, std::memory_order_acq_rel)) {
+            // Our own queue is empty here, so nobody else can be modifying it
+            reset(end - half, end);
+            return true;
+        }
+    }
+}
+
+// One run from `start`, in the caller's storage: the state is overwritten,
+// the policy reassigned and the autopilot built on first use. Both
+// MonteCarloRunner::simulate and the pool workers go through here, so a run
+// index gives the same result either way.
+static BatchResult simulateRun(const MonteCarloConfig& config, uint32_t runIndex, const ReactorState& start,
+                               ReactorState& state, ScriptedPolicy& policy, std::unique_ptr<AutopilotPolicy>& pilot,
+                               TurnDistributions* distributions) {
+    state = start;
+    state.reseed(config.seed, runIndex);
+    state.distributions = distributions;
+    CoreModels engines;
+    engines.attach(state, config.models);
+    policy = config.policy;
+    if (!config.autopilot) return BatchRunner::run(state, policy, config.horizon);
+    if (!pilot) pilot.reset(new AutopilotPolicy(policy));
+    return BatchRunner::run(state, *pilot, config.horizon);
+}
+
+BatchResult MonteCarloRunner::simulate(const MonteCarloConfig& config, uint32_t runIndex,
+                                       TurnDistributions* distributions) {
+    ReactorState start(Difficulty::NORMAL);
+    start.currentDifficulty = config.difficulty;
+    ReactorState state(Difficulty::NORMAL);
+    ScriptedPolicy policy;
+    std::unique_ptr<AutopilotPolicy> pilot;
+    return simulateRun(config, runIndex, start, state, policy, pilot, distributions);
+}
+
+// Everything a run needs, kept between runs and batches
+struct MonteCarloPool::Worker {
+    explicit Worker(int horizon) : state(Difficulty::NORMAL), stats(horizon) {}
+
+    ReactorState state;
+    ScriptedPolicy policy;                   // Assigned per run, keeping its capacity
+    std::unique_ptr<AutopilotPolicy> pilot;  // Built by the first autopilot run
+    MonteCarloStats stats;
+};
+
+MonteCarloPool::MonteCarloPool(int threads)
+    : queues(std::max(1, threads)),
+      total(1),
+      fresh(Difficulty::NORMAL),
+      config(nullptr),
+      generation(0),
+      pending(0),
+      stopping(false)
+{
+    for (size_t t = 0; t < queues.size(); ++t) workers.emplace_back(new Worker(1));
+    for (size_t t = 1; t < queues.size(); ++t) helpers.emplace_back(&MonteCarloPool::serve, this, static_cast<int>(t));
+}
+
+MonteCarloPool::~MonteCarloPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& helper : helpers) helper.join();
+}
+
+void MonteCarloPool::serve(int id) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        work(id);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) finished.notify_one();
+    }
+}
+
+void MonteCarloPool::work(int id) {
+    const MonteCarloConfig& cfg = *config;
+    Worker& worker = *workers[id];
+    WorkStealingQueue& own = queues[id];
+    const int count = threads();
+    for (;;) {
+        uint32_t index;
+        while (own.pop(index)) {
+            // One set of sketches per worker, merged with the others at the end
+            TurnDistributions* readings = cfg.distributions ? &worker.stats.readings : nullptr;
+            worker.stats.add(simulateRun(cfg, index, fresh, worker.state, worker.policy, worker.pilot, readings));
+        }
+        bool stolen = false;
+        for (int k = 1; k < count && !stolen; ++k) {
+            stolen = own.steal(queues[(id + k) % count]);
+        }
+        if (!stolen) break;
+    }
+}
+
+const MonteCarloStats& MonteCarloPool::run(const MonteCarloConfig& batch) {
+    const int count = threads();
+    uint32_t runs = static_cast<uint32_t>(std::max(0L, batch.runs));
+
+    // Even initial split; stealing rebalances when runs end at very different turns
+    for (int t = 0; t < count; ++t) {
+        uint64_t begin = static_cast<uint64_t>(runs) * t / count;
+        uint64_t end = static_cast<uint64_t>(runs) * (t + 1) / count;
+        queues[t].reset(static_cast<uint32_t>(begin), static_cast<uint32_t>(end));
+        workers[t]->stats.clear(batch.horizon);
+    }
+    fresh = ReactorState(Difficulty::NORMAL);
+    fresh.currentDifficulty = batch.difficulty;
+    config = &batch;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = count - 1;
+        generation++;
+    }
+    wake.notify_all();
+    work(0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return pending == 0; });
+    }
+
+    // Merged in worker order, so a batch's totals do not depend on timing
+    total.clear(batch.horizon);
+    for (const std::unique_ptr<Worker>& worker : workers) total.merge(worker->stats);
+    return total;
+}
+
+MonteCarloStats MonteCarloRunner::run(const MonteCarloConfig& config) {
+    MonteCarloPool pool(config.threads);
+    return pool.run(config);
+}
+
+void MonteCarloRunner::wilsonInterval(long successes, long trials, double& low, double& high) {
+    if (trials <= 0) {
+        low = 0.0;
+        high = 1.0;
+        return;
+    }
+    const double z = 1.96;
+    double n = static_cast<double>(trials);
+    double p = successes / n;
+    double denom = 1.0 + z * z / n;
+    double center = (p + z * z / (2.0 * n)) / denom;
+    double half = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denom;
+    low = std::max(0.0, center - half);
+    high = std::min(1.0, center + half);
+}
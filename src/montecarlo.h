@@ -0,0 +1,166 @@
+#pragma once
+
+#include "reactor_state.h"
+#include "policy.h"
+#include "batch.h"
+#include "quantiles.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Welford running mean/variance; merge() uses Chan's parallel update
+class RunningStats {
+public:
+    RunningStats() : n(0), mu(0.0), m2(0.0), lo(0.0), hi(0.0) {}
+
+    void add(double x);
+    void clear() { *this = RunningStats(); }
+    void merge(const RunningStats& other);
+
+    long count() const { return n; }
+    double mean() const { return mu; }
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double stddev() const;
+    double min() const { return lo; }
+    double max() const { return hi; }
+
+private:
+    long n;
+    double mu;
+    double m2;
+    double lo;
+    double hi;
+};
+
+// Fixed-width histogram over [0, binWidth * bins); the last bin collects overflow
+class Histogram {
+public:
+    Histogram(double binWidth, int bins) : width(binWidth), counts(bins, 0), total(0) {}
+
+    void add(double x);
+    void merge(const Histogram& other);
+    // Empty the bins, keeping their storage, with a new width
+    void clear(double binWidth);
+
+    int bins() const { return static_cast<int>(counts.size()); }
+    double binWidth() const { return width; }
+    long count(int bin) const { return counts[bin]; }
+    long samples() const { return total; }
+
+    // Approximate quantile: finds the bin holding the q-th sample and
+    // interpolates linearly across it, as if its samples were spread evenly
+    // between its edges. Quantiles in the overflow bin stay below its upper edge.
+    double quantile(double q) const;
+
+private:
+    double width;
+    std::vector<long> counts;
+    long total;
+};
+
+// Per-thread result accumulator; all members merge associatively
+struct MonteCarloStats {
+    long runs;
+    long survived;
+    long meltdowns;
+    long shutdowns;
+    long scrams;
+    RunningStats score;
+    RunningStats turns;
+    Histogram scramRate;     // SCRAMs per 1000 turns
+    Histogram meltdownTurn;  // Turn of meltdown, melted runs only
+    TurnDistributions readings;  // Every turn of every run, with config.distributions
+
+    explicit MonteCarloStats(int horizon);
+
+    // SCRAMs per 1000 turns over all runs
+    double meanScramRate() const;
+
+    void add(const BatchResult& result);
+    void merge(const MonteCarloStats& other);
+    // Start over for a batch with this horizon, without reallocating
+    void clear(int horizon);
+};
+
+struct MonteCarloConfig {
+    DifficultySettings difficulty;
+    ScriptedPolicy policy;  // Copied fresh for every run
+    long runs;
+    int horizon;
+    int threads;
+    uint64_t seed;
+    ModelOptions models;
+    bool distributions;  // Sketch every turn's readings into MonteCarloStats::readings
+    bool autopilot;      // The autopilot sets the rods; the policy keeps the rest
+};
+
+// Index ranges with lock-free owner pop and thief steal-half. The range is
+// packed as (begin << 32 | end) in one atomic so both sides use a single CAS.
+// Padded to a cache line so neighbouring workers' queues never share one.
+class WorkStealingQueue {
+public:
+    WorkStealingQueue() : range(0) {}
+
+    void reset(uint32_t begin, uint32_t end);
+    bool pop(uint32_t& index);
+    bool steal(WorkStealingQueue& victim);
+
+private:
+    std::atomic<uint64_t> range;
+    char pad[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+// Persistent workers for many batches in a row, such as the calibrator's
+// fitness evaluations. Threads, queues, per-worker states, policies and
+// stats are created once; a batch only resets them. The calling thread is
+// worker 0.
+class MonteCarloPool {
+public:
+    explicit MonteCarloPool(int threads);
+    ~MonteCarloPool();
+
+    // config.runs simulations spread over the pool; config.threads is ignored.
+    // The result stays valid until the next batch.
+    const MonteCarloStats& run(const MonteCarloConfig& config);
+
+    int threads() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct Worker;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<WorkStealingQueue> queues;
+    std::vector<std::thread> helpers;
+    MonteCarloStats total;
+    ReactorState fresh;  // Each run starts from a copy of this
+    const MonteCarloConfig* config;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    uint64_t generation;  // Batches started
+    int pending;          // Helpers still working on this one
+    bool stopping;
+
+    void serve(int id);
+    void work(int id);
+};
+
+class MonteCarloRunner {
+public:
+    // Run config.runs independent simulations across config.threads workers
+    static MonteCarloStats run(const MonteCarloConfig& config);
+
+    // Simulate one run; the run index selects its RNG stream. Its turns are
+    // added to `distributions` when given.
+    static BatchResult simulate(const MonteCarloConfig& config, uint32_t runIndex,
+                                TurnDistributions* distributions = nullptr);
+
+    // Wilson score interval for a binomial proportion at ~95% confidence
+    static void wilsonInterval(long successes, long trials, double& low, double& high);
+};
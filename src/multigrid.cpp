@@ -0,0 +1,193 @@
+#include "multigrid.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const int PRE_SWEEPS = 2;
+const int POST_SWEEPS = 2;
+const int COARSEST_SWEEPS = 40;
+const int COARSEST_CELLS = 64;
+}
+
+MultigridSolver::MultigridSolver(int nx, int ny, int nz, double hx, double hy, double hz,
+                                 double diffusion) {
+    for (;;) {
+        Level l;
+        l.nx = nx;
+        l.ny = ny;
+        l.nz = nz;
+        l.sx = nx + 2;
+        l.sy = ny + 2;
+        l.cx = diffusion / (hx * hx);
+        l.cy = diffusion / (hy * hy);
+        l.cz = diffusion / (hz * hz);
+        size_t padded = static_cast<size_t>(nx + 2) * (ny + 2) * (nz + 2);
+        l.sigma.assign(padded, 0.0);
+        l.invDiag.assign(padded, 0.0);
+        l.x.assign(padded, 0.0);
+        l.b.assign(padded, 0.0);
+        levels.push_back(l);
+
+        if (nx * ny * nz <= COARSEST_CELLS || std::min(nx, std::min(ny, nz)) < 2) break;
+        nx = (nx + 1) / 2;
+        ny = (ny + 1) / 2;
+        nz = (nz + 1) / 2;
+        hx *= 2.0;
+        hy *= 2.0;
+        hz *= 2.0;
+    }
+}
+
+void MultigridSolver::updateCoefficients() {
+    for (size_t n = 0; n < levels.size(); ++n) {
+        Level& l = levels[n];
+        if (n > 0) {
+            // Coarse sigma is the average over the (up to 8) child cells
+            const Level& f = levels[n - 1];
+#pragma omp parallel for schedule(static)
+            for (int k = 0; k < l.nz; ++k) {
+                for (int j = 0; j < l.ny; ++j) {
+                    for (int i = 0; i < l.nx; ++i) {
+                        double sum = 0.0;
+                        int count = 0;
+                        for (int c = 0; c < 8; ++c) {
+                            int fi = 2 * i + (c & 1), fj = 2 * j + ((c >> 1) & 1), fk = 2 * k + (c >> 2);
+                            if (fi < f.nx && fj < f.ny && fk < f.nz) {
+                                sum += f.sigma[f.at(fi, fj, fk)];
+                                count++;
+                            }
+                        }
+                        l.sigma[l.at(i, j, k)] = sum / count;
+                    }
+                }
+            }
+        }
+        double offDiagonal = 2.0 * (l.cx + l.cy + l.cz);
+#pragma omp parallel for schedule(static)
+        for (int k = 0; k < l.nz; ++k) {
+            for (int j = 0; j < l.ny; ++j) {
+                for (int i = 0; i < l.nx; ++i) {
+                    size_t c = l.at(i, j, k);
+                    l.invDiag[c] = 1.0 / (offDiagonal + l.sigma[c]);
+                }
+            }
+        }
+    }
+}
+
+void MultigridSolver::smooth(Level& l, int sweeps) {
+    const int sx = l.sx;
+    const std::ptrdiff_t sxy = static_cast<std::ptrdiff_t>(l.sx) * l.sy;
+    for (int s = 0; s < sweeps; ++s) {
+        for (int color = 0; color < 2; ++color) {
+#pragma omp parallel for schedule(static)
+            for (int k = 0; k < l.nz; ++k) {
+                for (int j = 0; j < l.ny; ++j) {
+                    size_t row = l.at(0, j, k);
+                    double* x = &l.x[row];
+                    const double* b = &l.b[row];
+                    const double* inv = &l.invDiag[row];
+                    for (int i = (j + k + color) & 1; i < l.nx; i += 2) {
+                        double sum = l.cx * (x[i - 1] + x[i + 1])
+                                   + l.cy * (x[i - sx] + x[i + sx])
+                                   + l.cz * (x[i - sxy] + x[i + sxy]);
+                        x[i] = (b[i] + sum) * inv[i];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void MultigridSolver::restrictResidual(const Level& f, Level& c) {
+    const int sx = f.sx;
+    const std::ptrdiff_t sxy = static_cast<std::ptrdiff_t>(f.sx) * f.sy;
+    const double offDiagonal = 2.0 * (f.cx + f.cy + f.cz);
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < c.nz; ++k) {
+        for (int j = 0; j < c.ny; ++j) {
+            for (int i = 0; i < c.nx; ++i) {
+                double sum = 0.0;
+                int count = 0;
+                for (int ch = 0; ch < 8; ++ch) {
+                    int fi = 2 * i + (ch & 1), fj = 2 * j + ((ch >> 1) & 1), fk = 2 * k + (ch >> 2);
+                    if (fi >= f.nx || fj >= f.ny || fk >= f.nz) continue;
+                    size_t n = f.at(fi, fj, fk);
+                    const double* x = &f.x[n];
+                    double ax = (offDiagonal + f.sigma[n]) * x[0]
+                              - f.cx * (x[-1] + x[1])
+                              - f.cy * (x[-sx] + x[sx])
+                              - f.cz * (x[-sxy] + x[sxy]);
+                    sum += f.b[n] - ax;
+                    count++;
+                }
+                size_t n = c.at(i, j, k);
+                c.b[n] = sum / count;
+                c.x[n] = 0.0;
+            }
+        }
+    }
+}
+
+void MultigridSolver::prolongCorrection(const Level& c, Level& f) {
+    // Each fine cell sits a quarter coarse cell from its parent's centre:
+    // weights 3/4 (parent) and 1/4 (neighbour on that side) per dimension.
+    // Ghost cells hold zero, matching the vacuum boundary.
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < f.nz; ++k) {
+        int pk = k / 2, nk = pk + ((k & 1) ? 1 : -1);
+        for (int j = 0; j < f.ny; ++j) {
+            int pj = j / 2, nj = pj + ((j & 1) ? 1 : -1);
+            for (int i = 0; i < f.nx; ++i) {
+                int pi = i / 2, ni = pi + ((i & 1) ? 1 : -1);
+                double v = 27.0 * c.x[c.at(pi, pj, pk)]
+                         + 9.0 * (c.x[c.at(ni, pj, pk)] + c.x[c.at(pi, nj, pk)] + c.x[c.at(pi, pj, nk)])
+                         + 3.0 * (c.x[c.at(ni, nj, pk)] + c.x[c.at(ni, pj, nk)] + c.x[c.at(pi, nj, nk)])
+                         + c.x[c.at(ni, nj, nk)];
+                f.x[f.at(i, j, k)] += v / 64.0;
+            }
+        }
+    }
+}
+
+void MultigridSolver::vcycle(size_t n) {
+    Level& l = levels[n];
+    if (n + 1 == levels.size()) {
+        smooth(l, COARSEST_SWEEPS);
+        return;
+    }
+    smooth(l, PRE_SWEEPS);
+    restrictResidual(l, levels[n + 1]);
+    vcycle(n + 1);
+    prolongCorrection(levels[n + 1], l);
+    smooth(l, POST_SWEEPS);
+}
+
+double MultigridSolver::solve(int cycles) {
+    for (int c = 0; c < cycles; ++c) vcycle(0);
+    return residualNorm();
+}
+
+double MultigridSolver::residualNorm() {
+    const Level& l = levels[0];
+    const int sx = l.sx;
+    const std::ptrdiff_t sxy = static_cast<std::ptrdiff_t>(l.sx) * l.sy;
+    const double offDiagonal = 2.0 * (l.cx + l.cy + l.cz);
+    double sum = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:sum)
+    for (int k = 0; k < l.nz; ++k) {
+        for (int j = 0; j < l.ny; ++j) {
+            for (int i = 0; i < l.nx; ++i) {
+                size_t n = l.at(i, j, k);
+                const double* x = &l.x[n];
+                double r = l.b[n] - (offDiagonal + l.sigma[n]) * x[0]
+                         + l.cx * (x[-1] + x[1])
+                         + l.cy * (x[-sx] + x[sx])
+                         + l.cz * (x[-sxy] + x[sxy]);
+                sum += r * r;
+            }
+        }
+    }
+    return std::sqrt(sum);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Geometric multigrid for one-group diffusion on a cell-centred box mesh:
+//
+//   -D lap(x) + sigma x = b,  x = 0 one cell beyond the boundary (vacuum)
+//
+// sigma varies per cell, D is constant. Arrays are stored with one layer of
+// zero ghost cells so stencils need no boundary branches; index cells with
+// at(i, j, k). Coarse levels halve each dimension (rounding up) and
+// rediscretize with averaged sigma. V-cycles use red-black Gauss-Seidel,
+// trilinear prolongation and a fused residual + restriction pass.
+class MultigridSolver {
+public:
+    MultigridSolver(int nx, int ny, int nz, double hx, double hy, double hz, double diffusion);
+
+    int nx() const { return levels[0].nx; }
+    int ny() const { return levels[0].ny; }
+    int nz() const { return levels[0].nz; }
+    int levelCount() const { return static_cast<int>(levels.size()); }
+
+    size_t at(int i, int j, int k) const { return levels[0].at(i, j, k); }
+
+    // Finest-level coefficient, right-hand side and solution (padded layout)
+    std::vector<double>& sigma() { return levels[0].sigma; }
+    std::vector<double>& rhs() { return levels[0].b; }
+    std::vector<double>& solution() { return levels[0].x; }
+    const std::vector<double>& solution() const { return levels[0].x; }
+
+    // Call after changing sigma(): rebuilds diagonals of every level
+    void updateCoefficients();
+
+    // Run V-cycles from the current solution; returns the final residual 2-norm
+    double solve(int cycles);
+
+    double residualNorm();
+
+private:
+    struct Level {
+        int nx, ny, nz;
+        int sx, sy;  // Strides of the padded layout
+        double cx, cy, cz;  // D / h^2
+        std::vector<double> sigma, invDiag, x, b;
+
+        size_t at(int i, int j, int k) const {
+            return (static_cast<size_t>(k + 1) * sy + (j + 1)) * sx + (i + 1);
+        }
+    };
+
+    std::vector<Level> levels;
+
+    void smooth(Level& l, int sweeps);
+    void restrictResidual(const Level& fine, Level& coarse);
+    void prolongCorrection(const Level& coarse, Level& fine);
+    void vcycle(size_t level);
+};
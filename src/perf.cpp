@@ -0,0 +1,222 @@
+#include "perf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <streambuf>
+#include <string>
+
+#ifdef REACTOR_PERF
+namespace {
+// Log-linear buckets: exact below 8 ticks, then 8 per power of two (about 6%
+// wide), up to 2^64 ticks
+const int SUB_BUCKETS = 8;
+const int BUCKETS = 62 * SUB_BUCKETS;
+const int PROBES = static_cast<int>(PerfProbe::PROBE_COUNT);
+
+const char* const PROBE_NAMES[PROBES] = {
+    "turn", "spatial", "neutronics", "depletion", "thermal", "xenon", "turbine", "emergency",
+    "radiation", "containment", "weather", "grid", "scoring", "achievements", "events", "safety",
+    "render", "present", "input", "autopilot"
+};
+
+struct Histogram {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+    uint32_t buckets[BUCKETS];
+};
+
+struct Counters {
+    Histogram probes[PROBES];
+    uint64_t turns;
+    uint64_t messages;
+    uint64_t maxMessages;
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t maxBytes;
+    uint64_t bytesSeen;  // Output counter at the last frame
+};
+
+thread_local Counters counters;
+
+int bucket(uint64_t ticks) {
+    if (ticks < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<int>(ticks);
+    int exponent = 63 - __builtin_clzll(ticks);
+    return (exponent - 2) * SUB_BUCKETS + static_cast<int>((ticks >> (exponent - 3)) & (SUB_BUCKETS - 1));
+}
+
+// Middle of a bucket, in ticks
+double bucketMiddle(int b) {
+    if (b < SUB_BUCKETS) return b;
+    int exponent = b / SUB_BUCKETS + 2;
+    double width = static_cast<double>(uint64_t(1) << (exponent - 3));
+    return (SUB_BUCKETS + b % SUB_BUCKETS) * width + width / 2.0;
+}
+
+double percentile(const Histogram& h, double q) {
+    uint64_t rank = static_cast<uint64_t>(q * (h.count - 1));
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += h.buckets[b];
+        if (seen > rank) {
+            return b == bucket(h.max) ? static_cast<double>(h.max) : bucketMiddle(b);
+        }
+    }
+    return static_cast<double>(h.max);
+}
+
+// Passes everything through to the real buffer, counting bytes
+class CountingBuffer : public std::streambuf {
+public:
+    explicit CountingBuffer(std::streambuf* target) : target(target), written(0) {}
+    uint64_t bytes() const { return written; }
+
+protected:
+    int overflow(int c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        written++;
+        return target->sputc(traits_type::to_char_type(c));
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        std::streamsize put = target->sputn(s, n);
+        written += static_cast<uint64_t>(put);
+        return put;
+    }
+    int sync() override { return target->pubsync(); }
+
+private:
+    std::streambuf* target;
+    uint64_t written;
+};
+
+CountingBuffer* output = nullptr;
+// Written to by the render thread of a real-time session
+std::atomic<uint64_t> directBytes(0);
+
+// TSC ticks per nanosecond, against the steady clock since program start
+struct Anchor {
+    uint64_t ticks;
+    std::chrono::steady_clock::time_point time;
+};
+const Anchor START = {Perf::now(), std::chrono::steady_clock::now()};
+
+double ticksPerNanosecond() {
+#if defined(__x86_64__) || defined(__i386__)
+    // Wait out the first 20 ms so the ratio is accurate to well under 0.1%
+    while (std::chrono::steady_clock::now() - START.time < std::chrono::milliseconds(20)) {}
+    uint64_t ticks = Perf::now();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - START.time).count();
+    return (ticks - START.ticks) / ns;
+#else
+    return 1.0;
+#endif
+}
+
+std::string duration(double ns) {
+    char text[32];
+    if (ns < 1e3) {
+        std::snprintf(text, sizeof(text), "%.0f ns", ns);
+    } else if (ns < 1e6) {
+        std::snprintf(text, sizeof(text), "%.1f \xc2\xb5s", ns / 1e3);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1f ms", ns / 1e6);
+    }
+    return text;
+}
+}
+
+PERF_THREAD_LOCAL bool Perf::sampleTurn = true;
+
+void Perf::record(PerfProbe probe, uint64_t ticks) {
+    Histogram& h = counters.probes[static_cast<int>(probe)];
+    h.count++;
+    h.total += ticks;
+    if (ticks > h.max) h.max = ticks;
+    h.buckets[bucket(ticks)]++;
+}
+
+void Perf::turnCompleted(size_t messages) {
+    counters.turns++;
+    // Interactive turns wait on the operator anyway, so time all of them
+    sampleTurn = output || counters.turns % SAMPLE_TURNS == 0;
+    counters.messages += messages;
+    if (messages > counters.maxMessages) counters.maxMessages = messages;
+}
+
+void Perf::frameCompleted() {
+    if (!output) return;
+    uint64_t seen = output->bytes() + directBytes.load(std::memory_order_relaxed);
+    uint64_t bytes = seen - counters.bytesSeen;
+    counters.bytesSeen = seen;
+    counters.frames++;
+    counters.bytes += bytes;
+    if (bytes > counters.maxBytes) counters.maxBytes = bytes;
+}
+
+void Perf::countWrite(size_t bytes) {
+    directBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Perf::countOutput(std::ostream& stream) {
+    if (output) return;
+    // Never freed: the stream may flush through it during exit
+    output = new CountingBuffer(stream.rdbuf());
+    stream.rdbuf(output);
+    counters.bytesSeen = 0;
+}
+
+void Perf::reset() {
+    uint64_t seen = counters.bytesSeen;
+    std::memset(&counters, 0, sizeof(counters));
+    counters.bytesSeen = seen;
+    sampleTurn = true;
+}
+
+void Perf::report(std::ostream& out) {
+    double perNs = ticksPerNanosecond();
+    std::ios format(nullptr);
+    format.copyfmt(out);
+
+    out << "Hot-path timing for this thread (" << std::fixed << std::setprecision(2) << perNs << " ticks/ns, ";
+    if (output) {
+        out << "every turn timed)\n";
+    } else {
+        out << "one turn in " << SAMPLE_TURNS << " timed)\n";
+    }
+    out << "  " << std::left << std::setw(14) << "probe" << std::right << std::setw(10) << "calls"
+        << std::setw(11) << "p50" << std::setw(11) << "p99" << std::setw(11) << "max" << "\n";
+    for (int p = 0; p < PROBES; ++p) {
+        const Histogram& h = counters.probes[p];
+        if (h.count == 0) continue;
+        out << "  " << std::left << std::setw(14) << PROBE_NAMES[p] << std::right << std::setw(10) << h.count
+            << std::setw(11) << duration(percentile(h, 0.50) / perNs)
+            << std::setw(11) << duration(percentile(h, 0.99) / perNs)
+            << std::setw(11) << duration(h.max / perNs) << "\n";
+    }
+
+    const Histogram& turn = counters.probes[static_cast<int>(PerfProbe::TURN)];
+    double turnSeconds = turn.total / perNs / 1e9;
+    out << std::setprecision(0) << "  Turns: " << counters.turns;
+    if (turnSeconds > 0.0) out << ", " << turn.count / turnSeconds << " turns/sec of simulation time";
+    out << "\n" << std::setprecision(2)
+        << "  Messages per turn: mean " << (counters.turns ? static_cast<double>(counters.messages) / counters.turns : 0.0)
+        << ", max " << counters.maxMessages << "\n";
+    if (counters.frames > 0) {
+        out << std::setprecision(0)
+            << "  Terminal output per frame: mean " << static_cast<double>(counters.bytes) / counters.frames
+            << " bytes, max " << counters.maxBytes << " bytes over " << counters.frames << " frames\n";
+    }
+    out.copyfmt(format);
+}
+#else
+void Perf::countOutput(std::ostream&) {}
+void Perf::reset() {}
+
+void Perf::report(std::ostream& out) {
+    out << "Hot-path instrumentation is compiled out; rebuild with PERF=-DREACTOR_PERF.\n";
+}
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef REACTOR_PERF
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+// Hot-path instrumentation, compiled in with -DREACTOR_PERF (the Makefile's
+// PERF variable, on by default). PERF_SCOPE timestamps a block with the TSC
+// and adds it to a per-thread log2 histogram: two counter reads and a few
+// increments, no locks or allocation. A basic-model turn is only a few
+// hundred nanoseconds, so the probes inside a turn time one turn in
+// Perf::SAMPLE_TURNS (every turn in interactive play) and cost a
+// thread-local test otherwise. Without REACTOR_PERF the scopes and counters
+// compile to nothing. `perf` and headless runs print the calling thread's
+// data.
+enum class PerfProbe : int {
+    TURN,          // Physics, events and safety of one turn; sampled up to SAFETY
+    SPATIAL,
+    NEUTRONICS,    // Point kinetics or the basic core multiplier
+    DEPLETION,
+    THERMAL,       // Channels or the lumped core heat balance
+    XENON,
+    TURBINE,
+    EMERGENCY,     // ECCS and diesel
+    RADIATION,
+    CONTAINMENT,
+    WEATHER,
+    GRID,
+    SCORING,
+    ACHIEVEMENTS,
+    EVENTS,
+    SAFETY,
+    RENDER,        // Timed every time from here on: composing the dashboard, score, status and tip
+    PRESENT,       // Diffing a frame against the last one and writing it
+    INPUT,         // Executing a command, not waiting for it
+    AUTOPILOT,     // Choosing the rods for a turn in auto mode
+    PROBE_COUNT
+};
+
+namespace Perf {
+#ifdef REACTOR_PERF
+    static constexpr bool ENABLED = true;
+    static constexpr uint64_t SAMPLE_TURNS = 16;
+
+    // Whether the probes inside the current turn are timed. GCC's __thread
+    // skips the initialization check an extern thread_local costs per access.
+#ifdef __GNUC__
+#define PERF_THREAD_LOCAL __thread
+#else
+#define PERF_THREAD_LOCAL thread_local
+#endif
+    extern PERF_THREAD_LOCAL bool sampleTurn;
+
+    inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    void record(PerfProbe probe, uint64_t ticks);
+    void turnCompleted(size_t messages);  // Messages the turn queued
+    void frameCompleted();                // Terminal bytes since the last frame
+    void countWrite(size_t bytes);        // Bytes written to the terminal around the counted stream
+#else
+    static constexpr bool ENABLED = false;
+
+    inline void turnCompleted(size_t) {}
+    inline void frameCompleted() {}
+    inline void countWrite(size_t) {}
+#endif
+
+    // Count the bytes written to `stream` for frameCompleted (interactive play)
+    void countOutput(std::ostream& stream);
+
+    void report(std::ostream& out);
+    void reset();
+}
+
+#ifdef REACTOR_PERF
+class PerfScope {
+public:
+    explicit PerfScope(PerfProbe probe)
+        : probe(probe), start(probe >= PerfProbe::RENDER || Perf::sampleTurn ? Perf::now() : 0) {}
+    ~PerfScope() {
+        if (start) Perf::record(probe, Perf::now() - start);
+    }
+
+private:
+    PerfProbe probe;
+    uint64_t start;
+
+    PerfScope(const PerfScope&);
+    PerfScope& operator=(const PerfScope&);
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(probe) PerfScope PERF_CONCAT(perfScope, __LINE__)(PerfProbe::probe)
+#else
+#define PERF_SCOPE(probe) do {} while (0)
+#endif
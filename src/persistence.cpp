@@ -1,50 +1,413 @@
 #include "persistence.h"
+#include "history.h"
+#include "spatial.h"
+#include "subchannel.h"
+#include "depletion.h"
+#include "trends.h"
+#include "quantiles.h"
+#include "journal.h"
+#include "mapped_file.h"
+#include "crc32.h"
+#include "byte_stream.h"
+#include "event_catalog.h"
 
 #include <fstream>
+#include <algorithm>
+#include <cstddef>
 #include <string>
+#include <vector>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
 
-bool PersistenceSystem::saveGame(const ReactorState& state) {
-    std::ofstream file(RC::SAVE_FILE);
-    if (!file.is_open()) return false;
-
-    file << state.currentDifficulty.name << "\n";
-    file << state.neutrons << " " << state.controlRods << " " << state.temperature << "\n";
-    file << state.coolant << " " << state.power << " " << state.fuel << "\n";
-    file << state.xenonLevel << " " << state.xenonHandledCount << "\n";
-    file << state.turbineRPM << " " << state.steamPressure << " " << state.electricityOutput << "\n";
-    file << state.totalElectricityGenerated << " " << state.turbineOnline << " " << state.maxTurbineTurns << "\n";
-    file << state.eccsAvailable << " " << state.eccsCooldownTimer << "\n";
-    file << state.score << " " << state.turns << " " << state.scramCount << "\n";
-    file << state.eventsExperienced << " " << state.turnsWithoutScram << " " << state.scramRecoveries << "\n";
-
-    file.close();
-    return true;
+namespace {
+struct SaveHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sections;
+    uint32_t crc;  // Header with this field zero, then the section table
+    int32_t difficulty;
+    int32_t turns;
+    int32_t score;
+    uint32_t catalog;  // EventCatalog::checksum of the log entries' texts
+    uint32_t reserved;
+    int64_t savedAt;
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t crc;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(SaveHeader) == 40 && sizeof(SectionEntry) == 24, "save layout");
+
+const int MAX_SECTIONS = 16;
+
+std::string slotPath(int slot) {
+    return std::string(RC::SAVE_FILE) + "_" + std::to_string(slot);
+}
+
+std::string journalPath(int slot) {
+    return slotPath(slot) + ".journal";
+}
+
+// The journal section: which entries of the slot's journal copy are the save's
+struct JournalSection {
+    uint64_t records;
+    uint32_t crc;  // CRC-32C of those records
+    uint32_t reserved;
+};
+
+uint32_t headerCrc(SaveHeader header, const SectionEntry* table) {
+    header.crc = 0;
+    return crc32c(table, header.sections * sizeof(SectionEntry), crc32c(&header, sizeof(header)));
+}
+
+uint64_t aligned(uint64_t offset) {
+    return (offset + 7) / 8 * 8;
+}
+
+// Tag of every saved StateSnapshot field. Tags are never reused: a field
+// that goes away keeps its number retired.
+struct StateField {
+    uint16_t tag;
+    uint16_t offset;
+    uint16_t size;
+};
+
+static_assert(sizeof(StateSnapshot) <= UINT16_MAX, "state field offsets are 16-bit");
+
+#define FIELD(tag, member) {tag, offsetof(StateSnapshot, member), sizeof(StateSnapshot::member)}
+const StateField STATE_FIELDS[] = {
+    FIELD(1, neutrons),
+    FIELD(2, controlRods),
+    FIELD(3, temperature),
+    FIELD(4, coolant),
+    FIELD(5, power),
+    FIELD(6, fuel),
+    FIELD(7, precursors),
+    FIELD(8, kineticsStep),
+    FIELD(9, kineticsReactivity),
+    FIELD(10, xenonLevel),
+    FIELD(11, turbineRPM),
+    FIELD(12, steamPressure),
+    FIELD(13, electricityOutput),
+    FIELD(14, totalElectricityGenerated),
+    FIELD(15, dieselFuel),
+    FIELD(16, radiationLevel),
+    FIELD(17, totalRadiationExposure),
+    FIELD(18, gridDemand),
+    FIELD(19, demandSatisfaction),
+    FIELD(20, containmentIntegrity),
+    FIELD(21, peakTemperature),
+    FIELD(22, peakPower),
+    FIELD(23, peakElectricity),
+    FIELD(24, totalPowerGenerated),
+    FIELD(25, averageTemperature),
+    FIELD(26, temperatureSum),
+    FIELD(27, lowestCoolant),
+    FIELD(28, highestXenon),
+    FIELD(29, rngSeed),
+    FIELD(30, difficulty),
+    FIELD(31, xenonHandledCount),
+    FIELD(32, maxTurbineTurns),
+    FIELD(33, pressureWarnings),
+    FIELD(34, eccsCooldownTimer),
+    FIELD(35, dieselRuntime),
+    FIELD(36, radiationAlarms),
+    FIELD(37, weather),
+    FIELD(38, weatherDuration),
+    FIELD(39, weatherChangeCooldown),
+    FIELD(40, demandBonus),
+    FIELD(41, demandPenalty),
+    FIELD(42, lastTipTurn),
+    FIELD(43, highSatisfactionTurns),
+    FIELD(44, stormsSurvived),
+    FIELD(45, turnsWithoutPressureRelief),
+    FIELD(46, safeRadiationTurns),
+    FIELD(47, score),
+    FIELD(48, turns),
+    FIELD(49, scramCount),
+    FIELD(50, eventsExperienced),
+    FIELD(51, turnsWithoutScram),
+    FIELD(52, scramRecoveries),
+    FIELD(53, criticalEvents),
+    FIELD(54, unlockedAchievements),
+    FIELD(55, sessionAchievements),
+    FIELD(56, rngRunId),
+    FIELD(57, rngTurn),
+    FIELD(58, rngDraws),
+    // 59 and 60 held the operator log's ring position; the log is now its own section
+    FIELD(61, running),
+    FIELD(62, kineticsEnabled),
+    FIELD(63, turbineOnline),
+    FIELD(64, pressureReliefOpen),
+    FIELD(65, eccsAvailable),
+    FIELD(66, dieselRunning),
+    FIELD(67, dieselAutoStart),
+    FIELD(68, containmentBreach),
+    FIELD(69, paused),
+    FIELD(70, autoRods),
+    // 71 held the operator log slots
+    FIELD(72, loggedEntries),
+};
+#undef FIELD
+
+const size_t STATE_FIELD_COUNT = sizeof(STATE_FIELDS) / sizeof(STATE_FIELDS[0]);
+
+void encodeState(const StateSnapshot& snapshot, std::vector<unsigned char>& out) {
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(&snapshot);
+    putValue(out, SV::STATE_VERSION);
+    putValue(out, static_cast<uint32_t>(STATE_FIELD_COUNT));
+    for (const StateField& field : STATE_FIELDS) {
+        putValue(out, field.tag);
+        putValue(out, field.size);
+        putBytes(out, base + field.offset, field.size);
+    }
 }
 
-bool PersistenceSystem::loadGame(ReactorState& state) {
-    std::ifstream file(RC::SAVE_FILE);
-    if (!file.is_open()) return false;
+// Fields over `snapshot`, which holds the values for any the data lacks
+LoadResult decodeState(const unsigned char* data, size_t size, StateSnapshot& snapshot) {
+    unsigned char* base = reinterpret_cast<unsigned char*>(&snapshot);
+    ByteReader in(data, size);
+    uint32_t version, count;
+    if (!in.value(version) || !in.value(count)) return LoadResult::DAMAGED;
+    if (version != SV::STATE_VERSION) return LoadResult::INCOMPATIBLE;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t tag, bytes;
+        if (!in.value(tag) || !in.value(bytes)) return LoadResult::DAMAGED;
+        const StateField* field = nullptr;
+        for (const StateField& f : STATE_FIELDS) {
+            if (f.tag == tag) field = &f;
+        }
+        if (!field) {
+            if (!in.skip(bytes)) return LoadResult::DAMAGED;
+            continue;
+        }
+        if (bytes != field->size) return LoadResult::INCOMPATIBLE;
+        if (!in.bytes(base + field->offset, bytes)) return LoadResult::DAMAGED;
+    }
+    return in.finished() ? LoadResult::OK : LoadResult::DAMAGED;
+}
+}
 
-    std::string diffName;
-    file >> diffName;
+bool PersistenceSystem::saveGame(const ReactorState& state, int slot) {
+    if (slot < 0 || slot >= RC::SAVE_SLOTS) return false;
 
-    file >> state.neutrons >> state.controlRods >> state.temperature;
-    file >> state.coolant >> state.power >> state.fuel;
-    file >> state.xenonLevel >> state.xenonHandledCount;
-    file >> state.turbineRPM >> state.steamPressure >> state.electricityOutput;
-    file >> state.totalElectricityGenerated >> state.turbineOnline >> state.maxTurbineTurns;
-    file >> state.eccsAvailable >> state.eccsCooldownTimer;
-    file >> state.score >> state.turns >> state.scramCount;
-    file >> state.eventsExperienced >> state.turnsWithoutScram >> state.scramRecoveries;
+    struct Section {
+        uint32_t id;
+        const void* data;
+        size_t size;
+    };
+    Section sections[SV::SECTION_IDS];
+    int count = 0;
+    StateSnapshot snapshot;
+    StateHistory::capture(state, snapshot);
+    std::vector<unsigned char> fields;
+    encodeState(snapshot, fields);
+    sections[count++] = Section{SV::STATE, fields.data(), fields.size()};
 
-    file.close();
+    LogEntry log[RC::MAX_LOG_ENTRIES];
+    for (size_t i = 0; i < state.operatorLog.size(); ++i) log[i] = state.operatorLog[i];
+    sections[count++] = Section{SV::LOG, log, state.operatorLog.size() * sizeof(LogEntry)};
+
+    std::vector<unsigned char> history;
+    if (state.history && state.history->size() > 0) {
+        state.history->serialize(history);
+        sections[count++] = Section{SV::HISTORY, history.data(), history.size()};
+    }
+
+    // The records stay in the slot's journal copy, which gains only those
+    // added since it was last brought up to date
+    JournalSection journal{0, 0, 0};
+    if (state.journal && state.journal->isOpen()) {
+        if (!state.journal->saveCopy(journalPath(slot))) return false;
+        journal.records = state.journal->size();
+        journal.crc = state.journal->checksum();
+        sections[count++] = Section{SV::JOURNAL, &journal, sizeof(journal)};
+    }
+
+    std::vector<unsigned char> spatial, channels, depletion;
+    if (state.spatial) {
+        state.spatial->saveState(spatial);
+        sections[count++] = Section{SV::SPATIAL, spatial.data(), spatial.size()};
+    }
+    if (state.channels) {
+        state.channels->saveState(channels);
+        sections[count++] = Section{SV::CHANNELS, channels.data(), channels.size()};
+    }
+    if (state.depletion) {
+        state.depletion->saveState(depletion);
+        sections[count++] = Section{SV::DEPLETION, depletion.data(), depletion.size()};
+    }
+
+    SaveHeader header{SV::MAGIC, SV::VERSION, static_cast<uint16_t>(count), 0,
+                      static_cast<int32_t>(state.currentDifficulty.level), state.turns, state.score,
+                      EventCatalog::active().checksum(), 0, static_cast<int64_t>(std::time(nullptr))};
+    SectionEntry table[SV::SECTION_IDS];
+    uint64_t offset = aligned(sizeof(header) + count * sizeof(SectionEntry));
+    for (int i = 0; i < count; ++i) {
+        table[i] = SectionEntry{sections[i].id, crc32c(sections[i].data, sections[i].size), offset, sections[i].size};
+        offset = aligned(offset + sections[i].size);
+    }
+    header.crc = headerCrc(header, table);
+
+    // Write a temporary file and move it over the slot once it is on disk,
+    // so a crash or a full disk mid-save leaves the previous save intact
+    std::string path = slotPath(slot);
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+    static const unsigned char padding[8] = {};
+    uint64_t written = sizeof(header) + count * sizeof(SectionEntry);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(table, sizeof(SectionEntry), count, file) == static_cast<size_t>(count);
+    for (int i = 0; ok && i < count; ++i) {
+        ok = std::fwrite(padding, 1, table[i].offset - written, file) == table[i].offset - written &&
+             std::fwrite(sections[i].data, 1, sections[i].size, file) == sections[i].size;
+        written = table[i].offset + sections[i].size;
+    }
+    ok = syncFile(file) && ok;
+    ok = std::fclose(file) == 0 && ok && replaceFile(temporary, path);
+    if (!ok) std::remove(temporary.c_str());
+    return ok;
+}
+
+LoadResult PersistenceSystem::loadGame(ReactorState& state, int slot) {
+    if (slot < 0 || slot >= RC::SAVE_SLOTS) return LoadResult::MISSING;
+    MappedFile file(slotPath(slot));
+    if (!file.isOpen()) return LoadResult::MISSING;
+
+    SaveHeader header;
+    if (file.size() < sizeof(header)) return LoadResult::DAMAGED;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != SV::MAGIC) return LoadResult::DAMAGED;
+    if (header.version != SV::VERSION) return LoadResult::INCOMPATIBLE;
+    if (header.sections > MAX_SECTIONS || file.size() < sizeof(header) + header.sections * sizeof(SectionEntry)) {
+        return LoadResult::DAMAGED;
+    }
+    SectionEntry table[MAX_SECTIONS];
+    std::memcpy(table, file.data() + sizeof(header), header.sections * sizeof(SectionEntry));
+    if (headerCrc(header, table) != header.crc) return LoadResult::DAMAGED;
+
+    const unsigned char* sections[SV::SECTION_IDS] = {};
+    size_t sizes[SV::SECTION_IDS] = {};
+    for (int i = 0; i < header.sections; ++i) {
+        const SectionEntry& entry = table[i];
+        if (entry.offset > file.size() || entry.size > file.size() - entry.offset) return LoadResult::DAMAGED;
+        const unsigned char* data = file.data() + entry.offset;
+        if (crc32c(data, entry.size) != entry.crc) return LoadResult::DAMAGED;
+        if (entry.id < SV::SECTION_IDS) {
+            sections[entry.id] = data;
+            sizes[entry.id] = entry.size;
+        }
+    }
+    if (!sections[SV::STATE]) return LoadResult::DAMAGED;
+    if (header.difficulty < 0 || header.difficulty > static_cast<int>(Difficulty::NIGHTMARE)) {
+        return LoadResult::INCOMPATIBLE;
+    }
+    Difficulty difficulty = static_cast<Difficulty>(header.difficulty);
+
+    // Fields the save lacks start as in a new game
+    StateSnapshot snapshot;
+    StateHistory::capture(ReactorState(difficulty), snapshot);
+    LoadResult decoded = decodeState(sections[SV::STATE], sizes[SV::STATE], snapshot);
+    if (decoded != LoadResult::OK) return decoded;
+    // Saved under another event catalog: its texts are not the loaded ones
+    const bool sameCatalog = header.catalog == EventCatalog::active().checksum();
+
+    StateHistory::restoreSnapshot(state, snapshot);
+    // The newest entries of a longer log, if the section has more
+    state.operatorLog.clear();
+    const LogEntry* log = reinterpret_cast<const LogEntry*>(sections[SV::LOG]);
+    size_t logged = sizes[SV::LOG] / sizeof(LogEntry);
+    for (size_t i = logged - std::min(logged, state.operatorLog.capacity()); i < logged; ++i) {
+        LogEntry entry = log[i];
+        if (!sameCatalog) EventCatalog::forgetTexts(&entry, 1);
+        state.operatorLog.push(entry);
+    }
+    state.currentDifficulty = getDifficultySettings(difficulty);
+    if (state.spatial && !(sections[SV::SPATIAL] &&
+                           state.spatial->loadState(sections[SV::SPATIAL], sizes[SV::SPATIAL]))) {
+        state.spatial->reset(state);
+    }
+    if (state.depletion && !(sections[SV::DEPLETION] &&
+                             state.depletion->loadState(sections[SV::DEPLETION], sizes[SV::DEPLETION]))) {
+        state.depletion->reset(state);
+    }
+    if (state.channels && !(sections[SV::CHANNELS] &&
+                            state.channels->loadState(sections[SV::CHANNELS], sizes[SV::CHANNELS]))) {
+        state.channels->reset(state);
+    }
     state.running = true;
-    return true;
+    loadHighScore(state);
+
+    if (state.history && !(sameCatalog && sections[SV::HISTORY] &&
+                           state.history->restore(sections[SV::HISTORY], sizes[SV::HISTORY]))) {
+        // No usable history (its snapshots' logs hold another catalog's
+        // texts, if any): the loaded turn starts a new one
+        state.history->clear();
+        state.history->record(state);
+    }
+    // Trends and distributions are not saved: the loaded turn starts new ones
+    if (state.trends) state.trends->clear();
+    if (state.distributions) state.distributions->clear();
+    if (state.journal) {
+        // The copy may have grown past the save, or been rewritten by a save
+        // that never completed; without the save's records the journal
+        // starts over from the loaded turn
+        JournalSection journal{0, 0, 0};
+        MappedFile copy;
+        size_t count = 0;
+        const LogEntry* entries = nullptr;
+        if (sizes[SV::JOURNAL] == sizeof(journal)) {
+            std::memcpy(&journal, sections[SV::JOURNAL], sizeof(journal));
+            entries = Journal::mapCopy(copy, journalPath(slot), count);
+        }
+        if (!entries || count < journal.records ||
+            crc32c(entries, journal.records * sizeof(LogEntry)) != journal.crc) {
+            journal.records = 0;
+        }
+        if (sameCatalog) {
+            state.journal->replace(entries, journal.records);
+        } else {
+            std::vector<LogEntry> kept(entries, entries + journal.records);
+            EventCatalog::forgetTexts(kept.data(), kept.size());
+            state.journal->replace(kept.data(), kept.size());
+        }
+    }
+    return LoadResult::OK;
+}
+
+SaveSlotInfo PersistenceSystem::slotInfo(int slot) {
+    SaveSlotInfo info{LoadResult::MISSING, Difficulty::NORMAL, 0, 0, 0};
+    std::FILE* file = std::fopen(slotPath(slot).c_str(), "rb");
+    if (!file) return info;
+    SaveHeader header;
+    bool read = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fclose(file);
+
+    if (!read || header.magic != SV::MAGIC) {
+        info.status = LoadResult::DAMAGED;
+    } else if (header.version != SV::VERSION ||
+               header.difficulty < 0 || header.difficulty > static_cast<int>(Difficulty::NIGHTMARE)) {
+        info.status = LoadResult::INCOMPATIBLE;
+    } else {
+        // Section checksums are only verified on load
+        info.status = LoadResult::OK;
+        info.difficulty = static_cast<Difficulty>(header.difficulty);
+        info.turns = header.turns;
+        info.score = header.score;
+        info.savedAt = header.savedAt;
+    }
+    return info;
 }
 
-void PersistenceSystem::deleteSave() {
-    std::remove(RC::SAVE_FILE);
+void PersistenceSystem::deleteSave(int slot) {
+    std::remove(slotPath(slot).c_str());
+    std::remove(journalPath(slot).c_str());
 }
 
 void PersistenceSystem::loadHighScore(ReactorState& state) {
@@ -83,8 +446,8 @@ void PersistenceSystem::loadAchievements(ReactorState& state) {
 void PersistenceSystem::saveAchievements(const ReactorState& state) {
     std::ofstream file(RC::ACHIEVEMENTS_FILE);
     if (file.is_open()) {
-        for (const auto& ach : state.unlockedAchievements) {
-            file << static_cast<int>(ach) << "\n";
+        for (int i = 0; i < static_cast<int>(Achievement::ACHIEVEMENT_COUNT); ++i) {
+            if (state.unlockedAchievements.contains(static_cast<Achievement>(i))) file << i << "\n";
         }
         file.close();
     }
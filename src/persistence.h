@@ -2,11 +2,73 @@
 
 #include "reactor_state.h"
 
+#include <cstdint>
+#include <string>
+
+// Save files (RC::SAVE_FILE + "_" + slot) are a binary container: a header
+// with the magic, container version and a summary for slot listings, a
+// section table, then 8-byte aligned sections, each with a CRC-32C. Loading
+// maps the file and reads the history section in place.
+//
+// The journal's records are kept in a copy next to the slot (slot path +
+// ".journal", see Journal::saveCopy) rather than in the save, so saving
+// again in the same game only appends the records added since. The save's
+// journal section holds the record count and CRC-32C its game had; a copy
+// that no longer starts with those records loads as an empty journal.
+//
+// The header also holds the checksum of the event catalog the game ran
+// with. Loaded under another catalog, the log and journal keep their catalog
+// entries as a generic "Catalog event" and the rewind history is dropped.
+//
+// The state section has its own version, then the StateSnapshot fields one
+// by one as (tag, byte count, value). Tags are fixed per field, so either
+// struct can be reordered without touching saves. A loader skips tags it does
+// not know and gives fields the save lacks their new-game values; a known
+// tag with another size makes the save incompatible. Changing what a tag
+// means needs a new tag or SV::STATE_VERSION.
+//
+// Attached spatial, channel and depletion models save their own sections.
+// A model whose section is missing or was saved for another grid restarts
+// from the loaded core, as after a rewind.
+namespace SV {
+    static constexpr uint32_t MAGIC = 0x56415352;  // "RSAV"
+    static constexpr uint16_t VERSION = 6;
+    static constexpr uint32_t STATE_VERSION = 1;
+
+    enum Section : uint32_t {
+        STATE = 1,      // Tagged StateSnapshot fields, RNG included
+        HISTORY = 2,    // StateHistory::serialize
+        JOURNAL = 3,    // Record count and CRC of the slot's journal copy
+        SPATIAL = 4,    // SpatialCore::saveState
+        CHANNELS = 5,   // SubchannelModel::saveState
+        DEPLETION = 6,  // DepletionCore::saveState
+        LOG = 7,        // Operator log entries, oldest first
+        SECTION_IDS
+    };
+}
+
+enum class LoadResult {
+    OK,
+    MISSING,
+    DAMAGED,       // Truncated, or a checksum does not match
+    INCOMPATIBLE   // Other schema version or state layout
+};
+
+// Summary read from a save header alone
+struct SaveSlotInfo {
+    LoadResult status;
+    Difficulty difficulty;
+    int turns;
+    int score;
+    int64_t savedAt;  // Unix time
+};
+
 class PersistenceSystem {
 public:
-    static bool saveGame(const ReactorState& state);
-    static bool loadGame(ReactorState& state);
-    static void deleteSave();
+    static bool saveGame(const ReactorState& state, int slot = 1);
+    static LoadResult loadGame(ReactorState& state, int slot = 1);
+    static SaveSlotInfo slotInfo(int slot);
+    static void deleteSave(int slot);
 
     static void loadHighScore(ReactorState& state);
     static void saveHighScore(const ReactorState& state);
@@ -9,55 +9,102 @@
 #include "scoring.h"
 #include "achievements.h"
 #include "persistence.h"
+#include "spatial.h"
+#include "subchannel.h"
+#include "depletion.h"
+#include "perf.h"
 
-#include <sstream>
 #include <algorithm>
 
+double CorePhysics::reactivity(const ReactorState& state) {
+    // The nodal solve already includes rods, xenon, fuel and Doppler feedback
+    if (state.spatial) return (state.spatial->keff() - 1.0) * PK::REACTIVITY_SCALE;
+
+    double k_eff = std::max(0.0, (1.05 - state.controlRods * 1.1) * poisonFactor(state) * state.fuel / 100.0);
+    return (k_eff - 1.0) * PK::REACTIVITY_SCALE
+         + (state.temperature - RC::INITIAL_TEMPERATURE) * PK::TEMPERATURE_COEFFICIENT;
+}
+
+double CorePhysics::poisonFactor(const ReactorState& state) {
+    double factor = 1.0 - (state.xenonLevel / RC::MAX_XENON) * 0.3;
+    if (state.depletion) factor *= state.depletion->samariumFactor();
+    return factor;
+}
+
 void CorePhysics::update(ReactorState& state) {
-    // Apply xenon poisoning effect on reactivity
-    double xenonFactor = 1.0 - (state.xenonLevel / RC::MAX_XENON) * 0.3;
+    if (state.spatial) {
+        PERF_SCOPE(SPATIAL);
+        state.spatial->update(state);
+    }
 
-    double k_eff = (1.05 - state.controlRods * 1.1) * xenonFactor;
-    k_eff = std::max(0.7, k_eff);
-    state.neutrons *= k_eff;
+    {
+        PERF_SCOPE(NEUTRONICS);
+        if (state.kinetics.enabled) {
+            PointKinetics::advance(state.kinetics, state.neutrons, reactivity(state), PK::TURN_SECONDS);
+            state.power = state.neutrons * RC::NEUTRON_TO_POWER_RATIO;
+        } else if (state.spatial) {
+            state.neutrons *= std::max(0.7, state.spatial->keff());
+            state.power = state.neutrons * RC::NEUTRON_TO_POWER_RATIO;
+        } else {
+            // Apply xenon poisoning effect on reactivity
+            double k_eff = (1.05 - state.controlRods * 1.1) * poisonFactor(state);
+            k_eff = std::max(0.7, k_eff);
+            state.neutrons *= k_eff;
 
-    state.power = state.neutrons * RC::NEUTRON_TO_POWER_RATIO;
+            state.power = state.neutrons * RC::NEUTRON_TO_POWER_RATIO;
 
-    double fuel_eff = state.fuel / 100.0;
-    state.neutrons *= fuel_eff;
-    state.fuel = std::max(0.0, state.fuel - state.currentDifficulty.fuelDepletionRate);
+            double fuel_eff = state.fuel / 100.0;
+            state.neutrons *= fuel_eff;
+        }
+    }
+    if (state.depletion) {
+        PERF_SCOPE(DEPLETION);
+        state.depletion->update(state);
+    } else if (!state.spatial || !state.spatial->depleting()) {
+        state.fuel = std::max(0.0, state.fuel - state.currentDifficulty.fuelDepletionRate);
+    }
 
-    state.temperature += state.power * RC::POWER_TO_HEAT_RATIO;
     state.coolant = std::max(0.0, state.coolant - state.currentDifficulty.coolantLossRate);
 
-    // Apply weather-modified cooling
-    WeatherInfo weatherInfo = getWeatherInfo(state.currentWeather);
-    double effectiveCooling = RC::NATURAL_COOLING_RATE * weatherInfo.coolingModifier;
-    state.temperature = std::max(0.0, state.temperature - effectiveCooling);
+    {
+        PERF_SCOPE(THERMAL);
+        if (state.channels) {
+            // Channel heat balance replaces the lumped heating and cooling; low
+            // coolant shows up there as lost pump flow
+            state.channels->update(state);
+        } else {
+            state.temperature += state.power * RC::POWER_TO_HEAT_RATIO;
 
-    if (state.coolant < RC::CRITICAL_COOLANT) {
-        {
-            std::ostringstream oss;
-            oss << Color::BG_RED << Color::WHITE << Color::BOLD
-                << "!!! WARNING: Coolant is critically low! !!!"
-                << Color::RESET << "\n";
-            state.addSoundMessage(oss.str());
+            // Apply weather-modified cooling
+            const WeatherInfo& weatherInfo = getWeatherInfo(state.currentWeather);
+            double effectiveCooling = RC::NATURAL_COOLING_RATE * weatherInfo.coolingModifier;
+            state.temperature = std::max(0.0, state.temperature - effectiveCooling);
         }
-        state.temperature += 5.0;
+    }
+
+    if (state.coolant < RC::CRITICAL_COOLANT) {
+        state.post(MessageCode::COOLANT_CRITICAL, Severity::CRITICAL);
+        if (!state.channels) state.temperature += 5.0;
     }
 
     // Update subsystems
-    XenonSystem::update(state);
-    TurbineSystem::update(state);
-    EmergencySystem::updateECCS(state);
-    EmergencySystem::updateDiesel(state);
-    RadiationSystem::update(state);
-    ContainmentSystem::update(state);
-    WeatherSystem::update(state);
-    GridSystem::update(state);
+    { PERF_SCOPE(XENON);       XenonSystem::update(state); }
+    { PERF_SCOPE(TURBINE);     TurbineSystem::update(state); }
+    {
+        PERF_SCOPE(EMERGENCY);
+        EmergencySystem::updateECCS(state);
+        EmergencySystem::updateDiesel(state);
+    }
+    { PERF_SCOPE(RADIATION);   RadiationSystem::update(state); }
+    { PERF_SCOPE(CONTAINMENT); ContainmentSystem::update(state); }
+    { PERF_SCOPE(WEATHER);     WeatherSystem::update(state); }
+    { PERF_SCOPE(GRID);        GridSystem::update(state); }
 
     // Update statistics
-    ScoringSystem::update(state);
+    {
+        PERF_SCOPE(SCORING);
+        ScoringSystem::update(state);
+    }
 
     // Update score with difficulty multiplier
     state.turns++;
@@ -67,7 +114,8 @@ void CorePhysics::update(ReactorState& state) {
     state.score += static_cast<int>(state.electricityOutput / 100.0 * RC::POINTS_PER_MW * state.currentDifficulty.scoreMultiplier);
 
     // Check achievements
-    if (AchievementSystem::check(state)) {
+    PERF_SCOPE(ACHIEVEMENTS);
+    if (AchievementSystem::check(state) && !state.headless) {
         PersistenceSystem::saveAchievements(state);
     }
 }
@@ -5,4 +5,12 @@
 class CorePhysics {
 public:
     static void update(ReactorState& state);
+
+    // Point-kinetics reactivity (dk/k) from rods, xenon, fuel and temperature,
+    // or from the spatial solve's k_eff when that model is on
+    static double reactivity(const ReactorState& state);
+
+    // k multiplier from fission-product poisons: xenon, plus samarium when
+    // the depletion chain tracks it
+    static double poisonFactor(const ReactorState& state);
 };
@@ -0,0 +1,62 @@
+#include "policy.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+ScriptedPolicy::ScriptedPolicy()
+    : nextStep(0), autoReset(true), turbine(true), refillBelow(0.0) {}
+
+void ScriptedPolicy::addStep(int turn, double controlRods) {
+    Step step{turn, std::max(0.0, std::min(1.0, controlRods))};
+    auto pos = std::upper_bound(steps.begin(), steps.end(), step,
+        [](const Step& a, const Step& b) { return a.turn < b.turn; });
+    steps.insert(pos, step);
+    nextStep = 0;
+}
+
+void ScriptedPolicy::act(ReactorState& state) {
+    // Rods are re-applied every turn so a SCRAM's full insertion is undone on restart
+    while (nextStep < steps.size() && steps[nextStep].turn <= state.turns) {
+        ++nextStep;
+    }
+    if (nextStep > 0) {
+        state.controlRods = steps[nextStep - 1].controlRods;
+    }
+
+    if (turbine && !state.turbineOnline) {
+        state.turbineOnline = true;
+    }
+
+    // Same effect as the interactive 'r' command
+    if (state.coolant < refillBelow) {
+        state.coolant = RC::INITIAL_COOLANT;
+        state.score = std::max(0, state.score - RC::REFILL_PENALTY);
+        state.addLogEntry(LogType::ACTION, LogCode::COOLANT_REFILLED);
+    }
+}
+
+bool ScriptedPolicy::resetAfterScram(const ReactorState&) {
+    return autoReset;
+}
+
+bool ScriptedPolicy::parse(const std::string& spec, ScriptedPolicy& policy) {
+    std::istringstream stream(spec);
+    std::string item;
+    bool any = false;
+    while (std::getline(stream, item, ',')) {
+        size_t colon = item.find(':');
+        try {
+            if (colon == std::string::npos) {
+                policy.addStep(0, std::stod(item) / 100.0);
+            } else {
+                policy.addStep(std::stoi(item.substr(0, colon)),
+                               std::stod(item.substr(colon + 1)) / 100.0);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        any = true;
+    }
+    return any;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "reactor_state.h"
+
+#include <string>
+#include <vector>
+
+// Operator policies drive the reactor without a human at the keyboard
+class OperatorPolicy {
+public:
+    virtual ~OperatorPolicy() {}
+
+    // Called before every turn; may set control rods or take operator actions
+    virtual void act(ReactorState& state) = 0;
+
+    // Called after an automatic SCRAM; returns true to restart the reactor
+    virtual bool resetAfterScram(const ReactorState& state) = 0;
+};
+
+// Piecewise-constant rod schedule: each step holds from its turn onward
+class ScriptedPolicy : public OperatorPolicy {
+public:
+    struct Step {
+        int turn;
+        double controlRods;  // 0.0 - 1.0
+    };
+
+    ScriptedPolicy();
+
+    void act(ReactorState& state) override;
+    bool resetAfterScram(const ReactorState& state) override;
+
+    void addStep(int turn, double controlRods);
+    void setAutoReset(bool enabled) { autoReset = enabled; }
+    void setTurbine(bool enabled) { turbine = enabled; }
+    void setRefillThreshold(double coolant) { refillBelow = coolant; }
+
+    size_t stepCount() const { return steps.size(); }
+    const Step& step(size_t i) const { return steps[i]; }
+    bool autoResetEnabled() const { return autoReset; }
+    bool turbineEnabled() const { return turbine; }
+    double refillThreshold() const { return refillBelow; }
+
+    // Parse "turn:rods%,turn:rods%" (e.g. "0:5,200:8"); returns false on bad input
+    static bool parse(const std::string& spec, ScriptedPolicy& policy);
+
+private:
+    std::vector<Step> steps;
+    size_t nextStep;
+    bool autoReset;
+    bool turbine;
+    double refillBelow;
+};
@@ -0,0 +1,196 @@
+#include "quantiles.h"
+#include "reactor_state.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+QuantileSketch::QuantileSketch() {
+    clear();
+}
+
+void QuantileSketch::clear() {
+    levelCount = 0;
+    levels[0] = CAPACITY;
+    addLevel();
+    n = 0;
+    lo = hi = 0.0;
+    coin = 0x9e3779b97f4a7c15ull;
+}
+
+void QuantileSketch::addLevel() {
+    levels[levelCount + 1] = CAPACITY;
+    levelCount++;
+    limit = 0;
+    for (int h = 0; h < levelCount; ++h) {
+        double width = std::ceil(QS::K * std::pow(2.0 / 3.0, levelCount - 1 - h));
+        widths[h] = std::max(QS::MIN_WIDTH, static_cast<int>(width));
+        limit += widths[h];
+    }
+}
+
+void QuantileSketch::add(double value) {
+    if (n == 0 || value < lo) lo = value;
+    if (n == 0 || value > hi) hi = value;
+    n++;
+    if (retained() >= limit) compress();
+    items[--levels[0]] = value;
+}
+
+void QuantileSketch::compress() {
+    // Over the total capacity, some level is over its own; the top one only
+    // when none below is
+    int h = 0;
+    while (h < levelCount - 1 && levels[h + 1] - levels[h] < widths[h]) h++;
+    // At QS::MAX_LEVELS the top level halves in place
+    if (h == levelCount - 1 && levelCount < QS::MAX_LEVELS) addLevel();
+
+    // Levels above 0 are kept sorted, so only new values need a sort
+    int a = levels[h], b = levels[h + 1];
+    if (h == 0) std::sort(items + a, items + b);
+    int odd = (b - a) & 1;
+    int half = (b - a - odd) / 2;
+    coin ^= coin << 13;
+    coin ^= coin >> 7;
+    coin ^= coin << 17;
+    int start = a + odd + static_cast<int>(coin & 1);
+
+    // Every other value goes to the bottom of the level above, and an odd one
+    // out stays below them; each write lands at or above its source
+    for (int j = half - 1; j >= 0; --j) items[b - half + j] = items[start + 2 * j];
+    if (odd) items[b - half - 1] = items[a];
+    if (h + 1 < levelCount) {
+        // Merge the promoted run into the level above, front to back
+        double promoted[CAPACITY / 2];
+        std::copy(items + b - half, items + b, promoted);
+        int end = levels[h + 2];
+        int out = b - half, i = 0, j = b;
+        while (i < half && j < end) {
+            bool first = promoted[i] <= items[j];
+            items[out++] = first ? promoted[i] : items[j];
+            i += first;
+            j += !first;
+        }
+        while (i < half) items[out++] = promoted[i++];
+        levels[h + 1] = b - half;
+    }
+
+    // Close the gap by moving the lower levels up
+    std::memmove(items + levels[0] + half, items + levels[0], sizeof(double) * (a - levels[0]));
+    for (int i = 0; i <= h; ++i) levels[i] += half;
+}
+
+void QuantileSketch::insert(int level, double value) {
+    while (level >= levelCount) addLevel();
+    if (retained() >= limit) compress();
+    std::memmove(items + levels[0] - 1, items + levels[0], sizeof(double) * (levels[level] - levels[0]));
+    for (int i = 0; i <= level; ++i) levels[i]--;
+    int i = levels[level];
+    items[i] = value;
+    if (level == 0) return;
+    for (; i + 1 < levels[level + 1] && items[i + 1] < value; ++i) std::swap(items[i], items[i + 1]);
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.n == 0) return;
+    for (int h = 0; h < other.levelCount; ++h) {
+        for (int i = other.levels[h]; i < other.levels[h + 1]; ++i) insert(h, other.items[i]);
+    }
+    lo = n == 0 ? other.lo : std::min(lo, other.lo);
+    hi = n == 0 ? other.hi : std::max(hi, other.hi);
+    n += other.n;
+}
+
+void QuantileSketch::quantiles(const double* ranks, double* values, int count) const {
+    if (n == 0) {
+        std::fill(values, values + count, 0.0);
+        return;
+    }
+    std::pair<double, uint64_t> weighted[CAPACITY];
+    int size = 0;
+    uint64_t total = 0;
+    for (int h = 0; h < levelCount; ++h) {
+        for (int i = levels[h]; i < levels[h + 1]; ++i) {
+            weighted[size++] = std::make_pair(items[i], uint64_t(1) << h);
+            total += uint64_t(1) << h;
+        }
+    }
+    std::sort(weighted, weighted + size);
+
+    for (int k = 0; k < count; ++k) {
+        double target = std::min(1.0, std::max(0.0, ranks[k])) * static_cast<double>(total);
+        uint64_t seen = 0;
+        int i = 0;
+        while (i < size - 1 && static_cast<double>(seen + weighted[i].second) < target) seen += weighted[i++].second;
+        values[k] = ranks[k] <= 0.0 ? lo : ranks[k] >= 1.0 ? hi : weighted[i].first;
+    }
+}
+
+double QuantileSketch::quantile(double q) const {
+    double value;
+    quantiles(&q, &value, 1);
+    return value;
+}
+
+const DistributionInfo& getDistributionInfo(Distribution series) {
+    static const DistributionInfo table[] = {
+        {"Temp",       "temp",        "> 90% SCRAM"},
+        {"Radiation",  "radiation",   "> 20 mSv/h"},
+        {"Pressure",   "pressure",    "> 130 bar"},
+        {"Grid",       "grid",        "< 50%"},
+        {"Score/turn", "score_delta", "< 0"},
+    };
+    static_assert(sizeof(table) / sizeof(table[0]) == static_cast<size_t>(Distribution::DISTRIBUTION_COUNT),
+                  "one DistributionInfo per series");
+    return table[static_cast<int>(series)];
+}
+
+TurnDistributions::TurnDistributions() : lastTurn(-1), lastScore(0) {
+    std::fill(std::begin(past), std::end(past), 0L);
+}
+
+void TurnDistributions::record(const ReactorState& state) {
+    const double values[SERIES] = {
+        state.temperature,
+        state.radiationLevel,
+        state.steamPressure,
+        state.demandSatisfaction,
+        static_cast<double>(state.score - lastScore),
+    };
+    const bool beyond[SERIES] = {
+        state.temperature > state.currentDifficulty.scramTemperature * 0.9,
+        state.radiationLevel > RC::MAX_SAFE_RADIATION,
+        state.steamPressure > RC::CRITICAL_PRESSURE,
+        state.demandSatisfaction < 50.0,
+        state.score < lastScore,
+    };
+    int score = static_cast<int>(Distribution::SCORE_DELTA);
+    bool consecutive = state.turns == lastTurn + 1;
+    for (int i = 0; i < SERIES; ++i) {
+        if (i == score && !consecutive) continue;
+        sketches[i].add(values[i]);
+        if (beyond[i]) past[i]++;
+    }
+    lastTurn = state.turns;
+    lastScore = state.score;
+}
+
+void TurnDistributions::merge(const TurnDistributions& other) {
+    for (int i = 0; i < SERIES; ++i) {
+        sketches[i].merge(other.sketches[i]);
+        past[i] += other.past[i];
+    }
+}
+
+void TurnDistributions::clear() {
+    for (QuantileSketch& sketch : sketches) sketch.clear();
+    std::fill(std::begin(past), std::end(past), 0L);
+    lastTurn = -1;
+    lastScore = 0;
+}
+
+double TurnDistributions::pastShare(Distribution series) const {
+    long turns = sketch(series).count();
+    return turns > 0 ? static_cast<double>(pastLimit(series)) / turns : 0.0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+struct ReactorState;
+
+// KLL quantile sketch (Karnin, Lang and Liberty). Level h holds values that
+// each stand for 2^h of the values added. When the sketch is full, the
+// lowest level over its capacity is sorted and every other value, from a
+// random start, moves up a level; capacities shrink by 2/3 per level below
+// the top. With QS::K = 200 a quantile is within about 1.7% of its true rank
+// (99% confidence), whatever the number of values. All levels share one
+// fixed array, lowest level first, so adding never allocates; sketches merge
+// level by level.
+namespace QS {
+    static constexpr int K = 200;          // Capacity of the top level
+    static constexpr int MIN_WIDTH = 8;    // Capacity floor of the levels below
+    static constexpr int MAX_LEVELS = 56;  // Enough for as many values as a long counts
+}
+
+class QuantileSketch {
+public:
+    QuantileSketch();
+
+    void add(double value);
+    void merge(const QuantileSketch& other);
+    void clear();
+
+    long count() const { return n; }
+    double min() const { return lo; }
+    double max() const { return hi; }
+    // Value at rank q (0-1); 0 when empty
+    double quantile(double q) const;
+    // Several ranks with one sort
+    void quantiles(const double* ranks, double* values, int count) const;
+    int retained() const { return CAPACITY - levels[0]; }
+
+private:
+    static constexpr int CAPACITY = 3 * QS::K + (QS::MIN_WIDTH + 1) * QS::MAX_LEVELS;
+
+    // Level h is items[levels[h], levels[h + 1]); the free space is below level 0
+    double items[CAPACITY];
+    int levels[QS::MAX_LEVELS + 1];
+    int levelCount;
+    int widths[QS::MAX_LEVELS];  // Capacity of each level, set as levels are added
+    int limit;                   // Their total
+    long n;
+    double lo;
+    double hi;
+    uint64_t coin;
+
+    void addLevel();
+    // Halve the lowest level over its capacity into the one above
+    void compress();
+    void insert(int level, double value);
+};
+
+// The per-turn readings the statistics report as distributions
+enum class Distribution {
+    TEMPERATURE,
+    RADIATION,
+    STEAM_PRESSURE,
+    SATISFACTION,
+    SCORE_DELTA,  // Points gained in a turn
+    DISTRIBUTION_COUNT
+};
+
+struct DistributionInfo {
+    const char* name;
+    const char* key;    // Prefix of its keys in the headless summary
+    const char* limit;  // The reading counted as past its limit
+};
+
+const DistributionInfo& getDistributionInfo(Distribution series);
+
+// Sketches of every turn's readings, fed by ScoringSystem::update, with the
+// turns past each reading's limit. Turns later rewound stay counted.
+class TurnDistributions {
+public:
+    TurnDistributions();
+
+    void record(const ReactorState& state);
+    void merge(const TurnDistributions& other);
+    void clear();
+
+    const QuantileSketch& sketch(Distribution series) const { return sketches[static_cast<int>(series)]; }
+    long pastLimit(Distribution series) const { return past[static_cast<int>(series)]; }
+    // Share of the recorded turns past the limit, 0-1
+    double pastShare(Distribution series) const;
+
+private:
+    static constexpr int SERIES = static_cast<int>(Distribution::DISTRIBUTION_COUNT);
+
+    QuantileSketch sketches[SERIES];
+    long past[SERIES];
+    // The score delta needs consecutive turns: a new run, rewind or load starts over
+    int lastTurn;
+    int lastScore;
+};
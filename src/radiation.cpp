@@ -1,7 +1,5 @@
 #include "radiation.h"
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
 void RadiationSystem::update(ReactorState& state) {
@@ -32,27 +30,16 @@ void RadiationSystem::update(ReactorState& state) {
 
     // Radiation warnings
     if (state.radiationLevel > RC::DANGER_RADIATION) {
-        std::ostringstream oss;
-        oss << Color::BG_RED << Color::WHITE << Color::BOLD
-            << " \xe2\x98\xa2 RADIATION CRITICAL: " << std::fixed << std::setprecision(1) << state.radiationLevel << " mSv/h - EVACUATE! "
-            << Color::RESET << "\n";
-        state.addAlertMessage(oss.str());
+        state.post(MessageCode::RADIATION_CRITICAL, Severity::ALARM, state.radiationLevel);
         state.radiationAlarms++;
-        state.addLogEntry("CRITICAL", "Radiation level critical - evacuation recommended");
+        state.addLogEntry(LogType::CRITICAL, LogCode::RADIATION_CRITICAL);
     } else if (state.radiationLevel > RC::WARNING_RADIATION) {
-        std::ostringstream oss;
-        oss << Color::RED << Color::BOLD
-            << "\xe2\x98\xa2 HIGH RADIATION: " << std::fixed << std::setprecision(1) << state.radiationLevel << " mSv/h"
-            << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::RADIATION_HIGH, Severity::WARNING, state.radiationLevel);
         if (state.radiationAlarms % 5 == 0) {  // Don't spam
-            state.addLogEntry("WARNING", "Elevated radiation levels detected");
+            state.addLogEntry(LogType::WARNING, LogCode::RADIATION_ELEVATED);
         }
         state.radiationAlarms++;
     } else if (state.radiationLevel > RC::MAX_SAFE_RADIATION) {
-        std::ostringstream oss;
-        oss << Color::YELLOW << "\xe2\x9a\xa0 Elevated radiation: "
-            << std::fixed << std::setprecision(1) << state.radiationLevel << " mSv/h" << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::RADIATION_ELEVATED, Severity::WARNING, state.radiationLevel);
     }
 }
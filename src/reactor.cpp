@@ -3,43 +3,214 @@
 #include "input.h"
 #include "physics.h"
 #include "events.h"
+#include "event_catalog.h"
 #include "safety.h"
 #include "persistence.h"
+#include "perf.h"
+#include "terminal.h"
+#include "render_thread.h"
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 
-ReactorSimulator::ReactorSimulator(Difficulty diff)
+ReactorSimulator::ReactorSimulator(Difficulty diff, uint64_t seed, const ModelOptions& models)
     : state(diff)
 {
+    state.reseed(seed);
+    this->models.attach(state, models);
     PersistenceSystem::loadHighScore(state);
     PersistenceSystem::loadAchievements(state);
+    if (journal.create(RC::JOURNAL_FILE, EventCatalog::active().checksum())) state.journal = &journal;
+    state.history = &history;
+    state.trends = &trends;
+    state.distributions = &distributions;
+    if (Autopilot::supports(state)) state.autopilot = &autopilot;
+}
+
+bool ReactorSimulator::record(const std::string& path, const ModelOptions& models) {
+    return recorder.open(path, state, models);
+}
+
+bool ReactorSimulator::publishTelemetry(const std::string& name, uint32_t* owner) {
+    return telemetry.open(name, owner);
 }
 
 void ReactorSimulator::run() {
-    Renderer::displayBanner(state);
+    start();
 
+    std::string line;
     while (state.running) {
-        Renderer::displayDashboard(state);
-        Renderer::displayScore(state);
-        Renderer::displayStatus(state);
-        Renderer::displayContextualTip(state);
+        drawFrame(nullptr);
 
-        InputResult result = InputHandler::handleInput(state);
+        if (!InputHandler::readCommand(state, line)) break;
+        Perf::frameCompleted();
+        recorder.command(line);
+        InputResult result;
+        {
+            PERF_SCOPE(INPUT);
+            result = InputHandler::execute(state, line);
+        }
 
         if (result == InputResult::QUIT) break;
-        if (result == InputResult::CONTINUE) continue;
+        if (result == InputResult::RESTORED) {
+            recorder.resync(state);
+            trends.record(state);
+        }
+        if (result != InputResult::ADVANCE_TURN) continue;
 
         // ADVANCE_TURN
+        simulateTurn();
+        if (!state.running) {
+            std::string reply;
+            if (!SafetySystem::promptScramReset(reply)) break;
+            recorder.command(reply);
+            if (!SafetySystem::handleScramReset(state, reply)) break;
+        }
+        finishTurn();
+    }
+
+    finish();
+}
+
+bool ReactorSimulator::runRealtime(int hz, int fps, bool renderThread) {
+    TickLoop loop;
+    if (!loop.start(hz)) return false;
+    start();
+    if (fps <= 0) fps = Terminal::active() ? 10 : 1;
+    std::cout << Color::DIM << "Real-time mode: " << hz << " turns per second. Type a command and press Enter."
+              << Color::RESET << "\n";
+
+    // On its own thread the renderer paces itself and the loop only publishes
+    RenderThread display;
+    if (renderThread) display.start(fps);
+
+    const auto framePeriod = std::chrono::microseconds(1000000 / fps);
+    auto nextFrame = std::chrono::steady_clock::now();
+    bool dirty = true;
+    bool awaitingReset = false;
+    bool quit = false;
+    std::string line;
+    while (!quit) {
+        int timeoutMs = -1;
+        if (renderThread) {
+            if (dirty) display.publish(state, loop.stats());
+            dirty = false;
+        } else {
+            auto now = std::chrono::steady_clock::now();
+            if (dirty && now >= nextFrame) {
+                drawFrame(&loop.stats());
+                Perf::frameCompleted();
+                nextFrame = now + framePeriod;
+                dirty = false;
+            }
+            if (dirty) {
+                auto left = std::chrono::duration_cast<std::chrono::microseconds>(nextFrame - now).count();
+                timeoutMs = static_cast<int>(std::max<long long>(0, (left + 999) / 1000));
+            }
+        }
+        loop.wait(timeoutMs);
+
+        // Commands apply as they arrive; turns advance only with the clock
+        while (!quit && loop.readLine(line)) {
+            dirty = true;
+            if (awaitingReset) {
+                quit = !SafetySystem::handleScramReset(state, line);
+                awaitingReset = false;
+                if (!quit) finishTurn();
+                continue;
+            }
+            bool screen = InputHandler::isScreen(line);
+            if (screen && renderThread) display.hold();
+            InputResult result;
+            {
+                PERF_SCOPE(INPUT);
+                result = InputHandler::execute(state, line);
+            }
+            if (result == InputResult::QUIT) quit = true;
+            if (result == InputResult::RESTORED) trends.record(state);
+            if (screen) {
+                if (renderThread) display.release();
+                loop.skipPassed();
+                loop.takeBufferedInput();
+            }
+        }
+        if (quit || loop.inputClosed()) break;
+
+        if (state.paused || awaitingReset) {
+            // A held clock has no deadlines to miss
+            loop.skipPassed();
+        } else if (loop.tickDue()) {
+            simulateTurn();
+            if (state.running) {
+                finishTurn();
+            } else {
+                SafetySystem::printScramPrompt();
+                std::cout.flush();
+                awaitingReset = true;
+            }
+            dirty = true;
+        }
+    }
+
+    if (renderThread) {
+        display.publish(state, loop.stats());
+        display.stop();
+    }
+    finish();
+    Renderer::displayClockSummary(loop.stats());
+    return true;
+}
+
+void ReactorSimulator::start() {
+    Perf::countOutput(std::cout);
+    Renderer::displayBanner(state);
+    Terminal::enter();
+    history.record(state);
+    trends.record(state);
+    telemetry.publish(state);
+}
+
+void ReactorSimulator::drawFrame(const TickStats* clock) {
+    {
+        PERF_SCOPE(RENDER);
+        Terminal::beginFrame();
+        Renderer::displayDashboard(state);
+        Renderer::displayScore(state);
+        Renderer::displayStatus(state);
+        if (clock) Renderer::displayClock(*clock);
+        Renderer::displayContextualTip(state);
+    }
+    {
+        PERF_SCOPE(PRESENT);
+        Terminal::endFrame();
+    }
+}
+
+void ReactorSimulator::simulateTurn() {
+    Autopilot::steer(state);
+    {
+        PERF_SCOPE(TURN);
         CorePhysics::update(state);
         RandomEventSystem::process(state);
         SafetySystem::check(state);
-        Renderer::drainMessages(state);
-
-        if (!state.running && !SafetySystem::handleScramReset(state)) {
-            break;
-        }
     }
+    Perf::turnCompleted(state.messages.size());
+    Renderer::drainMessages(state);
+    telemetry.publish(state);
+}
+
+void ReactorSimulator::finishTurn() {
+    history.record(state);
+    trends.record(state);
+    recorder.turnCompleted(state);
+    if (state.autosave) PersistenceSystem::saveGame(state, RC::AUTOSAVE_SLOT);
+}
 
+void ReactorSimulator::finish() {
+    journal.flush();
+    recorder.close(state);
+    Terminal::leave();
     PersistenceSystem::saveHighScore(state);
     // Update highScore in state so displayFinalScore shows the correct value
     if (state.score > state.highScore) {
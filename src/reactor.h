@@ -1,12 +1,49 @@
 #pragma once
 
 #include "reactor_state.h"
+#include "models.h"
+#include "history.h"
+#include "trends.h"
+#include "quantiles.h"
+#include "autopilot.h"
+#include "replay.h"
+#include "realtime.h"
+#include "telemetry.h"
+
+#include <string>
+#include <cstdint>
 
 class ReactorSimulator {
 public:
-    explicit ReactorSimulator(Difficulty diff);
+    ReactorSimulator(Difficulty diff, uint64_t seed, const ModelOptions& models);
+    // Record the session to `path` for --replay; call before run()
+    bool record(const std::string& path, const ModelOptions& models);
+    // Publish every turn to the shared-memory segment `name`; call before run().
+    // See TelemetryPublisher::open for `owner`.
+    bool publishTelemetry(const std::string& name, uint32_t* owner = nullptr);
     void run();
+    // Advance `hz` turns per second, applying commands as they arrive and
+    // drawing at most `fps` frames per second (0: 10 on a terminal, else 1),
+    // on a render thread unless `renderThread` is false. False where the
+    // platform has no poll().
+    bool runRealtime(int hz, int fps, bool renderThread);
 
 private:
     ReactorState state;
+    CoreModels models;
+    Journal journal;
+    StateHistory history;
+    TrendHistory trends;
+    TurnDistributions distributions;
+    Autopilot autopilot;
+    SessionRecorder recorder;
+    TelemetryPublisher telemetry;
+
+    void start();
+    void drawFrame(const TickStats* clock);
+    // Autopilot, physics, events and safety, then the turn's messages
+    void simulateTurn();
+    // History, trends, recording and autosave once a turn stands (after any SCRAM reset)
+    void finishTurn();
+    void finish();
 };
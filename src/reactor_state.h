@@ -2,31 +2,52 @@
 
 #include "types.h"
 #include "constants.h"
+#include "rng.h"
+#include "kinetics.h"
+#include "ring_buffer.h"
+#include "journal.h"
 
 #include <vector>
-#include <set>
 #include <string>
 #include <random>
 #include <chrono>
+#include <cstdint>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <iterator>
 
+// Queued event: plain data, formatted only when a sink drains the queue
+// (Renderer::drainMessages), so headless runs pay a few stores per event
 struct GameMessage {
-    std::string text;  // Pre-formatted with ANSI codes
-    bool triggerSound;
-    bool triggerAlert;
-
-    GameMessage(const std::string& t, bool sound = false, bool alert = false)
-        : text(t), triggerSound(sound), triggerAlert(alert) {}
+    MessageCode code;
+    Severity severity;
+    int turn;
+    int detail;    // Integer payload (counts, enum values)
+    double value;  // Numeric payload
 };
 
-struct LogEntry {
-    int turn;
-    std::string type;   // ACTION, EVENT, WARNING, CRITICAL
-    std::string message;
+// Optional higher-fidelity models selected on the command line
+struct ModelOptions {
+    bool kinetics;  // Point kinetics with delayed neutrons
+    int spatialNx;  // Spatial diffusion grid; 0 = single-node core
+    int spatialNy;
+    int spatialNz;
+    int channels;   // Subchannel thermal-hydraulics; 0 = lumped core temperature
+    bool depletion; // CRAM nuclide chain instead of linear fuel/xenon bookkeeping
+
+    ModelOptions() : kinetics(false), spatialNx(0), spatialNy(0), spatialNz(0), channels(0),
+                     depletion(false) {}
 };
 
+class SpatialCore;
+class SubchannelModel;
+class DepletionCore;
+class StateHistory;
+class TrendHistory;
+class TurnDistributions;
+class Autopilot;
+
 struct ReactorState {
     // Difficulty
     DifficultySettings currentDifficulty;
@@ -40,6 +61,19 @@ struct ReactorState {
     double fuel;
     bool running;
 
+    // Point-kinetics model; when disabled the one-multiplier-per-turn core is used
+    KineticsState kinetics;
+
+    // Nodal diffusion model, owned by whoever runs the simulation; null when off
+    SpatialCore* spatial;
+
+    // Coolant channel model, owned like spatial; null when off
+    SubchannelModel* channels;
+
+    // Single-node nuclide depletion, owned like spatial; null when off or when
+    // the spatial core depletes per node
+    DepletionCore* depletion;
+
     // Xenon poisoning
     double xenonLevel;
     int xenonHandledCount;
@@ -114,22 +148,41 @@ struct ReactorState {
     double lowestCoolant;
     double highestXenon;
 
-    // Operator event log
-    std::vector<LogEntry> operatorLog;
+    // Operator event log, oldest entries overwritten; the journal (interactive
+    // play only) keeps everything
+    RingBuffer<LogEntry, RC::MAX_LOG_ENTRIES> operatorLog;
+    uint64_t loggedEntries;  // Ever added to operatorLog
+    Journal* journal;
+
+    // Per-turn snapshots for rewind (interactive play only); null when off
+    StateHistory* history;
 
     // Achievements
-    std::set<Achievement> unlockedAchievements;
-    std::set<Achievement> sessionAchievements;
+    AchievementSet unlockedAchievements;
+    AchievementSet sessionAchievements;
 
-    // Modern random number generation
-    std::mt19937 rng;
+    // Counter-based random streams keyed by (seed, runId, turn, stream)
+    RngState rng;
 
     // Sound/UI flags
     bool soundEnabled;
+    bool autosave;  // Save to RC::AUTOSAVE_SLOT after every turn
     bool paused;
+    bool headless;  // Batch runs: no terminal output or save files
+    bool autoRods;  // The autopilot sets the rods each turn (the `auto` command)
 
     // Message queue — subsystems push here, renderer drains
-    std::vector<GameMessage> messages;
+    RingBuffer<GameMessage, RC::MESSAGE_QUEUE_CAPACITY> messages;
+
+    // Per-turn readings for the trend displays (interactive play only); null
+    // when off. After the queue, so snapshots and saves do not include it.
+    TrendHistory* trends;
+
+    // Quantile sketches of every turn's readings, owned like trends; null when off
+    TurnDistributions* distributions;
+
+    // Rod controller for auto mode, owned like trends; null when unavailable
+    Autopilot* autopilot;
 
     // Constructor
     ReactorState(Difficulty diff)
@@ -141,6 +194,10 @@ struct ReactorState {
           power(0.0),
           fuel(RC::INITIAL_FUEL),
           running(true),
+          kinetics(),
+          spatial(nullptr),
+          channels(nullptr),
+          depletion(nullptr),
           xenonLevel(0.0),
           xenonHandledCount(0),
           turbineRPM(0.0),
@@ -191,33 +248,58 @@ struct ReactorState {
           criticalEvents(0),
           lowestCoolant(RC::INITIAL_COOLANT),
           highestXenon(0.0),
-          rng(std::chrono::steady_clock::now().time_since_epoch().count()),
+          loggedEntries(0),
+          journal(nullptr),
+          history(nullptr),
+          rng(),
           soundEnabled(true),
-          paused(false) {}
+          autosave(false),
+          paused(false),
+          headless(false),
+          autoRods(false),
+          trends(nullptr),
+          distributions(nullptr),
+          autopilot(nullptr) {
+        reseed(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    }
 
-    // Message helpers
-    void addMessage(const std::string& text) {
-        messages.emplace_back(text);
+    // Select the random sequence for this simulation; runId separates ensemble runs
+    void reseed(uint64_t seed, uint32_t runId = 0) {
+        rng.seed = seed;
+        rng.runId = runId;
+        rng.turn = turns;
+        std::fill(std::begin(rng.draws), std::end(rng.draws), 0u);
     }
 
-    void addSoundMessage(const std::string& text) {
-        messages.emplace_back(text, true, false);
+    // Generator for one subsystem's draws this turn; counters restart each turn
+    CounterRng rngStream(RngStream stream) {
+        if (rng.turn != turns) {
+            rng.turn = turns;
+            std::fill(std::begin(rng.draws), std::end(rng.draws), 0u);
+        }
+        return CounterRng(rng.seed, rng.runId, static_cast<uint32_t>(turns), stream,
+                          &rng.draws[static_cast<int>(stream)]);
+    }
+
+    // Switch on the optional models, starting them from the current core state
+    void enableModels(const ModelOptions& models) {
+        if (models.kinetics) PointKinetics::reset(kinetics, neutrons);
     }
 
-    void addAlertMessage(const std::string& text) {
-        messages.emplace_back(text, false, true);
+    // Queue an event for the renderer
+    void post(MessageCode code, Severity severity, double value = 0.0, int detail = 0) {
+        messages.push(GameMessage{code, severity, turns, detail, value});
     }
 
     void clearMessages() {
         messages.clear();
     }
 
-    // Log helper
-    void addLogEntry(const std::string& type, const std::string& message) {
-        LogEntry entry{turns, type, message};
-        operatorLog.push_back(entry);
-        if (static_cast<int>(operatorLog.size()) > RC::MAX_LOG_ENTRIES) {
-            operatorLog.erase(operatorLog.begin());
-        }
+    // Log helper; entries also go to the journal when one is attached
+    void addLogEntry(LogType type, LogCode code, double payload = 0.0) {
+        LogEntry& entry = operatorLog.push();
+        entry = LogEntry{turns, type, 0, code, payload};
+        loggedEntries++;
+        if (journal) journal->append(entry);
     }
 };
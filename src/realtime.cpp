@@ -0,0 +1,157 @@
+#include "realtime.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+void TickStats::record(double lateUs) {
+    ticks++;
+    totalLateness += lateUs;
+    maxLateness = std::max(maxLateness, lateUs);
+    // Bucket 0 is under 1 us, bucket b >= 1 is [2^(b-1), 2^b) us
+    int bucket = lateUs < 1.0 ? 0 : std::min(BUCKETS - 1, 1 + static_cast<int>(std::log2(lateUs)));
+    lateness[bucket]++;
+}
+
+double TickStats::latenessPercentile(double q) const {
+    if (ticks == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(q * (ticks - 1));
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += lateness[b];
+        if (seen > rank) return std::min(std::ldexp(1.0, b), maxLateness);
+    }
+    return maxLateness;
+}
+
+TickLoop::TickLoop() : timerFd(-1), period(0), deadlines(0), closed(false), tickStats() {}
+
+TickLoop::~TickLoop() {
+#ifdef __linux__
+    if (timerFd >= 0) close(timerFd);
+#endif
+}
+
+bool TickLoop::start(int hz) {
+#ifdef _WIN32
+    (void)hz;
+    return false;
+#else
+    period = std::chrono::nanoseconds(1000000000LL / hz);
+    tickStats = TickStats();
+    tickStats.hz = hz;
+    deadlines = 0;
+    started = std::chrono::steady_clock::now();
+#ifdef __linux__
+    // Fires on the same CLOCK_MONOTONIC as steady_clock, from just after `started`
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd >= 0) {
+        itimerspec spec;
+        spec.it_interval.tv_sec = static_cast<time_t>(period.count() / 1000000000LL);
+        spec.it_interval.tv_nsec = static_cast<long>(period.count() % 1000000000LL);
+        spec.it_value = spec.it_interval;
+        if (timerfd_settime(timerFd, 0, &spec, nullptr) != 0) {
+            close(timerFd);
+            timerFd = -1;
+        }
+    }
+#endif
+    takeBufferedInput();
+    return true;
+#endif
+}
+
+uint64_t TickLoop::deadlinesPassed() const {
+    return static_cast<uint64_t>((std::chrono::steady_clock::now() - started) / period);
+}
+
+void TickLoop::wait(int timeoutMs) {
+#ifdef _WIN32
+    (void)timeoutMs;
+#else
+    pollfd fds[2];
+    nfds_t count = 0;
+    if (!closed) fds[count++] = pollfd{STDIN_FILENO, POLLIN, 0};
+    if (timerFd >= 0) {
+        fds[count++] = pollfd{timerFd, POLLIN, 0};
+    } else {
+        // No timer descriptor: sleep until the next deadline, rounded up
+        auto next = started + period * static_cast<std::chrono::nanoseconds::rep>(deadlines + 1);
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>(next - std::chrono::steady_clock::now());
+        int ms = static_cast<int>(std::max<long long>(0, (left.count() + 999) / 1000));
+        timeoutMs = timeoutMs < 0 ? ms : std::min(timeoutMs, ms);
+    }
+
+    if (poll(fds, count, timeoutMs) <= 0) return;
+    if (!closed && (fds[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+        char buffer[4096];
+        ssize_t got = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (got > 0) {
+            pending.append(buffer, static_cast<size_t>(got));
+        } else if (got == 0 || (errno != EINTR && errno != EAGAIN)) {
+            closed = true;
+        }
+    }
+#endif
+}
+
+bool TickLoop::tickDue() {
+#ifdef __linux__
+    if (timerFd >= 0) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+    }
+#endif
+    uint64_t passed = deadlinesPassed();
+    if (passed <= deadlines) return false;
+
+    tickStats.missed += passed - deadlines - 1;
+    deadlines = passed;
+    auto deadline = started + period * static_cast<std::chrono::nanoseconds::rep>(passed);
+    tickStats.record(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - deadline).count());
+    return true;
+}
+
+void TickLoop::skipPassed() {
+    deadlines = std::max(deadlines, deadlinesPassed());
+}
+
+void TickLoop::takeBufferedInput() {
+#ifndef _WIN32
+    // getc() returns what stdio holds, then EOF once the descriptor would block
+    int flags = fcntl(STDIN_FILENO, F_GETFL);
+    if (flags < 0 || fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK) != 0) return;
+    int c;
+    while ((c = std::getc(stdin)) != EOF) pending += static_cast<char>(c);
+    if (std::feof(stdin)) closed = true;
+    std::clearerr(stdin);
+    fcntl(STDIN_FILENO, F_SETFL, flags);
+#endif
+}
+
+bool TickLoop::readLine(std::string& line) {
+    size_t end = pending.find('\n');
+    if (end == std::string::npos) {
+        if (!closed || pending.empty()) return false;
+        end = pending.size();
+    }
+    line.assign(pending, 0, end);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    pending.erase(0, std::min(end + 1, pending.size()));
+    return true;
+}
+
+bool TickLoop::inputClosed() const {
+    return closed && pending.empty();
+}
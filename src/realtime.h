@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// Timing of the physics ticks in a real-time session. Lateness is how long
+// after its deadline a tick was handled; ticks whose deadline passed while
+// the loop was busy with an earlier one are skipped and counted as missed.
+struct TickStats {
+    static constexpr int BUCKETS = 32;  // Lateness in log2 microseconds
+
+    int hz;
+    uint64_t ticks;       // Ticks handled
+    uint64_t missed;      // Deadlines skipped
+    double totalLateness;  // Microseconds, for the mean
+    double maxLateness;
+    uint64_t lateness[BUCKETS];
+
+    void record(double lateUs);
+    double meanLateness() const { return ticks ? totalLateness / ticks : 0.0; }
+    // Upper bound of the lateness histogram bucket holding quantile q, in microseconds
+    double latenessPercentile(double q) const;
+};
+
+// Event source for --realtime: a periodic timer (timerfd on Linux, poll
+// timeouts elsewhere) and line input from stdin, waited on together with
+// poll(). Commands are read without blocking the ticks.
+class TickLoop {
+public:
+    TickLoop();
+    ~TickLoop();
+
+    // Start ticking at `hz`; false where poll() is unavailable (Windows)
+    bool start(int hz);
+
+    // Sleep until a tick is due, input arrives, or `timeoutMs` passes (-1: no limit)
+    void wait(int timeoutMs);
+
+    // True once per due tick, recording its lateness and any missed deadlines
+    bool tickDue();
+    // Drop the deadlines that passed while the loop was held up on purpose
+    // (a screen waiting for Enter) without counting them as missed
+    void skipPassed();
+    // Take over input that stdin's buffer read ahead of the last line read
+    // through std::cin (the difficulty menu, a screen waiting for Enter)
+    void takeBufferedInput();
+    // Next complete line of input
+    bool readLine(std::string& line);
+    // stdin reached end of file and every line has been read
+    bool inputClosed() const;
+
+    const TickStats& stats() const { return tickStats; }
+
+private:
+    int timerFd;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::nanoseconds period;
+    uint64_t deadlines;  // Deadlines passed so far, handled or missed
+    std::string pending;  // Input after the last complete line
+    bool closed;
+    TickStats tickStats;
+
+    uint64_t deadlinesPassed() const;
+
+    TickLoop(const TickLoop&);
+    TickLoop& operator=(const TickLoop&);
+};
@@ -0,0 +1,222 @@
+#include "render_thread.h"
+#include "terminal.h"
+#include "perf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+// Collects a frame's text, keeping its storage between frames
+class FrameText : public std::streambuf {
+public:
+    std::string text;
+
+protected:
+    int overflow(int c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        text += traits_type::to_char_type(c);
+        return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        text.append(s, static_cast<size_t>(n));
+        return n;
+    }
+};
+}
+
+ConsoleQueue::ConsoleQueue() : head(0), tail(0), droppedBytes(0) {}
+
+int ConsoleQueue::overflow(int c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    char ch = traits_type::to_char_type(c);
+    xsputn(&ch, 1);
+    return c;
+}
+
+std::streamsize ConsoleQueue::xsputn(const char* s, std::streamsize n) {
+    uint64_t end = tail.load(std::memory_order_relaxed);
+    uint64_t room = CAPACITY - (end - head.load(std::memory_order_acquire));
+    size_t size = static_cast<size_t>(n);
+    if (size > room) {
+        // Drop the whole write: half a line or half an escape sequence would
+        // garble the terminal
+        droppedBytes.fetch_add(size, std::memory_order_relaxed);
+        return n;
+    }
+    size_t at = static_cast<size_t>(end % CAPACITY);
+    size_t first = std::min(size, CAPACITY - at);
+    std::memcpy(ring + at, s, first);
+    std::memcpy(ring, s + first, size - first);
+    tail.store(end + size, std::memory_order_release);
+    // Report everything as written: the stream must not fail
+    return n;
+}
+
+size_t ConsoleQueue::read(char* data, size_t size) {
+    uint64_t start = head.load(std::memory_order_relaxed);
+    uint64_t available = tail.load(std::memory_order_acquire) - start;
+    size_t count = static_cast<size_t>(std::min<uint64_t>(available, size));
+    size_t at = static_cast<size_t>(start % CAPACITY);
+    size_t first = std::min(count, CAPACITY - at);
+    std::memcpy(data, ring + at, first);
+    std::memcpy(data + first, ring, count - first);
+    head.store(start + count, std::memory_order_release);
+    return count;
+}
+
+RenderThread::RenderThread()
+    : previous(nullptr), published(0), starved(false), running(false), stopping(false), holding(false), held(false),
+      framePeriodUs(0), drawn(0), stale(0), droppedReported(0), tipTurn(-10) {}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::start(int fps) {
+    if (running) return;
+    framePeriodUs = 1000000 / std::max(1, fps);
+    std::cout.flush();
+    previous = std::cout.rdbuf(&console);
+    stopping = false;
+    running = true;
+    thread = std::thread(&RenderThread::loop, this);
+}
+
+void RenderThread::stop() {
+    if (!running) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    std::cout.rdbuf(previous);
+    running = false;
+}
+
+void RenderThread::publish(const ReactorState& state, const TickStats& clock) {
+    DisplaySnapshot& snapshot = snapshots.back();
+    snapshot.state = state;
+    // The models, sketches and autopilot belong to the simulation thread;
+    // what the frame shows of them is read out below
+    snapshot.state.spatial = nullptr;
+    snapshot.state.channels = nullptr;
+    snapshot.state.depletion = nullptr;
+    snapshot.state.journal = nullptr;
+    snapshot.state.history = nullptr;
+    snapshot.state.trends = nullptr;
+    snapshot.state.distributions = nullptr;
+    snapshot.state.autopilot = nullptr;
+    Renderer::readModels(state, snapshot.models);
+    Renderer::readTrends(state, snapshot.trends);
+    snapshot.clock = clock;
+    snapshot.sequence = ++published;
+    snapshots.publish();
+    // Wake the renderer for console text, or when it has a frame due; a
+    // fresh snapshot alone can wait for the frame period
+    if (!console.empty() ||
+        (starved.load(std::memory_order_relaxed) && starved.exchange(false, std::memory_order_relaxed))) {
+        wake.notify_one();
+    }
+}
+
+void RenderThread::hold() {
+    std::unique_lock<std::mutex> lock(mutex);
+    holding = true;
+    wake.notify_one();
+    idle.wait(lock, [this] { return held; });
+    lock.unlock();
+    std::cout.rdbuf(previous);
+}
+
+void RenderThread::release() {
+    std::cout.flush();
+    std::cout.rdbuf(&console);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        holding = false;
+    }
+    wake.notify_one();
+}
+
+void RenderThread::loop() {
+    FrameText buffer;
+    std::ostream out(&buffer);
+    auto nextFrame = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        bool finishing = stopping;
+        bool standAside = holding;
+        lock.unlock();
+
+        writeConsole();
+        auto now = std::chrono::steady_clock::now();
+        if (finishing || (!standAside && now >= nextFrame)) {
+            // With nothing new, draw as soon as publish() says there is
+            starved.store(true, std::memory_order_relaxed);
+            if (snapshots.update()) {
+                starved.store(false, std::memory_order_relaxed);
+                draw(out, buffer.text);
+                nextFrame = now + std::chrono::microseconds(framePeriodUs);
+            }
+        }
+        if (finishing) {
+            writeConsole();
+            return;
+        }
+
+        lock.lock();
+        if (standAside) {
+            held = true;
+            idle.notify_one();
+            wake.wait(lock, [this] { return !holding || stopping; });
+            held = false;
+            // The screen was taken over: draw as soon as there is something to draw
+            nextFrame = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (!stopping && !holding) {
+            bool due = starved.load(std::memory_order_relaxed);
+            wake.wait_until(lock, due ? now + std::chrono::microseconds(framePeriodUs) : nextFrame);
+        }
+    }
+}
+
+void RenderThread::draw(std::ostream& out, std::string& text) {
+    DisplaySnapshot& snapshot = snapshots.front();
+    if (drawn != 0) stale += snapshot.sequence - drawn - 1;
+    drawn = snapshot.sequence;
+    // Tips are paced by the turn they were last shown on, which only the renderer knows
+    ReactorState& state = snapshot.state;
+    state.lastTipTurn = tipTurn;
+
+    PERF_SCOPE(RENDER);
+    text.clear();
+    Renderer::displayDashboard(state, snapshot.trends, out);
+    Renderer::displayScore(state, out);
+    Renderer::displayStatus(state, snapshot.models, out);
+    Renderer::displayClock(snapshot.clock, out, static_cast<long long>(stale));
+    Renderer::displayContextualTip(state, out);
+    out.flush();
+    tipTurn = state.lastTipTurn;
+    Terminal::present(text);
+}
+
+void RenderThread::writeConsole() {
+    char chunk[4096];
+    size_t got;
+    while ((got = console.read(chunk, sizeof(chunk))) > 0) Terminal::write(chunk, got);
+
+    uint64_t dropped = console.dropped();
+    if (dropped != droppedReported) {
+        char note[80];
+        int length = std::snprintf(note, sizeof(note), "\033[0m[%llu bytes of output dropped]\n",
+                                   static_cast<unsigned long long>(dropped - droppedReported));
+        Terminal::write(note, static_cast<size_t>(length));
+        droppedReported = dropped;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "reactor_state.h"
+#include "renderer.h"
+#include "realtime.h"
+#include "triple_buffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+
+// Everything a dashboard frame shows, copied out of the simulation. The
+// model, sketch and autopilot pointers in `state` are cleared; `models` has
+// their figures.
+struct DisplaySnapshot {
+    ReactorState state;
+    ModelReadout models;
+    TrendReadout trends;
+    TickStats clock;
+    uint64_t sequence;  // Snapshots published before this one, plus one
+
+    DisplaySnapshot() : state(Difficulty::NORMAL), models(), trends(), clock(), sequence(0) {}
+};
+
+// Bytes printed by the simulation thread on their way to the render thread:
+// a single-producer single-consumer ring. A write that does not fit is
+// dropped whole rather than wait for the terminal.
+class ConsoleQueue : public std::streambuf {
+public:
+    static const size_t CAPACITY = 1 << 16;
+
+    ConsoleQueue();
+
+    // Reader side: copy out up to `size` bytes
+    size_t read(char* data, size_t size);
+    bool empty() const { return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_relaxed); }
+    // Bytes dropped so far
+    uint64_t dropped() const { return droppedBytes.load(std::memory_order_relaxed); }
+
+protected:
+    int overflow(int c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+private:
+    char ring[CAPACITY];
+    alignas(64) std::atomic<uint64_t> head;  // Total bytes read
+    alignas(64) std::atomic<uint64_t> tail;  // Total bytes written
+    std::atomic<uint64_t> droppedBytes;
+};
+
+// Draws the dashboard of a real-time session on its own thread, so a slow
+// terminal never holds up a tick. The simulation thread publish()es a
+// snapshot after each change and its std::cout output is queued; the render
+// thread writes the queued text as it arrives and draws the newest snapshot
+// at most `fps` times a second, skipping any it had no time for.
+class RenderThread {
+public:
+    RenderThread();
+    ~RenderThread();
+
+    // Start the thread and queue std::cout, which from now on belongs to the
+    // calling thread alone
+    void start(int fps);
+    // Draw the last snapshot, write out the queue and give std::cout back
+    void stop();
+
+    // Never waits on the render thread
+    void publish(const ReactorState& state, const TickStats& clock);
+
+    // Let the calling thread use the terminal directly (a full screen that
+    // waits for Enter) until release(). Waits for queued text to be written.
+    void hold();
+    void release();
+
+private:
+    TripleBuffer<DisplaySnapshot> snapshots;
+    ConsoleQueue console;
+    std::streambuf* previous;
+    std::thread thread;
+    uint64_t published;
+    std::atomic<bool> starved;  // A frame is due and waits for a snapshot
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool running;
+    bool stopping;
+    bool holding;  // Asked to stand aside
+    bool held;     // Standing aside
+
+    // Render thread only
+    int framePeriodUs;
+    uint64_t drawn;    // Sequence of the last snapshot drawn
+    uint64_t stale;    // Snapshots replaced before they were drawn
+    uint64_t droppedReported;
+    int tipTurn;
+
+    void loop();
+    void draw(std::ostream& out, std::string& text);
+    void writeConsole();
+
+    RenderThread(const RenderThread&);
+    RenderThread& operator=(const RenderThread&);
+};
@@ -1,4 +1,10 @@
 #include "renderer.h"
+#include "spatial.h"
+#include "subchannel.h"
+#include "depletion.h"
+#include "persistence.h"
+#include "realtime.h"
+#include "event_catalog.h"
 
 #include <iostream>
 #include <iomanip>
@@ -7,6 +13,10 @@
 #include <algorithm>
 #include <vector>
 #include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <ctime>
 
 std::string Renderer::getBarColor(double value, double max, bool inverse) {
     double ratio = value / max;
@@ -17,51 +27,124 @@ std::string Renderer::getBarColor(double value, double max, bool inverse) {
     return Color::RED;
 }
 
-void Renderer::printBar(const std::string& label, double value, double max, int width, bool inverse) {
+void Renderer::printBar(std::ostream& out, const std::string& label, double value, double max, int width,
+                        bool inverse, const unsigned char* trend) {
     int bars = static_cast<int>((value / max) * width);
     bars = std::max(0, std::min(width, bars));
 
     std::string color = getBarColor(value, max, inverse);
 
-    std::cout << std::left << std::setw(10) << label << "[";
-    std::cout << color;
+    out << std::left << std::setw(10) << label << "[";
+    out << color;
     for (int i = 0; i < width; ++i) {
-        std::cout << (i < bars ? "\xe2\x96\x88" : " ");
+        out << (i < bars ? "\xe2\x96\x88" : " ");
     }
-    std::cout << Color::RESET << "] ";
+    out << Color::RESET << "] ";
 
-    std::cout << color << std::fixed << std::setprecision(1) << value << Color::RESET;
-    if (label == "Temp") std::cout << "\xc2\xb0""C";
-    else if (label == "Coolant" || label == "Fuel" || label == "Xenon" || label == "Diesel") std::cout << "%";
-    else if (label == "Turbine") std::cout << " RPM";
-    else if (label == "Pressure") std::cout << " bar";
-    else if (label == "Radiation") std::cout << " mSv/h";
-    else if (label == "Output") std::cout << " MW";
-    std::cout << "\n";
+    const char* unit = "";
+    int unitColumns = 0;
+    if (label == "Temp") { unit = "\xc2\xb0""C"; unitColumns = 2; }
+    else if (label == "Coolant" || label == "Fuel" || label == "Xenon" || label == "Diesel") { unit = "%"; unitColumns = 1; }
+    else if (label == "Turbine") { unit = " RPM"; unitColumns = 4; }
+    else if (label == "Pressure") { unit = " bar"; unitColumns = 4; }
+    else if (label == "Radiation") { unit = " mSv/h"; unitColumns = 6; }
+    else if (label == "Output") { unit = " MW"; unitColumns = 3; }
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%.1f", value);
+    out << color << std::fixed << std::setprecision(1) << value << Color::RESET << unit;
+
+    if (trend) {
+        // Sparklines line up after the widest reading ("3600.0 RPM")
+        out << std::setw(std::max(1, 12 - length - unitColumns)) << "" << Color::DIM;
+        printSparkline(out, trend);
+        out << Color::RESET;
+    }
+    out << "\n";
 }
 
-void Renderer::displayDashboard(const ReactorState& state) {
-    WeatherInfo weatherInfo = getWeatherInfo(state.currentWeather);
-    std::cout << "\n" << Color::BOLD << Color::CYAN
-              << "\xe2\x95\x94\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x97"
-              << Color::RESET << "\n";
+void Renderer::printSparkline(std::ostream& out, const unsigned char* levels) {
+    for (int i = 0; i < TR::SPARK_WIDTH; ++i) {
+        if (levels[i] == 0) {
+            out << ' ';
+        } else {
+            const char glyph[] = {'\xe2', '\x96', static_cast<char>(0x80 + levels[i]), '\0'};
+            out << glyph;
+        }
+    }
+}
+
+void Renderer::readTrends(const ReactorState& state, TrendReadout& trends) {
+    static const Trend bars[TrendReadout::SERIES] = {
+        Trend::TEMPERATURE, Trend::COOLANT, Trend::FUEL, Trend::XENON, Trend::RADIATION,
+        Trend::TURBINE_RPM, Trend::STEAM_PRESSURE, Trend::ELECTRICITY, Trend::DIESEL_FUEL,
+    };
+    trends.window = 0;
+    if (!state.trends || state.trends->newestTurn() < 0) return;
+    int oldest = state.trends->oldestTurn(), newest = state.trends->newestTurn();
+    int window = state.trends->window();
+    trends.window = window > 0 ? std::min(window, newest - oldest + 1) : newest - oldest + 1;
+
+    TrendSummary buckets[TR::SPARK_WIDTH];
+    for (int i = 0; i < TrendReadout::SERIES; ++i) {
+        state.trends->query(bars[i], window, buckets, TR::SPARK_WIDTH);
+        sparkLevels(buckets, trends.levels[i]);
+    }
+}
+
+void Renderer::sparkLevels(const TrendSummary* buckets, unsigned char* levels) {
+    double low = 0.0, high = 0.0;
+    bool any = false;
+    for (int b = 0; b < TR::SPARK_WIDTH; ++b) {
+        if (buckets[b].count == 0) continue;
+        double mean = buckets[b].mean();
+        if (!any || mean < low) low = mean;
+        if (!any || mean > high) high = mean;
+        any = true;
+    }
+    // Scaled to the window's own range; a flat reading stays on the floor
+    double range = high - low;
+    bool flat = range <= 1e-9 * std::max(1.0, std::fabs(high));
+    for (int b = 0; b < TR::SPARK_WIDTH; ++b) {
+        if (buckets[b].count == 0) {
+            levels[b] = 0;
+        } else {
+            levels[b] = flat ? 1 : static_cast<unsigned char>(1 + std::lround((buckets[b].mean() - low) / range * 7.0));
+        }
+    }
+}
+
+static const unsigned char* trend(const TrendReadout& trends, int series) {
+    return trends.window > 0 ? trends.levels[series] : nullptr;
+}
+
+void Renderer::displayDashboard(const ReactorState& state, std::ostream& out) {
+    TrendReadout trends;
+    readTrends(state, trends);
+    displayDashboard(state, trends, out);
+}
+
+void Renderer::displayDashboard(const ReactorState& state, const TrendReadout& trends, std::ostream& out) {
+    const WeatherInfo& weatherInfo = getWeatherInfo(state.currentWeather);
+    out << "\n" << Color::BOLD << Color::CYAN
+        << "\xe2\x95\x94\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x97"
+        << Color::RESET << "\n";
 
     std::string pauseIndicator = state.paused
         ? (std::string(Color::BG_YELLOW) + Color::WHITE + " PAUSED " + Color::RESET + Color::CYAN)
         : "";
-    std::cout << Color::BOLD << Color::CYAN
-              << "\xe2\x95\x91   REACTOR DASHBOARD [" << state.currentDifficulty.name << "] "
-              << weatherInfo.icon << " " << weatherInfo.name
-              << std::setw(15 - static_cast<int>(state.currentDifficulty.name.length())
-                              - static_cast<int>(weatherInfo.name.length())
+    out << Color::BOLD << Color::CYAN
+        << "\xe2\x95\x91   REACTOR DASHBOARD [" << state.currentDifficulty.name << "] "
+        << weatherInfo.icon << " " << weatherInfo.name
+        << std::setw(15 - static_cast<int>(std::strlen(state.currentDifficulty.name))
+                              - static_cast<int>(std::strlen(weatherInfo.name))
                               - (state.paused ? 8 : 0))
               << "" << pauseIndicator << "\xe2\x95\x91" << Color::RESET << "\n";
-    std::cout << Color::BOLD << Color::CYAN
-              << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
-              << Color::RESET << "\n";
+    out << Color::BOLD << Color::CYAN
+        << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
+        << Color::RESET << "\n";
 
     // Core section
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "REACTOR CORE" << Color::RESET;
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "REACTOR CORE" << Color::RESET;
     std::string eccsStatus = state.eccsAvailable
         ? (std::string(Color::GREEN) + "ECCS READY" + Color::RESET)
         : (std::string(Color::RED) + "ECCS CD:" + std::to_string(state.eccsCooldownTimer) + Color::RESET);
@@ -70,92 +153,189 @@ void Renderer::displayDashboard(const ReactorState& state) {
         : (state.containmentIntegrity < RC::CONTAINMENT_WARNING
             ? (std::string(Color::YELLOW) + "STRESSED" + Color::RESET)
             : (std::string(Color::GREEN) + "INTACT" + Color::RESET));
-    std::cout << std::setw(10) << "" << eccsStatus << " " << containmentStatus
-              << Color::CYAN << "  \xe2\x95\x91" << Color::RESET << "\n";
-
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Temp", state.temperature, state.currentDifficulty.meltdownTemperature, 16, false);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Coolant", state.coolant, 100.0, 16, true);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Fuel", state.fuel, 100.0, 16, true);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Xenon", state.xenonLevel, RC::MAX_XENON, 16, false);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Radiation", state.radiationLevel, RC::DANGER_RADIATION, 16, false);
+    out << std::setw(10) << "" << eccsStatus << " " << containmentStatus
+        << Color::CYAN << "  \xe2\x95\x91" << Color::RESET;
+    // Heading for the sparklines below
+    if (trends.window > 0) out << Color::DIM << " last " << trends.window << " turns" << Color::RESET;
+    out << "\n";
+
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Temp", state.temperature, state.currentDifficulty.meltdownTemperature, 16, false, trend(trends, 0));
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Coolant", state.coolant, 100.0, 16, true, trend(trends, 1));
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Fuel", state.fuel, 100.0, 16, true, trend(trends, 2));
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Xenon", state.xenonLevel, RC::MAX_XENON, 16, false, trend(trends, 3));
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Radiation", state.radiationLevel, RC::DANGER_RADIATION, 16, false, trend(trends, 4));
 
     // Turbine section
-    std::cout << Color::CYAN
-              << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
-              << Color::RESET << "\n";
+    out << Color::CYAN
+        << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
+        << Color::RESET << "\n";
     std::string turbineStatus = state.turbineOnline
         ? (std::string(Color::GREEN) + "ONLINE" + Color::RESET)
         : (std::string(Color::RED) + "OFFLINE" + Color::RESET);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "TURBINE HALL" << Color::RESET
-              << " [" << turbineStatus << "]"
-              << std::setw(27) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "TURBINE HALL" << Color::RESET
+        << " [" << turbineStatus << "]"
+        << std::setw(27) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
 
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Turbine", state.turbineRPM, RC::MAX_TURBINE_RPM, 16, false);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Pressure", state.steamPressure, RC::MAX_STEAM_PRESSURE, 16, false);
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Output", state.electricityOutput, 1000.0, 16, false);
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Turbine", state.turbineRPM, RC::MAX_TURBINE_RPM, 16, false, trend(trends, 5));
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Pressure", state.steamPressure, RC::MAX_STEAM_PRESSURE, 16, false, trend(trends, 6));
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Output", state.electricityOutput, 1000.0, 16, false, trend(trends, 7));
 
     // Diesel generator section
-    std::cout << Color::CYAN
-              << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
-              << Color::RESET << "\n";
+    out << Color::CYAN
+        << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
+        << Color::RESET << "\n";
     std::string dieselStatus = state.dieselRunning
         ? (std::string(Color::GREEN) + "RUNNING" + Color::RESET)
         : (std::string(Color::DIM) + "STANDBY" + Color::RESET);
     std::string autoStatus = state.dieselAutoStart ? "AUTO" : "MANUAL";
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "DIESEL GENERATOR" << Color::RESET
-              << " [" << dieselStatus << "] [" << autoStatus << "]"
-              << std::setw(15) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
-    std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
-    printBar("Diesel", state.dieselFuel, RC::DIESEL_FUEL_CAPACITY, 16, true);
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "DIESEL GENERATOR" << Color::RESET
+        << " [" << dieselStatus << "] [" << autoStatus << "]"
+        << std::setw(15) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    out << Color::CYAN << "\xe2\x95\x91 " << Color::RESET;
+    printBar(out, "Diesel", state.dieselFuel, RC::DIESEL_FUEL_CAPACITY, 16, true, trend(trends, 8));
 
-    std::cout << Color::BOLD << Color::CYAN
-              << "\xe2\x95\x9a\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x9d"
-              << Color::RESET << "\n";
+    out << Color::BOLD << Color::CYAN
+        << "\xe2\x95\x9a\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x9d"
+        << Color::RESET << "\n";
 }
 
-void Renderer::displayScore(const ReactorState& state) {
-    std::cout << Color::YELLOW << "\xe2\x95\xad\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x95\xae" << Color::RESET << "\n";
-    std::cout << Color::YELLOW << "\xe2\x94\x82 " << Color::BOLD << "SCORE:" << Color::RESET
-              << std::setw(7) << state.score
-              << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "HIGH:" << Color::RESET
-              << std::setw(7) << state.highScore
-              << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "TURN:" << Color::RESET
-              << std::setw(4) << state.turns
-              << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "MW\xc2\xb7h:" << Color::RESET
-              << std::setw(6) << static_cast<int>(state.totalElectricityGenerated)
-              << Color::YELLOW << " \xe2\x94\x82" << Color::RESET << "\n";
+void Renderer::displayScore(const ReactorState& state, std::ostream& out) {
+    out << Color::YELLOW << "\xe2\x95\xad\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x95\xae" << Color::RESET << "\n";
+    out << Color::YELLOW << "\xe2\x94\x82 " << Color::BOLD << "SCORE:" << Color::RESET
+        << std::setw(7) << state.score
+        << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "HIGH:" << Color::RESET
+        << std::setw(7) << state.highScore
+        << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "TURN:" << Color::RESET
+        << std::setw(4) << state.turns
+        << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "MW\xc2\xb7h:" << Color::RESET
+        << std::setw(6) << static_cast<int>(state.totalElectricityGenerated)
+        << Color::YELLOW << " \xe2\x94\x82" << Color::RESET << "\n";
 
     // Grid demand line
     std::string demandColor = state.demandSatisfaction >= 90 ? Color::GREEN :
                              (state.demandSatisfaction >= 60 ? Color::YELLOW : Color::RED);
-    std::cout << Color::YELLOW << "\xe2\x94\x82 " << Color::BOLD << "GRID DEMAND:" << Color::RESET
-              << std::setw(4) << static_cast<int>(state.gridDemand) << " MW"
-              << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "SATISFACTION:" << Color::RESET
-              << demandColor << std::setw(3) << static_cast<int>(state.demandSatisfaction) << "%" << Color::RESET
-              << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "BONUS:" << Color::RESET
-              << std::setw(5) << state.demandBonus
-              << Color::YELLOW << " \xe2\x94\x82" << Color::RESET << "\n";
-    std::cout << Color::YELLOW << "\xe2\x95\xb0\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x95\xaf" << Color::RESET << "\n";
+    out << Color::YELLOW << "\xe2\x94\x82 " << Color::BOLD << "GRID DEMAND:" << Color::RESET
+        << std::setw(4) << static_cast<int>(state.gridDemand) << " MW"
+        << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "SATISFACTION:" << Color::RESET
+        << demandColor << std::setw(3) << static_cast<int>(state.demandSatisfaction) << "%" << Color::RESET
+        << Color::YELLOW << " \xe2\x94\x82 " << Color::BOLD << "BONUS:" << Color::RESET
+        << std::setw(5) << state.demandBonus
+        << Color::YELLOW << " \xe2\x94\x82" << Color::RESET << "\n";
+    out << Color::YELLOW << "\xe2\x95\xb0\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x94\x80\xe2\x95\xaf" << Color::RESET << "\n";
+}
+
+void Renderer::readModels(const ReactorState& state, ModelReadout& models) {
+    models.spatial = state.spatial != nullptr;
+    if (state.spatial) {
+        const SpatialCore& core = *state.spatial;
+        models.nx = core.nx();
+        models.ny = core.ny();
+        models.nz = core.nz();
+        models.keff = core.keff();
+        for (int b = 0; b < SC::BANKS; ++b) models.banks[b] = core.bankInsertion(b);
+        models.peaking = core.peakingFactor();
+        models.axialOffset = core.axialOffset();
+    }
+    models.poisons = state.depletion || (state.spatial && state.spatial->depleting());
+    if (models.poisons) {
+        models.xenon = state.depletion ? state.depletion->xenonRelative() : state.spatial->averageXenon();
+        models.samarium = state.depletion ? state.depletion->samariumRelative() : state.spatial->averageSamarium();
+    }
+    models.channelCount = state.channels ? state.channels->channelCount() : 0;
+    if (state.channels) models.channels = state.channels->summary();
+    models.autopilot = state.autoRods && state.autopilot;
+    if (models.autopilot) models.plan = state.autopilot->lastPlan();
+}
+
+void Renderer::displayStatus(const ReactorState& state, std::ostream& out) {
+    ModelReadout models;
+    readModels(state, models);
+    displayStatus(state, models, out);
+}
+
+void Renderer::displayStatus(const ReactorState& state, const ModelReadout& models, std::ostream& out) {
+    out << Color::DIM << "Neutrons: " << Color::RESET
+        << std::fixed << std::setprecision(0) << state.neutrons
+        << Color::DIM << " | Rods: " << Color::RESET
+        << static_cast<int>(state.controlRods * 100) << "%";
+    if (state.autoRods) out << Color::CYAN << " AUTO" << Color::RESET;
+    out << Color::DIM << " | Power: " << Color::RESET << std::setprecision(1) << state.power;
+    if (state.kinetics.enabled) {
+        out << Color::DIM << " | \xcf\x81: " << Color::RESET << std::setprecision(2)
+            << state.kinetics.reactivity / PointKinetics::beta() << "$"
+            << Color::DIM << " (" << state.kinetics.stats.lastTurnSteps << " steps)" << Color::RESET;
+    }
+    out << Color::DIM << " | Events: " << Color::RESET << state.eventsExperienced
+        << Color::DIM << " | \xf0\x9f\x8f\x86 " << Color::RESET
+        << state.unlockedAchievements.size() << "/"
+        << static_cast<int>(Achievement::ACHIEVEMENT_COUNT) << "\n";
+
+    if (models.autopilot) {
+        const AutopilotPlan& plan = models.plan;
+        out << Color::DIM << "Autopilot: " << Color::RESET << std::setprecision(0) << plan.satisfaction << "%"
+            << Color::DIM << " of demand over " << AP::HORIZON << " turns | Peak " << Color::RESET
+            << plan.peakTemperature << "\xc2\xb0""C"
+            << Color::DIM << " | Planned in " << std::setprecision(1) << plan.micros / 1000.0 << " ms" << Color::RESET;
+        if (!plan.withinMargins) out << Color::YELLOW << " | No plan within margins" << Color::RESET;
+        out << "\n";
+    }
+
+    if (models.spatial) {
+        out << Color::DIM << "Core " << models.nx << "x" << models.ny << "x" << models.nz
+            << ": k=" << Color::RESET << std::setprecision(4) << models.keff
+            << Color::DIM << " | Banks: " << Color::RESET;
+        for (int b = 0; b < SC::BANKS; ++b) {
+            out << (b ? "/" : "") << static_cast<int>(models.banks[b] * 100);
+        }
+        out << "%" << Color::DIM << " | Peaking: " << Color::RESET << std::setprecision(2)
+            << models.peaking
+            << Color::DIM << " | Axial offset: " << Color::RESET << std::showpos << std::setprecision(1)
+            << models.axialOffset * 100.0 << "%" << std::noshowpos << "\n";
+    }
+
+    if (models.poisons) {
+        out << Color::DIM << "Poisons (x equilibrium): Xe-135 " << Color::RESET << std::setprecision(2) << models.xenon
+            << Color::DIM << " | Sm-149 " << Color::RESET << models.samarium
+            << Color::DIM << " | Fuel worth: " << Color::RESET << std::setprecision(1) << state.fuel << "%\n";
+    }
+
+    if (models.channelCount > 0) {
+        const ChannelSummary& ch = models.channels;
+        const char* cladColor = ch.peakClad > TH::CLAD_SCRAM_TEMPERATURE * 0.8 ? Color::RED
+                              : ch.dnbChannels > 0 ? Color::YELLOW : Color::RESET;
+        out << Color::DIM << models.channelCount << " channels: peak clad " << Color::RESET
+            << cladColor << std::setprecision(0) << ch.peakClad << "\xc2\xb0""C" << Color::RESET
+            << Color::DIM << " | Centerline: " << Color::RESET << ch.peakCenterline << "\xc2\xb0""C"
+            << Color::DIM << " | Outlet: " << Color::RESET << ch.maxOutlet << "\xc2\xb0""C"
+            << Color::DIM << " | Flow: " << Color::RESET << ch.flowFraction * 100.0 << "%"
+            << Color::DIM << " | DNB: " << Color::RESET << ch.dnbChannels << "\n";
+    }
+}
+
+void Renderer::displayClock(const TickStats& clock, std::ostream& out, long long staleFrames) {
+    out << Color::DIM << "Clock " << clock.hz << " Hz | Ticks " << clock.ticks
+        << " | Lateness mean " << std::fixed << std::setprecision(0) << clock.meanLateness()
+        << " \xc2\xb5s, p99 " << clock.latenessPercentile(0.99)
+        << " \xc2\xb5s, max " << clock.maxLateness << " \xc2\xb5s | Missed "
+        << (clock.missed ? Color::YELLOW : "") << clock.missed << Color::RESET;
+    if (staleFrames >= 0) out << Color::DIM << " | Stale frames " << staleFrames << Color::RESET;
+    out << "\n";
 }
 
-void Renderer::displayStatus(const ReactorState& state) {
-    std::cout << Color::DIM << "Neutrons: " << Color::RESET
-              << std::fixed << std::setprecision(0) << state.neutrons
-              << Color::DIM << " | Rods: " << Color::RESET
-              << static_cast<int>(state.controlRods * 100) << "%"
-              << Color::DIM << " | Power: " << Color::RESET << std::setprecision(1) << state.power
-              << Color::DIM << " | Events: " << Color::RESET << state.eventsExperienced
-              << Color::DIM << " | \xf0\x9f\x8f\x86 " << Color::RESET
-              << state.unlockedAchievements.size() << "/"
-              << static_cast<int>(Achievement::ACHIEVEMENT_COUNT) << "\n";
+void Renderer::displayClockSummary(const TickStats& clock) {
+    std::cout << Color::DIM << clock.ticks << " ticks at " << clock.hz << " Hz, lateness mean "
+              << std::fixed << std::setprecision(0) << clock.meanLateness() << " \xc2\xb5s, p99 "
+              << clock.latenessPercentile(0.99) << " \xc2\xb5s, max " << clock.maxLateness
+              << " \xc2\xb5s, " << clock.missed << " missed deadline" << (clock.missed == 1 ? "" : "s")
+              << Color::RESET << "\n";
 }
 
 void Renderer::displayHelp(const ReactorState& state) {
@@ -169,6 +349,8 @@ void Renderer::displayHelp(const ReactorState& state) {
               << std::setw(50) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   0-100  : Set control rod insertion percentage"
               << std::setw(10) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   auto   : Toggle the predictive rod autopilot"
+              << std::setw(12) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   r      : Refill coolant (-" << RC::REFILL_PENALTY << " points)"
               << std::setw(22) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   t      : Toggle turbine online/offline"
@@ -187,12 +369,24 @@ void Renderer::displayHelp(const ReactorState& state) {
               << std::setw(23) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   log    : View operator event log"
               << std::setw(23) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   log ...: Filter, e.g. log critical 500-900"
+              << std::setw(13) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   perf   : Timing per subsystem (perf reset clears)"
+              << std::setw(6) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   p      : Pause/Resume simulation"
               << std::setw(23) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
-    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   s/save : Save game"
-              << std::setw(37) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
-    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   l/load : Load saved game"
-              << std::setw(31) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   s/save [N] : Save game to slot N (default 1)"
+              << std::setw(11) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   l/load [N] : Load slot N (default 1)"
+              << std::setw(19) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   slots      : List save slots"
+              << std::setw(27) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   autosave   : Toggle saving to slot 0 every turn"
+              << std::setw(8) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   rewind N : Go back N turns (default 1)"
+              << std::setw(17) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+    std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   trend [N]: Trend window, N turns or all"
+              << std::setw(16) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   sound  : Toggle sound effects"
               << std::setw(25) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   tips   : Toggle operator tips"
@@ -227,7 +421,7 @@ void Renderer::displayHelp(const ReactorState& state) {
     std::cout << Color::CYAN << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3" << Color::RESET << "\n";
 
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << Color::BOLD << " SAFETY LIMITS (" << state.currentDifficulty.name << " mode):" << Color::RESET
-              << std::setw(34 - static_cast<int>(state.currentDifficulty.name.length())) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
+              << std::setw(34 - static_cast<int>(std::strlen(state.currentDifficulty.name))) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   \xe2\x80\xa2 SCRAM at: " << state.currentDifficulty.scramTemperature << "\xc2\xb0""C or "
               << RC::SCRAM_NEUTRONS << " neutrons" << std::setw(15) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "   \xe2\x80\xa2 MELTDOWN at: " << state.currentDifficulty.meltdownTemperature << "\xc2\xb0""C"
@@ -254,7 +448,7 @@ void Renderer::displayAchievements(const ReactorState& state) {
     for (int i = 0; i < static_cast<int>(Achievement::ACHIEVEMENT_COUNT); ++i) {
         Achievement ach = static_cast<Achievement>(i);
         const auto& info = infoTable[i];
-        bool unlocked = state.unlockedAchievements.find(ach) != state.unlockedAchievements.end();
+        bool unlocked = state.unlockedAchievements.contains(ach);
 
         std::cout << Color::MAGENTA << "\xe2\x95\x91 " << Color::RESET;
         if (unlocked) {
@@ -280,41 +474,67 @@ void Renderer::displayAchievements(const ReactorState& state) {
     std::getline(std::cin, dummy);
 }
 
-void Renderer::displayLog(const ReactorState& state) {
+void Renderer::displayLog(const ReactorState& state, const LogFilter& filter) {
     std::cout << "\n" << Color::BOLD << Color::WHITE
               << "\xe2\x95\x94\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x97\n"
               << "\xe2\x95\x91                    OPERATOR LOG                           \xe2\x95\x91\n"
               << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3"
               << Color::RESET << "\n";
 
-    if (state.operatorLog.empty()) {
-        std::cout << Color::WHITE << "\xe2\x95\x91 " << Color::DIM << "No log entries yet."
-                  << std::setw(40) << "" << Color::WHITE << "\xe2\x95\x91" << Color::RESET << "\n";
+    // Last 15 matches, from the journal when there is one
+    std::vector<LogEntry> shown;
+    uint64_t matches = 0;
+    double millis = 0.0;
+    if (state.journal) {
+        auto start = std::chrono::steady_clock::now();
+        matches = state.journal->query(filter, 15, shown);
+        millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    } else {
+        for (size_t i = 0; i < state.operatorLog.size(); ++i) {
+            if (filter.matches(state.operatorLog[i])) shown.push_back(state.operatorLog[i]);
+        }
+        matches = shown.size();
+        if (shown.size() > 15) shown.erase(shown.begin(), shown.end() - 15);
+    }
+
+    if (shown.empty()) {
+        const char* empty = filter.filtered() ? "No matching log entries." : "No log entries yet.";
+        std::cout << Color::WHITE << "\xe2\x95\x91 " << Color::DIM << empty
+                  << std::setw(59 - static_cast<int>(std::strlen(empty))) << "" << Color::WHITE << "\xe2\x95\x91" << Color::RESET << "\n";
     } else {
-        // Show last 15 entries
-        int start = std::max(0, static_cast<int>(state.operatorLog.size()) - 15);
-        for (size_t i = start; i < state.operatorLog.size(); ++i) {
-            const auto& entry = state.operatorLog[i];
-            std::string color;
-            std::string prefix;
-            if (entry.type == "CRITICAL") { color = Color::RED; prefix = "!!"; }
-            else if (entry.type == "WARNING") { color = Color::YELLOW; prefix = "!!"; }
-            else if (entry.type == "EVENT") { color = Color::CYAN; prefix = ">>"; }
-            else { color = Color::GREEN; prefix = ">>"; }
+        char message[64];
+        for (const LogEntry& entry : shown) {
+            const char* color;
+            const char* prefix;
+            switch (entry.type) {
+                case LogType::CRITICAL: color = Color::RED; prefix = "!!"; break;
+                case LogType::WARNING: color = Color::YELLOW; prefix = "!!"; break;
+                case LogType::EVENT: color = Color::CYAN; prefix = ">>"; break;
+                default: color = Color::GREEN; prefix = ">>"; break;
+            }
+            formatLogEntry(entry, message, sizeof(message));
 
             std::cout << Color::WHITE << "\xe2\x95\x91 " << Color::DIM << "[T" << std::setw(3) << entry.turn << "] "
-                      << Color::RESET << color << prefix << " " << entry.message << Color::RESET;
+                      << Color::RESET << color << prefix << " " << message << Color::RESET;
 
-            int padding = 48 - static_cast<int>(entry.message.length());
+            int padding = 48 - static_cast<int>(std::strlen(message));
             if (padding > 0) std::cout << std::setw(padding) << "";
             std::cout << Color::WHITE << "\xe2\x95\x91" << Color::RESET << "\n";
         }
     }
 
+    std::ostringstream footer;
+    if (filter.filtered()) {
+        footer << " Matches: " << matches << " of " << (state.journal ? state.journal->size() : state.operatorLog.size());
+    } else {
+        footer << " Total Entries: " << std::left << std::setw(4) << matches;
+    }
+    if (state.journal) footer << "  (" << std::fixed << std::setprecision(2) << millis << " ms)";
+    int footerPadding = std::max(0, 58 - static_cast<int>(footer.str().size()));
+
     std::cout << Color::BOLD << Color::WHITE
               << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3\n"
-              << "\xe2\x95\x91 Total Entries: " << std::setw(4) << state.operatorLog.size()
-              << std::setw(38) << "" << "\xe2\x95\x91\n"
+              << "\xe2\x95\x91" << footer.str() << std::setw(footerPadding) << "" << "\xe2\x95\x91\n"
               << "\xe2\x95\x9a\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x9d"
               << Color::RESET << "\n\n";
 
@@ -323,6 +543,29 @@ void Renderer::displayLog(const ReactorState& state) {
     std::getline(std::cin, dummy);
 }
 
+void Renderer::displaySlots() {
+    std::cout << "\n" << Color::BOLD << Color::WHITE << "\xf0\x9f\x92\xbe SAVE SLOTS" << Color::RESET << "\n";
+    for (int slot = 0; slot < RC::SAVE_SLOTS; ++slot) {
+        SaveSlotInfo info = PersistenceSystem::slotInfo(slot);
+        std::cout << "  " << slot << (slot == RC::AUTOSAVE_SLOT ? " (auto) " : "        ");
+        if (info.status == LoadResult::MISSING) {
+            std::cout << Color::DIM << "empty" << Color::RESET << "\n";
+        } else if (info.status == LoadResult::OK) {
+            char when[32] = "";
+            std::time_t savedAt = static_cast<std::time_t>(info.savedAt);
+            const std::tm* local = std::localtime(&savedAt);
+            if (local) std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M", local);
+            std::cout << std::left << std::setw(10) << getDifficultySettings(info.difficulty).name << std::right
+                      << " turn " << std::setw(5) << info.turns << "  score " << std::setw(7) << info.score
+                      << "  " << Color::DIM << when << Color::RESET << "\n";
+        } else {
+            std::cout << Color::RED << (info.status == LoadResult::DAMAGED ? "damaged" : "incompatible version")
+                      << Color::RESET << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
 void Renderer::displayStatistics(const ReactorState& state) {
     std::cout << "\n" << Color::BOLD << Color::BLUE
               << "\xe2\x95\x94\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x97\n"
@@ -363,6 +606,23 @@ void Renderer::displayStatistics(const ReactorState& state) {
               << std::setw(11) << state.criticalEvents
               << std::setw(28) << "" << Color::BLUE << "\xe2\x95\x91" << Color::RESET << "\n";
 
+    if (state.distributions && state.distributions->sketch(Distribution::TEMPERATURE).count() > 0) {
+        std::string title = "DISTRIBUTIONS (" +
+            std::to_string(state.distributions->sketch(Distribution::TEMPERATURE).count()) + " turns):";
+        std::cout << Color::BLUE << "\xe2\x95\x91 " << Color::RESET << Color::BOLD << title << Color::RESET
+                  << std::setw(std::max(0, 59 - static_cast<int>(title.size()))) << "" << Color::BLUE
+                  << "\xe2\x95\x91" << Color::RESET << "\n";
+        char lines[1 + static_cast<int>(Distribution::DISTRIBUTION_COUNT)][96];
+        int count = formatDistributions(*state.distributions, lines);
+        for (int i = 0; i < count; ++i) {
+            std::cout << Color::BLUE << "\xe2\x95\x91 " << Color::RESET << "  " << lines[i]
+                      << std::setw(std::max(0, 57 - static_cast<int>(std::strlen(lines[i])))) << ""
+                      << Color::BLUE << "\xe2\x95\x91" << Color::RESET << "\n";
+        }
+    }
+
+    if (state.trends && state.trends->newestTurn() >= 0) displayTrendTable(*state.trends);
+
     // Calculate efficiency rating
     double efficiency = 0.0;
     if (state.turns > 0) {
@@ -394,6 +654,74 @@ void Renderer::displayStatistics(const ReactorState& state) {
     std::getline(std::cin, dummy);
 }
 
+void Renderer::displayTrendTable(const TrendHistory& trends) {
+    int window = trends.window();
+    int span = trends.newestTurn() - trends.oldestTurn() + 1;
+    std::string title = window > 0 ? "TRENDS (last " + std::to_string(std::min(window, span)) + " turns):"
+                                   : "TRENDS (whole session, " + std::to_string(span) + " turns):";
+    std::cout << Color::BLUE << "\xe2\x95\x91 " << Color::RESET << Color::BOLD << title << Color::RESET
+              << std::setw(std::max(0, 59 - static_cast<int>(title.size()))) << "" << Color::BLUE << "\xe2\x95\x91"
+              << Color::RESET << "\n";
+    std::cout << Color::BLUE << "\xe2\x95\x91 " << Color::RESET << std::right << std::setw(40) << "min"
+              << std::setw(8) << "avg" << std::setw(8) << "max" << std::setw(3) << "" << Color::BLUE
+              << "\xe2\x95\x91" << Color::RESET << "\n";
+
+    // One pass per series: the buckets make the sparkline and, merged, the window's summary
+    TrendSummary buckets[TR::SPARK_WIDTH];
+    unsigned char levels[TR::SPARK_WIDTH];
+    for (int i = 0; i < static_cast<int>(Trend::TREND_COUNT); ++i) {
+        Trend series = static_cast<Trend>(i);
+        trends.query(series, window, buckets, TR::SPARK_WIDTH);
+        sparkLevels(buckets, levels);
+        TrendSummary total;
+        for (const TrendSummary& bucket : buckets) total.merge(bucket);
+
+        char text[3][24];
+        double readings[3] = {total.min, total.mean(), total.max};
+        for (int k = 0; k < 3; ++k) {
+            // Neutron counts and scores outgrow the columns in fixed notation
+            std::snprintf(text[k], sizeof(text[k]), std::fabs(readings[k]) < 1e5 ? "%8.1f" : "%8.2g", readings[k]);
+        }
+        std::cout << Color::BLUE << "\xe2\x95\x91 " << Color::RESET << "  " << std::left << std::setw(13)
+                  << getTrendInfo(series).name << std::right << Color::DIM;
+        printSparkline(std::cout, levels);
+        std::cout << Color::RESET << " " << text[0] << text[1] << text[2] << std::setw(3) << ""
+                  << Color::BLUE << "\xe2\x95\x91" << Color::RESET << "\n";
+    }
+
+    char storage[80];
+    size_t sealed = trends.sealedTurns();
+    if (sealed > 0) {
+        std::snprintf(storage, sizeof(storage), "  %zu turns, %.1f KB sealed: %.1f bits per reading",
+                      trends.turns(), trends.bytes() / 1024.0,
+                      trends.bytes() * 8.0 / (sealed * static_cast<double>(Trend::TREND_COUNT)));
+    } else {
+        std::snprintf(storage, sizeof(storage), "  %zu turns, none sealed yet", trends.turns());
+    }
+    std::cout << Color::BLUE << "\xe2\x95\x91 " << Color::RESET << Color::DIM << storage << Color::RESET
+              << std::setw(std::max(0, 59 - static_cast<int>(std::strlen(storage)))) << "" << Color::BLUE
+              << "\xe2\x95\x91" << Color::RESET << "\n";
+}
+
+int Renderer::formatDistributions(const TurnDistributions& distributions, char (*lines)[96]) {
+    std::snprintf(lines[0], sizeof(lines[0]), "%-10s%7s%7s%7s%7s %s", "", "p50", "p95", "p99", "past", "limit");
+    const double ranks[3] = {0.5, 0.95, 0.99};
+    int count = static_cast<int>(Distribution::DISTRIBUTION_COUNT);
+    for (int i = 0; i < count; ++i) {
+        Distribution series = static_cast<Distribution>(i);
+        double values[3];
+        distributions.sketch(series).quantiles(ranks, values, 3);
+        char text[3][16];
+        for (int k = 0; k < 3; ++k) {
+            std::snprintf(text[k], sizeof(text[k]), std::fabs(values[k]) < 1e5 ? "%7.1f" : "%7.2g", values[k]);
+        }
+        const DistributionInfo& info = getDistributionInfo(series);
+        std::snprintf(lines[i + 1], sizeof(lines[i + 1]), "%-10s%s%s%s%6.1f%% %s", info.name, text[0], text[1],
+                      text[2], distributions.pastShare(series) * 100.0, info.limit);
+    }
+    return count + 1;
+}
+
 void Renderer::displayFinalScore(ReactorState& state) {
     const AchievementInfo* infoTable = getAchievementInfoTable();
 
@@ -415,15 +743,29 @@ void Renderer::displayFinalScore(ReactorState& state) {
     std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET << "Final Score: "
               << std::setw(37) << state.score << Color::CYAN << " \xe2\x95\x91" << Color::RESET << "\n";
     std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET << "High Score (" << state.currentDifficulty.name << "): "
-              << std::setw(33 - static_cast<int>(state.currentDifficulty.name.length())) << state.highScore
+              << std::setw(33 - static_cast<int>(std::strlen(state.currentDifficulty.name))) << state.highScore
               << Color::CYAN << " \xe2\x95\x91" << Color::RESET << "\n";
 
+    if (state.distributions && state.distributions->sketch(Distribution::TEMPERATURE).count() > 0) {
+        std::cout << Color::CYAN << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3" << Color::RESET << "\n";
+        std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "TURN DISTRIBUTIONS:" << Color::RESET
+                  << std::setw(31) << "" << Color::CYAN << " \xe2\x95\x91" << Color::RESET << "\n";
+        char lines[1 + static_cast<int>(Distribution::DISTRIBUTION_COUNT)][96];
+        int count = formatDistributions(*state.distributions, lines);
+        for (int i = 0; i < count; ++i) {
+            std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::RESET << lines[i]
+                      << std::setw(std::max(0, 50 - static_cast<int>(std::strlen(lines[i])))) << ""
+                      << Color::CYAN << " \xe2\x95\x91" << Color::RESET << "\n";
+        }
+    }
+
     if (!state.sessionAchievements.empty()) {
         std::cout << Color::CYAN << "\xe2\x95\xa0\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\x90\xe2\x95\xa3" << Color::RESET << "\n";
         std::cout << Color::CYAN << "\xe2\x95\x91 " << Color::BOLD << "ACHIEVEMENTS UNLOCKED THIS SESSION:" << Color::RESET
                   << std::setw(15) << "" << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
-        for (const auto& ach : state.sessionAchievements) {
-            const auto& info = infoTable[static_cast<int>(ach)];
+        for (int i = 0; i < static_cast<int>(Achievement::ACHIEVEMENT_COUNT); ++i) {
+            if (!state.sessionAchievements.contains(static_cast<Achievement>(i))) continue;
+            const auto& info = infoTable[i];
             std::cout << Color::CYAN << "\xe2\x95\x91   " << Color::GREEN << info.icon << " " << info.name << Color::RESET
                       << std::setw(37 - static_cast<int>(info.name.length())) << ""
                       << Color::CYAN << "\xe2\x95\x91" << Color::RESET << "\n";
@@ -439,7 +781,7 @@ void Renderer::displayFinalScore(ReactorState& state) {
     }
 }
 
-void Renderer::displayContextualTip(ReactorState& state) {
+void Renderer::displayContextualTip(ReactorState& state, std::ostream& out) {
     if (!state.tipsEnabled || state.turns - state.lastTipTurn < 5) return;
 
     std::string tip;
@@ -480,12 +822,13 @@ void Renderer::displayContextualTip(ReactorState& state) {
                 "TIP: Higher difficulty means faster fuel depletion and more events."
             };
             std::uniform_int_distribution<size_t> tipDist(0, generalTips.size() - 1);
-            tip = generalTips[tipDist(state.rng)];
+            CounterRng rng = state.rngStream(RngStream::UI);
+            tip = generalTips[tipDist(rng)];
         }
     }
 
     if (!tip.empty()) {
-        std::cout << Color::DIM << Color::CYAN << tip << Color::RESET << "\n";
+        out << Color::DIM << Color::CYAN << tip << Color::RESET << "\n";
         state.lastTipTurn = state.turns;
     }
 }
@@ -501,11 +844,233 @@ void Renderer::displayBanner(const ReactorState& state) {
               << Color::RESET;
 }
 
+void Renderer::formatMessage(std::ostream& out, const GameMessage& msg) {
+    // Every message starts from default number formatting
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out.flags(std::ios::fmtflags());
+    out.precision(6);
+
+    switch (msg.code) {
+        case MessageCode::COOLANT_CRITICAL:
+            out << Color::BG_RED << Color::WHITE << Color::BOLD
+                << "!!! WARNING: Coolant is critically low! !!!" << Color::RESET << "\n";
+            break;
+        case MessageCode::AUTO_SCRAM:
+            out << "\n" << Color::BG_RED << Color::WHITE << Color::BOLD
+                << "*** AUTO SCRAM! Emergency shutdown! ***" << Color::RESET << "\n";
+            break;
+        case MessageCode::SCRAM_PENALTY:
+            out << Color::RED << "Score penalty: -" << static_cast<int>(msg.value) << " points" << Color::RESET << "\n";
+            break;
+        case MessageCode::MELTDOWN:
+            out << "\n" << Color::BG_RED << Color::WHITE << Color::BOLD
+                << "!!! MELTDOWN !!! Core has gone critical. Game Over." << Color::RESET << "\n";
+            break;
+        case MessageCode::XENON_POISONING:
+            out << Color::MAGENTA << Color::BOLD
+                << "\xe2\x98\xa2 XENON POISONING: High Xe-135 levels affecting reactivity!" << Color::RESET << "\n";
+            break;
+        case MessageCode::RELIEF_VALVE_OPENED:
+            out << Color::YELLOW << Color::BOLD << "\xf0\x9f\x94\xa7 PRESSURE RELIEF VALVE opened at "
+                << std::fixed << std::setprecision(1) << msg.value << " bar!" << Color::RESET << "\n";
+            break;
+        case MessageCode::RELIEF_VALVE_CLOSED:
+            out << Color::GREEN << "\xe2\x9c\x93 Pressure relief valve closed. Pressure stabilized." << Color::RESET << "\n";
+            break;
+        case MessageCode::PIPE_RUPTURE:
+            out << Color::BG_RED << Color::WHITE << Color::BOLD
+                << " \xf0\x9f\x92\xa5 STEAM PIPE RUPTURE! Critical pressure exceeded! " << Color::RESET << "\n";
+            break;
+        case MessageCode::TURBINE_TOO_COLD:
+            out << Color::YELLOW << "\xe2\x9a\xa0 Turbine cannot operate below " << RC::MIN_TURBINE_TEMP << "\xc2\xb0""C!" << Color::RESET << "\n";
+            break;
+        case MessageCode::HIGH_STEAM_PRESSURE:
+            out << Color::RED << "\xe2\x9a\xa0 HIGH STEAM PRESSURE: " << std::fixed << std::setprecision(1) << msg.value
+                << " bar (max " << RC::MAX_STEAM_PRESSURE << ")" << Color::RESET << "\n";
+            break;
+        case MessageCode::RADIATION_CRITICAL:
+            out << Color::BG_RED << Color::WHITE << Color::BOLD << " \xe2\x98\xa2 RADIATION CRITICAL: "
+                << std::fixed << std::setprecision(1) << msg.value << " mSv/h - EVACUATE! " << Color::RESET << "\n";
+            break;
+        case MessageCode::RADIATION_HIGH:
+            out << Color::RED << Color::BOLD << "\xe2\x98\xa2 HIGH RADIATION: "
+                << std::fixed << std::setprecision(1) << msg.value << " mSv/h" << Color::RESET << "\n";
+            break;
+        case MessageCode::RADIATION_ELEVATED:
+            out << Color::YELLOW << "\xe2\x9a\xa0 Elevated radiation: "
+                << std::fixed << std::setprecision(1) << msg.value << " mSv/h" << Color::RESET << "\n";
+            break;
+        case MessageCode::CONTAINMENT_BREACH:
+            out << Color::BG_RED << Color::WHITE << Color::BOLD
+                << " \xe2\x9a\xa0 CONTAINMENT BREACH! Structural integrity critical! " << Color::RESET << "\n";
+            break;
+        case MessageCode::CONTAINMENT_WARNING:
+            out << Color::RED << "\xe2\x9a\xa0 CONTAINMENT WARNING: Integrity at "
+                << std::fixed << std::setprecision(1) << msg.value << "%" << Color::RESET << "\n";
+            break;
+        case MessageCode::CONTAINMENT_RESTORED:
+            out << Color::GREEN << "\xe2\x9c\x93 Containment integrity restored!" << Color::RESET << "\n";
+            break;
+        case MessageCode::ECCS_RECHARGED:
+            out << Color::GREEN << "\xe2\x9c\x93 ECCS recharged and ready!" << Color::RESET << "\n";
+            break;
+        case MessageCode::ECCS_COOLDOWN:
+            out << Color::RED << "\xe2\x9c\x97 ECCS on cooldown! " << msg.detail << " turns remaining." << Color::RESET << "\n";
+            break;
+        case MessageCode::ECCS_ACTIVATED:
+            out << Color::BG_BLUE << Color::WHITE << Color::BOLD
+                << " \xf0\x9f\x9a\xa8 ECCS ACTIVATED! +" << RC::ECCS_COOLANT_BOOST << "% coolant, -" << RC::ECCS_TEMP_REDUCTION << "\xc2\xb0""C "
+                << Color::RESET << "\n";
+            break;
+        case MessageCode::ECCS_PENALTY:
+            out << Color::RED << "(-" << static_cast<int>(msg.value) << " points)" << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_AUTO_START:
+            out << Color::YELLOW << Color::BOLD
+                << "\xf0\x9f\x94\x8c DIESEL GENERATOR auto-started! Low power detected." << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_FUEL_LOW:
+            out << Color::YELLOW << "\xe2\x9a\xa0 Diesel fuel low: "
+                << std::fixed << std::setprecision(1) << msg.value << "%" << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_OUT_OF_FUEL:
+            out << Color::RED << Color::BOLD
+                << "\xe2\x9a\xa0 DIESEL GENERATOR stopped - OUT OF FUEL!" << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_NO_FUEL:
+            out << Color::RED << "\xe2\x9c\x97 Cannot start diesel generator - no fuel!" << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_STARTED:
+            out << Color::GREEN << "\xf0\x9f\x94\x8c Diesel generator started manually." << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_STOPPED:
+            out << Color::YELLOW << "\xf0\x9f\x94\x8c Diesel generator stopped." << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_TANK_FULL:
+            out << Color::YELLOW << "Diesel tank already full." << Color::RESET << "\n";
+            break;
+        case MessageCode::DIESEL_REFILLED:
+            out << Color::GREEN << "\xe2\x9b\xbd Diesel tank refilled!" << Color::RESET << "\n";
+            break;
+        case MessageCode::CATALOG_EVENT: {
+            const EventCatalog& catalog = EventCatalog::active();
+            char text[EC::TEXT_SIZE];
+            catalog.formatText(msg.detail, msg.value, text, sizeof(text));
+            out << catalog.textColor(msg.detail) << Color::BOLD << text << Color::RESET << "\n";
+            break;
+        }
+        case MessageCode::GRID_CRITICAL:
+            out << Color::RED << Color::BOLD << "\xe2\x9a\xa0 GRID ALERT: Power output critically below demand! ("
+                << std::fixed << std::setprecision(0) << msg.value << "%)" << Color::RESET << "\n";
+            break;
+        case MessageCode::GRID_LOW:
+            out << Color::YELLOW << "\xe2\x9a\xa0 Low grid satisfaction: "
+                << std::fixed << std::setprecision(0) << msg.value << "%" << Color::RESET << "\n";
+            break;
+        case MessageCode::WEATHER_CHANGE: {
+            const WeatherInfo& info = getWeatherInfo(static_cast<Weather>(msg.detail));
+            out << Color::CYAN << "\xf0\x9f\x8c\xa1\xef\xb8\x8f Weather change: " << info.icon << " " << info.name
+                << Color::DIM << " - " << info.description << Color::RESET << "\n";
+            break;
+        }
+        case MessageCode::LIGHTNING_STRIKE:
+            out << Color::YELLOW << Color::BOLD << "\xe2\x9a\xa1 LIGHTNING STRIKE near the facility!" << Color::RESET << "\n";
+            break;
+        case MessageCode::LIGHTNING_TURBINE:
+            out << Color::YELLOW << "   Turbine RPM fluctuation" << Color::RESET << "\n";
+            break;
+        case MessageCode::LIGHTNING_SENSORS:
+            out << Color::YELLOW << "   Minor sensor interference" << Color::RESET << "\n";
+            break;
+        case MessageCode::LIGHTNING_GRID:
+            out << Color::RED << "   External power grid disruption!" << Color::RESET << "\n";
+            break;
+        case MessageCode::LIGHTNING_DIESEL_START:
+            out << Color::GREEN << "   Diesel generator auto-started." << Color::RESET << "\n";
+            break;
+        case MessageCode::ACHIEVEMENT_UNLOCKED: {
+            const AchievementInfo& info = getAchievementInfoTable()[msg.detail];
+            out << "\n" << Color::BG_MAGENTA << Color::WHITE << Color::BOLD
+                << " " << info.icon << " ACHIEVEMENT UNLOCKED: " << info.name << "! " << Color::RESET << "\n";
+            out << Color::MAGENTA << "   " << info.description << Color::RESET << "\n\n";
+            break;
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void Renderer::formatLogEntry(const LogEntry& entry, char* text, size_t size) {
+    uint16_t code = static_cast<uint16_t>(entry.code);
+    if (code >= static_cast<uint16_t>(LogCode::CATALOG_TEXT)) {
+        EventCatalog::active().formatText(code - static_cast<uint16_t>(LogCode::CATALOG_TEXT), entry.payload, text, size);
+        return;
+    }
+    const char* fixed = "";
+    switch (entry.code) {
+        case LogCode::COOLANT_LEAK:
+            std::snprintf(text, size, "Coolant leak detected - %d%% lost", static_cast<int>(entry.payload));
+            return;
+        case LogCode::PIPE_RUPTURE:
+            std::snprintf(text, size, "Steam pipe rupture - pressure exceeded %d bar", static_cast<int>(entry.payload));
+            return;
+        case LogCode::REWOUND:
+            std::snprintf(text, size, "Rewound %d turn%s", static_cast<int>(entry.payload),
+                          entry.payload == 1.0 ? "" : "s");
+            return;
+        case LogCode::WEATHER_CHANGE:
+            std::snprintf(text, size, "Weather changed to %s",
+                          getWeatherInfo(static_cast<Weather>(static_cast<int>(entry.payload))).name);
+            return;
+        case LogCode::COOLANT_REFILLED: fixed = "Coolant system refilled to 100%"; break;
+        case LogCode::TURBINE_ONLINE: fixed = "Turbine brought online"; break;
+        case LogCode::TURBINE_OFFLINE: fixed = "Turbine taken offline"; break;
+        case LogCode::DIESEL_AUTO_ENABLED: fixed = "Diesel auto-start enabled"; break;
+        case LogCode::DIESEL_AUTO_DISABLED: fixed = "Diesel auto-start disabled"; break;
+        case LogCode::AUTOPILOT_ENGAGED: fixed = "Autopilot engaged"; break;
+        case LogCode::AUTOPILOT_DISENGAGED: fixed = "Autopilot disengaged"; break;
+        case LogCode::PAUSED: fixed = "Simulation paused by operator"; break;
+        case LogCode::RESUMED: fixed = "Simulation resumed"; break;
+        case LogCode::ECCS_ACTIVATED: fixed = "ECCS activated - emergency cooling"; break;
+        case LogCode::DIESEL_AUTO_START: fixed = "Diesel generator auto-started"; break;
+        case LogCode::DIESEL_OUT_OF_FUEL: fixed = "Diesel generator stopped - fuel depleted"; break;
+        case LogCode::DIESEL_STARTED: fixed = "Diesel generator started manually"; break;
+        case LogCode::DIESEL_STOPPED: fixed = "Diesel generator stopped"; break;
+        case LogCode::DIESEL_REFILLED: fixed = "Diesel fuel tank refilled"; break;
+        case LogCode::CONTAINMENT_BREACH: fixed = "Containment breach detected"; break;
+        case LogCode::CONTAINMENT_RESTORED: fixed = "Containment integrity restored"; break;
+        case LogCode::POWER_SURGE: fixed = "Power surge - temperature spike"; break;
+        case LogCode::PUMP_FAILURE: fixed = "Coolant pump failure"; break;
+        case LogCode::XENON_SPIKE: fixed = "Xenon-135 spike detected"; break;
+        case LogCode::STEAM_LEAK_TURBINE: fixed = "Steam leak in turbine hall"; break;
+        case LogCode::STEAM_LEAK_BUILDING: fixed = "Steam leak in reactor building"; break;
+        case LogCode::TURBINE_TRIP: fixed = "Turbine trip - emergency shutdown"; break;
+        case LogCode::EFFICIENCY_BONUS: fixed = "Efficiency improvement bonus"; break;
+        case LogCode::COOLANT_DELIVERY: fixed = "Coolant delivery received"; break;
+        case LogCode::MAINTENANCE_CREW: fixed = "Maintenance crew performed repairs"; break;
+        case LogCode::RADIATION_CRITICAL: fixed = "Radiation level critical - evacuation recommended"; break;
+        case LogCode::RADIATION_ELEVATED: fixed = "Elevated radiation levels detected"; break;
+        case LogCode::SCRAM_TEMPERATURE: fixed = "AUTO SCRAM triggered - temperature exceeded limit"; break;
+        case LogCode::SCRAM_NEUTRONS: fixed = "AUTO SCRAM triggered - neutron flux exceeded limit"; break;
+        case LogCode::SCRAM_CLAD: fixed = "AUTO SCRAM triggered - clad temperature exceeded limit"; break;
+        case LogCode::MELTDOWN: fixed = "MELTDOWN - Core destruction"; break;
+        case LogCode::RELIEF_VALVE_OPENED: fixed = "Pressure relief valve opened"; break;
+        case LogCode::RELIEF_VALVE_CLOSED: fixed = "Pressure relief valve closed"; break;
+        case LogCode::LIGHTNING_STRIKE: fixed = "Lightning strike detected"; break;
+        case LogCode::CATALOG_EVENT: fixed = "Catalog event"; break;
+        case LogCode::CATALOG_TEXT: break;  // Handled above
+    }
+    std::snprintf(text, size, "%s", fixed);
+}
+
 void Renderer::drainMessages(ReactorState& state) {
-    for (const auto& msg : state.messages) {
-        std::cout << msg.text;
-        if (msg.triggerSound) Sound::beep();
-        if (msg.triggerAlert) Sound::alert();
+    for (size_t i = 0; i < state.messages.size(); ++i) {
+        const GameMessage& msg = state.messages[i];
+        formatMessage(std::cout, msg);
+        if (msg.severity == Severity::CRITICAL) Sound::beep();
+        if (msg.severity == Severity::ALARM) Sound::alert();
     }
     state.clearMessages();
 }
@@ -1,24 +1,82 @@
 #pragma once
 
 #include "reactor_state.h"
+#include "spatial.h"
+#include "subchannel.h"
+#include "trends.h"
+#include "quantiles.h"
+#include "autopilot.h"
 
 #include <string>
+#include <iostream>
+
+struct TickStats;
+
+// What displayStatus shows of the optional core models and the autopilot,
+// copied out so a dashboard can be drawn while the models keep running
+struct ModelReadout {
+    bool spatial;
+    int nx, ny, nz;
+    double keff;
+    double banks[SC::BANKS];
+    double peaking;
+    double axialOffset;
+    bool poisons;  // Depletion chain: xenon and samarium relative to equilibrium
+    double xenon;
+    double samarium;
+    int channelCount;  // 0 without the subchannel model
+    ChannelSummary channels;
+    bool autopilot;  // Auto mode engaged, with the plan behind the last rod setting
+    AutopilotPlan plan;
+};
+
+// Sparklines beside the dashboard bars, computed from the trend history by
+// whoever owns it
+struct TrendReadout {
+    static constexpr int SERIES = 9;  // Temp through Diesel, in bar order
+
+    int window;  // Turns covered; 0 without a trend history
+    unsigned char levels[SERIES][TR::SPARK_WIDTH];  // 1-8, or 0 for no turns
+};
 
 class Renderer {
 public:
-    static void displayDashboard(const ReactorState& state);
-    static void displayScore(const ReactorState& state);
-    static void displayStatus(const ReactorState& state);
+    // The dashboard frame; a render thread passes its own stream
+    static void displayDashboard(const ReactorState& state, std::ostream& out = std::cout);
+    static void displayDashboard(const ReactorState& state, const TrendReadout& trends, std::ostream& out);
+    static void readTrends(const ReactorState& state, TrendReadout& trends);
+    static void displayScore(const ReactorState& state, std::ostream& out = std::cout);
+    static void displayStatus(const ReactorState& state, std::ostream& out = std::cout);
+    static void displayStatus(const ReactorState& state, const ModelReadout& models, std::ostream& out);
+    static void readModels(const ReactorState& state, ModelReadout& models);
+    // Tick rate, jitter and missed deadlines of a real-time session, and
+    // snapshots the render thread skipped (when staleFrames >= 0)
+    static void displayClock(const TickStats& clock, std::ostream& out = std::cout, long long staleFrames = -1);
+    static void displayClockSummary(const TickStats& clock);
     static void displayHelp(const ReactorState& state);
     static void displayAchievements(const ReactorState& state);
-    static void displayLog(const ReactorState& state);
+    static void displayLog(const ReactorState& state, const LogFilter& filter = LogFilter());
+    static void displaySlots();
     static void displayStatistics(const ReactorState& state);
     static void displayFinalScore(ReactorState& state);
-    static void displayContextualTip(ReactorState& state);
+    static void displayContextualTip(ReactorState& state, std::ostream& out = std::cout);
     static void displayBanner(const ReactorState& state);
     static void drainMessages(ReactorState& state);
 
+    // Text of one queued event, as drainMessages prints it
+    static void formatMessage(std::ostream& out, const GameMessage& msg);
+    // Text of one operator log entry
+    static void formatLogEntry(const LogEntry& entry, char* text, size_t size);
+
 private:
     static std::string getBarColor(double value, double max, bool inverse = false);
-    static void printBar(const std::string& label, double value, double max, int width = 18, bool inverse = false);
+    static void printBar(std::ostream& out, const std::string& label, double value, double max, int width = 18,
+                         bool inverse = false, const unsigned char* trend = nullptr);
+    static void printSparkline(std::ostream& out, const unsigned char* levels);
+    // Sparkline and min/avg/max of every trend series over the selected window
+    static void displayTrendTable(const TrendHistory& trends);
+    // Bucket means as sparkline levels 1-8, scaled to their own range
+    static void sparkLevels(const TrendSummary* buckets, unsigned char* levels);
+    // A header and one p50/p95/p99 and past-limit line per distribution, 50 columns each
+    static int formatDistributions(const TurnDistributions& distributions, char (*lines)[96]);
 };
@@ -0,0 +1,465 @@
+#include "replay.h"
+#include "input.h"
+#include "physics.h"
+#include "events.h"
+#include "safety.h"
+#include "history.h"
+#include "models.h"
+#include "mapped_file.h"
+#include "crc32.h"
+#include "perf.h"
+#include "autopilot.h"
+#include "event_catalog.h"
+#include "byte_stream.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace {
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t snapshotBytes;
+    int32_t difficulty;
+    uint64_t seed;
+    int64_t recordedAt;
+    int32_t kinetics;
+    int32_t spatialNx;
+    int32_t spatialNy;
+    int32_t spatialNz;
+    int32_t channels;
+    int32_t depletion;
+    uint32_t events;  // EventCatalog checksum
+    uint32_t snapshotVersion;
+};
+
+struct RecordHeader {
+    uint8_t kind;
+    uint8_t reserved[3];
+    uint32_t size;    // Payload bytes
+    uint32_t turn;    // Session turns completed before this record
+    uint32_t millis;  // Since the recording started
+};
+
+struct EndRecord {
+    uint32_t hash;
+    int32_t turns;
+    int32_t score;
+};
+
+struct IndexTrailer {
+    uint64_t offset;  // Of the first index entry
+    uint32_t count;
+    uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 64 && sizeof(RecordHeader) == 16 && sizeof(IndexTrailer) == 16,
+              "recording layout");
+
+class Hasher {
+public:
+    Hasher() : crc(0) {}
+    template <typename T>
+    void add(const T& value) { crc = crc32c(&value, sizeof(value), crc); }
+    uint32_t value() const { return crc; }
+
+private:
+    uint32_t crc;
+};
+
+// Records from `offset` that fit in the file, or false at the end
+bool readRecord(const MappedFile& file, uint64_t offset, RecordHeader& record, const unsigned char*& payload) {
+    if (offset > file.size() || file.size() - offset < sizeof(record)) return false;
+    std::memcpy(&record, file.data() + offset, sizeof(record));
+    if (file.size() - offset - sizeof(record) < record.size) return false;
+    payload = file.data() + offset + sizeof(record);
+    return true;
+}
+
+// The index written when the session closed, or a scan of the records when
+// it did not (the session crashed or was killed)
+void loadIndex(const MappedFile& file, std::vector<RP::IndexEntry>& index) {
+    index.clear();
+    IndexTrailer trailer;
+    if (file.size() >= sizeof(FileHeader) + sizeof(trailer)) {
+        std::memcpy(&trailer, file.data() + file.size() - sizeof(trailer), sizeof(trailer));
+        uint64_t end = file.size() - sizeof(trailer);
+        if (trailer.magic == RP::INDEX_MAGIC && trailer.offset <= end &&
+            (end - trailer.offset) / sizeof(RP::IndexEntry) == trailer.count) {
+            const unsigned char* entries = file.data() + trailer.offset;
+            index.assign(reinterpret_cast<const RP::IndexEntry*>(entries),
+                         reinterpret_cast<const RP::IndexEntry*>(entries) + trailer.count);
+            return;
+        }
+    }
+    RecordHeader record;
+    const unsigned char* payload;
+    for (uint64_t offset = sizeof(FileHeader); readRecord(file, offset, record, payload);
+         offset += sizeof(record) + record.size) {
+        if (record.kind == RP::KEYFRAME || record.kind == RP::RESYNC) {
+            index.push_back(RP::IndexEntry{record.turn, 0, offset});
+        }
+        if (record.kind == RP::END) break;
+    }
+}
+
+// Spatial, depletion and channel model state, each as a byte count and its saveState()
+void saveModels(const ReactorState& state, std::vector<unsigned char>& out) {
+    std::vector<unsigned char> model;
+    for (int m = 0; m < 3; ++m) {
+        model.clear();
+        if (m == 0 && state.spatial) state.spatial->saveState(model);
+        if (m == 1 && state.depletion) state.depletion->saveState(model);
+        if (m == 2 && state.channels) state.channels->saveState(model);
+        putValue(out, static_cast<uint64_t>(model.size()));
+        putBytes(out, model.data(), model.size());
+    }
+}
+
+bool loadModels(ReactorState& state, const unsigned char* data, size_t size) {
+    ByteReader in(data, size);
+    const unsigned char* model = data;
+    for (int m = 0; m < 3; ++m) {
+        uint64_t bytes;
+        if (!in.value(bytes)) return false;
+        model += sizeof(bytes);
+        if (!in.skip(bytes)) return false;
+        bool loaded = bytes == 0;  // Models the session did not attach
+        if (m == 0 && state.spatial) loaded = state.spatial->loadState(model, bytes);
+        if (m == 1 && state.depletion) loaded = state.depletion->loadState(model, bytes);
+        if (m == 2 && state.channels) loaded = state.channels->loadState(model, bytes);
+        if (!loaded) return false;
+        model += bytes;
+    }
+    return in.finished();
+}
+
+// Bring in a recorded snapshot, and the models' state when the record has
+// it: restoreSnapshot keeps the session's difficulty, achievements and pause
+// state, which a recording reproduces
+bool applySnapshot(ReactorState& state, const unsigned char* data, size_t size) {
+    StateSnapshot snapshot;
+    uint32_t logged;
+    ByteReader in(data, size);
+    if (!in.value(snapshot) || !in.value(logged) || logged > state.operatorLog.capacity()) return false;
+    StateHistory::restoreSnapshot(state, snapshot);
+    state.operatorLog.clear();
+    for (uint32_t i = 0; i < logged; ++i) {
+        if (!in.value(state.operatorLog.push())) return false;
+    }
+    if (snapshot.difficulty >= 0 && snapshot.difficulty <= static_cast<int>(Difficulty::NIGHTMARE)) {
+        state.currentDifficulty = getDifficultySettings(static_cast<Difficulty>(snapshot.difficulty));
+    }
+    state.unlockedAchievements = AchievementSet::fromMask(snapshot.unlockedAchievements);
+    state.sessionAchievements = AchievementSet::fromMask(snapshot.sessionAchievements);
+    state.paused = snapshot.paused != 0;
+    size_t read = sizeof(snapshot) + sizeof(logged) + logged * sizeof(LogEntry);
+    return size == read || loadModels(state, data + read, size - read);
+}
+}
+
+SessionRecorder::SessionRecorder() : file(nullptr), position(0), turns(0) {}
+
+SessionRecorder::~SessionRecorder() {
+    if (file) std::fclose(file);
+}
+
+bool SessionRecorder::open(const std::string& path, const ReactorState& state, const ModelOptions& models) {
+    if (file) std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    FileHeader header{RP::MAGIC, RP::VERSION, static_cast<uint32_t>(sizeof(StateSnapshot)),
+                      static_cast<int32_t>(state.currentDifficulty.level), state.rng.seed,
+                      static_cast<int64_t>(std::time(nullptr)),
+                      models.kinetics, models.spatialNx, models.spatialNy, models.spatialNz,
+                      models.channels, models.depletion, EventCatalog::active().checksum(),
+                      SH::SNAPSHOT_VERSION};
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    position = sizeof(header);
+    turns = 0;
+    keyframes.clear();
+    started = std::chrono::steady_clock::now();
+    snapshot(RP::RESYNC, state);  // Starting state, achievements and high score included
+    return true;
+}
+
+void SessionRecorder::write(RP::Record kind, const void* payload, size_t size, const void* extra, size_t extraSize) {
+    uint32_t millis = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count());
+    RecordHeader record{kind, {0, 0, 0}, static_cast<uint32_t>(size + extraSize), turns, millis};
+    std::fwrite(&record, sizeof(record), 1, file);
+    std::fwrite(payload, 1, size, file);
+    if (extraSize) std::fwrite(extra, 1, extraSize, file);
+    // Flushed per record so a crashed session still replays up to the crash
+    std::fflush(file);
+    position += sizeof(record) + size + extraSize;
+}
+
+void SessionRecorder::snapshot(RP::Record kind, const ReactorState& state) {
+    keyframes.push_back(RP::IndexEntry{turns, 0, position});
+    uint32_t hash = ReplayRunner::stateHash(state);
+    StateSnapshot captured;
+    StateHistory::capture(state, captured);
+    std::vector<unsigned char> body;
+    putValue(body, captured);
+    putValue(body, static_cast<uint32_t>(state.operatorLog.size()));
+    for (size_t i = 0; i < state.operatorLog.size(); ++i) putValue(body, state.operatorLog[i]);
+    // Loads and rewinds also replace the models' state
+    if (kind == RP::RESYNC && (state.spatial || state.channels || state.depletion)) saveModels(state, body);
+    write(kind, &hash, sizeof(hash), body.data(), body.size());
+}
+
+void SessionRecorder::command(const std::string& line) {
+    if (!file) return;
+    write(RP::COMMAND, line.data(), line.size());
+}
+
+void SessionRecorder::resync(const ReactorState& state) {
+    if (!file) return;
+    snapshot(RP::RESYNC, state);
+}
+
+void SessionRecorder::turnCompleted(const ReactorState& state) {
+    if (!file) return;
+    turns++;
+    if (turns % RP::KEYFRAME_TURNS == 0) snapshot(RP::KEYFRAME, state);
+}
+
+void SessionRecorder::close(const ReactorState& state) {
+    if (!file) return;
+    EndRecord end{ReplayRunner::stateHash(state), state.turns, state.score};
+    write(RP::END, &end, sizeof(end));
+    IndexTrailer trailer{position, static_cast<uint32_t>(keyframes.size()), RP::INDEX_MAGIC};
+    std::fwrite(keyframes.data(), sizeof(RP::IndexEntry), keyframes.size(), file);
+    std::fwrite(&trailer, sizeof(trailer), 1, file);
+    std::fclose(file);
+    file = nullptr;
+}
+
+uint32_t ReplayRunner::stateHash(const ReactorState& s) {
+    Hasher h;
+    h.add(static_cast<int>(s.currentDifficulty.level));
+    for (double v : {s.neutrons, s.controlRods, s.temperature, s.coolant, s.power, s.fuel,
+                     s.kinetics.step, s.kinetics.reactivity, s.xenonLevel, s.turbineRPM, s.steamPressure,
+                     s.electricityOutput, s.totalElectricityGenerated, s.dieselFuel, s.radiationLevel,
+                     s.totalRadiationExposure, s.gridDemand, s.demandSatisfaction, s.containmentIntegrity,
+                     s.peakTemperature, s.peakPower, s.peakElectricity, s.totalPowerGenerated,
+                     s.averageTemperature, s.temperatureSum, s.lowestCoolant, s.highestXenon}) {
+        h.add(v);
+    }
+    for (double v : s.kinetics.precursors) h.add(v);
+    for (int v : {s.xenonHandledCount, s.maxTurbineTurns, s.pressureWarnings, s.eccsCooldownTimer,
+                  s.dieselRuntime, s.radiationAlarms, static_cast<int>(s.currentWeather), s.weatherDuration,
+                  s.weatherChangeCooldown, s.demandBonus, s.demandPenalty, s.highSatisfactionTurns,
+                  s.stormsSurvived, s.turnsWithoutPressureRelief, s.safeRadiationTurns, s.score, s.turns,
+                  s.scramCount, s.eventsExperienced, s.turnsWithoutScram, s.scramRecoveries, s.criticalEvents}) {
+        h.add(v);
+    }
+    for (bool v : {s.running, s.kinetics.enabled, s.turbineOnline, s.pressureReliefOpen, s.eccsAvailable,
+                   s.dieselRunning, s.dieselAutoStart, s.containmentBreach, s.paused}) {
+        h.add(v);
+    }
+    for (size_t i = 0; i < s.operatorLog.size(); ++i) {
+        const LogEntry& entry = s.operatorLog[i];
+        h.add(entry.turn);
+        h.add(entry.type);
+        h.add(entry.code);
+        h.add(entry.payload);
+    }
+    for (int i = 0; i < static_cast<int>(Achievement::ACHIEVEMENT_COUNT); ++i) {
+        h.add(s.unlockedAchievements.contains(static_cast<Achievement>(i)));
+        h.add(s.sessionAchievements.contains(static_cast<Achievement>(i)));
+    }
+    h.add(s.rng.seed);
+    h.add(s.rng.runId);
+    h.add(s.rng.turn);
+    for (uint32_t draws : s.rng.draws) h.add(draws);
+    return h.value();
+}
+
+ReplayResult ReplayRunner::run(const std::string& path, long seekTurn) {
+    ReplayResult result{ReplayOutcome::UNREADABLE, 0, 0, 0, 0, 0, 0, 0.0, "", 0, 0, 0, 0.0};
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file(path);
+    FileHeader header;
+    if (file.size() < sizeof(header)) return result;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != RP::MAGIC || header.version != RP::VERSION ||
+        header.snapshotBytes != sizeof(StateSnapshot) || header.snapshotVersion != SH::SNAPSHOT_VERSION ||
+        header.difficulty < 0 || header.difficulty > static_cast<int>(Difficulty::NIGHTMARE)) {
+        return result;
+    }
+    if (header.events != EventCatalog::active().checksum()) {
+        result.outcome = ReplayOutcome::WRONG_EVENTS;
+        return result;
+    }
+    std::vector<RP::IndexEntry> index;
+    loadIndex(file, index);
+    if (index.empty() || index[0].turn != 0) return result;
+
+    ModelOptions models;
+    models.kinetics = header.kinetics != 0;
+    models.spatialNx = header.spatialNx;
+    models.spatialNy = header.spatialNy;
+    models.spatialNz = header.spatialNz;
+    models.channels = header.channels;
+    models.depletion = header.depletion != 0;
+
+    // Keyframes do not hold the spatial, channel or depletion model state, so
+    // sessions using them replay from the start
+    size_t keyframe = 0;
+    bool externalModels = models.spatialNx > 0 || models.channels > 0 || models.depletion;
+    if (seekTurn >= 0 && !externalModels) {
+        auto after = std::upper_bound(index.begin(), index.end(), static_cast<uint64_t>(seekTurn),
+                                      [](uint64_t turn, const RP::IndexEntry& entry) { return turn < entry.turn; });
+        keyframe = static_cast<size_t>(after - index.begin()) - 1;
+    }
+
+    ReactorState state(static_cast<Difficulty>(header.difficulty));
+    state.reseed(header.seed);
+    state.headless = true;
+    CoreModels engines;
+    engines.attach(state, models);
+    // Sessions flown in auto mode need the same controller to come out the same
+    Autopilot autopilot;
+    if (Autopilot::supports(state)) state.autopilot = &autopilot;
+
+    RecordHeader record;
+    const unsigned char* payload;
+    uint64_t offset = index[keyframe].offset;
+    if (!readRecord(file, offset, record, payload) || record.size < sizeof(uint32_t) ||
+        !applySnapshot(state, payload + sizeof(uint32_t), record.size - sizeof(uint32_t))) {
+        return result;
+    }
+    offset += sizeof(record) + record.size;
+
+    // Commands print as they would interactively; nobody is watching
+    std::ios format(nullptr);
+    format.copyfmt(std::cout);
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+
+    result.outcome = ReplayOutcome::INCOMPLETE;
+    result.startTurn = index[keyframe].turn;
+    uint32_t turns = result.startTurn;
+    bool awaitingReply = false;
+    std::string line;
+    for (; readRecord(file, offset, record, payload); offset += sizeof(record) + record.size) {
+        if (seekTurn >= 0 && turns >= static_cast<uint64_t>(seekTurn)) break;
+        if (record.turn != turns) {
+            result.outcome = ReplayOutcome::MISMATCH;
+            result.divergedAt = turns;
+            break;
+        }
+
+        if (record.kind == RP::COMMAND) {
+            result.commands++;
+            result.recordedSeconds = record.millis / 1000.0;
+            line.assign(reinterpret_cast<const char*>(payload), record.size);
+            if (awaitingReply) {
+                awaitingReply = false;
+                // Anything but a reset ends the session; the END record follows
+                if (SafetySystem::handleScramReset(state, line)) turns++;
+                continue;
+            }
+            if (InputHandler::execute(state, line) != InputResult::ADVANCE_TURN) continue;
+
+            Autopilot::steer(state);
+            {
+                PERF_SCOPE(TURN);
+                CorePhysics::update(state);
+                RandomEventSystem::process(state);
+                SafetySystem::check(state);
+            }
+            Perf::turnCompleted(state.messages.size());
+            state.clearMessages();
+            if (state.running) {
+                turns++;
+            } else {
+                awaitingReply = true;
+            }
+        } else if (record.kind == RP::KEYFRAME || record.kind == RP::RESYNC) {
+            if (record.size < sizeof(uint32_t) + header.snapshotBytes) break;
+            uint32_t hash;
+            std::memcpy(&hash, payload, sizeof(hash));
+            if (record.kind == RP::KEYFRAME) {
+                result.keyframes++;
+                if (stateHash(state) != hash) {
+                    result.outcome = ReplayOutcome::MISMATCH;
+                    result.divergedAt = turns;
+                    break;
+                }
+            } else if (!applySnapshot(state, payload + sizeof(hash), record.size - sizeof(hash))) {
+                break;
+            }
+        } else if (record.kind == RP::END) {
+            EndRecord end;
+            if (record.size != sizeof(end)) break;
+            std::memcpy(&end, payload, sizeof(end));
+            result.outcome = stateHash(state) == end.hash ? ReplayOutcome::MATCH : ReplayOutcome::MISMATCH;
+            if (result.outcome == ReplayOutcome::MISMATCH) result.divergedAt = turns;
+            break;
+        } else {
+            break;
+        }
+    }
+    if (seekTurn >= 0 && result.outcome == ReplayOutcome::INCOMPLETE && turns >= static_cast<uint64_t>(seekTurn)) {
+        result.outcome = ReplayOutcome::MATCH;
+    }
+    std::cout.rdbuf(console);
+    std::cout.copyfmt(format);
+
+    result.turns = turns;
+    result.hash = stateHash(state);
+    result.difficulty = state.currentDifficulty.name;
+    result.gameTurn = state.turns;
+    result.score = state.score;
+    result.scramCount = state.scramCount;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+const char* ReplayRunner::outcomeName(ReplayOutcome outcome) {
+    switch (outcome) {
+        case ReplayOutcome::MATCH:        return "MATCH";
+        case ReplayOutcome::MISMATCH:     return "MISMATCH";
+        case ReplayOutcome::INCOMPLETE:   return "INCOMPLETE";
+        case ReplayOutcome::WRONG_EVENTS: return "WRONG_EVENTS";
+        case ReplayOutcome::UNREADABLE:   return "UNREADABLE";
+        default:                          return "UNKNOWN";
+    }
+}
+
+void ReplayRunner::printSummary(const std::string& path, const ReplayResult& result) {
+    std::cout << "replay=" << path << " result=" << outcomeName(result.outcome);
+    if (result.outcome == ReplayOutcome::UNREADABLE || result.outcome == ReplayOutcome::WRONG_EVENTS) {
+        std::cout << "\n";
+        return;
+    }
+    if (result.outcome == ReplayOutcome::MISMATCH) std::cout << " diverged_at=" << result.divergedAt;
+    double turnsPerSec = result.seconds > 0.0 ? (result.turns - result.startTurn) / result.seconds : 0.0;
+    std::cout << " difficulty=" << result.difficulty
+              << " session_turns=" << result.turns
+              << " from_keyframe=" << result.startTurn
+              << " commands=" << result.commands
+              << " keyframes_checked=" << result.keyframes
+              << " turn=" << result.gameTurn
+              << " score=" << result.score
+              << " scrams=" << result.scramCount
+              << " hash=" << std::hex << std::setw(8) << std::setfill('0') << result.hash
+              << std::dec << std::setfill(' ')
+              << std::fixed << std::setprecision(1)
+              << " recorded_seconds=" << result.recordedSeconds
+              << std::setprecision(3)
+              << " seconds=" << result.seconds
+              << std::setprecision(0)
+              << " turns_per_sec=" << turnsPerSec << "\n";
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "reactor_state.h"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+// Session recordings (`--record FILE`, `--replay FILE`). A recording holds
+// the difficulty, models and seed, the starting state, and every line the
+// operator typed with the turn and time it was entered. Every
+// RP::KEYFRAME_TURNS turns a keyframe stores the state and its hash: replays
+// check the hash to find where a run diverged, and seeking starts from the
+// latest keyframe at or before the target turn. Loads and rewinds bring in
+// state from outside the recording, so the state after them is stored too,
+// with the spatial, channel and depletion models' state.
+// Turns are counted across the session; they match the game's turn counter
+// unless the operator rewound or loaded. The header holds the checksum of the
+// event catalog, which a replay must be given too.
+namespace RP {
+    static constexpr uint32_t MAGIC = 0x43455252;        // "RREC"
+    static constexpr uint32_t INDEX_MAGIC = 0x58445252;  // "RRDX"
+    static constexpr uint32_t VERSION = 6;
+    static constexpr int KEYFRAME_TURNS = 1024;
+
+    enum Record : uint8_t {
+        COMMAND = 1,   // Operator input line, or the reply to the SCRAM prompt
+        KEYFRAME = 2,  // State hash, snapshot and operator log; the replay must match it
+        RESYNC = 3,    // Keyframe contents and model state after a load or rewind
+        END = 4        // Final state hash, turn and score
+    };
+
+    // Keyframe index entry; the index follows the END record
+    struct IndexEntry {
+        uint32_t turn;
+        uint32_t reserved;
+        uint64_t offset;  // Of the KEYFRAME or RESYNC record
+    };
+}
+
+class SessionRecorder {
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    // Start recording a session about to run from `state` with these models
+    bool open(const std::string& path, const ReactorState& state, const ModelOptions& models);
+
+    // Write the final state hash and the keyframe index
+    void close(const ReactorState& state);
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Calls do nothing unless a recording is open
+    void command(const std::string& line);
+    void resync(const ReactorState& state);
+    // After each completed turn, including the reply to a SCRAM prompt
+    void turnCompleted(const ReactorState& state);
+
+private:
+    std::FILE* file;
+    uint64_t position;
+    uint32_t turns;
+    std::chrono::steady_clock::time_point started;
+    std::vector<RP::IndexEntry> keyframes;
+
+    void write(RP::Record kind, const void* payload, size_t size, const void* extra = nullptr, size_t extraSize = 0);
+    void snapshot(RP::Record kind, const ReactorState& state);
+};
+
+enum class ReplayOutcome {
+    MATCH,         // Every keyframe and the final hash matched
+    MISMATCH,      // The replay diverged from the recording
+    INCOMPLETE,    // The recording ends without a final hash (session crashed)
+    WRONG_EVENTS,  // Recorded with another event catalog (see --events)
+    UNREADABLE
+};
+
+struct ReplayResult {
+    ReplayOutcome outcome;
+    uint32_t turns;        // Session turns replayed (or reached when seeking)
+    uint32_t startTurn;    // Keyframe the replay started from
+    uint32_t divergedAt;   // Turn of the first mismatch
+    uint32_t commands;
+    uint32_t keyframes;    // Keyframes checked
+    uint32_t hash;         // stateHash() where the replay stopped
+    double recordedSeconds;  // Session time of the last command replayed
+    const char* difficulty;
+    int gameTurn;          // state.turns where the replay stopped
+    int score;
+    int scramCount;
+    double seconds;
+};
+
+class ReplayRunner {
+public:
+    // Re-execute a recording headless at full speed. With seekTurn >= 0 stop
+    // once that many session turns have run, starting from the nearest keyframe.
+    static ReplayResult run(const std::string& path, long seekTurn = -1);
+
+    // Hash of the simulated state: everything a replay reproduces, leaving
+    // out pointers, operator preferences and the high score
+    static uint32_t stateHash(const ReactorState& state);
+
+    static const char* outcomeName(ReplayOutcome outcome);
+    static void printSummary(const std::string& path, const ReplayResult& result);
+};
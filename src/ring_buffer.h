@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+// Fixed-capacity FIFO stored inline. Pushing onto a full buffer overwrites
+// the oldest element, so steady-state use never touches the heap.
+template <typename T, size_t N>
+class RingBuffer {
+public:
+    RingBuffer() : head(0), count(0) {}
+
+    // Slot for a new newest element, to be filled in by the caller
+    T& push() {
+        T& slot = items[(head + count) % N];
+        if (count < N) {
+            count++;
+        } else {
+            head = (head + 1) % N;
+        }
+        return slot;
+    }
+    void push(const T& item) { push() = item; }
+
+    // Oldest first
+    const T& operator[](size_t i) const { return items[(head + i) % N]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { head = count = 0; }
+    static constexpr size_t capacity() { return N; }
+
+    // Storage order, for snapshots that want slots to stay put as it wraps
+    const T& slot(size_t i) const { return items[i]; }
+    size_t oldestSlot() const { return head; }
+    void assign(const T* slots, size_t oldest, size_t size) {
+        for (size_t i = 0; i < N; ++i) items[i] = slots[i];
+        head = oldest % N;
+        count = size < N ? size : N;
+    }
+
+private:
+    T items[N];
+    size_t head;
+    size_t count;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+// Independent random streams, one per consuming subsystem
+enum class RngStream : uint32_t {
+    EVENTS,
+    WEATHER,
+    GRID,
+    UI,
+    STREAM_COUNT
+};
+
+// Philox4x32-10 block function (Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3"). Maps a 128-bit counter and 64-bit key to 128 random bits.
+inline void philox4x32(uint32_t ctr[4], uint32_t k0, uint32_t k1) {
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+        uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+        uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+        ctr[0] = hi1 ^ ctr[1] ^ k0;
+        ctr[1] = lo1;
+        ctr[2] = hi0 ^ ctr[3] ^ k1;
+        ctr[3] = lo0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+}
+
+// UniformRandomBitGenerator for one (seed, run, turn, stream) sequence. Draw i
+// is a pure function of those keys and i, so any turn's randomness can be
+// regenerated without replaying earlier turns. The draw index lives with the
+// caller (see ReactorState::rngStream) so it survives this short-lived object.
+class CounterRng {
+public:
+    typedef uint32_t result_type;
+
+    CounterRng(uint64_t seed, uint32_t runId, uint32_t turn, RngStream stream, uint32_t* draws)
+        : seed(seed), runId(runId), turn(turn), stream(static_cast<uint32_t>(stream)),
+          draws(draws), cachedBlock(UINT32_MAX) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()() {
+        uint32_t index = (*draws)++;
+        uint32_t block = index >> 2;
+        if (block != cachedBlock) {
+            cached[0] = block;
+            cached[1] = stream;
+            cached[2] = turn;
+            cached[3] = runId;
+            philox4x32(cached, static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32));
+            cachedBlock = block;
+        }
+        return cached[index & 3];
+    }
+
+private:
+    uint64_t seed;
+    uint32_t runId;
+    uint32_t turn;
+    uint32_t stream;
+    uint32_t* draws;
+    uint32_t cachedBlock;
+    uint32_t cached[4];
+};
+
+// Complete RNG state of a simulation: a few dozen bytes, cheap to snapshot
+struct RngState {
+    uint64_t seed;
+    uint32_t runId;
+    int turn;  // Turn the draw counters belong to
+    uint32_t draws[static_cast<int>(RngStream::STREAM_COUNT)];
+};
+
+// Uniform integer in [0, n) without the modulo bias of rng() % n (Lemire,
+// "Fast Random Integer Generation in an Interval"): the high half of a
+// 32x32 product, redrawing the few low halves that would favour some values
+template <class Generator>
+inline uint32_t uniformBelow(Generator& rng, uint32_t n) {
+    uint64_t product = static_cast<uint64_t>(rng()) * n;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < n) {
+        uint32_t threshold = (0u - n) % n;  // 2^32 mod n
+        while (low < threshold) {
+            product = static_cast<uint64_t>(rng()) * n;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
@@ -1,20 +1,16 @@
 #include "safety.h"
+#include "subchannel.h"
+#include "perf.h"
 
-#include <sstream>
 #include <iostream>
-#include <string>
 #include <algorithm>
 
 void SafetySystem::check(ReactorState& state) {
+    PERF_SCOPE(SAFETY);
+    bool cladTrip = state.channels && state.channels->summary().peakClad > TH::CLAD_SCRAM_TEMPERATURE;
     if ((state.temperature > state.currentDifficulty.scramTemperature ||
-         state.neutrons > RC::SCRAM_NEUTRONS) && state.running) {
-        {
-            std::ostringstream oss;
-            oss << "\n" << Color::BG_RED << Color::WHITE << Color::BOLD
-                << "*** AUTO SCRAM! Emergency shutdown! ***"
-                << Color::RESET << "\n";
-            state.addAlertMessage(oss.str());
-        }
+         state.neutrons > RC::SCRAM_NEUTRONS || cladTrip) && state.running) {
+        state.post(MessageCode::AUTO_SCRAM, Severity::ALARM);
         state.controlRods = 1.0;
         state.neutrons *= 0.05;
         state.temperature = std::max(0.0, state.temperature - 200);
@@ -23,43 +19,45 @@ void SafetySystem::check(ReactorState& state) {
         state.scramCount++;
         state.turnsWithoutScram = 0;
         state.score = std::max(0, state.score - RC::SCRAM_PENALTY);
-        {
-            std::ostringstream oss;
-            oss << Color::RED << "Score penalty: -" << RC::SCRAM_PENALTY << " points" << Color::RESET << "\n";
-            state.addMessage(oss.str());
-        }
-        std::string reason = state.temperature > state.currentDifficulty.scramTemperature
-            ? "temperature exceeded limit" : "neutron flux exceeded limit";
-        state.addLogEntry("CRITICAL", "AUTO SCRAM triggered - " + reason);
+        state.post(MessageCode::SCRAM_PENALTY, Severity::WARNING, RC::SCRAM_PENALTY);
+        LogCode reason = cladTrip ? LogCode::SCRAM_CLAD
+            : state.temperature > state.currentDifficulty.scramTemperature
+            ? LogCode::SCRAM_TEMPERATURE : LogCode::SCRAM_NEUTRONS;
+        state.addLogEntry(LogType::CRITICAL, reason);
     }
 
-    if (state.temperature > state.currentDifficulty.meltdownTemperature) {
-        {
-            std::ostringstream oss;
-            oss << "\n" << Color::BG_RED << Color::WHITE << Color::BOLD
-                << "!!! MELTDOWN !!! Core has gone critical. Game Over."
-                << Color::RESET << "\n";
-            state.addAlertMessage(oss.str());
-        }
-        state.addLogEntry("CRITICAL", "MELTDOWN - Core destruction");
+    if (isMeltdown(state)) {
+        state.post(MessageCode::MELTDOWN, Severity::ALARM);
+        state.addLogEntry(LogType::CRITICAL, LogCode::MELTDOWN);
         state.running = false;
     }
 }
 
-bool SafetySystem::handleScramReset(ReactorState& state) {
+bool SafetySystem::isMeltdown(const ReactorState& state) {
+    return state.temperature > state.currentDifficulty.meltdownTemperature;
+}
+
+void SafetySystem::restartAfterScram(ReactorState& state) {
+    state.running = true;
+    state.temperature = RC::INITIAL_TEMPERATURE;
+    state.controlRods = 1.0;
+    state.scramRecoveries++;
+}
+
+bool SafetySystem::promptScramReset(std::string& reply) {
+    printScramPrompt();
+    return static_cast<bool>(std::getline(std::cin, reply));
+}
+
+void SafetySystem::printScramPrompt() {
     std::cout << Color::YELLOW << "Type 'reset' to restart reactor, or 'q' to quit: "
               << Color::RESET;
-    std::string input;
-    if (!std::getline(std::cin, input)) {
-        return false;
-    }
+}
 
-    if (input == "reset") {
+bool SafetySystem::handleScramReset(ReactorState& state, const std::string& reply) {
+    if (reply == "reset") {
         std::cout << Color::GREEN << "Reactor restart initiated..." << Color::RESET << "\n";
-        state.running = true;
-        state.temperature = RC::INITIAL_TEMPERATURE;
-        state.controlRods = 1.0;
-        state.scramRecoveries++;
+        restartAfterScram(state);
         return true;
     }
     return false;
@@ -2,11 +2,24 @@
 
 #include "reactor_state.h"
 
+#include <string>
+
 class SafetySystem {
 public:
     // Check safety limits: triggers SCRAM or meltdown if thresholds exceeded
     static void check(ReactorState& state);
 
-    // Interactive SCRAM reset prompt (uses cout/cin directly); returns true if reset
-    static bool handleScramReset(ReactorState& state);
+    // True once the core has passed the meltdown temperature
+    static bool isMeltdown(const ReactorState& state);
+
+    // Bring the reactor back online after a SCRAM with rods fully inserted
+    static void restartAfterScram(ReactorState& state);
+
+    // Interactive SCRAM reset prompt (uses cout/cin directly); false at end of input
+    static bool promptScramReset(std::string& reply);
+    // Just the prompt text, for loops that read input themselves
+    static void printScramPrompt();
+
+    // Apply the operator's reply to the reset prompt; returns true if reset
+    static bool handleScramReset(ReactorState& state, const std::string& reply);
 };
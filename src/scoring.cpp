@@ -1,4 +1,5 @@
 #include "scoring.h"
+#include "quantiles.h"
 
 #include <algorithm>
 
@@ -23,4 +24,6 @@ void ScoringSystem::update(ReactorState& state) {
         state.xenonLevel > RC::MAX_XENON * 0.8) {
         state.criticalEvents++;
     }
+
+    if (state.distributions) state.distributions->record(state);
 }
@@ -0,0 +1,96 @@
+#pragma once
+
+// Thin SIMD layer for structure-of-arrays kernels. The lane width is chosen at
+// compile time from the target ISA (-march): AVX-512 gives 8 doubles, AVX2
+// gives 4, anything else falls back to plain scalar doubles.
+// REACTOR_SCALAR_LANES forces the scalar fallback whatever the target, for
+// checking the vector kernels against it (make check-ensemble).
+//
+// vmax/vmin follow std::max/std::min operand semantics (including which
+// operand wins on ties), so kernels written with them reproduce the scalar
+// subsystem code bit-for-bit as long as FMA contraction is disabled.
+
+#include <algorithm>
+#include <cmath>
+
+#if !defined(REACTOR_SCALAR_LANES) && (defined(__AVX512F__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+#if defined(__AVX512F__) && !defined(REACTOR_SCALAR_LANES)
+
+typedef __m512d Vec;
+typedef __mmask8 Mask;
+constexpr int WIDTH = 8;
+constexpr const char* NAME = "avx512";
+
+inline Vec load(const double* p)       { return _mm512_loadu_pd(p); }
+inline void store(double* p, Vec v)    { _mm512_storeu_pd(p, v); }
+inline Vec set1(double x)              { return _mm512_set1_pd(x); }
+// Full-mask forms avoid GCC's -Wmaybe-uninitialized false positive on the
+// unmasked intrinsics, which pass an undefined passthrough register
+inline Vec vmax(Vec a, Vec b)          { return _mm512_mask_max_pd(a, 0xFF, b, a); }
+inline Vec vmin(Vec a, Vec b)          { return _mm512_mask_min_pd(a, 0xFF, b, a); }
+inline Vec vabs(Vec a)                 { return _mm512_abs_pd(a); }
+inline Vec vtrunc(Vec a)               { return _mm512_mask_roundscale_pd(a, 0xFF, a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+inline Mask gt(Vec a, Vec b)           { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+inline Mask lt(Vec a, Vec b)           { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+inline Mask mand(Mask a, Mask b)       { return static_cast<Mask>(a & b); }
+inline Mask mor(Mask a, Mask b)        { return static_cast<Mask>(a | b); }
+inline Mask mnot(Mask a)               { return static_cast<Mask>(~a); }
+inline bool any(Mask m)                { return m != 0; }
+inline Vec select(Mask m, Vec t, Vec f) { return _mm512_mask_blend_pd(m, f, t); }
+
+#elif defined(__AVX2__) && !defined(REACTOR_SCALAR_LANES)
+
+typedef __m256d Vec;
+typedef __m256d Mask;
+constexpr int WIDTH = 4;
+constexpr const char* NAME = "avx2";
+
+inline Vec load(const double* p)       { return _mm256_loadu_pd(p); }
+inline void store(double* p, Vec v)    { _mm256_storeu_pd(p, v); }
+inline Vec set1(double x)              { return _mm256_set1_pd(x); }
+inline Vec vmax(Vec a, Vec b)          { return _mm256_max_pd(b, a); }
+inline Vec vmin(Vec a, Vec b)          { return _mm256_min_pd(b, a); }
+inline Vec vabs(Vec a)                 { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+inline Vec vtrunc(Vec a)               { return _mm256_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+inline Mask gt(Vec a, Vec b)           { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+inline Mask lt(Vec a, Vec b)           { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+inline Mask mand(Mask a, Mask b)       { return _mm256_and_pd(a, b); }
+inline Mask mor(Mask a, Mask b)        { return _mm256_or_pd(a, b); }
+inline Mask mnot(Mask a)               { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+inline bool any(Mask m)                { return _mm256_movemask_pd(m) != 0; }
+inline Vec select(Mask m, Vec t, Vec f) { return _mm256_blendv_pd(f, t, m); }
+
+#else
+
+typedef double Vec;
+typedef bool Mask;
+constexpr int WIDTH = 1;
+constexpr const char* NAME = "scalar";
+
+inline Vec load(const double* p)       { return *p; }
+inline void store(double* p, Vec v)    { *p = v; }
+inline Vec set1(double x)              { return x; }
+inline Vec vmax(Vec a, Vec b)          { return std::max(a, b); }
+inline Vec vmin(Vec a, Vec b)          { return std::min(a, b); }
+inline Vec vabs(Vec a)                 { return std::abs(a); }
+inline Vec vtrunc(Vec a)               { return std::trunc(a); }
+inline Mask gt(Vec a, Vec b)           { return a > b; }
+inline Mask lt(Vec a, Vec b)           { return a < b; }
+inline Mask mand(Mask a, Mask b)       { return a && b; }
+inline Mask mor(Mask a, Mask b)        { return a || b; }
+inline Mask mnot(Mask a)               { return !a; }
+inline bool any(Mask m)                { return m; }
+inline Vec select(Mask m, Vec t, Vec f) { return m ? t : f; }
+
+#endif
+
+// Flags are stored as 0.0 / 1.0 doubles in SoA arrays
+inline Mask isSet(Vec flag)            { return gt(flag, set1(0.5)); }
+inline Vec flag(Mask m)                { return select(m, set1(1.0), set1(0.0)); }
+
+}  // namespace simd
@@ -0,0 +1,435 @@
+#include "spatial.h"
+#include "byte_stream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+// Power iterations for a reset from a flat flux
+const int RESET_OUTER = 200;
+}
+
+SpatialCore::SpatialCore(int nx, int ny, int nz)
+    : nodesX(nx), nodesY(ny), nodesZ(nz),
+      fast(nx, ny, nz, SC::CORE_WIDTH / nx, SC::CORE_WIDTH / ny, SC::CORE_HEIGHT / nz, SC::D1),
+      thermal(nx, ny, nz, SC::CORE_WIDTH / nx, SC::CORE_WIDTH / ny, SC::CORE_HEIGHT / nz, SC::D2),
+      k(1.0), normalization(1.0), fuelFraction(1.0),
+      peaking(1.0), offset(0.0), xenonMean(0.0), samariumMean(0.0), fissileMean(1.0),
+      statistics{0, 0, 0.0, 0.0},
+      xe135(-1), sm149(-1), xenonEquilibrium(1.0), samariumEquilibrium(1.0), freshWorth(1.0) {
+    size_t padded = fast.solution().size();
+    iodine.assign(padded, 0.0);
+    xenon.assign(padded, 0.0);
+    power.assign(padded, 0.0);
+    samarium.assign(padded, 0.0);
+
+    // Banks interleave on a grid of pseudo-assemblies so each spans the core
+    int assembly = std::max(1, std::min(nx, ny) / 10);
+    bankOf.assign(static_cast<size_t>(nx) * ny, 0);
+    for (int j = 0; j < ny; ++j) {
+        for (int i = 0; i < nx; ++i) {
+            bankOf[j * nx + i] = (i / assembly) % 2 + 2 * ((j / assembly) % 2);
+        }
+    }
+
+    for (int kk = 0; kk < nz; ++kk) {
+        for (int j = 0; j < ny; ++j) {
+            for (int i = 0; i < nx; ++i) {
+                size_t n = fast.at(i, j, kk);
+                fast.solution()[n] = 1.0;
+                thermal.solution()[n] = 1.0;
+                power[n] = 1.0;
+            }
+        }
+    }
+
+    // Converge the clean core once, then scale fission to hit CLEAN_KEFF
+    setBanks(0.0);
+    setCrossSections(RC::INITIAL_TEMPERATURE, RC::INITIAL_FUEL);
+    solveEigenvalue(2000);
+    normalization = SC::CLEAN_KEFF / k;
+    k = SC::CLEAN_KEFF;
+    computePower();
+    statistics = SpatialStats{0, 0, 0.0, 0.0};
+}
+
+std::unique_ptr<SpatialCore> SpatialCore::create(const ModelOptions& models) {
+    if (models.spatialNx <= 0) return std::unique_ptr<SpatialCore>();
+    return std::unique_ptr<SpatialCore>(new SpatialCore(models.spatialNx, models.spatialNy, models.spatialNz));
+}
+
+bool SpatialCore::parseGrid(const std::string& spec, ModelOptions& models) {
+    int nx = 0, ny = 0, nz = 0;
+    char tail;
+    if (std::sscanf(spec.c_str(), "%dx%dx%d%c", &nx, &ny, &nz, &tail) != 3) return false;
+    if (nx < 1 || ny < 1 || nz < 1 || nx > 512 || ny > 512 || nz > 512) return false;
+    models.spatialNx = nx;
+    models.spatialNy = ny;
+    models.spatialNz = nz;
+    return true;
+}
+
+void SpatialCore::setBanks(double controlRods) {
+    // Overlapping bank sequence: bank b travels while the overall demand
+    // moves through [0.2 b, 0.2 b + 0.4]
+    for (int b = 0; b < SC::BANKS; ++b) {
+        banks[b] = std::min(1.0, std::max(0.0, (controlRods - 0.2 * b) / 0.4));
+    }
+}
+
+void SpatialCore::setCrossSections(double temperature, double fuel) {
+    fuelFraction = fuel / 100.0;
+    double sqrtReference = std::sqrt(RC::INITIAL_TEMPERATURE);
+#pragma omp parallel for schedule(static)
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        // Rods enter from the top (kk = nodesZ - 1); fraction of this layer covered
+        double depthFromTop = nodesZ - 1 - kk;
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                double inserted = banks[bankOf[j * nodesX + i]] * nodesZ;
+                double covered = std::min(1.0, std::max(0.0, inserted - depthFromTop));
+
+                // Fuel temperature rises above the coolant with local power
+                double nodeTemp = std::max(0.0, RC::INITIAL_TEMPERATURE
+                                           + (temperature - RC::INITIAL_TEMPERATURE) * power[n]);
+                fast.sigma()[n] = SC::SIGMA_A1 + SC::SIGMA_S12
+                                + SC::DOPPLER_SIGMA_A1 * (std::sqrt(nodeTemp) - sqrtReference);
+                thermal.sigma()[n] = SC::SIGMA_A2 + SC::ROD_SIGMA_A2 * covered
+                                   + SC::XENON_SIGMA_A2 * xenon[n] + SC::SAMARIUM_SIGMA_A2 * samarium[n];
+            }
+        }
+    }
+    fast.updateCoefficients();
+    thermal.updateCoefficients();
+}
+
+void SpatialCore::solveEigenvalue(int maxOuter) {
+    std::vector<double>& phi1 = fast.solution();
+    std::vector<double>& phi2 = thermal.solution();
+    std::vector<double>& fastSource = fast.rhs();
+    std::vector<double>& thermalSource = thermal.rhs();
+    const double fission1 = SC::NU_SIGMA_F1 * normalization * fuelFraction;
+    const double fission2 = SC::NU_SIGMA_F2 * normalization * fuelFraction;
+
+    double total = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:total)
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                total += fission1 * phi1[n] + fission2 * phi2[n];
+            }
+        }
+    }
+
+    for (int outer = 0; outer < maxOuter; ++outer) {
+        // Fast group driven by fission, thermal group by down-scatter; one
+        // V-cycle each from the previous flux (inexact inner solves)
+        double invK = 1.0 / k;
+#pragma omp parallel for schedule(static)
+        for (int kk = 0; kk < nodesZ; ++kk) {
+            for (int j = 0; j < nodesY; ++j) {
+                for (int i = 0; i < nodesX; ++i) {
+                    size_t n = fast.at(i, j, kk);
+                    fastSource[n] = (fission1 * phi1[n] + fission2 * phi2[n]) * invK;
+                }
+            }
+        }
+        fast.solve(1);
+#pragma omp parallel for schedule(static)
+        for (int kk = 0; kk < nodesZ; ++kk) {
+            for (int j = 0; j < nodesY; ++j) {
+                for (int i = 0; i < nodesX; ++i) {
+                    size_t n = fast.at(i, j, kk);
+                    thermalSource[n] = SC::SIGMA_S12 * phi1[n];
+                }
+            }
+        }
+        thermal.solve(1);
+
+        // New eigenvalue from the source ratio; source change is measured on
+        // the normalized shapes so the flux level does not matter
+        double newTotal = 0.0, change = 0.0, norm = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:newTotal)
+        for (int kk = 0; kk < nodesZ; ++kk) {
+            for (int j = 0; j < nodesY; ++j) {
+                for (int i = 0; i < nodesX; ++i) {
+                    size_t n = fast.at(i, j, kk);
+                    newTotal += fission1 * phi1[n] + fission2 * phi2[n];
+                }
+            }
+        }
+        double kNew = k * newTotal / total;
+#pragma omp parallel for schedule(static) reduction(+:change, norm)
+        for (int kk = 0; kk < nodesZ; ++kk) {
+            for (int j = 0; j < nodesY; ++j) {
+                for (int i = 0; i < nodesX; ++i) {
+                    size_t n = fast.at(i, j, kk);
+                    double s = (fission1 * phi1[n] + fission2 * phi2[n]) / newTotal;
+                    double previous = fastSource[n] * k / total;
+                    change += (s - previous) * (s - previous);
+                    norm += s * s;
+                }
+            }
+        }
+
+        // Renormalize so the flux neither over- nor underflows across turns
+        double scale = 1.0 / (newTotal / (static_cast<double>(nodesX) * nodesY * nodesZ));
+#pragma omp parallel for schedule(static)
+        for (int kk = 0; kk < nodesZ; ++kk) {
+            for (int j = 0; j < nodesY; ++j) {
+                for (int i = 0; i < nodesX; ++i) {
+                    size_t n = fast.at(i, j, kk);
+                    phi1[n] *= scale;
+                    phi2[n] *= scale;
+                }
+            }
+        }
+        total = newTotal * scale;
+
+        double kChange = std::abs(kNew - k);
+        k = kNew;
+        statistics.outerIterations++;
+        statistics.lastResidual = std::sqrt(change / norm);
+        if (statistics.lastResidual < SC::SOURCE_TOLERANCE && kChange < SC::SOURCE_TOLERANCE) break;
+    }
+}
+
+void SpatialCore::computePower() {
+    const std::vector<double>& phi1 = fast.solution();
+    const std::vector<double>& phi2 = thermal.solution();
+    double total = 0.0, top = 0.0, peak = 0.0;
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                double p = SC::NU_SIGMA_F1 * phi1[n] + SC::NU_SIGMA_F2 * phi2[n];
+                power[n] = p;
+                total += p;
+                if (2 * kk >= nodesZ) top += p;
+                peak = std::max(peak, p);
+            }
+        }
+    }
+    double mean = total / (static_cast<double>(nodesX) * nodesY * nodesZ);
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                power[fast.at(i, j, kk)] /= mean;
+            }
+        }
+    }
+    peaking = peak / mean;
+    offset = (2.0 * top - total) / total;
+}
+
+void SpatialCore::advanceXenon(double amplitude) {
+    // Exact exponential update at constant local power P (relative to nominal).
+    // Iodine: u' = lI (P - u). Xenon, normalized to 1 at nominal equilibrium:
+    // x' = (yX P + yI u)(lX + b) / (yI + yX) - (lX + b P) x, with u at its
+    // step average.
+    const double dt = SC::XENON_HOURS_PER_TURN;
+    const double iodineFactor = std::exp(-SC::IODINE_DECAY * dt);
+    const double iodineAverage = (1.0 - iodineFactor) / (SC::IODINE_DECAY * dt);
+    const double removalNominal = SC::XENON_DECAY + SC::XENON_BURNOUT;
+    const double yieldTotal = SC::IODINE_YIELD + SC::XENON_YIELD;
+    double sum = 0.0;
+#pragma omp parallel for schedule(static) reduction(+:sum)
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                double p = amplitude * power[n];
+                double u = iodine[n];
+                double uMean = p + (u - p) * iodineAverage;
+                iodine[n] = p + (u - p) * iodineFactor;
+
+                double production = (SC::XENON_YIELD * p + SC::IODINE_YIELD * uMean) * removalNominal / yieldTotal;
+                double removal = SC::XENON_DECAY + SC::XENON_BURNOUT * p;
+                double equilibrium = production / removal;
+                xenon[n] = equilibrium + (xenon[n] - equilibrium) * std::exp(-removal * dt);
+                sum += xenon[n];
+            }
+        }
+    }
+    xenonMean = sum / (static_cast<double>(nodesX) * nodesY * nodesZ);
+}
+
+void SpatialCore::enableDepletion(const DepletionChain& chain) {
+    size_t nodes = static_cast<size_t>(nodesX) * nodesY * nodesZ;
+    depletion.reset(new DepletionBatch(chain, nodes, SC::XENON_HOURS_PER_TURN * 3600.0));
+    xe135 = chain.index("Xe135");
+    sm149 = chain.index("Sm149");
+
+    std::vector<double> densities(chain.size());
+    for (int i = 0; i < chain.size(); ++i) densities[i] = chain.freshDensity(i);
+    freshWorth = chain.fissionRate(&densities[0]);
+    chain.equilibrium(DP::NOMINAL_FLUX, &densities[0]);
+    if (xe135 >= 0 && densities[xe135] > 0.0) xenonEquilibrium = densities[xe135];
+    if (sm149 >= 0 && densities[sm149] > 0.0) samariumEquilibrium = densities[sm149];
+}
+
+void SpatialCore::advanceDepletion(double amplitude) {
+    double* flux = depletion->flux();
+    size_t cell = 0;
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                flux[cell++] = DP::NOMINAL_FLUX * std::max(0.0, amplitude * power[fast.at(i, j, kk)]);
+            }
+        }
+    }
+    depletion->advance();
+
+    double xenonSum = 0.0, samariumSum = 0.0, worthSum = 0.0;
+    const double* xenonDensity = xe135 >= 0 ? depletion->density(xe135) : nullptr;
+    const double* samariumDensity = sm149 >= 0 ? depletion->density(sm149) : nullptr;
+    cell = 0;
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                xenon[n] = xenonDensity ? xenonDensity[cell] / xenonEquilibrium : 0.0;
+                samarium[n] = samariumDensity ? samariumDensity[cell] / samariumEquilibrium : 0.0;
+                xenonSum += xenon[n];
+                samariumSum += samarium[n];
+                worthSum += depletion->fissionRate(cell) / freshWorth;
+                cell++;
+            }
+        }
+    }
+    xenonMean = xenonSum / cell;
+    samariumMean = samariumSum / cell;
+    fissileMean = worthSum / cell;
+}
+
+void SpatialCore::update(ReactorState& state) {
+    auto start = std::chrono::steady_clock::now();
+
+    setBanks(state.controlRods);
+    setCrossSections(state.temperature, state.fuel);
+    solveEigenvalue(SC::MAX_OUTER);
+    computePower();
+    if (depletion) {
+        advanceDepletion(state.neutrons / RC::INITIAL_NEUTRONS);
+        state.fuel = std::min(RC::INITIAL_FUEL, 100.0 * fissileMean);
+    } else {
+        advanceXenon(state.neutrons / RC::INITIAL_NEUTRONS);
+    }
+    state.xenonLevel = std::min(RC::MAX_XENON, 50.0 * xenonMean);
+
+    statistics.solves++;
+    statistics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SpatialCore::reset(const ReactorState& state) {
+    const double amplitude = std::max(0.0, state.neutrons) / RC::INITIAL_NEUTRONS;
+    const double level = state.xenonLevel / 50.0;
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                xenon[n] = level;
+                samarium[n] = depletion ? 1.0 : 0.0;
+                fast.solution()[n] = 1.0;
+                thermal.solution()[n] = 1.0;
+                power[n] = 1.0;
+            }
+        }
+    }
+
+    // Flux shape for the restored rods, temperature and poisons, from a flat
+    // guess so the result depends on the state alone (replays reset too)
+    k = SC::CLEAN_KEFF;
+    setBanks(state.controlRods);
+    setCrossSections(state.temperature, state.fuel);
+    solveEigenvalue(RESET_OUTER);
+    computePower();
+    xenonMean = level;
+
+    if (!depletion) {
+        for (int kk = 0; kk < nodesZ; ++kk) {
+            for (int j = 0; j < nodesY; ++j) {
+                for (int i = 0; i < nodesX; ++i) {
+                    size_t n = fast.at(i, j, kk);
+                    iodine[n] = amplitude * power[n];
+                }
+            }
+        }
+        return;
+    }
+
+    const DepletionChain& chain = depletion->chain();
+    std::vector<double> densities(chain.size());
+    const double fuelScale = std::max(0.0, state.fuel) / 100.0;
+    double samariumSum = 0.0, worthSum = 0.0;
+    size_t cell = 0;
+    for (int kk = 0; kk < nodesZ; ++kk) {
+        for (int j = 0; j < nodesY; ++j) {
+            for (int i = 0; i < nodesX; ++i) {
+                size_t n = fast.at(i, j, kk);
+                for (int d = 0; d < chain.size(); ++d) densities[d] = chain.freshDensity(d) * fuelScale;
+                chain.equilibrium(DP::NOMINAL_FLUX * amplitude * power[n], &densities[0]);
+                if (xe135 >= 0) densities[xe135] = level * xenonEquilibrium;
+                for (int d = 0; d < chain.size(); ++d) depletion->density(d)[cell] = densities[d];
+                samarium[n] = sm149 >= 0 ? densities[sm149] / samariumEquilibrium : 0.0;
+                samariumSum += samarium[n];
+                worthSum += depletion->fissionRate(cell) / freshWorth;
+                cell++;
+            }
+        }
+    }
+    samariumMean = samariumSum / cell;
+    fissileMean = worthSum / cell;
+}
+
+void SpatialCore::saveState(std::vector<unsigned char>& out) const {
+    int32_t shape[4] = {nodesX, nodesY, nodesZ, depletion ? depletion->chain().size() : 0};
+    double scalars[] = {k, fuelFraction, banks[0], banks[1], banks[2], banks[3],
+                        peaking, offset, xenonMean, samariumMean, fissileMean};
+    putValue(out, shape);
+    putValue(out, scalars);
+    for (const std::vector<double>* v : {&fast.solution(), &thermal.solution(), &iodine, &xenon, &power, &samarium}) {
+        putBytes(out, v->data(), v->size() * sizeof(double));
+    }
+    if (depletion) {
+        for (int i = 0; i < shape[3]; ++i) putBytes(out, depletion->density(i), depletion->cells() * sizeof(double));
+    }
+}
+
+bool SpatialCore::loadState(const unsigned char* data, size_t size) {
+    int32_t shape[4];
+    double scalars[11];
+    const size_t padded = iodine.size();
+    const size_t cells = depletion ? depletion->cells() : 0;
+    const int nuclides = depletion ? depletion->chain().size() : 0;
+    ByteReader in(data, size);
+    if (!in.value(shape) || shape[0] != nodesX || shape[1] != nodesY || shape[2] != nodesZ ||
+        shape[3] != nuclides ||
+        size != sizeof(shape) + sizeof(scalars) + (6 * padded + nuclides * cells) * sizeof(double)) {
+        return false;
+    }
+    in.value(scalars);
+    k = scalars[0];
+    fuelFraction = scalars[1];
+    for (int b = 0; b < SC::BANKS; ++b) banks[b] = scalars[2 + b];
+    peaking = scalars[6];
+    offset = scalars[7];
+    xenonMean = scalars[8];
+    samariumMean = scalars[9];
+    fissileMean = scalars[10];
+    for (std::vector<double>* v : {&fast.solution(), &thermal.solution(), &iodine, &xenon, &power, &samarium}) {
+        in.bytes(v->data(), padded * sizeof(double));
+    }
+    for (int i = 0; i < nuclides; ++i) in.bytes(depletion->density(i), cells * sizeof(double));
+    return true;
+}
+
+double SpatialCore::columnPower(int i, int j) const {
+    double sum = 0.0;
+    for (int kk = 0; kk < nodesZ; ++kk) sum += power[fast.at(i, j, kk)];
+    return sum / nodesZ;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "reactor_state.h"
+#include "multigrid.h"
+#include "depletion.h"
+
+#include <vector>
+#include <memory>
+#include <string>
+
+// Spatial core model (opt-in with --spatial NxMxK). The core is a box of
+// nodes with two-group diffusion solved for the flux shape and k_eff each
+// turn. Rods move in four banks, and iodine/xenon are tracked per node so
+// xenon can redistribute the power (spatial xenon oscillations). The scalar
+// fields the other subsystems consume are reductions over the nodes:
+//   neutrons  amplitude, scaled by k_eff each turn as in the basic model
+//   xenonLevel  core-average xenon (50 = equilibrium at nominal power)
+namespace SC {
+    static constexpr double CORE_WIDTH = 320.0;   // cm, both radial directions
+    static constexpr double CORE_HEIGHT = 360.0;  // cm
+
+    // Two-group constants (fast = 1, thermal = 2), cm and 1/cm
+    static constexpr double D1 = 1.4;
+    static constexpr double D2 = 0.4;
+    static constexpr double SIGMA_A1 = 0.010;
+    static constexpr double SIGMA_S12 = 0.018;   // Fast-to-thermal removal
+    static constexpr double SIGMA_A2 = 0.085;
+    static constexpr double NU_SIGMA_F1 = 0.0065;
+    static constexpr double NU_SIGMA_F2 = 0.13;
+    static constexpr double CLEAN_KEFF = 1.05;   // Fission is normalized to this
+
+    // Feedback on thermal absorption (full rod, xenon per unit of equilibrium)
+    // and fast absorption (Doppler, per sqrt(K) above INITIAL_TEMPERATURE)
+    static constexpr double ROD_SIGMA_A2 = 0.06;
+    static constexpr double XENON_SIGMA_A2 = 0.004;
+    static constexpr double SAMARIUM_SIGMA_A2 = 0.001;  // Per unit of equilibrium, with --depletion
+    static constexpr double DOPPLER_SIGMA_A1 = 2.0e-5;
+
+    // Iodine-135 / xenon-135 chain; one turn stands for 15 minutes of xenon time
+    static constexpr double XENON_HOURS_PER_TURN = 0.25;
+    static constexpr double IODINE_DECAY = 0.1055;      // 1/h
+    static constexpr double XENON_DECAY = 0.0758;       // 1/h
+    static constexpr double XENON_BURNOUT = 0.2;        // 1/h at nominal flux
+    static constexpr double IODINE_YIELD = 0.0639;
+    static constexpr double XENON_YIELD = 0.00237;
+
+    static constexpr int BANKS = 4;
+    static constexpr int MAX_OUTER = 12;        // Power iterations per turn
+    static constexpr double SOURCE_TOLERANCE = 1.0e-5;
+}
+
+struct SpatialStats {
+    long solves;
+    long outerIterations;
+    double seconds;       // Wall time spent in solves
+    double lastResidual;  // Relative fission-source change of the last outer
+};
+
+class SpatialCore {
+public:
+    SpatialCore(int nx, int ny, int nz);
+
+    // Build the core requested by the options, or null when the model is off
+    static std::unique_ptr<SpatialCore> create(const ModelOptions& models);
+
+    // Parse "NxMxK" (e.g. "50x50x30") into the options; returns false on bad input
+    static bool parseGrid(const std::string& spec, ModelOptions& models);
+
+    // Track the full nuclide chain per node (CRAM, batched over the nodes)
+    // instead of the built-in iodine/xenon update; fuel then burns per node
+    void enableDepletion(const DepletionChain& chain);
+    bool depleting() const { return static_cast<bool>(depletion); }
+
+    // Refresh cross sections from the state, solve, and advance xenon one turn
+    void update(ReactorState& state);
+
+    // Start over from a restored state (rewind, load without model data):
+    // uniform xenon at state.xenonLevel, iodine and the other fission
+    // products in equilibrium with the solved flux, fuel scaled to state.fuel
+    void reset(const ReactorState& state);
+
+    // Flux, poisons and nuclide inventory for save files. loadState() is
+    // false, changing nothing, for data from another grid or chain.
+    void saveState(std::vector<unsigned char>& out) const;
+    bool loadState(const unsigned char* data, size_t size);
+
+    int nx() const { return nodesX; }
+    int ny() const { return nodesY; }
+    int nz() const { return nodesZ; }
+    double keff() const { return k; }
+    double bankInsertion(int bank) const { return banks[bank]; }
+    double peakingFactor() const { return peaking; }
+    double axialOffset() const { return offset; }   // (top - bottom) / total power
+    double averageXenon() const { return xenonMean; }
+    double averageSamarium() const { return samariumMean; }
+    const SpatialStats& stats() const { return statistics; }
+
+    // Relative power of a radial column, averaged over height (1.0 = core average)
+    double columnPower(int i, int j) const;
+
+private:
+    int nodesX, nodesY, nodesZ;
+    MultigridSolver fast;
+    MultigridSolver thermal;
+
+    // Per-node data in the solvers' padded layout
+    std::vector<double> iodine;         // Normalized to 1 at nominal equilibrium
+    std::vector<double> xenon;
+    std::vector<double> power;          // Relative power density, mean 1
+    std::vector<double> samarium;       // Normalized to 1 at equilibrium; 0 without depletion
+    std::vector<int> bankOf;            // Rod bank of each radial column
+
+    double k;
+    double normalization;   // Scales nu-Sigma_f so the clean core has CLEAN_KEFF
+    double fuelFraction;
+    double banks[SC::BANKS];
+    double peaking;
+    double offset;
+    double xenonMean;
+    double samariumMean;
+    double fissileMean;     // Fission rate per unit flux relative to fresh fuel
+    SpatialStats statistics;
+
+    // Per-node nuclide chain in compact node order (i fastest), when enabled
+    std::unique_ptr<DepletionBatch> depletion;
+    int xe135, sm149;
+    double xenonEquilibrium, samariumEquilibrium, freshWorth;
+
+    void setBanks(double controlRods);
+    void setCrossSections(double temperature, double fuel);
+    void solveEigenvalue(int maxOuter);
+    void computePower();
+    void advanceXenon(double amplitude);
+    void advanceDepletion(double amplitude);
+};
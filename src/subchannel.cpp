@@ -0,0 +1,246 @@
+#include "subchannel.h"
+#include "spatial.h"
+#include "simd.h"
+#include "byte_stream.h"
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+const double PI = 3.14159265358979323846;
+
+// Radial shape used when no spatial solution is available: a flattened
+// cosine across the square channel layout
+double cosineShape(int i, int j, int side) {
+    double x = (i + 0.5) / side - 0.5;
+    double y = (j + 0.5) / side - 0.5;
+    return std::cos(0.8 * PI * x) * std::cos(0.8 * PI * y);
+}
+}
+
+SubchannelModel::SubchannelModel(int channels)
+    : count(channels),
+      padded((static_cast<size_t>(channels) + 7) / 8 * 8),
+      gridSide(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(channels))))),
+      data(static_cast<size_t>(ChannelField::FIELD_COUNT) * padded, 0.0),
+      last(),
+      reportedTemperature(RC::INITIAL_TEMPERATURE),
+      sessionPeak(0.0),
+      updates(0),
+      kernelSeconds(0.0) {
+    double* weight = field(ChannelField::WEIGHT);
+    double* share = field(ChannelField::POWER_SHARE);
+    double sum = 0.0;
+    for (int c = 0; c < count; ++c) {
+        weight[c] = 1.0;
+        share[c] = cosineShape(c % gridSide, c / gridSide, gridSide);
+        sum += share[c];
+    }
+    for (int c = 0; c < count; ++c) share[c] *= count / sum;
+    setFlowShares();
+}
+
+void SubchannelModel::setFlowShares() {
+    // Orifices are sized once for the design power shape: hot channels get
+    // somewhat more flow. Padding lanes keep a unit share so divisions stay finite.
+    double* share = field(ChannelField::POWER_SHARE);
+    double* flow = field(ChannelField::FLOW_SHARE);
+    double* convection = field(ChannelField::CONVECTION_SHARE);
+    double sum = 0.0;
+    for (int c = 0; c < count; ++c) {
+        flow[c] = 0.9 + 0.1 * share[c];
+        sum += flow[c];
+    }
+    for (size_t c = 0; c < padded; ++c) {
+        flow[c] = static_cast<int>(c) < count ? flow[c] * count / sum : 1.0;
+        convection[c] = std::pow(flow[c], 0.8);
+    }
+}
+
+void SubchannelModel::reset(const ReactorState& state) {
+    // Uniform temperature matching the state, so attaching the model is seamless
+    for (ChannelField f : {ChannelField::PEAK_CLAD, ChannelField::PEAK_CENTERLINE,
+                           ChannelField::FUEL_AVERAGE, ChannelField::OUTLET}) {
+        std::fill(field(f), field(f) + padded, state.temperature);
+    }
+    std::fill(field(ChannelField::DNB), field(ChannelField::DNB) + padded, 0.0);
+    reportedTemperature = state.temperature;
+    last = ChannelSummary{state.temperature, state.temperature, state.temperature,
+                          state.temperature, 1.0, TH::INLET_TEMPERATURE, 0};
+}
+
+void SubchannelModel::saveState(std::vector<unsigned char>& out) const {
+    int32_t channels = count;
+    double scalars[] = {reportedTemperature, sessionPeak, last.peakClad, last.peakCenterline, last.maxOutlet,
+                        last.averageFuel, last.flowFraction, last.inlet, static_cast<double>(last.dnbChannels)};
+    putValue(out, channels);
+    putValue(out, scalars);
+    putBytes(out, data.data(), data.size() * sizeof(double));
+}
+
+bool SubchannelModel::loadState(const unsigned char* bytes, size_t size) {
+    int32_t channels;
+    double scalars[9];
+    ByteReader in(bytes, size);
+    if (!in.value(channels) || channels != count ||
+        size != sizeof(channels) + sizeof(scalars) + data.size() * sizeof(double)) {
+        return false;
+    }
+    in.value(scalars);
+    in.bytes(data.data(), data.size() * sizeof(double));
+    reportedTemperature = scalars[0];
+    sessionPeak = scalars[1];
+    last = ChannelSummary{scalars[2], scalars[3], scalars[4], scalars[5], scalars[6], scalars[7],
+                          static_cast<int>(scalars[8])};
+    return true;
+}
+
+void SubchannelModel::updatePowerShares(const ReactorState& state) {
+    if (!state.spatial) return;  // Fixed design shape
+
+    // Each channel samples the spatial column under it
+    const SpatialCore& core = *state.spatial;
+    double* share = field(ChannelField::POWER_SHARE);
+    double sum = 0.0;
+    for (int c = 0; c < count; ++c) {
+        int i = (c % gridSide) * core.nx() / gridSide;
+        int j = (c / gridSide) * core.ny() / gridSide;
+        share[c] = core.columnPower(i, j);
+        sum += share[c];
+    }
+    if (sum <= 0.0) return;
+    for (int c = 0; c < count; ++c) share[c] *= count / sum;
+}
+
+void SubchannelModel::update(ReactorState& state) {
+    using namespace simd;
+    auto start = std::chrono::steady_clock::now();
+
+    updatePowerShares(state);
+
+    // Whatever moved state.temperature since the last turn (events, ECCS,
+    // SCRAM) moves the fuel of every channel with it
+    const double external = state.temperature - reportedTemperature;
+
+    // Core-wide conditions for this turn
+    const double flowFraction = std::min(1.0, std::max(TH::MIN_FLOW_FRACTION,
+                                         state.coolant / TH::PUMP_SUCTION_COOLANT));
+    const double coolingModifier = getWeatherInfo(state.currentWeather).coolingModifier;
+    const double inlet = TH::INLET_TEMPERATURE + 20.0 * (1.0 - coolingModifier);
+    const double relativePower = std::max(0.0, state.power) / 100.0;
+    const double coreRise = relativePower * 100.0 * TH::MW_PER_POWER_UNIT
+                          / (TH::NOMINAL_FLOW * flowFraction * TH::COOLANT_CP);
+    const double axialPeaking = state.spatial
+        ? std::max(1.0, state.spatial->peakingFactor()
+                        / std::max(1.0, *std::max_element(field(ChannelField::POWER_SHARE),
+                                                          field(ChannelField::POWER_SHARE) + count)))
+        : TH::AXIAL_PEAKING;
+
+    // Linear heat rate (W/m) and film coefficient at a channel of unit shares
+    const double linearHeat = TH::NOMINAL_LINEAR_HEAT * relativePower;
+    const double film = TH::CONVECTION * std::pow(flowFraction, 0.8);
+    const double perimeter = PI * TH::ROD_DIAMETER;
+
+    const Vec vZero = set1(0.0);
+    const Vec vHalf = set1(0.5);
+    const Vec vInlet = set1(inlet);
+    const Vec vSat = set1(TH::SATURATION_TEMPERATURE);
+    const Vec vDnbLimit = set1(TH::SATURATION_TEMPERATURE + TH::DNB_SUPERHEAT);
+    const Vec vRise = set1(coreRise);
+    const Vec vHeat = set1(linearHeat);
+    const Vec vPeak = set1(axialPeaking);
+    const Vec vFilm = set1(film);
+    const Vec vBoiling = set1(TH::FILM_BOILING_FACTOR);
+    const Vec vPerimeter = set1(perimeter);
+    const Vec vGap = set1(1.0 / (perimeter * TH::GAP_CONDUCTANCE));
+    const Vec vPellet = set1(1.0 / (4.0 * PI * TH::FUEL_CONDUCTIVITY));
+    const Vec vExternal = set1(external);
+    const Vec vFuelRelax = set1(TH::FUEL_RELAXATION);
+    const Vec vCladRelax = set1(TH::CLAD_RELAXATION);
+
+    double* share = field(ChannelField::POWER_SHARE);
+    double* flow = field(ChannelField::FLOW_SHARE);
+    double* convection = field(ChannelField::CONVECTION_SHARE);
+    double* weight = field(ChannelField::WEIGHT);
+    double* outlet = field(ChannelField::OUTLET);
+    double* clad = field(ChannelField::PEAK_CLAD);
+    double* centerline = field(ChannelField::PEAK_CENTERLINE);
+    double* fuel = field(ChannelField::FUEL_AVERAGE);
+    double* dnb = field(ChannelField::DNB);
+
+    Vec fuelSum = vZero, dnbSum = vZero;
+    Vec cladMax = set1(-1.0e300), centerMax = cladMax, outletMax = cladMax;
+    for (size_t c = 0; c < padded; c += WIDTH) {
+        const Vec s = load(share + c);
+        const Vec w = load(flow + c);
+
+        // Enthalpy rise; the coolant cannot heat past saturation (bulk boiling)
+        const Vec rise = vRise * s / w;
+        const Vec out = vmin(vSat, vInlet + rise);
+        const Vec mid = vmin(vSat, vInlet + vHalf * rise);
+
+        // Hot spot of the channel: nucleate boiling until the wall superheat
+        // reaches the DNB limit, film boiling until it falls back to saturation
+        const Vec qAverage = vHeat * s;
+        const Vec qPeak = qAverage * vPeak;
+        const Vec h = vFilm * load(convection + c);
+        const Vec cladNucleate = mid + qPeak / (vPerimeter * h);
+        const Mask departed = mor(gt(cladNucleate, vDnbLimit),
+                                  mand(isSet(load(dnb + c)), gt(cladNucleate, vSat)));
+        const Vec hWall = select(departed, h * vBoiling, h);
+        const Vec filmDrop = vPerimeter * hWall;
+        const Vec cladTarget = mid + qPeak / filmDrop;
+        const Vec centerTarget = cladTarget + qPeak * (vGap + vPellet);
+        const Vec fuelTarget = mid + qAverage / filmDrop + qAverage * (vGap + vHalf * vPellet);
+
+        Vec cl = load(clad + c);
+        Vec ce = load(centerline + c) + vExternal;
+        Vec fa = load(fuel + c) + vExternal;
+        cl = cl + vCladRelax * (cladTarget - cl);
+        ce = ce + vFuelRelax * (centerTarget - ce);
+        fa = fa + vFuelRelax * (fuelTarget - fa);
+
+        store(outlet + c, out);
+        store(clad + c, cl);
+        store(centerline + c, ce);
+        store(fuel + c, fa);
+        store(dnb + c, flag(departed));
+
+        fuelSum = fuelSum + fa * load(weight + c);
+        dnbSum = dnbSum + flag(departed);
+        cladMax = vmax(cladMax, cl);
+        centerMax = vmax(centerMax, ce);
+        outletMax = vmax(outletMax, out);
+    }
+
+    double lanes[5][WIDTH];
+    store(lanes[0], fuelSum);
+    store(lanes[1], dnbSum);
+    store(lanes[2], cladMax);
+    store(lanes[3], centerMax);
+    store(lanes[4], outletMax);
+    ChannelSummary summary{lanes[2][0], lanes[3][0], lanes[4][0], 0.0, flowFraction, inlet, 0};
+    double totalFuel = 0.0, totalDnb = 0.0;
+    for (int l = 0; l < WIDTH; ++l) {
+        totalFuel += lanes[0][l];
+        totalDnb += lanes[1][l];
+        summary.peakClad = std::max(summary.peakClad, lanes[2][l]);
+        summary.peakCenterline = std::max(summary.peakCenterline, lanes[3][l]);
+        summary.maxOutlet = std::max(summary.maxOutlet, lanes[4][l]);
+    }
+    summary.averageFuel = totalFuel / count;
+    summary.dnbChannels = static_cast<int>(totalDnb + 0.5);
+    last = summary;
+    sessionPeak = std::max(sessionPeak, summary.peakClad);
+
+    state.temperature = std::max(0.0, summary.averageFuel);
+    reportedTemperature = state.temperature;
+
+    updates++;
+    kernelSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double SubchannelModel::nanosPerUpdate() const {
+    return updates > 0 ? 1.0e9 * kernelSeconds / updates : 0.0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "reactor_state.h"
+
+#include <vector>
+#include <cstddef>
+
+// Subchannel thermal-hydraulics (opt-in with --channels N). The core's heat
+// goes into N parallel coolant channels, each with its own power share and
+// orificed flow. Per turn every channel gets an enthalpy rise, a hot-spot
+// clad temperature from forced convection (degraded past departure from
+// nucleate boiling) and fuel average/centerline temperatures through the gap
+// and pellet conduction. Channel state lives in SoA arrays advanced with the
+// simd.h kernels.
+//
+// state.temperature becomes the core-average fuel temperature. Changes other
+// systems make to it between turns (events, ECCS, SCRAM) are applied to every
+// channel's fuel so they keep their effect.
+namespace TH {
+    static constexpr double MW_PER_POWER_UNIT = 30.0;      // 100 power units = 3000 MWt
+    static constexpr double NOMINAL_FLOW = 17000.0;        // kg/s, whole core
+    static constexpr double COOLANT_CP = 5.5e-3;           // MJ/(kg K)
+    static constexpr double INLET_TEMPERATURE = 290.0;     // C at clear weather
+    static constexpr double SATURATION_TEMPERATURE = 345.0;  // C at 155 bar
+    static constexpr double DNB_SUPERHEAT = 25.0;          // Wall superheat at DNB
+    static constexpr double FILM_BOILING_FACTOR = 0.1;     // h after DNB
+    static constexpr double CLAD_SCRAM_TEMPERATURE = 700.0;  // Peak clad trip setpoint
+
+    // Fuel rod: linear heat rate at nominal power, geometry and conductances
+    static constexpr double NOMINAL_LINEAR_HEAT = 12.0e3;  // W/m, core average
+    static constexpr double AXIAL_PEAKING = 1.5;
+    static constexpr double ROD_DIAMETER = 9.5e-3;         // m
+    static constexpr double CONVECTION = 3.0e4;            // W/(m2 K) at nominal flow
+    static constexpr double GAP_CONDUCTANCE = 1.0e4;       // W/(m2 K)
+    static constexpr double FUEL_CONDUCTIVITY = 3.5;       // W/(m K)
+
+    // Fraction of the way to steady state covered per turn
+    static constexpr double FUEL_RELAXATION = 0.5;
+    static constexpr double CLAD_RELAXATION = 0.7;
+
+    // Natural circulation once the pumps lose suction
+    static constexpr double MIN_FLOW_FRACTION = 0.03;
+    static constexpr double PUMP_SUCTION_COOLANT = 30.0;   // % inventory for full flow
+}
+
+// Per-channel arrays; PEAK_* hold the hot spot (axial peak) of the channel
+enum class ChannelField {
+    POWER_SHARE,     // Relative channel power, mean 1
+    FLOW_SHARE,      // Relative channel flow from orificing, mean 1
+    CONVECTION_SHARE,  // FLOW_SHARE^0.8 (Dittus-Boelter)
+    WEIGHT,          // 1 for real channels, 0 for SIMD padding
+    OUTLET,
+    PEAK_CLAD,
+    PEAK_CENTERLINE,
+    FUEL_AVERAGE,
+    DNB,             // 1 after departure from nucleate boiling at the hot spot
+    FIELD_COUNT
+};
+
+struct ChannelSummary {
+    double peakClad;
+    double peakCenterline;
+    double maxOutlet;
+    double averageFuel;
+    double flowFraction;
+    double inlet;
+    int dnbChannels;
+};
+
+class SubchannelModel {
+public:
+    explicit SubchannelModel(int channels);
+
+    // Put every channel at the zero-power state for the current inlet conditions
+    void reset(const ReactorState& state);
+
+    // Advance one turn from state.power and state.coolant; sets state.temperature
+    void update(ReactorState& state);
+
+    // Channel fields for save files; loadState() is false, changing nothing,
+    // for data from another channel count
+    void saveState(std::vector<unsigned char>& out) const;
+    bool loadState(const unsigned char* data, size_t size);
+
+    int channelCount() const { return count; }
+    const ChannelSummary& summary() const { return last; }
+    double sessionPeakClad() const { return sessionPeak; }
+    double nanosPerUpdate() const;  // Mean kernel cost
+
+    double* field(ChannelField f) { return &data[static_cast<size_t>(f) * padded]; }
+    const double* field(ChannelField f) const { return &data[static_cast<size_t>(f) * padded]; }
+
+private:
+    int count;
+    size_t padded;
+    int gridSide;               // Channels are laid out on a gridSide^2 square
+    std::vector<double> data;
+    ChannelSummary last;
+    double reportedTemperature; // state.temperature as this model last set it
+    double sessionPeak;
+    long updates;
+    double kernelSeconds;
+
+    void updatePowerShares(const ReactorState& state);
+    void setFlowShares();
+};
@@ -0,0 +1,219 @@
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(TelemetryFields) % 8 == 0, "telemetry fields must be whole 8-byte words");
+static_assert(std::is_trivially_copyable<TelemetryFields>::value, "telemetry fields are copied as words");
+
+void TelemetryFields::capture(const ReactorState& state) {
+    publishedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    turn = state.turns;
+    score = state.score;
+    scramCount = state.scramCount;
+    difficulty = static_cast<int64_t>(state.currentDifficulty.level);
+    flags = 0;
+    if (state.running) flags |= TF_RUNNING;
+    if (state.paused) flags |= TF_PAUSED;
+    if (state.turbineOnline) flags |= TF_TURBINE_ONLINE;
+    if (state.pressureReliefOpen) flags |= TF_RELIEF_OPEN;
+    if (state.eccsAvailable) flags |= TF_ECCS_AVAILABLE;
+    if (state.dieselRunning) flags |= TF_DIESEL_RUNNING;
+    if (state.dieselAutoStart) flags |= TF_DIESEL_AUTO;
+    if (state.containmentBreach) flags |= TF_CONTAINMENT_BREACH;
+
+    neutrons = state.neutrons;
+    controlRods = state.controlRods;
+    temperature = state.temperature;
+    coolant = state.coolant;
+    power = state.power;
+    fuel = state.fuel;
+    xenon = state.xenonLevel;
+
+    turbineRPM = state.turbineRPM;
+    steamPressure = state.steamPressure;
+    electricityOutput = state.electricityOutput;
+    totalElectricity = state.totalElectricityGenerated;
+
+    eccsCooldown = state.eccsCooldownTimer;
+    dieselFuel = state.dieselFuel;
+    dieselRuntime = state.dieselRuntime;
+
+    radiationLevel = state.radiationLevel;
+    radiationExposure = state.totalRadiationExposure;
+    containmentIntegrity = state.containmentIntegrity;
+
+    gridDemand = state.gridDemand;
+    demandSatisfaction = state.demandSatisfaction;
+    weather = static_cast<int64_t>(state.currentWeather);
+    weatherDuration = state.weatherDuration;
+}
+
+TelemetryPublisher::TelemetryPublisher() : segment(nullptr), sequence(0) {}
+
+TelemetryPublisher::~TelemetryPublisher() {
+    close();
+}
+
+#ifndef _WIN32
+// Process id of the simulator publishing to an existing segment `name`, or 0
+// when its writer has exited and the segment can be replaced. A segment
+// without a complete header may be one another simulator is creating right
+// now, so it counts as held (by an unknown process) rather than stale.
+static bool segmentHeld(const std::string& name, uint32_t& owner) {
+    owner = 0;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return errno != ENOENT;
+    struct stat info;
+    bool whole = fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(TelemetrySegment));
+    void* mapped = whole ? mmap(nullptr, sizeof(TelemetrySegment), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (mapped == MAP_FAILED) return true;
+    const TelemetrySegment* existing = static_cast<const TelemetrySegment*>(mapped);
+    bool headed = existing->magic.load(std::memory_order_acquire) == TM::MAGIC;
+    owner = headed ? existing->writer : 0;
+    munmap(mapped, sizeof(TelemetrySegment));
+    if (!headed) return true;
+    // EPERM: alive, under another user
+    return owner != 0 && (kill(static_cast<pid_t>(owner), 0) == 0 || errno == EPERM);
+}
+#endif
+
+bool TelemetryPublisher::open(const std::string& segmentName, uint32_t* owner) {
+    close();
+    if (owner) *owner = 0;
+#ifdef _WIN32
+    (void)segmentName;
+    return false;
+#else
+    // Exclusive creation, so two simulators never write one segment. A stale
+    // segment is unlinked and creation retried once; losing that race to
+    // another simulator fails like finding it running.
+    int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        uint32_t holder;
+        if (segmentHeld(segmentName, holder)) {
+            if (owner) *owner = holder;
+            return false;
+        }
+        shm_unlink(segmentName.c_str());
+        fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) return false;
+    bool sized = ftruncate(fd, sizeof(TelemetrySegment)) == 0;
+    void* mapped = sized ? mmap(nullptr, sizeof(TelemetrySegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                         : MAP_FAILED;
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(segmentName.c_str());
+        return false;
+    }
+
+    // Readers ignore the segment until magic is set, after the header
+    segment = static_cast<TelemetrySegment*>(mapped);
+    segment->magic.store(0, std::memory_order_relaxed);
+    segment->version = TM::VERSION;
+    segment->size = sizeof(TelemetrySegment);
+    segment->writer = static_cast<uint32_t>(getpid());
+    sequence = 0;
+    segment->sequence.store(0, std::memory_order_relaxed);
+    segment->magic.store(TM::MAGIC, std::memory_order_release);
+    name = segmentName;
+    return true;
+#endif
+}
+
+void TelemetryPublisher::close() {
+#ifndef _WIN32
+    if (!segment) return;
+    munmap(segment, sizeof(TelemetrySegment));
+    shm_unlink(name.c_str());
+    segment = nullptr;
+#endif
+}
+
+void TelemetryPublisher::publish(const ReactorState& state) {
+    if (!segment) return;
+    TelemetryFields fields;
+    fields.capture(state);
+    uint64_t words[TelemetrySegment::WORDS];
+    std::memcpy(words, &fields, sizeof(words));
+
+    // Odd while writing; the fence keeps the stores below after it
+    segment->sequence.store(++sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < TelemetrySegment::WORDS; ++i) {
+        segment->words[i].store(words[i], std::memory_order_relaxed);
+    }
+    segment->sequence.store(++sequence, std::memory_order_release);
+}
+
+TelemetryReader::TelemetryReader() : segment(nullptr) {}
+
+TelemetryReader::~TelemetryReader() {
+    close();
+}
+
+bool TelemetryReader::open(const std::string& segmentName) {
+    close();
+#ifdef _WIN32
+    (void)segmentName;
+    return false;
+#else
+    int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    void* mapped = mmap(nullptr, sizeof(TelemetrySegment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    segment = static_cast<const TelemetrySegment*>(mapped);
+    if (segment->magic.load(std::memory_order_acquire) != TM::MAGIC || segment->version != TM::VERSION ||
+        segment->size != sizeof(TelemetrySegment)) {
+        close();
+        return false;
+    }
+    return true;
+#endif
+}
+
+void TelemetryReader::close() {
+#ifndef _WIN32
+    if (!segment) return;
+    munmap(const_cast<TelemetrySegment*>(segment), sizeof(TelemetrySegment));
+    segment = nullptr;
+#endif
+}
+
+bool TelemetryReader::sample(TelemetryFields& fields, uint64_t& updates) const {
+    if (!segment) return false;
+    uint64_t words[TelemetrySegment::WORDS];
+    for (int attempt = 0; attempt < TM::READ_ATTEMPTS; ++attempt) {
+        uint64_t before = segment->sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        for (int i = 0; i < TelemetrySegment::WORDS; ++i) {
+            words[i] = segment->words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence.load(std::memory_order_relaxed) != before) continue;
+        if (before == 0) return false;
+        std::memcpy(&fields, words, sizeof(words));
+        updates = before / 2;
+        return true;
+    }
+    return false;
+}
+
+uint32_t TelemetryReader::writer() const {
+    return segment ? segment->writer : 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "reactor_state.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Per-turn telemetry in POSIX shared memory for external monitors. The
+// segment holds a fixed header and one TelemetryFields record guarded by a
+// seqlock: the simulator bumps the sequence to odd, stores the record and
+// bumps it to even, never waiting for anyone. Readers copy the record and
+// keep the copy only if the sequence was even and unchanged around it, so
+// any number of them can sample without a lock or a syscall. Every field is
+// 8 bytes and stored as a relaxed atomic word; new fields go at the end with
+// a version bump, and readers check the version and size before trusting
+// the layout.
+namespace TM {
+    static constexpr uint32_t MAGIC = 0x4c455452;  // "RTEL"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* DEFAULT_NAME = "/reactor";
+    // Reader attempts while the writer is mid-update before giving up
+    static constexpr int READ_ATTEMPTS = 64;
+}
+
+// Bits of TelemetryFields::flags
+enum TelemetryFlag : uint64_t {
+    TF_RUNNING = 1u << 0,          // False after a SCRAM until reset
+    TF_PAUSED = 1u << 1,
+    TF_TURBINE_ONLINE = 1u << 2,
+    TF_RELIEF_OPEN = 1u << 3,
+    TF_ECCS_AVAILABLE = 1u << 4,
+    TF_DIESEL_RUNNING = 1u << 5,
+    TF_DIESEL_AUTO = 1u << 6,
+    TF_CONTAINMENT_BREACH = 1u << 7,
+};
+
+struct TelemetryFields {
+    uint64_t publishedNs;  // CLOCK_MONOTONIC (steady_clock) time of the update
+    int64_t turn;
+    int64_t score;
+    int64_t scramCount;
+    int64_t difficulty;  // Difficulty enum value
+    uint64_t flags;      // TelemetryFlag bits
+
+    // Core
+    double neutrons;
+    double controlRods;  // 0-1
+    double temperature;  // degC
+    double coolant;      // %
+    double power;        // %
+    double fuel;         // %
+    double xenon;        // %
+
+    // Turbine
+    double turbineRPM;
+    double steamPressure;      // bar
+    double electricityOutput;  // MW
+    double totalElectricity;   // MW.h
+
+    // Emergency systems
+    int64_t eccsCooldown;  // Turns
+    double dieselFuel;     // %
+    int64_t dieselRuntime;
+
+    // Radiation and containment
+    double radiationLevel;     // mSv/h
+    double radiationExposure;  // Accumulated mSv
+    double containmentIntegrity;
+
+    // Grid and weather
+    double gridDemand;          // MW
+    double demandSatisfaction;  // %
+    int64_t weather;            // Weather enum value
+    int64_t weatherDuration;    // Turns left
+
+    void capture(const ReactorState& state);
+};
+
+// Shared-memory layout. The header is written once, before magic.
+struct TelemetrySegment {
+    static constexpr int WORDS = sizeof(TelemetryFields) / 8;
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t size;    // sizeof(TelemetrySegment) of the writer
+    uint32_t writer;  // Process id; a new simulator takes the name over only once it exits
+    std::atomic<uint64_t> sequence;  // Odd while the record is being written
+    std::atomic<uint64_t> words[WORDS];
+};
+
+class TelemetryPublisher {
+public:
+    TelemetryPublisher();
+    ~TelemetryPublisher();
+
+    // Create the segment `name`, e.g. "/reactor". A segment left behind by a
+    // simulator that has exited is replaced; one whose writer is still running,
+    // or is still being set up, is left alone and open fails, with the writer's
+    // process id in `owner` when known (0 otherwise).
+    bool open(const std::string& name, uint32_t* owner = nullptr);
+    // Unmap and remove the segment
+    void close();
+    bool isOpen() const { return segment != nullptr; }
+
+    // Never blocks or allocates
+    void publish(const ReactorState& state);
+
+private:
+    TelemetrySegment* segment;
+    std::string name;
+    uint64_t sequence;
+
+    TelemetryPublisher(const TelemetryPublisher&);
+    TelemetryPublisher& operator=(const TelemetryPublisher&);
+};
+
+class TelemetryReader {
+public:
+    TelemetryReader();
+    ~TelemetryReader();
+
+    // Map the segment read-only; false if it is missing or has another layout
+    bool open(const std::string& name);
+    void close();
+
+    // A consistent copy of the newest record, and the number of updates
+    // published so far; false when no update is published yet or the writer
+    // stayed mid-update for TM::READ_ATTEMPTS tries
+    bool sample(TelemetryFields& fields, uint64_t& updates) const;
+    // Process id of the simulator that created the segment
+    uint32_t writer() const;
+
+private:
+    const TelemetrySegment* segment;
+
+    TelemetryReader(const TelemetryReader&);
+    TelemetryReader& operator=(const TelemetryReader&);
+};
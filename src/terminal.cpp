@@ -0,0 +1,233 @@
+#include "terminal.h"
+#include "framebuffer.h"
+#include "perf.h"
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Smallest screen the split layout is used on: the dashboard's width, and
+// enough rows under it for the prompt and a few messages
+const int MIN_COLUMNS = 60;
+const int MIN_CONSOLE_ROWS = 8;
+// Rows reserved under the first frame for tips, which come and go and may
+// wrap. Anything past the reserved rows is cut off: growing the dashboard
+// would mean clearing the messages under it.
+const int SPARE_ROWS = 2;
+
+const char ENTER_SEQUENCE[] = "\033[?1049h";
+// Whole-screen scrolling, default attributes, normal screen
+const char LEAVE_SEQUENCE[] = "\033[r\033[0m\033[?1049l";
+const char SUSPEND_SEQUENCE[] = "\033[r\033[0m\033[2J\033[H";
+
+// Collects the text of a frame, keeping its storage between frames
+class CaptureBuffer : public std::streambuf {
+public:
+    std::string text;
+
+protected:
+    int overflow(int c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        text += traits_type::to_char_type(c);
+        return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        text.append(s, static_cast<size_t>(n));
+        return n;
+    }
+};
+
+struct Screen {
+    bool active;
+    bool laidOut;        // Dashboard painted and the scrolling region set
+    int rows;
+    int cols;
+    int height;          // Rows reserved for the dashboard
+    FrameBuffer front;   // What the terminal shows
+    FrameBuffer back;    // The frame being composed
+    CaptureBuffer capture;
+    std::streambuf* console;
+    std::string out;
+
+    Screen() : active(false), laidOut(false), rows(0), cols(0), height(0), console(nullptr) {}
+};
+
+Screen screen;
+
+void writeAll(const char* data, size_t size) {
+    Perf::countWrite(size);
+#ifdef _WIN32
+    std::fwrite(data, 1, size, stdout);
+    std::fflush(stdout);
+#else
+    while (size > 0) {
+        ssize_t written = ::write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+#endif
+}
+
+bool querySize(int& rows, int& cols) {
+#ifdef _WIN32
+    (void)rows;
+    (void)cols;
+    return false;
+#else
+    winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0 || size.ws_col == 0) return false;
+    rows = size.ws_row;
+    cols = size.ws_col;
+    return true;
+#endif
+}
+
+#ifndef _WIN32
+void restoreOnSignal(int sig) {
+    ssize_t ignored = ::write(STDOUT_FILENO, LEAVE_SEQUENCE, sizeof(LEAVE_SEQUENCE) - 1);
+    (void)ignored;
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+const int RESTORE_SIGNALS[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+#endif
+
+// Back to the normal screen, leaving std::cout to the caller
+void restore() {
+    writeAll(LEAVE_SEQUENCE, sizeof(LEAVE_SEQUENCE) - 1);
+#ifndef _WIN32
+    for (int sig : RESTORE_SIGNALS) std::signal(sig, SIG_DFL);
+#endif
+    screen.active = false;
+    screen.laidOut = false;
+}
+
+// Clear the screen, paint the dashboard over its first `height` rows and
+// scroll only the rows below it
+void layout(const std::string& text) {
+    screen.back.resize(screen.height, screen.cols);
+    screen.back.compose(text);
+    screen.front.resize(screen.height, screen.cols);
+
+    char region[48];
+    std::snprintf(region, sizeof(region), "\033[%d;%dr\033[%d;1H", screen.height + 1, screen.rows,
+                  screen.height + 1);
+    screen.out = "\033[r\033[0m\033[2J";
+    screen.back.paint(0, screen.out);
+    screen.out += region;
+    screen.laidOut = true;
+}
+}
+
+bool Terminal::enter() {
+#ifdef _WIN32
+    return false;
+#else
+    if (screen.active) return true;
+    const char* term = std::getenv("TERM");
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO) || !term || !*term || std::strcmp(term, "dumb") == 0) {
+        return false;
+    }
+    if (!querySize(screen.rows, screen.cols)) return false;
+
+    std::cout.flush();
+    writeAll(ENTER_SEQUENCE, sizeof(ENTER_SEQUENCE) - 1);
+    for (int sig : RESTORE_SIGNALS) std::signal(sig, restoreOnSignal);
+    screen.active = true;
+    screen.laidOut = false;
+    screen.height = 0;
+    return true;
+#endif
+}
+
+void Terminal::leave() {
+    if (!screen.active) return;
+    std::cout.flush();
+    restore();
+}
+
+bool Terminal::active() {
+    return screen.active;
+}
+
+void Terminal::beginFrame() {
+    if (!screen.active) return;
+    screen.capture.text.clear();
+    screen.console = std::cout.rdbuf(&screen.capture);
+}
+
+void Terminal::endFrame() {
+    if (!screen.active) return;
+    std::cout.rdbuf(screen.console);
+    std::cout.flush();
+    present(screen.capture.text);
+}
+
+void Terminal::present(const std::string& text) {
+    if (!screen.active) {
+        writeAll(text.data(), text.size());
+        return;
+    }
+
+    int rows = screen.rows, cols = screen.cols;
+    querySize(rows, cols);
+    if (rows != screen.rows || cols != screen.cols) {
+        screen.rows = rows;
+        screen.cols = cols;
+        screen.laidOut = false;
+    }
+
+    if (screen.laidOut) {
+        screen.back.compose(text);
+        screen.out = "\0337";  // Save the console cursor and attributes
+        size_t empty = screen.out.size();
+        screen.back.diff(screen.front, 0, screen.out);
+        if (screen.out.size() == empty) {
+            screen.out.clear();
+        } else {
+            screen.out += "\0338";
+        }
+    } else {
+        // Measure at full screen height
+        screen.back.resize(screen.rows, screen.cols);
+        screen.back.compose(text);
+        screen.height = screen.back.lines() + SPARE_ROWS;
+        if (screen.cols < MIN_COLUMNS || screen.rows - screen.height < MIN_CONSOLE_ROWS) {
+            restore();
+            writeAll(text.data(), text.size());
+            return;
+        }
+        layout(text);
+    }
+
+    if (!screen.out.empty()) writeAll(screen.out.data(), screen.out.size());
+    std::swap(screen.front, screen.back);
+}
+
+void Terminal::write(const char* data, size_t size) {
+    writeAll(data, size);
+}
+
+void Terminal::suspend() {
+    if (!screen.active || !screen.laidOut) return;
+    std::cout.flush();
+    writeAll(SUSPEND_SEQUENCE, sizeof(SUSPEND_SEQUENCE) - 1);
+    screen.laidOut = false;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Full-screen dashboard for interactive play. Between beginFrame() and
+// endFrame() everything printed to std::cout is composed into a
+// FrameBuffer; endFrame() sends only the cells that changed since the last
+// frame, with cursor addressing, in a single write(). The dashboard sits at
+// the top of the alternate screen above a scrolling region that holds the
+// prompt, command feedback and event messages. suspend() hands the whole
+// screen to a modal screen (help, stats, log...) and the next frame lays the
+// dashboard out again. Without a terminal (pipes, TERM=dumb, Windows) or on
+// a screen too small for the dashboard, frames print as scrolling text.
+class Terminal {
+public:
+    // Switch to the alternate screen if stdin and stdout are a terminal
+    static bool enter();
+    // Back to the normal screen
+    static void leave();
+    static bool active();
+
+    static void beginFrame();
+    static void endFrame();
+    // Show a composed frame without going through std::cout, for a thread
+    // other than the one printing console text. Without the alternate screen
+    // the text is written as is.
+    static void present(const std::string& text);
+    // Console text, straight to the terminal
+    static void write(const char* data, size_t size);
+
+    // Clear the screen and release the scrolling region for a modal screen
+    static void suspend();
+};
@@ -0,0 +1,349 @@
+#include "trends.h"
+#include "reactor_state.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// Bits are packed from the low end of each word
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint64_t>& words) : words(words), bits(0) {}
+
+    void put(uint64_t value, int count) {
+        if (count < 64) value &= (uint64_t(1) << count) - 1;
+        size_t index = bits / 64;
+        int offset = static_cast<int>(bits % 64);
+        if (index + 1 >= words.size()) words.resize(index + 2, 0);
+        words[index] |= value << offset;
+        if (offset + count > 64) words[index + 1] |= value >> (64 - offset);
+        bits += count;
+    }
+
+    size_t size() const { return bits; }
+
+private:
+    std::vector<uint64_t>& words;
+    size_t bits;
+};
+
+class BitReader {
+public:
+    BitReader(const uint64_t* words, size_t bits) : words(words), bits(bits) {}
+
+    uint64_t get(int count) {
+        size_t index = bits / 64;
+        int offset = static_cast<int>(bits % 64);
+        uint64_t value = words[index] >> offset;
+        if (offset + count > 64) value |= words[index + 1] << (64 - offset);
+        bits += count;
+        return count < 64 ? value & ((uint64_t(1) << count) - 1) : value;
+    }
+
+private:
+    const uint64_t* words;
+    size_t bits;
+};
+
+uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int64_t signExtend(uint64_t value, int count) {
+    uint64_t sign = uint64_t(1) << (count - 1);
+    return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+// Delta-of-delta prefixes: 0, 10, 110, 1110 and 1111 with the payload widths below
+const int DOD_WIDTHS[] = {7, 9, 12, 32};
+
+void putTurns(BitWriter& out, const int* turns, int count) {
+    out.put(static_cast<uint32_t>(turns[0]), 32);
+    int64_t delta = 1;
+    for (int i = 1; i < count; ++i) {
+        int64_t next = static_cast<int64_t>(turns[i]) - turns[i - 1];
+        int64_t dod = next - delta;
+        delta = next;
+        if (dod == 0) {
+            out.put(0, 1);
+            continue;
+        }
+        int k = 0;
+        while (k < 3 && (dod < -(int64_t(1) << (DOD_WIDTHS[k] - 1)) || dod >= (int64_t(1) << (DOD_WIDTHS[k] - 1)))) k++;
+        out.put((uint64_t(1) << (k + 1)) - 1, k + 1);  // k + 1 ones...
+        if (k < 3) out.put(0, 1);                      // ...ended by a zero below 1111
+        out.put(static_cast<uint64_t>(dod), DOD_WIDTHS[k]);
+    }
+}
+
+void getTurns(BitReader& in, int* turns, int count) {
+    turns[0] = static_cast<int>(static_cast<uint32_t>(in.get(32)));
+    int64_t delta = 1;
+    for (int i = 1; i < count; ++i) {
+        int k = 0;
+        while (k < 4 && in.get(1)) k++;
+        if (k > 0) {
+            int width = DOD_WIDTHS[k - 1];
+            delta += signExtend(in.get(width), width);
+        }
+        turns[i] = static_cast<int>(turns[i - 1] + delta);
+    }
+}
+
+// Gorilla XOR encoding: 0 for a repeat; 10 and the meaningful bits when they
+// fit the previous leading/trailing zero window; otherwise 11, 5 bits of
+// leading zeros, 6 bits of length - 1 and the meaningful bits
+void putValues(BitWriter& out, const double* values, int count) {
+    uint64_t previous = toBits(values[0]);
+    out.put(previous, 64);
+    int leading = -1, trailing = 0;
+    for (int i = 1; i < count; ++i) {
+        uint64_t bits = toBits(values[i]);
+        uint64_t x = bits ^ previous;
+        previous = bits;
+        if (!x) {
+            out.put(0, 1);
+            continue;
+        }
+        int lead = std::min(31, __builtin_clzll(x));
+        int trail = __builtin_ctzll(x);
+        if (leading >= 0 && lead >= leading && trail >= trailing) {
+            out.put(1, 2);
+            out.put(x >> trailing, 64 - leading - trailing);
+        } else {
+            leading = lead;
+            trailing = trail;
+            int meaningful = 64 - leading - trailing;
+            out.put(3, 2);
+            out.put(static_cast<uint64_t>(leading), 5);
+            out.put(static_cast<uint64_t>(meaningful - 1), 6);
+            out.put(x >> trailing, meaningful);
+        }
+    }
+}
+
+void getValues(BitReader& in, double* values, int count) {
+    uint64_t previous = in.get(64);
+    values[0] = fromBits(previous);
+    int leading = 0, trailing = 0;
+    for (int i = 1; i < count; ++i) {
+        if (in.get(1)) {
+            if (in.get(1)) {
+                leading = static_cast<int>(in.get(5));
+                trailing = 64 - leading - (static_cast<int>(in.get(6)) + 1);
+            }
+            previous ^= in.get(64 - leading - trailing) << trailing;
+        }
+        values[i] = fromBits(previous);
+    }
+}
+
+void capture(const ReactorState& state, double* values) {
+    values[static_cast<int>(Trend::TEMPERATURE)] = state.temperature;
+    values[static_cast<int>(Trend::COOLANT)] = state.coolant;
+    values[static_cast<int>(Trend::FUEL)] = state.fuel;
+    values[static_cast<int>(Trend::XENON)] = state.xenonLevel;
+    values[static_cast<int>(Trend::RADIATION)] = state.radiationLevel;
+    values[static_cast<int>(Trend::TURBINE_RPM)] = state.turbineRPM;
+    values[static_cast<int>(Trend::STEAM_PRESSURE)] = state.steamPressure;
+    values[static_cast<int>(Trend::ELECTRICITY)] = state.electricityOutput;
+    values[static_cast<int>(Trend::DIESEL_FUEL)] = state.dieselFuel;
+    values[static_cast<int>(Trend::NEUTRONS)] = state.neutrons;
+    values[static_cast<int>(Trend::CONTROL_RODS)] = state.controlRods * 100.0;
+    values[static_cast<int>(Trend::POWER)] = state.power;
+    values[static_cast<int>(Trend::CONTAINMENT)] = state.containmentIntegrity;
+    values[static_cast<int>(Trend::EXPOSURE)] = state.totalRadiationExposure;
+    values[static_cast<int>(Trend::TOTAL_ELECTRICITY)] = state.totalElectricityGenerated;
+    values[static_cast<int>(Trend::GRID_DEMAND)] = state.gridDemand;
+    values[static_cast<int>(Trend::SATISFACTION)] = state.demandSatisfaction;
+    values[static_cast<int>(Trend::WEATHER)] = static_cast<double>(state.currentWeather);
+    values[static_cast<int>(Trend::WEATHER_DURATION)] = state.weatherDuration;
+    values[static_cast<int>(Trend::SCORE)] = state.score;
+}
+}
+
+const TrendInfo& getTrendInfo(Trend series) {
+    static const TrendInfo table[] = {
+        {"Temp",         "\xc2\xb0""C"},
+        {"Coolant",      "%"},
+        {"Fuel",         "%"},
+        {"Xenon",        "%"},
+        {"Radiation",    "mSv/h"},
+        {"Turbine",      "RPM"},
+        {"Pressure",     "bar"},
+        {"Output",       "MW"},
+        {"Diesel",       "%"},
+        {"Neutrons",     ""},
+        {"Rods",         "%"},
+        {"Power",        ""},
+        {"Containment",  "%"},
+        {"Exposure",     "mSv"},
+        {"Generated",    "MW\xc2\xb7h"},
+        {"Grid demand",  "MW"},
+        {"Satisfaction", "%"},
+        {"Weather",      ""},
+        {"Weather left", "turns"},
+        {"Score",        ""},
+    };
+    static_assert(sizeof(table) / sizeof(table[0]) == static_cast<size_t>(Trend::TREND_COUNT),
+                  "one TrendInfo per series");
+    return table[static_cast<int>(series)];
+}
+
+void TrendSummary::add(double value) {
+    if (count == 0 || value < min) min = value;
+    if (count == 0 || value > max) max = value;
+    sum += value;
+    count++;
+}
+
+void TrendSummary::merge(const TrendSummary& other) {
+    if (other.count == 0) return;
+    if (count == 0 || other.min < min) min = other.min;
+    if (count == 0 || other.max > max) max = other.max;
+    sum += other.sum;
+    count += other.count;
+}
+
+TrendHistory::TrendHistory() : openCount(0), lastTurn(-1), displayWindow(TR::DEFAULT_WINDOW) {}
+
+void TrendHistory::record(const ReactorState& state) {
+    if (state.turns <= lastTurn) truncate(state.turns);
+    if (openCount == TR::BLOCK_TURNS) seal();
+
+    double values[COLUMNS];
+    capture(state, values);
+    for (int c = 0; c < COLUMNS; ++c) openValues[c][openCount] = values[c];
+    openTurns[openCount++] = state.turns;
+    lastTurn = state.turns;
+}
+
+void TrendHistory::clear() {
+    blocks.clear();
+    groups.clear();
+    openCount = 0;
+    lastTurn = -1;
+}
+
+void TrendHistory::seal() {
+    blocks.emplace_back();
+    Block& block = blocks.back();
+    block.firstTurn = openTurns[0];
+    block.lastTurn = openTurns[openCount - 1];
+    block.count = openCount;
+
+    scratch.assign(scratch.size(), 0);
+    BitWriter out(scratch);
+    putTurns(out, openTurns, openCount);
+    for (int c = 0; c < COLUMNS; ++c) {
+        block.start[c] = static_cast<uint32_t>(out.size());
+        putValues(out, openValues[c], openCount);
+        for (int i = 0; i < openCount; ++i) block.summary[c].add(openValues[c][i]);
+    }
+    block.bits.assign(scratch.begin(), scratch.begin() + (out.size() + 63) / 64);
+    openCount = 0;
+
+    if (blocks.size() % TR::GROUP_BLOCKS == 0) {
+        groups.resize(groups.size() + COLUMNS);
+        TrendSummary* group = &groups[groups.size() - COLUMNS];
+        for (size_t b = blocks.size() - TR::GROUP_BLOCKS; b < blocks.size(); ++b) {
+            for (int c = 0; c < COLUMNS; ++c) group[c].merge(blocks[b].summary[c]);
+        }
+    }
+}
+
+void TrendHistory::truncate(int turn) {
+    while (openCount > 0 && openTurns[openCount - 1] >= turn) openCount--;
+    if (openCount == 0) {
+        while (!blocks.empty() && blocks.back().firstTurn >= turn) blocks.pop_back();
+        if (!blocks.empty() && blocks.back().lastTurn >= turn) {
+            // The last kept turn is in a sealed block: carry on filling it
+            const Block& block = blocks.back();
+            for (int c = 0; c < COLUMNS; ++c) decode(block, c, openTurns, openValues[c]);
+            openCount = block.count;
+            blocks.pop_back();
+            while (openTurns[openCount - 1] >= turn) openCount--;
+        }
+    }
+    groups.resize(blocks.size() / TR::GROUP_BLOCKS * COLUMNS);
+    lastTurn = openCount > 0 ? openTurns[openCount - 1] : blocks.empty() ? -1 : blocks.back().lastTurn;
+}
+
+void TrendHistory::decode(const Block& block, int column, int* turns, double* values) {
+    if (turns) {
+        BitReader in(block.bits.data(), 0);
+        getTurns(in, turns, block.count);
+    }
+    BitReader in(block.bits.data(), block.start[column]);
+    getValues(in, values, block.count);
+}
+
+bool TrendHistory::query(Trend series, int window, TrendSummary* buckets, int count) const {
+    for (int b = 0; b < count; ++b) buckets[b] = TrendSummary();
+    if (lastTurn < 0) return false;
+
+    int from = oldestTurn();
+    if (window > 0) from = std::max(from, lastTurn - window + 1);
+    int64_t span = static_cast<int64_t>(lastTurn) - from + 1;
+    auto bucket = [&](int turn) { return static_cast<int>(static_cast<int64_t>(turn - from) * count / span); };
+    int column = static_cast<int>(series);
+
+    // Blocks ending before the window are skipped without a look inside
+    size_t b = std::lower_bound(blocks.begin(), blocks.end(), from,
+                                [](const Block& block, int turn) { return block.lastTurn < turn; }) - blocks.begin();
+    int turns[TR::BLOCK_TURNS];
+    double values[TR::BLOCK_TURNS];
+    while (b < blocks.size()) {
+        size_t group = b / TR::GROUP_BLOCKS;
+        if (b % TR::GROUP_BLOCKS == 0 && (group + 1) * COLUMNS <= groups.size()) {
+            int first = blocks[b].firstTurn, last = blocks[b + TR::GROUP_BLOCKS - 1].lastTurn;
+            if (first >= from && bucket(first) == bucket(last)) {
+                buckets[bucket(first)].merge(groups[group * COLUMNS + column]);
+                b += TR::GROUP_BLOCKS;
+                continue;
+            }
+        }
+        const Block& block = blocks[b++];
+        if (block.firstTurn >= from && bucket(block.firstTurn) == bucket(block.lastTurn)) {
+            buckets[bucket(block.firstTurn)].merge(block.summary[column]);
+            continue;
+        }
+        decode(block, column, turns, values);
+        for (int i = 0; i < block.count; ++i) {
+            if (turns[i] >= from) buckets[bucket(turns[i])].add(values[i]);
+        }
+    }
+    for (int i = 0; i < openCount; ++i) {
+        if (openTurns[i] >= from) buckets[bucket(openTurns[i])].add(openValues[column][i]);
+    }
+    return true;
+}
+
+size_t TrendHistory::turns() const {
+    return sealedTurns() + static_cast<size_t>(openCount);
+}
+
+size_t TrendHistory::sealedTurns() const {
+    size_t total = 0;
+    for (const Block& block : blocks) total += static_cast<size_t>(block.count);
+    return total;
+}
+
+size_t TrendHistory::bytes() const {
+    size_t total = 0;
+    for (const Block& block : blocks) total += sizeof(Block) + block.bits.size() * sizeof(uint64_t);
+    return total + groups.size() * sizeof(TrendSummary);
+}
+
+int TrendHistory::oldestTurn() const {
+    if (!blocks.empty()) return blocks.front().firstTurn;
+    return openCount > 0 ? openTurns[0] : -1;
+}
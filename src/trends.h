@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct ReactorState;
+
+// Per-turn history of the physics, turbine, grid and weather readings for
+// the trend displays (interactive play only). Turns are collected in blocks
+// of TR::BLOCK_TURNS; a full block is sealed column by column in Gorilla
+// encoding: turn numbers as delta-of-deltas, and each reading XORed with
+// the previous one in its column, keeping only the bits in between the
+// leading and trailing zeros. Readings that hold still cost one bit per
+// turn. Every sealed block keeps the min, max and sum of each column, and so
+// does every group of TR::GROUP_BLOCKS blocks, so a window or sparkline
+// bucket that spans whole blocks never decodes them, and one that spans
+// whole groups never visits their blocks.
+namespace TR {
+    static constexpr int BLOCK_TURNS = 128;
+    static constexpr int GROUP_BLOCKS = 64;
+    static constexpr int SPARK_WIDTH = 16;      // Buckets per sparkline
+    static constexpr int DEFAULT_WINDOW = 256;  // Turns; 0 is the whole session
+}
+
+enum class Trend {
+    TEMPERATURE,
+    COOLANT,
+    FUEL,
+    XENON,
+    RADIATION,
+    TURBINE_RPM,
+    STEAM_PRESSURE,
+    ELECTRICITY,
+    DIESEL_FUEL,
+    NEUTRONS,
+    CONTROL_RODS,
+    POWER,
+    CONTAINMENT,
+    EXPOSURE,
+    TOTAL_ELECTRICITY,
+    GRID_DEMAND,
+    SATISFACTION,
+    WEATHER,
+    WEATHER_DURATION,
+    SCORE,
+    TREND_COUNT
+};
+
+struct TrendInfo {
+    const char* name;
+    const char* unit;
+};
+
+const TrendInfo& getTrendInfo(Trend series);
+
+struct TrendSummary {
+    double min;
+    double max;
+    double sum;
+    int count;
+
+    TrendSummary() : min(0.0), max(0.0), sum(0.0), count(0) {}
+    void add(double value);
+    void merge(const TrendSummary& other);
+    double mean() const { return count ? sum / count : 0.0; }
+};
+
+class TrendHistory {
+public:
+    TrendHistory();
+
+    // Append the state after a turn. A turn at or before the newest one
+    // (after a rewind or load) first drops the turns from there on.
+    void record(const ReactorState& state);
+    void clear();
+
+    // Summaries of `series` over the last `window` turns (0: all), split into
+    // `count` equal spans of turns, oldest first. Spans without a recorded
+    // turn have count 0. False when nothing is recorded.
+    bool query(Trend series, int window, TrendSummary* buckets, int count) const;
+
+    // Turns the trend displays cover; 0 is the whole session
+    int window() const { return displayWindow; }
+    void setWindow(int turns) { displayWindow = turns; }
+
+    size_t turns() const;        // Recorded turns
+    size_t sealedTurns() const;  // Turns in sealed blocks
+    size_t bytes() const;        // Sealed blocks with their summaries
+    int newestTurn() const { return lastTurn; }
+    int oldestTurn() const;
+
+private:
+    static constexpr int COLUMNS = static_cast<int>(Trend::TREND_COUNT);
+
+    struct Block {
+        int firstTurn;
+        int lastTurn;
+        int count;
+        uint32_t start[COLUMNS];  // Bit offset of each column; turns start at 0
+        std::vector<uint64_t> bits;
+        TrendSummary summary[COLUMNS];
+    };
+
+    std::vector<Block> blocks;  // Sealed, oldest first
+    // Column summaries of each complete run of GROUP_BLOCKS blocks, COLUMNS per group
+    std::vector<TrendSummary> groups;
+    // The block being filled, kept decoded
+    int openTurns[TR::BLOCK_TURNS];
+    double openValues[COLUMNS][TR::BLOCK_TURNS];
+    int openCount;
+    int lastTurn;
+    int displayWindow;
+
+    std::vector<uint64_t> scratch;  // Encoding buffer, reused by seal()
+
+    void seal();
+    // Drop the turns from `turn` on, decoding the block that holds the last
+    // kept one back into the open block
+    void truncate(int turn);
+    // Turn numbers and one column of a sealed block
+    static void decode(const Block& block, int column, int* turns, double* values);
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest value from one writer thread to one reader thread. The
+// writer fills back() and publish()es it; the reader's update() takes the
+// newest published value, and any the reader never got to are dropped.
+// Neither side ever waits: the three slots trade places through a single
+// atomic exchange, so each side always owns one slot outright.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), backSlot(0), frontSlot(2) {}
+
+    // Writer side
+    T& back() { return slots[backSlot]; }
+    void publish() {
+        uint8_t old = middle.exchange(static_cast<uint8_t>(backSlot | FRESH), std::memory_order_acq_rel);
+        backSlot = old & INDEX;
+    }
+
+    // Reader side: true when front() now holds a value not seen before
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t old = middle.exchange(static_cast<uint8_t>(frontSlot), std::memory_order_acq_rel);
+        frontSlot = old & INDEX;
+        return true;
+    }
+    T& front() { return slots[frontSlot]; }
+
+private:
+    static const uint8_t INDEX = 0x3;
+    static const uint8_t FRESH = 0x4;  // The middle slot was published since the reader last took it
+
+    T slots[3];
+    // Each on its own cache line: the writer's index, the reader's, and the shared one
+    alignas(64) std::atomic<uint8_t> middle;
+    alignas(64) int backSlot;
+    alignas(64) int frontSlot;
+};
@@ -1,10 +1,7 @@
 #include "turbine.h"
 
-#include <sstream>
-#include <iomanip>
 #include <cmath>
 #include <algorithm>
-#include <string>
 
 void TurbineSystem::update(ReactorState& state) {
     // Calculate steam pressure based on temperature (more realistic model)
@@ -18,15 +15,8 @@ void TurbineSystem::update(ReactorState& state) {
     // Pressure relief valve logic
     if (state.steamPressure > RC::CRITICAL_PRESSURE && !state.pressureReliefOpen) {
         state.pressureReliefOpen = true;
-        {
-            std::ostringstream oss;
-            oss << Color::YELLOW << Color::BOLD
-                << "\xf0\x9f\x94\xa7 PRESSURE RELIEF VALVE opened at "
-                << std::fixed << std::setprecision(1) << state.steamPressure << " bar!"
-                << Color::RESET << "\n";
-            state.addMessage(oss.str());
-        }
-        state.addLogEntry("WARNING", "Pressure relief valve opened");
+        state.post(MessageCode::RELIEF_VALVE_OPENED, Severity::WARNING, state.steamPressure);
+        state.addLogEntry(LogType::WARNING, LogCode::RELIEF_VALVE_OPENED);
         state.pressureWarnings++;
     }
 
@@ -34,25 +24,15 @@ void TurbineSystem::update(ReactorState& state) {
         state.steamPressure = std::max(0.0, state.steamPressure - 10.0);
         if (state.steamPressure < RC::CRITICAL_PRESSURE * 0.8) {
             state.pressureReliefOpen = false;
-            {
-                std::ostringstream oss;
-                oss << Color::GREEN << "\xe2\x9c\x93 Pressure relief valve closed. Pressure stabilized." << Color::RESET << "\n";
-                state.addMessage(oss.str());
-            }
-            state.addLogEntry("EVENT", "Pressure relief valve closed");
+            state.post(MessageCode::RELIEF_VALVE_CLOSED, Severity::INFO);
+            state.addLogEntry(LogType::EVENT, LogCode::RELIEF_VALVE_CLOSED);
         }
     }
 
     // Check for pipe rupture
     if (state.steamPressure > RC::RUPTURE_PRESSURE) {
-        {
-            std::ostringstream oss;
-            oss << Color::BG_RED << Color::WHITE << Color::BOLD
-                << " \xf0\x9f\x92\xa5 STEAM PIPE RUPTURE! Critical pressure exceeded! "
-                << Color::RESET << "\n";
-            state.addAlertMessage(oss.str());
-        }
-        state.addLogEntry("CRITICAL", "Steam pipe rupture - pressure exceeded " + std::to_string(static_cast<int>(RC::RUPTURE_PRESSURE)) + " bar");
+        state.post(MessageCode::PIPE_RUPTURE, Severity::ALARM);
+        state.addLogEntry(LogType::CRITICAL, LogCode::PIPE_RUPTURE, RC::RUPTURE_PRESSURE);
         state.coolant = std::max(0.0, state.coolant - 25.0);
         state.temperature += 50.0;
         state.turbineOnline = false;
@@ -66,11 +46,7 @@ void TurbineSystem::update(ReactorState& state) {
     }
 
     if (state.temperature < RC::MIN_TURBINE_TEMP) {
-        {
-            std::ostringstream oss;
-            oss << Color::YELLOW << "\xe2\x9a\xa0 Turbine cannot operate below " << RC::MIN_TURBINE_TEMP << "\xc2\xb0""C!" << Color::RESET << "\n";
-            state.addMessage(oss.str());
-        }
+        state.post(MessageCode::TURBINE_TOO_COLD, Severity::WARNING);
         state.turbineRPM = std::max(0.0, state.turbineRPM - 50.0);
         state.electricityOutput = 0.0;
         return;
@@ -78,10 +54,7 @@ void TurbineSystem::update(ReactorState& state) {
 
     // Pressure warning
     if (state.steamPressure > RC::CRITICAL_PRESSURE * 0.9) {
-        std::ostringstream oss;
-        oss << Color::RED << "\xe2\x9a\xa0 HIGH STEAM PRESSURE: " << std::fixed << std::setprecision(1) << state.steamPressure
-            << " bar (max " << RC::MAX_STEAM_PRESSURE << ")" << Color::RESET << "\n";
-        state.addMessage(oss.str());
+        state.post(MessageCode::HIGH_STEAM_PRESSURE, Severity::WARNING, state.steamPressure);
     }
 
     double pressureRatio = std::min(1.0, state.steamPressure / RC::MAX_STEAM_PRESSURE);
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
 
 // Sound effects using terminal bell
 namespace Sound {
@@ -45,23 +46,25 @@ enum class Weather {
 };
 
 struct WeatherInfo {
-    std::string name;
-    std::string icon;
+    const char* name;
+    const char* icon;
     double coolingModifier;
     double eventModifier;
-    std::string description;
+    const char* description;
 };
 
-inline WeatherInfo getWeatherInfo(Weather w) {
-    switch (w) {
-        case Weather::CLEAR:     return {"Clear",     "\xe2\x98\x80\xef\xb8\x8f", 1.0, 1.0, "Optimal conditions"};
-        case Weather::CLOUDY:    return {"Cloudy",    "\xe2\x98\x81\xef\xb8\x8f", 1.1, 1.0, "Slightly improved cooling"};
-        case Weather::RAIN:      return {"Rain",      "\xf0\x9f\x8c\xa7\xef\xb8\x8f", 1.3, 0.9, "Enhanced cooling, fewer events"};
-        case Weather::STORM:     return {"Storm",     "\xe2\x9b\x88\xef\xb8\x8f", 1.2, 1.5, "Risk of lightning damage"};
-        case Weather::HEATWAVE:  return {"Heatwave",  "\xf0\x9f\x94\xa5", 0.6, 1.2, "Reduced cooling efficiency"};
-        case Weather::COLD_SNAP: return {"Cold Snap", "\xe2\x9d\x84\xef\xb8\x8f", 1.5, 0.8, "Excellent cooling"};
-        default:                 return {"Clear",     "\xe2\x98\x80\xef\xb8\x8f", 1.0, 1.0, "Optimal conditions"};
-    }
+// Static table so the per-turn lookups never copy strings
+inline const WeatherInfo& getWeatherInfo(Weather w) {
+    static const WeatherInfo table[] = {
+        {"Clear",     "\xe2\x98\x80\xef\xb8\x8f", 1.0, 1.0, "Optimal conditions"},
+        {"Cloudy",    "\xe2\x98\x81\xef\xb8\x8f", 1.1, 1.0, "Slightly improved cooling"},
+        {"Rain",      "\xf0\x9f\x8c\xa7\xef\xb8\x8f", 1.3, 0.9, "Enhanced cooling, fewer events"},
+        {"Storm",     "\xe2\x9b\x88\xef\xb8\x8f", 1.2, 1.5, "Risk of lightning damage"},
+        {"Heatwave",  "\xf0\x9f\x94\xa5", 0.6, 1.2, "Reduced cooling efficiency"},
+        {"Cold Snap", "\xe2\x9d\x84\xef\xb8\x8f", 1.5, 0.8, "Excellent cooling"}
+    };
+    int i = static_cast<int>(w);
+    return table[i >= 0 && i <= static_cast<int>(Weather::COLD_SNAP) ? i : 0];
 }
 
 enum class Achievement {
@@ -84,6 +87,38 @@ enum class Achievement {
     ACHIEVEMENT_COUNT
 };
 
+// Achievements as a bitmask: membership tests and unlocks never allocate
+class AchievementSet {
+public:
+    AchievementSet() : bits(0) {}
+
+    bool contains(Achievement ach) const { return (bits & bit(ach)) != 0; }
+    bool insert(Achievement ach) {
+        bool added = !contains(ach);
+        bits |= bit(ach);
+        return added;
+    }
+    int size() const {
+        int n = 0;
+        for (uint32_t b = bits; b; b &= b - 1) n++;
+        return n;
+    }
+    bool empty() const { return bits == 0; }
+    void clear() { bits = 0; }
+
+    // Bit per Achievement, for snapshots and save files
+    uint32_t mask() const { return bits; }
+    static AchievementSet fromMask(uint32_t mask) {
+        AchievementSet set;
+        set.bits = mask & ((1u << static_cast<int>(Achievement::ACHIEVEMENT_COUNT)) - 1);
+        return set;
+    }
+
+private:
+    uint32_t bits;
+    static uint32_t bit(Achievement ach) { return 1u << static_cast<int>(ach); }
+};
+
 struct AchievementInfo {
     std::string name;
     std::string description;
@@ -113,8 +148,124 @@ inline const AchievementInfo* getAchievementInfoTable() {
     return table;
 }
 
+// Events the subsystems report to the operator. Each becomes a GameMessage
+// record; the text for a code lives in Renderer::formatMessage.
+enum class MessageCode {
+    COOLANT_CRITICAL,
+    AUTO_SCRAM,
+    SCRAM_PENALTY,
+    MELTDOWN,
+    XENON_POISONING,
+    RELIEF_VALVE_OPENED,     // value: steam pressure
+    RELIEF_VALVE_CLOSED,
+    PIPE_RUPTURE,
+    TURBINE_TOO_COLD,
+    HIGH_STEAM_PRESSURE,     // value: steam pressure
+    RADIATION_CRITICAL,      // value: radiation level
+    RADIATION_HIGH,          // value: radiation level
+    RADIATION_ELEVATED,      // value: radiation level
+    CONTAINMENT_BREACH,
+    CONTAINMENT_WARNING,     // value: integrity
+    CONTAINMENT_RESTORED,
+    ECCS_RECHARGED,
+    ECCS_COOLDOWN,           // detail: turns remaining
+    ECCS_ACTIVATED,
+    ECCS_PENALTY,
+    DIESEL_AUTO_START,
+    DIESEL_FUEL_LOW,         // value: fuel
+    DIESEL_OUT_OF_FUEL,
+    DIESEL_NO_FUEL,
+    DIESEL_STARTED,
+    DIESEL_STOPPED,
+    DIESEL_TANK_FULL,
+    DIESEL_REFILLED,
+    CATALOG_EVENT,           // detail: event catalog text, value: the event's value
+    GRID_CRITICAL,           // value: demand satisfaction
+    GRID_LOW,                // value: demand satisfaction
+    WEATHER_CHANGE,          // detail: new Weather
+    LIGHTNING_STRIKE,
+    LIGHTNING_TURBINE,
+    LIGHTNING_SENSORS,
+    LIGHTNING_GRID,
+    LIGHTNING_DIESEL_START,
+    ACHIEVEMENT_UNLOCKED     // detail: Achievement
+};
+
+// CRITICAL messages beep, ALARM messages sound the alert
+enum class Severity {
+    INFO,
+    WARNING,
+    CRITICAL,
+    ALARM
+};
+
+enum class LogType : uint8_t {
+    ACTION,
+    EVENT,
+    WARNING,
+    CRITICAL,
+    TYPE_COUNT
+};
+
+// Operator log entries; the text for a code lives in Renderer::formatLogEntry
+enum class LogCode : uint16_t {
+    COOLANT_REFILLED,
+    TURBINE_ONLINE,
+    TURBINE_OFFLINE,
+    DIESEL_AUTO_ENABLED,
+    DIESEL_AUTO_DISABLED,
+    PAUSED,
+    RESUMED,
+    ECCS_ACTIVATED,
+    DIESEL_AUTO_START,
+    DIESEL_OUT_OF_FUEL,
+    DIESEL_STARTED,
+    DIESEL_STOPPED,
+    DIESEL_REFILLED,
+    CONTAINMENT_BREACH,
+    CONTAINMENT_RESTORED,
+    // Random events from before the event catalog, kept so older saves and
+    // journals still read
+    COOLANT_LEAK,            // payload: coolant lost
+    POWER_SURGE,
+    PUMP_FAILURE,
+    XENON_SPIKE,
+    STEAM_LEAK_TURBINE,
+    STEAM_LEAK_BUILDING,
+    TURBINE_TRIP,
+    EFFICIENCY_BONUS,
+    COOLANT_DELIVERY,
+    MAINTENANCE_CREW,
+    RADIATION_CRITICAL,
+    RADIATION_ELEVATED,
+    SCRAM_TEMPERATURE,
+    SCRAM_NEUTRONS,
+    SCRAM_CLAD,
+    MELTDOWN,
+    RELIEF_VALVE_OPENED,
+    RELIEF_VALVE_CLOSED,
+    PIPE_RUPTURE,            // payload: rupture pressure
+    WEATHER_CHANGE,          // payload: new Weather
+    LIGHTNING_STRIKE,
+    REWOUND,                 // payload: turns rewound
+    AUTOPILOT_ENGAGED,
+    AUTOPILOT_DISENGAGED,
+    CATALOG_EVENT,           // Text of an event catalog other than the loaded one; payload: the event's value
+    CATALOG_TEXT = 0x8000    // And up: event catalog text (code - CATALOG_TEXT); payload: the event's value
+};
+
+// Fixed-size log record, also the on-disk journal format
+struct LogEntry {
+    int32_t turn;
+    LogType type;
+    uint8_t reserved;
+    LogCode code;
+    double payload;
+};
+
 struct DifficultySettings {
-    std::string name;
+    Difficulty level;
+    const char* name;
     double fuelDepletionRate;
     double coolantLossRate;
     double eventChance;
@@ -128,14 +279,23 @@ struct DifficultySettings {
 inline DifficultySettings getDifficultySettings(Difficulty diff) {
     switch (diff) {
         case Difficulty::EASY:
-            return {"Easy",      0.05, 0.15, 15.0, 1200.0, 2500.0, 1, 0.95, 0.5};
+            return {Difficulty::EASY,      "Easy",      0.05, 0.15, 15.0, 1200.0, 2500.0, 1, 0.95, 0.5};
         case Difficulty::NORMAL:
-            return {"Normal",    0.1,  0.3,  10.0, 1000.0, 2000.0, 2, 0.90, 1.0};
+            return {Difficulty::NORMAL,    "Normal",    0.1,  0.3,  10.0, 1000.0, 2000.0, 2, 0.90, 1.0};
         case Difficulty::HARD:
-            return {"Hard",      0.15, 0.5,   7.0,  800.0, 1500.0, 3, 0.85, 1.5};
+            return {Difficulty::HARD,      "Hard",      0.15, 0.5,   7.0,  800.0, 1500.0, 3, 0.85, 1.5};
         case Difficulty::NIGHTMARE:
-            return {"Nightmare", 0.2,  0.7,   5.0,  600.0, 1200.0, 5, 0.75, 2.0};
+            return {Difficulty::NIGHTMARE, "Nightmare", 0.2,  0.7,   5.0,  600.0, 1200.0, 5, 0.75, 2.0};
         default:
-            return {"Normal",    0.1,  0.3,  10.0, 1000.0, 2000.0, 2, 0.90, 1.0};
+            return {Difficulty::NORMAL,    "Normal",    0.1,  0.3,  10.0, 1000.0, 2000.0, 2, 0.90, 1.0};
     }
 }
+
+// Command-line level: easy|normal|hard|nightmare or 1-4
+inline bool parseDifficulty(const std::string& name, Difficulty& diff) {
+    if (name == "1" || name == "easy")      { diff = Difficulty::EASY;      return true; }
+    if (name == "2" || name == "normal")    { diff = Difficulty::NORMAL;    return true; }
+    if (name == "3" || name == "hard")      { diff = Difficulty::HARD;      return true; }
+    if (name == "4" || name == "nightmare") { diff = Difficulty::NIGHTMARE; return true; }
+    return false;
+}
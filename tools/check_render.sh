@@ -0,0 +1,34 @@
+#!/bin/sh
+# Real-time clock under a stalled terminal: run a 500 Hz session into a pipe
+# whose reader sleeps for STALL seconds, resetting SCRAMs every half second,
+# and check the tick count and missed deadlines from the closing clock line.
+# With the dashboard on the render thread the clock keeps running through the
+# stall; drawing on the simulation thread (`--sync-render`) fails the check.
+#
+#   tools/check_render.sh [REACTOR] [EXTRA ARGS...]
+#
+# MIN_TICKS and MAX_MISSED override the thresholds.
+REACTOR=${1:-./reactor}
+[ $# -gt 0 ] && shift
+STALL=${STALL:-5}
+MIN_TICKS=${MIN_TICKS:-750}
+MAX_MISSED=${MAX_MISSED:-500}
+
+resets() { for i in 1 2 3 4 5 6; do sleep 0.5; echo reset; done; }
+
+line=$(resets | "$REACTOR" --difficulty easy --realtime 500 --fps 50 "$@" \
+    | (sleep "$STALL"; cat) | sed 's/\x1b\[[0-9;]*m//g' | grep ' ticks at ' | tail -1)
+ticks=$(echo "$line" | sed -n 's/^\([0-9]*\) ticks at .*/\1/p')
+missed=$(echo "$line" | sed -n 's/.* \([0-9]*\) missed deadlines\{0,1\}$/\1/p')
+
+if [ -z "$ticks" ] || [ -z "$missed" ]; then
+    echo "render_check=FAIL reason=no clock line in the output"
+    exit 1
+fi
+if [ "$ticks" -ge "$MIN_TICKS" ] && [ "$missed" -le "$MAX_MISSED" ]; then
+    result=PASS
+else
+    result=FAIL
+fi
+echo "render_check=$result ticks=$ticks min_ticks=$MIN_TICKS missed=$missed max_missed=$MAX_MISSED"
+[ "$result" = PASS ]
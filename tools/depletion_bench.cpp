@@ -0,0 +1,140 @@
+#include "depletion.h"
+#include "simd.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+// Cost and accuracy of the batched CRAM depletion solve. The reference
+// propagates the same chain with a long-double matrix exponential (scaling
+// and squaring of a Taylor series) of the dense burnup matrix.
+
+typedef std::vector<std::vector<long double> > Matrix;
+
+static Matrix multiply(const Matrix& a, const Matrix& b) {
+    size_t n = a.size();
+    Matrix out(n, std::vector<long double>(n, 0.0L));
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t k = 0; k < n; ++k) {
+            for (size_t c = 0; c < n; ++c) out[r][c] += a[r][k] * b[k][c];
+        }
+    }
+    return out;
+}
+
+static Matrix expm(const DepletionChain& chain, double flux, double dt) {
+    size_t n = static_cast<size_t>(chain.size());
+    Matrix a(n, std::vector<long double>(n, 0.0L));
+    for (int i = 0; i < chain.size(); ++i) {
+        a[i][i] = (chain.diagonalConstant(i) + flux * chain.diagonalPerFlux(i)) * static_cast<long double>(dt);
+        for (const DepletionChain::Entry& e : chain.row(i)) {
+            a[i][e.column] = (e.constant + flux * e.perFlux) * static_cast<long double>(dt);
+        }
+    }
+
+    long double norm = 0.0L;
+    for (size_t r = 0; r < n; ++r) {
+        long double row = 0.0L;
+        for (size_t c = 0; c < n; ++c) row += std::fabs(a[r][c]);
+        norm = std::max(norm, row);
+    }
+    int squarings = 0;
+    while (norm > 0.25L) {
+        norm /= 2.0L;
+        squarings++;
+    }
+    Matrix result(n, std::vector<long double>(n, 0.0L)), term = result;
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < n; ++c) a[r][c] = std::ldexp(a[r][c], -squarings);
+        result[r][r] = term[r][r] = 1.0L;
+    }
+    for (int k = 1; k <= 24; ++k) {
+        term = multiply(term, a);
+        for (size_t r = 0; r < n; ++r) {
+            for (size_t c = 0; c < n; ++c) {
+                term[r][c] /= k;
+                result[r][c] += term[r][c];
+            }
+        }
+    }
+    for (int s = 0; s < squarings; ++s) result = multiply(result, result);
+    return result;
+}
+
+// Largest relative error over all nuclides above a negligible density, after
+// `turns` steps from fresh fuel at constant flux
+static double measureError(const DepletionChain& chain, double flux, double dt, int turns) {
+    DepletionBatch batch(chain, 1, dt);
+    batch.flux()[0] = flux;
+    Matrix e = expm(chain, flux, dt);
+    std::vector<long double> ref(chain.size());
+    for (int i = 0; i < chain.size(); ++i) ref[i] = chain.freshDensity(i);
+
+    double worst = 0.0;
+    for (int t = 0; t < turns; ++t) {
+        batch.advance();
+        std::vector<long double> next(chain.size(), 0.0L);
+        for (int r = 0; r < chain.size(); ++r) {
+            for (int c = 0; c < chain.size(); ++c) next[r] += e[r][c] * ref[c];
+        }
+        ref = next;
+        for (int i = 0; i < chain.size(); ++i) {
+            if (ref[i] < 1.0e-20L) continue;
+            worst = std::max(worst, static_cast<double>(std::fabs((batch.density(i)[0] - ref[i]) / ref[i])));
+        }
+    }
+    return worst;
+}
+
+// Keeps the timed loop from being optimized away
+static volatile double benchSink;
+
+static double measureNanosPerCell(const DepletionChain& chain, size_t cells, double dt) {
+    DepletionBatch batch(chain, cells, dt);
+    for (size_t c = 0; c < cells; ++c) batch.flux()[c] = DP::NOMINAL_FLUX * (0.5 + static_cast<double>(c % 97) / 97.0);
+    long steps = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    while (seconds < 0.1) {
+        batch.advance();
+        steps++;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    benchSink = batch.density(0)[0];
+    return seconds * 1.0e9 / (static_cast<double>(steps) * cells);
+}
+
+int main() {
+    const DepletionChain chain = DepletionChain::standard(0.1);
+    const double turn = DP::HOURS_PER_TURN * 3600.0;
+
+    std::cout << "Depletion: CRAM-16, " << chain.size() << " nuclides, " << simd::NAME << " kernels\n\n";
+    std::cout << std::left << std::setw(14) << "flux" << std::right << std::setw(12) << "step (h)"
+              << std::setw(10) << "turns" << std::setw(14) << "max rel err" << "\n";
+    const double fluxes[] = {0.0, DP::NOMINAL_FLUX, 2.0 * DP::NOMINAL_FLUX, 30.0 * DP::NOMINAL_FLUX};
+    const double steps[] = {turn, 24.0 * 3600.0, 720.0 * 3600.0};
+    for (double flux : fluxes) {
+        for (double dt : steps) {
+            int turns = dt > turn ? 10 : 400;
+            std::cout << std::left << std::setw(14) << std::setprecision(2) << std::scientific << flux
+                      << std::right << std::setw(12) << std::fixed << std::setprecision(2) << dt / 3600.0
+                      << std::setw(10) << turns
+                      << std::setw(14) << std::setprecision(2) << std::scientific
+                      << measureError(chain, flux, dt, turns) << "\n";
+        }
+    }
+
+    std::cout << "\n" << std::left << std::setw(14) << "cells" << std::right << std::setw(12) << "ns/cell"
+              << std::setw(14) << "us/turn" << "\n";
+    const size_t sizes[] = {1, 8, 64, 1024, 4800, 75000};
+    for (size_t cells : sizes) {
+        double ns = measureNanosPerCell(chain, cells, turn);
+        std::cout << std::left << std::setw(14) << cells << std::right << std::fixed
+                  << std::setw(12) << std::setprecision(1) << ns
+                  << std::setw(14) << std::setprecision(2) << ns * cells / 1000.0 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "reactor_state.h"
+#include "policy.h"
+#include "physics.h"
+#include "safety.h"
+#include "ensemble.h"
+#include "crc32.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+// Checks the SoA ensemble kernel bit for bit. First against the scalar
+// turn: every member also runs as a ReactorState through ScriptedPolicy::act,
+// CorePhysics::update and SafetySystem::check, with the weather held and
+// without random events, and each physics and bookkeeping field must hold
+// the same bits. Grid bonuses are outside the kernel, so the scalar score is
+// compared without them. Then the same members run with random events from
+// --seed and the hash of every field is printed; make check-ensemble builds
+// this tool a second time with scalar lanes (REACTOR_SCALAR_LANES) and
+// requires the two hashes to match.
+
+namespace {
+
+const char* const FIELD_NAMES[] = {
+    "neutrons", "controlRods", "temperature", "coolant", "power", "fuel", "xenon", "turbineRPM",
+    "steamPressure", "electricity", "totalElectricity", "turbineOnline", "reliefOpen", "dieselFuel",
+    "dieselRunning", "radiation", "totalExposure", "containment", "breach", "running", "turns",
+    "score", "scrams", "events", "outcome",
+};
+const int CHECKED_FIELDS = static_cast<int>(EnsembleField::OUTCOME) + 1;
+static_assert(sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]) == CHECKED_FIELDS, "one name per checked field");
+
+// Member i's difficulty and constant-rod policy: every level, rods from 2%
+// to 47%, three refill thresholds, turbine and auto-reset mostly on
+struct MemberSetup {
+    DifficultySettings difficulty;
+    ScriptedPolicy policy;
+    double rods;
+};
+
+MemberSetup setup(size_t i) {
+    MemberSetup m;
+    m.difficulty = getDifficultySettings(static_cast<Difficulty>(i % 4));
+    m.rods = 0.02 + static_cast<double>((i / 4) % 16) * 0.03;
+    m.policy.addStep(0, m.rods);
+    m.policy.setRefillThreshold(static_cast<double>(i % 3) * 15.0);
+    m.policy.setTurbine(i % 5 != 0);
+    m.policy.setAutoReset(i % 7 != 0);
+    return m;
+}
+
+void fill(EnsembleState& ens) {
+    for (size_t i = 0; i < ens.size(); ++i) {
+        MemberSetup m = setup(i);
+        ens.initMember(i, m.difficulty, m.rods);
+        ens.field(EnsembleField::TURBINE_SETPOINT)[i] = m.policy.turbineEnabled() ? 1.0 : 0.0;
+        ens.field(EnsembleField::REFILL_BELOW)[i] = m.policy.refillThreshold();
+        ens.field(EnsembleField::AUTO_RESET)[i] = m.policy.autoResetEnabled() ? 1.0 : 0.0;
+    }
+}
+
+// The headless turn loop of BatchRunner::run without random events, with the
+// weather never changing; `expected` gets the member's fields as the kernel
+// stores them
+void runScalar(size_t i, int turns, uint64_t seed, EnsembleState& expected) {
+    MemberSetup m = setup(i);
+    ReactorState state(Difficulty::NORMAL);
+    state.currentDifficulty = m.difficulty;
+    state.controlRods = m.rods;
+    state.reseed(seed, static_cast<uint32_t>(i));
+    state.headless = true;
+
+    double outcome = 0.0;
+    for (int t = 0; t < turns; ++t) {
+        state.weatherDuration = std::numeric_limits<int>::max();
+        m.policy.act(state);
+        CorePhysics::update(state);
+        SafetySystem::check(state);
+        state.clearMessages();
+        if (!state.running) {
+            if (SafetySystem::isMeltdown(state)) {
+                outcome = 1.0;
+                break;
+            }
+            if (!m.policy.resetAfterScram(state)) {
+                outcome = 2.0;
+                break;
+            }
+            SafetySystem::restartAfterScram(state);
+        }
+    }
+    expected.loadMember(i, state);
+    expected.field(EnsembleField::SCORE)[i] = state.score - state.demandBonus;
+    expected.field(EnsembleField::OUTCOME)[i] = outcome;
+}
+
+uint32_t hashFields(const EnsembleState& ens) {
+    uint32_t crc = 0;
+    for (int f = 0; f < static_cast<int>(EnsembleField::FIELD_COUNT); ++f) {
+        crc = crc32c(ens.field(static_cast<EnsembleField>(f)), ens.size() * sizeof(double), crc);
+    }
+    return crc;
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --members N          Ensemble members (default 256)\n"
+              << "  --turns N            Turns per run (default 2000)\n"
+              << "  --seed N             Random event seed for the hashed run (default 1)\n"
+              << "  --expect HASH        Fail unless the hashed run gives HASH (hex)\n"
+              << "  --hash               Print only the hash of the run with events\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t members = 256;
+    int turns = 2000;
+    uint64_t seed = 1;
+    std::string expect;
+    bool hashOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--members" && hasValue) {
+                long n = std::stol(argv[++i]);
+                if (n < 1) throw std::invalid_argument(arg);
+                members = static_cast<size_t>(n);
+            } else if (arg == "--turns" && hasValue) {
+                turns = std::stoi(argv[++i]);
+                if (turns < 1) throw std::invalid_argument(arg);
+            } else if (arg == "--seed" && hasValue) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--expect" && hasValue) {
+                expect = argv[++i];
+            } else if (arg == "--hash") {
+                hashOnly = true;
+            } else if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Random events on: the hash both builds must agree on
+    EnsembleState withEvents(members);
+    fill(withEvents);
+    EnsembleEngine::run(withEvents, turns, true, seed);
+    char hash[16];
+    std::snprintf(hash, sizeof(hash), "%08x", hashFields(withEvents));
+    if (hashOnly) {
+        std::cout << hash << "\n";
+        return 0;
+    }
+
+    // Deterministic physics against the scalar turn
+    EnsembleState ens(members), expected(members);
+    fill(ens);
+    fill(expected);
+    EnsembleEngine::run(ens, turns);
+    long mismatches = 0;
+    for (size_t i = 0; i < members; ++i) {
+        runScalar(i, turns, seed, expected);
+        for (int f = 0; f < CHECKED_FIELDS; ++f) {
+            double got = ens.field(static_cast<EnsembleField>(f))[i];
+            double want = expected.field(static_cast<EnsembleField>(f))[i];
+            if (std::memcmp(&got, &want, sizeof(double)) == 0) continue;
+            if (mismatches++ < 10) {
+                std::cout << "member " << i << " " << FIELD_NAMES[f] << ": kernel " << std::setprecision(17)
+                          << got << ", scalar " << want << "\n";
+            }
+        }
+    }
+
+    bool hashMatches = expect.empty() || expect == hash;
+    bool pass = mismatches == 0 && hashMatches;
+    std::cout << "ensemble_check=" << (pass ? "PASS" : "FAIL")
+              << " kernel=" << EnsembleEngine::kernelName()
+              << " members=" << members
+              << " turns=" << turns
+              << " mismatches=" << mismatches
+              << " hash=" << hash;
+    if (!expect.empty()) std::cout << " expected=" << expect;
+    std::cout << "\n";
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include "kinetics.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+// Cost per turn versus accuracy of the adaptive point-kinetics integrator.
+// Reactivity is constant within a turn, so the exact solution over a turn is
+// exp(A dt) y; the reference propagates the same turns with a long-double
+// matrix exponential (scaling and squaring of a Taylor series).
+
+typedef long double Matrix[PK::SIZE][PK::SIZE];
+
+static void multiply(const Matrix a, const Matrix b, Matrix out) {
+    Matrix tmp;
+    for (int r = 0; r < PK::SIZE; ++r) {
+        for (int c = 0; c < PK::SIZE; ++c) {
+            long double sum = 0.0L;
+            for (int k = 0; k < PK::SIZE; ++k) sum += a[r][k] * b[k][c];
+            tmp[r][c] = sum;
+        }
+    }
+    for (int r = 0; r < PK::SIZE; ++r) {
+        for (int c = 0; c < PK::SIZE; ++c) out[r][c] = tmp[r][c];
+    }
+}
+
+static void expm(double reactivity, double dt, Matrix result) {
+    double a[PK::SIZE][PK::SIZE];
+    PointKinetics::systemMatrix(reactivity, a);
+
+    long double norm = 0.0L;
+    for (int r = 0; r < PK::SIZE; ++r) {
+        long double row = 0.0L;
+        for (int c = 0; c < PK::SIZE; ++c) row += std::fabs(static_cast<long double>(a[r][c]) * dt);
+        norm = std::max(norm, row);
+    }
+    int squarings = 0;
+    while (norm > 0.25L) {
+        norm /= 2.0L;
+        squarings++;
+    }
+    long double scale = std::ldexp(static_cast<long double>(dt), -squarings);
+
+    Matrix x, term;
+    for (int r = 0; r < PK::SIZE; ++r) {
+        for (int c = 0; c < PK::SIZE; ++c) {
+            x[r][c] = a[r][c] * scale;
+            result[r][c] = term[r][c] = (r == c) ? 1.0L : 0.0L;
+        }
+    }
+    for (int k = 1; k <= 24; ++k) {
+        multiply(term, x, term);
+        for (int r = 0; r < PK::SIZE; ++r) {
+            for (int c = 0; c < PK::SIZE; ++c) {
+                term[r][c] /= k;
+                result[r][c] += term[r][c];
+            }
+        }
+    }
+    for (int s = 0; s < squarings; ++s) multiply(result, result, result);
+}
+
+struct Scenario {
+    std::string name;
+    std::vector<double> dollars;  // Reactivity per turn, in units of beta
+};
+
+static std::vector<Scenario> scenarios() {
+    std::vector<Scenario> list;
+    list.push_back({"step +0.5$", std::vector<double>(60, 0.5)});
+    list.push_back({"step +0.95$", std::vector<double>(8, 0.95)});
+    list.push_back({"scram -10$", std::vector<double>(60, -10.0)});
+
+    Scenario wobble{"rods +-0.3$", {}};
+    for (int t = 0; t < 100; ++t) wobble.dollars.push_back(t % 2 ? 0.3 : -0.3);
+    list.push_back(wobble);
+
+    Scenario ramp{"ramp -2$..+0.8$", {}};
+    for (int t = 0; t < 100; ++t) ramp.dollars.push_back(-2.0 + 2.8 * t / 99.0);
+    list.push_back(ramp);
+    return list;
+}
+
+// Largest relative error in n over all turns
+static double measureError(const Scenario& sc, double rtol, KineticsStats& stats) {
+    const double n0 = 1000.0;
+    KineticsState kinetics;
+    PointKinetics::reset(kinetics, n0);
+    double n = n0;
+
+    long double ref[PK::SIZE];
+    ref[0] = n0;
+    for (int i = 0; i < PK::GROUPS; ++i) ref[i + 1] = kinetics.precursors[i];
+
+    double worst = 0.0;
+    for (double d : sc.dollars) {
+        double rho = d * PointKinetics::beta();
+        PointKinetics::advance(kinetics, n, rho, PK::TURN_SECONDS, rtol);
+
+        Matrix e;
+        expm(rho, PK::TURN_SECONDS, e);
+        long double next[PK::SIZE];
+        for (int r = 0; r < PK::SIZE; ++r) {
+            next[r] = 0.0L;
+            for (int c = 0; c < PK::SIZE; ++c) next[r] += e[r][c] * ref[c];
+        }
+        std::copy(next, next + PK::SIZE, ref);
+
+        worst = std::max(worst, static_cast<double>(std::fabs((n - ref[0]) / ref[0])));
+    }
+    stats = kinetics.stats;
+    return worst;
+}
+
+// Keeps the timed loop from being optimized away
+static volatile double benchSink;
+
+static double measureNanosPerTurn(const Scenario& sc, double rtol) {
+    long turns = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    while (seconds < 0.05) {
+        KineticsState kinetics;
+        PointKinetics::reset(kinetics, 1000.0);
+        double n = 1000.0;
+        for (double d : sc.dollars) {
+            PointKinetics::advance(kinetics, n, d * PointKinetics::beta(), PK::TURN_SECONDS, rtol);
+        }
+        benchSink = n;
+        turns += static_cast<long>(sc.dollars.size());
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return seconds * 1.0e9 / turns;
+}
+
+int main() {
+    const double tolerances[] = {1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-8};
+
+    std::cout << "Point kinetics: SDIRK2, " << PK::GROUPS << " delayed groups, LAMBDA="
+              << PK::GENERATION_TIME << " s, turn=" << PK::TURN_SECONDS << " s, budget "
+              << PK::MAX_SUBSTEPS << " steps/turn\n\n";
+    std::cout << std::left << std::setw(18) << "scenario" << std::right
+              << std::setw(8) << "rtol" << std::setw(12) << "ns/turn" << std::setw(12) << "steps/turn"
+              << std::setw(12) << "rejects" << std::setw(10) << "budget" << std::setw(14) << "max rel err" << "\n";
+
+    for (const Scenario& sc : scenarios()) {
+        for (double rtol : tolerances) {
+            KineticsStats stats;
+            double err = measureError(sc, rtol, stats);
+            double ns = measureNanosPerTurn(sc, rtol);
+            std::cout << std::left << std::setw(18) << sc.name << std::right
+                      << std::setw(8) << std::setprecision(0) << std::scientific << rtol
+                      << std::setw(12) << std::fixed << std::setprecision(0) << ns
+                      << std::setw(12) << std::setprecision(1) << static_cast<double>(stats.steps) / stats.turns
+                      << std::setw(12) << stats.rejected
+                      << std::setw(10) << stats.budgetHits
+                      << std::setw(14) << std::setprecision(2) << std::scientific << err << "\n";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
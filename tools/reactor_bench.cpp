@@ -0,0 +1,365 @@
+#include "reactor_state.h"
+#include "policy.h"
+#include "physics.h"
+#include "events.h"
+#include "safety.h"
+#include "xenon.h"
+#include "turbine.h"
+#include "radiation.h"
+#include "containment.h"
+#include "weather.h"
+#include "grid.h"
+#include "achievements.h"
+#include "renderer.h"
+#include "alloc_counter.h"
+#include "telemetry.h"
+#include "autopilot.h"
+#include "event_catalog.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Cost per call of the per-turn subsystem updates, the dashboard, a random
+// event and an autopilot rod decision over sets of states sampled from four
+// situations.
+// Every pass restores the sampled states (untimed) and calls the subsystem
+// once on each, so a measurement never drifts away from the situation it
+// describes.
+
+namespace {
+const int STATES_PER_SCENARIO = 32;
+
+// User-space instructions retired, through perf_event_open; unavailable
+// off Linux and where perf_event_paranoid forbids it
+class InstructionCounter {
+public:
+    InstructionCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr = perf_event_attr();
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~InstructionCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd;
+};
+
+// Accepts and drops everything, so the dashboard is timed without the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+struct Scenario {
+    const char* name;
+    std::vector<ReactorState> states;
+};
+
+struct Subsystem {
+    const char* name;
+    void (*call)(ReactorState&);
+};
+
+// Segment for the telemetry measurement, private to this process
+static TelemetryPublisher telemetry;
+
+// One rod decision per call: the decision latency of auto mode
+static Autopilot autopilot;
+
+// One catalog event per call: the turn's one-in-eventChance draw is left
+// out, so every call picks and runs one
+void fireEvent(ReactorState& state) {
+    const EventCatalog& catalog = EventCatalog::active();
+    CounterRng rng = state.rngStream(RngStream::EVENTS);
+    int event = catalog.pick(rng, EventCatalog::tableIndex(state.currentDifficulty.level, state.currentWeather));
+    if (event >= 0) catalog.run(event, state, rng);
+}
+
+struct Measurement {
+    double nsPerCall;
+    double allocsPerCall;        // Negative when not counted (see AllocCounter)
+    double instructionsPerCall;  // Negative when not counted
+    long calls;
+};
+
+void advance(ReactorState& state, OperatorPolicy& policy) {
+    policy.act(state);
+    CorePhysics::update(state);
+    RandomEventSystem::process(state);
+    SafetySystem::check(state);
+    state.clearMessages();
+    if (!state.running) SafetySystem::restartAfterScram(state);
+}
+
+// Every `stride` turns of a run under `rods`, after `warmup` turns
+std::vector<ReactorState> sample(double rods, bool turbine, int warmup, int stride, uint64_t seed) {
+    ReactorState state(Difficulty::NORMAL);
+    state.reseed(seed);
+    state.headless = true;
+    ScriptedPolicy policy;
+    policy.addStep(0, rods);
+    policy.setTurbine(turbine);
+    policy.setRefillThreshold(30.0);
+    for (int t = 0; t < warmup; ++t) advance(state, policy);
+
+    std::vector<ReactorState> states;
+    while (states.size() < static_cast<size_t>(STATES_PER_SCENARIO)) {
+        for (int t = 0; t < stride; ++t) advance(state, policy);
+        states.push_back(state);
+    }
+    return states;
+}
+
+std::vector<Scenario> buildScenarios(uint64_t seed) {
+    // The basic core runs near 100% power for its first few dozen turns at
+    // a few percent rod insertion, then burns down
+    const double CRITICAL_RODS = 0.03;
+    std::vector<Scenario> scenarios;
+
+    // Rods fully in and the turbine offline, the first turns of a session
+    scenarios.push_back(Scenario{"cold_start", sample(1.0, false, 0, 1, seed)});
+
+    // Near-critical core with the turbine online
+    scenarios.push_back(Scenario{"full_power", sample(CRITICAL_RODS, true, 0, 1, seed)});
+
+    // The turns after a SCRAM from full power, rods withdrawn again
+    std::vector<ReactorState> recovery;
+    for (uint64_t run = 1; recovery.size() < static_cast<size_t>(STATES_PER_SCENARIO); ++run) {
+        ReactorState state = sample(CRITICAL_RODS, true, 15, 1, seed + run).front();
+        state.temperature = state.currentDifficulty.scramTemperature + 1.0;
+        SafetySystem::check(state);
+        SafetySystem::restartAfterScram(state);
+        ScriptedPolicy policy;
+        policy.addStep(0, CRITICAL_RODS);
+        policy.setRefillThreshold(30.0);
+        for (int t = 0; t < 8; ++t) {
+            state.clearMessages();
+            recovery.push_back(state);
+            advance(state, policy);
+        }
+    }
+    scenarios.push_back(Scenario{"scram_recovery", recovery});
+
+    // Full power through a storm
+    std::vector<ReactorState> storm = sample(CRITICAL_RODS, true, 0, 1, seed + 100);
+    for (size_t i = 0; i < storm.size(); ++i) {
+        storm[i].currentWeather = Weather::STORM;
+        storm[i].weatherDuration = 5 + static_cast<int>(i % 10);
+    }
+    scenarios.push_back(Scenario{"storm", storm});
+    return scenarios;
+}
+
+Measurement measure(const Scenario& scenario, const Subsystem& subsystem, double minSeconds,
+                    InstructionCounter& counter) {
+    std::vector<ReactorState> work(scenario.states);
+    for (ReactorState& state : work) subsystem.call(state);  // Warm caches and branch predictors
+
+    double seconds = 0.0;
+    uint64_t allocations = 0, instructions = 0;
+    long calls = 0;
+    while (seconds < minSeconds) {
+        for (size_t i = 0; i < work.size(); ++i) work[i] = scenario.states[i];
+
+        counter.start();
+        uint64_t allocationsBefore = AllocCounter::count();
+        auto start = std::chrono::steady_clock::now();
+        for (ReactorState& state : work) subsystem.call(state);
+        auto end = std::chrono::steady_clock::now();
+        allocations += AllocCounter::count() - allocationsBefore;
+        instructions += counter.stop();
+
+        seconds += std::chrono::duration<double>(end - start).count();
+        calls += static_cast<long>(work.size());
+    }
+    return Measurement{1e9 * seconds / calls,
+                       AllocCounter::available() ? static_cast<double>(allocations) / calls : -1.0,
+                       counter.available() ? static_cast<double>(instructions) / calls : -1.0, calls};
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --kv                 One key=value line per measurement, for comparing builds\n"
+              << "  --only NAME          Only this subsystem or scenario (e.g. weather, storm)\n"
+              << "  --seconds S          Timed seconds per measurement (default 0.01)\n"
+              << "  --seed N             Seed for the sampled states (default 1)\n"
+              << "  --events FILE        Time this event catalog instead of the built-in one\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    bool keyValue = false;
+    std::string only;
+    double minSeconds = 0.01;
+    uint64_t seed = 1;
+    std::string eventsPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--kv") {
+                keyValue = true;
+            } else if (arg == "--only" && hasValue) {
+                only = argv[++i];
+            } else if (arg == "--seconds" && hasValue) {
+                minSeconds = std::stod(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--events" && hasValue) {
+                eventsPath = argv[++i];
+            } else if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!eventsPath.empty()) {
+        EventCatalog catalog;
+        std::string error;
+        if (!catalog.load(eventsPath, error)) {
+            std::cerr << "Event catalog " << eventsPath << ": " << error << "\n";
+            return 1;
+        }
+        EventCatalog::install(catalog);
+    }
+
+    const Subsystem subsystems[] = {
+        {"xenon",        XenonSystem::update},
+        {"turbine",      TurbineSystem::update},
+        {"radiation",    RadiationSystem::update},
+        {"containment",  ContainmentSystem::update},
+        {"weather",      WeatherSystem::update},
+        {"grid",         GridSystem::update},
+        {"event",        fireEvent},
+        {"achievements", [](ReactorState& state) { AchievementSystem::check(state); }},
+        {"dashboard",    [](ReactorState& state) { Renderer::displayDashboard(state); }},
+        {"telemetry",    [](ReactorState& state) { telemetry.publish(state); }},
+        {"autopilot",    [](ReactorState& state) { state.controlRods = autopilot.decide(state); }},
+    };
+#ifndef _WIN32
+    if (!telemetry.open("/reactor_bench." + std::to_string(getpid()))) {
+        std::cerr << "Cannot create a telemetry segment; its measurement is a no-op\n";
+    }
+#endif
+
+    std::vector<Scenario> scenarios = buildScenarios(seed);
+    InstructionCounter counter;
+    NullBuffer sink;
+
+    if (!keyValue) {
+        std::cout << "Subsystem cost per call, " << STATES_PER_SCENARIO << " sampled states per scenario, "
+                  << (counter.available() ? "instructions from perf_event_open" : "instruction counts unavailable")
+                  << "\n";
+        for (const Scenario& scenario : scenarios) {
+            double power = 0.0, temperature = 0.0;
+            for (const ReactorState& state : scenario.states) {
+                power += state.power / scenario.states.size();
+                temperature += state.temperature / scenario.states.size();
+            }
+            std::cout << "  " << std::left << std::setw(16) << scenario.name << std::right << std::fixed
+                      << std::setprecision(0) << "mean power " << std::setw(5) << power
+                      << "%, temperature " << std::setw(5) << temperature << "\u00b0C\n";
+        }
+        std::cout << "\n"
+                  << std::left << std::setw(14) << "subsystem" << std::setw(16) << "scenario" << std::right
+                  << std::setw(12) << "ns/call" << std::setw(14) << "allocs/call" << std::setw(14) << "instr/call"
+                  << "\n";
+    }
+    for (const Subsystem& subsystem : subsystems) {
+        for (const Scenario& scenario : scenarios) {
+            if (!only.empty() && only != subsystem.name && only != scenario.name) continue;
+
+            std::streambuf* console = std::cout.rdbuf(&sink);
+            Measurement m = measure(scenario, subsystem, minSeconds, counter);
+            std::cout.rdbuf(console);
+
+            if (keyValue) {
+                std::cout << "bench=" << subsystem.name << " scenario=" << scenario.name
+                          << std::fixed << std::setprecision(2) << " ns_per_call=" << m.nsPerCall
+                          << std::setprecision(3) << " allocs_per_call=";
+                if (m.allocsPerCall >= 0.0) {
+                    std::cout << m.allocsPerCall;
+                } else {
+                    std::cout << "na";
+                }
+                std::cout << std::setprecision(1) << " instructions_per_call=";
+                if (m.instructionsPerCall >= 0.0) {
+                    std::cout << m.instructionsPerCall;
+                } else {
+                    std::cout << "na";
+                }
+                std::cout << " calls=" << m.calls << "\n";
+            } else {
+                std::cout << std::left << std::setw(14) << subsystem.name << std::setw(16) << scenario.name
+                          << std::right << std::fixed << std::setprecision(1) << std::setw(12) << m.nsPerCall
+                          << std::setprecision(2) << std::setw(14);
+                if (m.allocsPerCall >= 0.0) {
+                    std::cout << m.allocsPerCall;
+                } else {
+                    std::cout << "-";
+                }
+                std::cout << std::setw(14);
+                if (m.instructionsPerCall >= 0.0) {
+                    std::cout << std::setprecision(0) << m.instructionsPerCall;
+                } else {
+                    std::cout << "-";
+                }
+                std::cout << "\n";
+            }
+        }
+    }
+    return 0;
+}
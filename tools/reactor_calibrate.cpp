@@ -0,0 +1,383 @@
+#include "montecarlo.h"
+#include "event_catalog.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+// Tunes the difficulty presets to target outcomes under a reference policy.
+// Each level's parameters are searched in log space around its hand-picked
+// preset with SPSA (simultaneous perturbation stochastic approximation):
+// every iteration perturbs all parameters at once by random signs and
+// evaluates the fitness on both sides, so an iteration costs two batches
+// of Monte Carlo runs however many parameters there are. Both batches use
+// the same run seeds, so their difference is the parameters' effect and not
+// run-to-run noise. The batches run on one MonteCarloPool, whose threads and
+// per-worker states are reused from one evaluation to the next.
+
+namespace {
+
+const char* const ENUM_NAMES[] = {"EASY", "NORMAL", "HARD", "NIGHTMARE"};
+
+struct Target {
+    Difficulty level;
+    double survival;   // Share of runs that last the horizon, 0-1
+    double scramRate;  // SCRAMs per 1000 turns; negative when not targeted
+};
+
+// LEVEL:SURVIVAL%[:SCRAMS], e.g. hard:40 or nightmare:10:4.5
+bool parseTarget(const std::string& spec, Target& target) {
+    size_t first = spec.find(':');
+    if (first == std::string::npos || !parseDifficulty(spec.substr(0, first), target.level)) return false;
+    size_t second = spec.find(':', first + 1);
+    try {
+        size_t used = 0;
+        std::string survival = spec.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1);
+        target.survival = std::stod(survival, &used) / 100.0;
+        if (used != survival.size() || target.survival < 0.0 || target.survival > 1.0) return false;
+        target.scramRate = -1.0;
+        if (second != std::string::npos) {
+            std::string rate = spec.substr(second + 1);
+            target.scramRate = std::stod(rate, &used);
+            if (used != rate.size() || target.scramRate < 0.0) return false;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// A tunable DifficultySettings field and how far from its preset the search
+// may take it
+struct Parameter {
+    const char* name;
+    double DifficultySettings::* field;
+    double lowest;   // Factor of the preset
+    double highest;
+};
+
+const Parameter PARAMETERS[] = {
+    {"fuel",     &DifficultySettings::fuelDepletionRate,   0.5,  2.0},
+    {"coolant",  &DifficultySettings::coolantLossRate,     0.5,  2.0},
+    {"events",   &DifficultySettings::eventChance,         0.5,  2.0},
+    {"scram",    &DifficultySettings::scramTemperature,    0.75, 1.25},
+    {"meltdown", &DifficultySettings::meltdownTemperature, 0.75, 1.25},
+    {"turbine",  &DifficultySettings::turbineEfficiency,   0.75, 1.25},
+    {"xenon",    &DifficultySettings::xenonBuildupRate,    0.5,  2.0},
+};
+const int PARAMETER_COUNT = sizeof(PARAMETERS) / sizeof(PARAMETERS[0]);
+
+// SPSA gains (Spall's recommended decay exponents)
+const double ALPHA = 0.602;
+const double GAMMA = 0.101;
+const double PERTURBATION = 0.1;  // c: the first perturbations are +-10% in log space
+const double MAX_PERTURBATION = 0.4;
+const double FIRST_STEP = 0.05;   // The first steps move about 5%
+const int GAIN_SAMPLES = 2;       // Gradient estimates that set the step gain
+
+struct Evaluation {
+    double survival;
+    double scramRate;
+    double fitness;
+};
+
+class Calibrator {
+public:
+    Calibrator(MonteCarloPool& pool, const MonteCarloConfig& base, const std::vector<int>& active, double regularize)
+        : pool(pool), config(base), active(active), regularize(regularize), evaluations(0) {}
+
+    // Monte Carlo batches run by search() so far
+    long batches() const { return evaluations; }
+
+    // Preset scaled by exp(theta) for the active parameters, kept physical
+    DifficultySettings settings(const DifficultySettings& preset, const std::vector<double>& theta) const {
+        DifficultySettings tuned = preset;
+        for (size_t i = 0; i < active.size(); ++i) {
+            const Parameter& p = PARAMETERS[active[i]];
+            tuned.*p.field = preset.*p.field * std::exp(theta[i]);
+        }
+        tuned.turbineEfficiency = std::min(1.0, tuned.turbineEfficiency);
+        tuned.meltdownTemperature = std::max(tuned.meltdownTemperature, tuned.scramTemperature + 100.0);
+        return tuned;
+    }
+
+    Evaluation evaluate(const Target& target, const DifficultySettings& settings,
+                        const std::vector<double>& theta, uint64_t seed) {
+        config.difficulty = settings;
+        config.seed = seed;
+        const MonteCarloStats& stats = pool.run(config);
+        Evaluation e;
+        e.survival = stats.runs > 0 ? static_cast<double>(stats.survived) / stats.runs : 0.0;
+        e.scramRate = stats.meanScramRate();
+        double miss = e.survival - target.survival;
+        e.fitness = miss * miss;
+        if (target.scramRate >= 0.0) {
+            double rateMiss = (e.scramRate - target.scramRate) / std::max(1.0, target.scramRate);
+            e.fitness += rateMiss * rateMiss;
+        }
+        // Pull toward the hand-picked preset, so the search changes no more than it needs to
+        for (double t : theta) e.fitness += regularize * t * t;
+        return e;
+    }
+
+    // SPSA from the preset into `theta`. False, leaving theta at the preset,
+    // when the fitness does not respond to any perturbation up to
+    // MAX_PERTURBATION, so there is no gradient to size the steps from.
+    bool search(const Target& target, const DifficultySettings& preset, int iterations, uint64_t seed,
+                bool verbose, std::vector<double>& theta) {
+        const size_t n = active.size();
+        theta.assign(n, 0.0);
+        std::vector<double> lo(n), hi(n), delta(n), plus(n), minus(n);
+        for (size_t i = 0; i < n; ++i) {
+            lo[i] = std::log(PARAMETERS[active[i]].lowest);
+            hi[i] = std::log(PARAMETERS[active[i]].highest);
+        }
+        std::mt19937_64 signs(seed);
+        const double stability = std::max(1.0, iterations / 10.0);
+        Evaluation up, down;
+        uint64_t pair = 0;
+
+        // One two-sided gradient estimate; both sides run on the same seeds
+        auto estimate = [&](double c) {
+            for (size_t i = 0; i < n; ++i) {
+                delta[i] = (signs() & 1) ? 1.0 : -1.0;
+                plus[i] = theta[i] + c * delta[i];
+                minus[i] = theta[i] - c * delta[i];
+            }
+            uint64_t runSeed = seed + pair++ * 1000003ull;
+            up = evaluate(target, settings(preset, plus), plus, runSeed);
+            down = evaluate(target, settings(preset, minus), minus, runSeed);
+            return (up.fitness - down.fitness) / (2.0 * c);
+        };
+
+        // Size the steps from the gradient at the preset. A preset deep in a
+        // plateau (every run survives either way) shows none, so the
+        // perturbation widens until the fitness responds.
+        double perturbation = PERTURBATION, slopes = 0.0;
+        for (;;) {
+            for (int s = 0; s < GAIN_SAMPLES; ++s) slopes += std::fabs(estimate(perturbation)) / GAIN_SAMPLES;
+            if (slopes > 0.0 || perturbation >= MAX_PERTURBATION) break;
+            perturbation *= 2.0;
+        }
+        evaluations += 2 * pair;
+        if (slopes == 0.0) return false;
+        if (verbose && perturbation > PERTURBATION) {
+            std::cout << "  flat at the preset; perturbing by " << std::fixed << std::setprecision(0)
+                      << perturbation * 100.0 << "% in log space\n";
+        }
+        const double gain = FIRST_STEP * std::pow(stability + 1.0, ALPHA) / slopes;
+
+        for (int k = 0; k < iterations; ++k) {
+            double c = perturbation / std::pow(k + 1.0, GAMMA);
+            double slope = estimate(c);
+            double a = gain / std::pow(k + 1.0 + stability, ALPHA);
+            for (size_t i = 0; i < n; ++i) {
+                theta[i] = std::max(lo[i], std::min(hi[i], theta[i] - a * slope / delta[i]));
+            }
+            evaluations += 2;
+            if (verbose && ((k + 1) % 10 == 0 || k + 1 == iterations)) {
+                std::cout << "  iteration " << std::setw(4) << k + 1 << std::fixed << std::setprecision(1)
+                          << "  survival " << std::setw(5) << 50.0 * (up.survival + down.survival) << "%"
+                          << std::setprecision(2) << "  SCRAMs/1000t " << std::setw(5)
+                          << 0.5 * (up.scramRate + down.scramRate)
+                          << std::setprecision(4) << "  fitness " << 0.5 * (up.fitness + down.fitness) << "\n";
+            }
+        }
+        return true;
+    }
+
+private:
+    MonteCarloPool& pool;
+    MonteCarloConfig config;
+    std::vector<int> active;
+    double regularize;
+    long evaluations;
+};
+
+void printRow(const char* label, const Evaluation& e) {
+    std::cout << "  " << std::left << std::setw(8) << label << std::right << std::fixed << std::setprecision(1)
+              << "survival " << std::setw(5) << e.survival * 100.0 << "%" << std::setprecision(2)
+              << "  SCRAMs/1000t " << std::setw(5) << e.scramRate << "\n";
+}
+
+// A getDifficultySettings case, aligned like the ones in src/types.h
+void printCase(const DifficultySettings& s) {
+    char name[32], quoted[32], line[256];
+    std::snprintf(name, sizeof(name), "Difficulty::%s,", ENUM_NAMES[static_cast<int>(s.level)]);
+    std::snprintf(quoted, sizeof(quoted), "\"%s\",", s.name);
+    std::snprintf(line, sizeof(line), "%-23s%-13s%.3f, %.3f, %4.1f, %6.1f, %6.1f, %d, %.2f, %.2f",
+                  name, quoted, s.fuelDepletionRate, s.coolantLossRate, std::floor(s.eventChance),
+                  s.scramTemperature, s.meltdownTemperature, s.scoreMultiplier, s.turbineEfficiency,
+                  s.xenonBuildupRate);
+    std::cout << "        case Difficulty::" << ENUM_NAMES[static_cast<int>(s.level)] << ":\n"
+              << "            return {" << line << "};\n";
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --target L:PCT[:SCRAMS]  Survival % over the horizon for level L, optionally SCRAMs per\n"
+              << "                       1000 turns (repeat per level; default easy:95 normal:80 hard:40\n"
+              << "                       nightmare:10)\n"
+              << "  --runs N             Runs per fitness evaluation (default 2000)\n"
+              << "  --turns N            Turn horizon per run (default 500)\n"
+              << "  --iterations N       SPSA iterations per level (default 40)\n"
+              << "  --threads N          Worker threads (default: all cores)\n"
+              << "  --seed N             Base seed (default 1)\n"
+              << "  --params LIST        Parameters to tune, comma-separated (default all:\n"
+              << "                       fuel,coolant,events,scram,meltdown,turbine,xenon)\n"
+              << "  --regularize W       Weight pulling the parameters toward the preset (default 0.01)\n"
+              << "  --quiet              Only the results and the tuned table\n"
+              << "  --events FILE        Draw random events from this catalog instead of the built-in one\n"
+              << "Reference policy (as for reactor_mc):\n"
+              << "  --rods SCHEDULE      Rod schedule as turn:percent,... (default 0:5)\n"
+              << "  --refill PCT         Refill coolant when it drops below PCT (default 25)\n"
+              << "  --reset              Restart after a SCRAM (default: a SCRAM ends the run)\n"
+              << "  --no-turbine         Leave the turbine offline\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<Target> targets;
+    MonteCarloConfig config{getDifficultySettings(Difficulty::NORMAL), ScriptedPolicy(), 2000, 500,
+                            static_cast<int>(std::thread::hardware_concurrency()), 1, ModelOptions(), false, false};
+    config.policy.setAutoReset(false);
+    config.policy.setRefillThreshold(25.0);
+    std::string rods = "0:5";
+    std::string eventsPath;
+    std::string params = "fuel,coolant,events,scram,meltdown,turbine,xenon";
+    int iterations = 40;
+    double regularize = 0.01;
+    bool verbose = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--target" && hasValue) {
+                Target target;
+                if (!parseTarget(argv[++i], target)) throw std::invalid_argument(arg);
+                targets.push_back(target);
+            } else if (arg == "--runs" && hasValue) {
+                config.runs = std::stol(argv[++i]);
+                if (config.runs < 1) throw std::invalid_argument(arg);
+            } else if (arg == "--turns" && hasValue) {
+                config.horizon = std::stoi(argv[++i]);
+                if (config.horizon < 1) throw std::invalid_argument(arg);
+            } else if (arg == "--iterations" && hasValue) {
+                iterations = std::stoi(argv[++i]);
+                if (iterations < 1) throw std::invalid_argument(arg);
+            } else if (arg == "--threads" && hasValue) {
+                config.threads = std::stoi(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                config.seed = std::stoull(argv[++i]);
+            } else if (arg == "--params" && hasValue) {
+                params = argv[++i];
+            } else if (arg == "--regularize" && hasValue) {
+                regularize = std::stod(argv[++i]);
+                if (regularize < 0.0) throw std::invalid_argument(arg);
+            } else if (arg == "--quiet") {
+                verbose = false;
+            } else if (arg == "--rods" && hasValue) {
+                rods = argv[++i];
+            } else if (arg == "--refill" && hasValue) {
+                config.policy.setRefillThreshold(std::stod(argv[++i]));
+            } else if (arg == "--reset") {
+                config.policy.setAutoReset(true);
+            } else if (arg == "--events" && hasValue) {
+                eventsPath = argv[++i];
+            } else if (arg == "--no-turbine") {
+                config.policy.setTurbine(false);
+            } else if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!eventsPath.empty()) {
+        EventCatalog catalog;
+        std::string error;
+        if (!catalog.load(eventsPath, error)) {
+            std::cerr << "Event catalog " << eventsPath << ": " << error << "\n";
+            return 1;
+        }
+        EventCatalog::install(catalog);
+    }
+    if (!ScriptedPolicy::parse(rods, config.policy)) {
+        std::cerr << "Invalid rod schedule: " << rods << "\n";
+        return 1;
+    }
+    std::vector<int> active;
+    size_t start = 0;
+    while (start <= params.size()) {
+        size_t comma = std::min(params.find(',', start), params.size());
+        std::string name = params.substr(start, comma - start);
+        int index = 0;
+        while (index < PARAMETER_COUNT && name != PARAMETERS[index].name) ++index;
+        if (index == PARAMETER_COUNT) {
+            std::cerr << "Unknown parameter: " << name << "\n";
+            return 1;
+        }
+        if (std::find(active.begin(), active.end(), index) == active.end()) active.push_back(index);
+        start = comma + 1;
+    }
+    if (targets.empty()) {
+        targets = {{Difficulty::EASY, 0.95, -1.0}, {Difficulty::NORMAL, 0.80, -1.0},
+                   {Difficulty::HARD, 0.40, -1.0}, {Difficulty::NIGHTMARE, 0.10, -1.0}};
+    }
+
+    MonteCarloPool pool(std::max(1, config.threads));
+    Calibrator calibrator(pool, config, active, regularize);
+    std::cout << "Calibrating: " << pool.threads() << " threads, " << config.runs << " runs x " << config.horizon
+              << " turns per evaluation, " << iterations << " iterations, rods " << rods
+              << (config.policy.autoResetEnabled() ? ", reset after SCRAM" : ", a SCRAM ends the run")
+              << ", tuning " << params << "\n\n";
+
+    // Results are checked on seeds the search never saw
+    const uint64_t checkSeed = config.seed + 0x5eed0000ull;
+    std::vector<DifficultySettings> tuned;
+    for (const Target& target : targets) {
+        DifficultySettings preset = getDifficultySettings(target.level);
+        std::cout << Color::BOLD << preset.name << Color::RESET << ": survival " << std::fixed
+                  << std::setprecision(1) << target.survival * 100.0 << "% over " << config.horizon << " turns";
+        if (target.scramRate >= 0.0) std::cout << std::setprecision(2) << ", " << target.scramRate << " SCRAMs/1000t";
+        std::cout << "\n";
+
+        long batches = calibrator.batches();
+        auto began = std::chrono::steady_clock::now();
+        std::vector<double> theta;
+        if (!calibrator.search(target, preset, iterations, config.seed, verbose, theta)) {
+            std::cout << Color::YELLOW << "  fitness flat up to +-" << std::fixed << std::setprecision(0)
+                      << MAX_PERTURBATION * 100.0 << "% in log space; keeping the preset" << Color::RESET
+                      << " (try more --runs or --turns, or other --params)\n";
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+
+        DifficultySettings result = calibrator.settings(preset, theta);
+        printRow("preset", calibrator.evaluate(target, preset, std::vector<double>(active.size(), 0.0), checkSeed));
+        printRow("tuned", calibrator.evaluate(target, result, theta, checkSeed));
+        std::cout << "  " << std::setprecision(1) << seconds << " s, "
+                  << std::setprecision(0) << static_cast<double>(calibrator.batches() - batches) * config.runs / seconds
+                  << " runs/s\n\n";
+        tuned.push_back(result);
+    }
+
+    std::cout << "Tuned settings for getDifficultySettings (src/types.h):\n";
+    for (const DifficultySettings& settings : tuned) printCase(settings);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "montecarlo.h"
+#include "event_catalog.h"
+#include "spatial.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --difficulty LEVEL   easy|normal|hard|nightmare (default: all four)\n"
+              << "  --runs N             Simulations per difficulty (default 1000)\n"
+              << "  --turns N            Turn horizon per run (default 5000)\n"
+              << "  --threads N          Worker threads (default: all cores)\n"
+              << "  --seed N             Base seed (default 1)\n"
+              << "  --rods SCHEDULE      Rod schedule as turn:percent,... (default 0:5)\n"
+              << "  --refill PCT         Refill coolant when it drops below PCT\n"
+              << "  --no-reset           Stop a run at its first SCRAM\n"
+              << "  --no-turbine         Leave the turbine offline\n"
+              << "  --kinetics           Point-kinetics core with delayed neutrons\n"
+              << "  --spatial NxMxK      Nodal two-group diffusion core (e.g. 20x20x12)\n"
+              << "  --channels N         Subchannel thermal-hydraulics with N coolant channels\n"
+              << "  --depletion          CRAM nuclide chain for fuel burnup, xenon and samarium\n"
+              << "  --distributions      p50/p95/p99 of every turn's readings across all runs\n"
+              << "  --autopilot          The model-predictive autopilot sets the rods (about 1 ms a turn)\n"
+              << "  --events FILE        Draw random events from this catalog instead of the built-in one\n";
+}
+
+static void printStats(const MonteCarloConfig& config, const MonteCarloStats& stats, double seconds) {
+    double low, high;
+    MonteCarloRunner::wilsonInterval(stats.survived, stats.runs, low, high);
+    double survival = stats.runs > 0 ? static_cast<double>(stats.survived) / stats.runs : 0.0;
+
+    std::cout << Color::BOLD << config.difficulty.name << Color::RESET
+              << "  (" << stats.runs << " runs x " << config.horizon << " turns, "
+              << std::fixed << std::setprecision(2) << seconds << " s, "
+              << std::setprecision(0) << (seconds > 0.0 ? stats.turns.mean() * stats.runs / seconds : 0.0)
+              << " turns/s)\n";
+    std::cout << std::setprecision(1)
+              << "  Survival:      " << survival * 100.0 << "%  [95% CI "
+              << low * 100.0 << "% - " << high * 100.0 << "%]\n"
+              << "  Meltdowns:     " << stats.meltdowns << "   Shutdowns: " << stats.shutdowns << "\n"
+              << "  Score:         mean " << stats.score.mean() << "  sd " << stats.score.stddev()
+              << "  min " << stats.score.min() << "  max " << stats.score.max() << "\n"
+              << "  Turns:         mean " << stats.turns.mean() << "  sd " << stats.turns.stddev() << "\n"
+              << std::setprecision(2)
+              << "  SCRAMs/1000t:  p50 " << stats.scramRate.quantile(0.5)
+              << "  p90 " << stats.scramRate.quantile(0.9)
+              << "  p99 " << stats.scramRate.quantile(0.99) << "\n";
+    if (stats.meltdowns > 0) {
+        std::cout << std::setprecision(0)
+                  << "  Meltdown turn: p10 " << stats.meltdownTurn.quantile(0.1)
+                  << "  p50 " << stats.meltdownTurn.quantile(0.5)
+                  << "  p90 " << stats.meltdownTurn.quantile(0.9) << "\n";
+    }
+    if (!config.distributions) return;
+
+    // Every turn of every run, from the workers' merged sketches
+    const double ranks[3] = {0.5, 0.95, 0.99};
+    std::cout << "  Per turn:      " << std::setw(10) << "p50" << std::setw(10) << "p95" << std::setw(10) << "p99"
+              << std::setw(9) << "past" << "\n";
+    for (int i = 0; i < static_cast<int>(Distribution::DISTRIBUTION_COUNT); ++i) {
+        Distribution series = static_cast<Distribution>(i);
+        const DistributionInfo& info = getDistributionInfo(series);
+        double values[3];
+        stats.readings.sketch(series).quantiles(ranks, values, 3);
+        std::cout << "    " << std::left << std::setw(11) << info.name << std::right << std::setprecision(1)
+                  << std::setw(10) << values[0] << std::setw(10) << values[1] << std::setw(10) << values[2]
+                  << std::setw(8) << stats.readings.pastShare(series) * 100.0 << "% " << info.limit << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<Difficulty> levels;
+    MonteCarloConfig config{getDifficultySettings(Difficulty::NORMAL), ScriptedPolicy(), 1000, 5000,
+                            static_cast<int>(std::thread::hardware_concurrency()), 1, ModelOptions(), false, false};
+    std::string rods = "0:5";
+    std::string eventsPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            Difficulty diff;
+            if (arg == "--difficulty" && hasValue) {
+                if (!parseDifficulty(argv[++i], diff)) throw std::invalid_argument(arg);
+                levels.push_back(diff);
+            } else if (arg == "--runs" && hasValue) {
+                config.runs = std::stol(argv[++i]);
+            } else if (arg == "--turns" && hasValue) {
+                config.horizon = std::stoi(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                config.threads = std::stoi(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                config.seed = std::stoull(argv[++i]);
+            } else if (arg == "--rods" && hasValue) {
+                rods = argv[++i];
+            } else if (arg == "--refill" && hasValue) {
+                config.policy.setRefillThreshold(std::stod(argv[++i]));
+            } else if (arg == "--no-reset") {
+                config.policy.setAutoReset(false);
+            } else if (arg == "--no-turbine") {
+                config.policy.setTurbine(false);
+            } else if (arg == "--kinetics") {
+                config.models.kinetics = true;
+            } else if (arg == "--spatial" && hasValue) {
+                if (!SpatialCore::parseGrid(argv[++i], config.models)) throw std::invalid_argument(arg);
+            } else if (arg == "--depletion") {
+                config.models.depletion = true;
+            } else if (arg == "--distributions") {
+                config.distributions = true;
+            } else if (arg == "--events" && hasValue) {
+                eventsPath = argv[++i];
+            } else if (arg == "--autopilot") {
+                config.autopilot = true;
+            } else if (arg == "--channels" && hasValue) {
+                config.models.channels = std::stoi(argv[++i]);
+                if (config.models.channels < 1 || config.models.channels > 100000) throw std::invalid_argument(arg);
+            } else if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!eventsPath.empty()) {
+        EventCatalog catalog;
+        std::string error;
+        if (!catalog.load(eventsPath, error)) {
+            std::cerr << "Event catalog " << eventsPath << ": " << error << "\n";
+            return 1;
+        }
+        EventCatalog::install(catalog);
+    }
+    if (!ScriptedPolicy::parse(rods, config.policy)) {
+        std::cerr << "Invalid rod schedule: " << rods << "\n";
+        return 1;
+    }
+    const ModelOptions& models = config.models;
+    if (config.autopilot && (models.kinetics || models.spatialNx > 0 || models.channels > 0 || models.depletion)) {
+        std::cerr << "The autopilot predicts with the basic core model; it cannot be combined with the optional models\n";
+        return 1;
+    }
+    if (levels.empty()) {
+        levels = {Difficulty::EASY, Difficulty::NORMAL, Difficulty::HARD, Difficulty::NIGHTMARE};
+    }
+    config.threads = std::max(1, config.threads);
+
+    std::cout << "Monte Carlo: " << config.threads << " threads, seed " << config.seed
+              << ", rods " << (config.autopilot ? "autopilot" : rods) << (config.models.kinetics ? ", point kinetics" : "");
+    if (config.models.spatialNx > 0) {
+        std::cout << ", spatial " << config.models.spatialNx << "x" << config.models.spatialNy
+                  << "x" << config.models.spatialNz;
+    }
+    if (config.models.channels > 0) std::cout << ", " << config.models.channels << " channels";
+    if (config.models.depletion) std::cout << ", depletion";
+    std::cout << "\n\n";
+    for (Difficulty diff : levels) {
+        config.difficulty = getDifficultySettings(diff);
+        auto start = std::chrono::steady_clock::now();
+        MonteCarloStats stats = MonteCarloRunner::run(config);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printStats(config, stats, seconds);
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "telemetry.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Live view of a simulator's telemetry segment (--telemetry NAME). Samples
+// the seqlocked record without ever holding up the simulator; any number of
+// these can watch the same segment.
+
+static const char* DIFFICULTY_NAMES[] = {"Easy", "Normal", "Hard", "Nightmare"};
+
+static void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --name NAME          Shared memory segment (default " << TM::DEFAULT_NAME << ")\n"
+              << "  --interval MS        Refresh period (default 500)\n"
+              << "  --once               Print one key=value sample and exit (1 if none)\n";
+}
+
+static bool writerAlive(uint32_t pid) {
+#ifndef _WIN32
+    return pid != 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+#else
+    (void)pid;
+    return true;
+#endif
+}
+
+static double ageMs(const TelemetryFields& f) {
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    return now > f.publishedNs ? (now - f.publishedNs) / 1e6 : 0.0;
+}
+
+static const char* onOff(const TelemetryFields& f, uint64_t flag) {
+    return (f.flags & flag) ? "on" : "off";
+}
+
+static void printKeyValue(const TelemetryFields& f, uint64_t updates) {
+    std::cout << std::fixed << std::setprecision(2)
+              << "updates=" << updates << " age_ms=" << ageMs(f)
+              << " turn=" << f.turn << " score=" << f.score << " scrams=" << f.scramCount
+              << " running=" << ((f.flags & TF_RUNNING) ? 1 : 0)
+              << " temperature=" << f.temperature << " coolant=" << f.coolant << " power=" << f.power
+              << " rods=" << f.controlRods * 100.0 << " fuel=" << f.fuel << " xenon=" << f.xenon
+              << " turbine_rpm=" << f.turbineRPM << " pressure=" << f.steamPressure
+              << " output_mw=" << f.electricityOutput << " diesel_fuel=" << f.dieselFuel
+              << " radiation=" << f.radiationLevel << " containment=" << f.containmentIntegrity
+              << " grid_demand=" << f.gridDemand << " satisfaction=" << f.demandSatisfaction
+              << " weather=" << getWeatherInfo(static_cast<Weather>(f.weather)).name << "\n";
+}
+
+static void printScreen(const std::string& name, const TelemetryFields& f, uint64_t updates, double rate,
+                        bool alive) {
+    std::ostringstream out;
+    out << "\033[H\033[2J" << std::fixed
+        << "reactor_top  " << name << "  " << (alive ? "" : "(simulator exited)  ")
+        << updates << " updates, " << std::setprecision(1) << rate << "/s, last " << ageMs(f) << " ms ago\n\n"
+        << "Turn " << f.turn << "  Score " << f.score << "  SCRAMs " << f.scramCount << "  "
+        << DIFFICULTY_NAMES[f.difficulty & 3]
+        << ((f.flags & TF_RUNNING) ? "" : "  ** SCRAM **") << ((f.flags & TF_PAUSED) ? "  (paused)" : "") << "\n\n"
+        << std::setprecision(1)
+        << "Core         temp " << f.temperature << " C  power " << f.power << " %  rods " << f.controlRods * 100.0
+        << " %  coolant " << f.coolant << " %  fuel " << f.fuel << " %  xenon " << f.xenon << " %\n"
+        << "Turbine      " << onOff(f, TF_TURBINE_ONLINE) << "  " << std::setprecision(0) << f.turbineRPM << " RPM  "
+        << std::setprecision(1) << f.steamPressure << " bar  " << f.electricityOutput << " MW  relief "
+        << onOff(f, TF_RELIEF_OPEN) << "  total " << std::setprecision(0) << f.totalElectricity << " MW.h\n"
+        << std::setprecision(1)
+        << "Emergency    ECCS " << ((f.flags & TF_ECCS_AVAILABLE) ? "ready" : "cooldown") << " " << f.eccsCooldown
+        << "  diesel " << onOff(f, TF_DIESEL_RUNNING) << " (auto " << onOff(f, TF_DIESEL_AUTO) << ")  fuel "
+        << f.dieselFuel << " %  runtime " << f.dieselRuntime << "\n"
+        << std::setprecision(2)
+        << "Radiation    " << f.radiationLevel << " mSv/h  exposure " << f.radiationExposure << " mSv\n"
+        << std::setprecision(1)
+        << "Containment  " << f.containmentIntegrity << " %" << ((f.flags & TF_CONTAINMENT_BREACH) ? "  BREACH" : "")
+        << "\n"
+        << "Grid         demand " << f.gridDemand << " MW  satisfaction " << f.demandSatisfaction << " %\n"
+        << "Weather      " << getWeatherInfo(static_cast<Weather>(f.weather)).name << ", " << f.weatherDuration
+        << " turns left\n";
+    std::cout << out.str() << std::flush;
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = TM::DEFAULT_NAME;
+    int intervalMs = 500;
+    bool once = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--name" && hasValue) {
+                name = argv[++i];
+            } else if (arg == "--interval" && hasValue) {
+                intervalMs = std::stoi(argv[++i]);
+                if (intervalMs < 1) throw std::invalid_argument(arg);
+            } else if (arg == "--once") {
+                once = true;
+            } else if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    TelemetryReader reader;
+    TelemetryFields fields;
+    uint64_t updates = 0;
+    if (once) {
+        if (!reader.open(name) || !reader.sample(fields, updates)) {
+            std::cerr << "No telemetry in " << name << "\n";
+            return 1;
+        }
+        printKeyValue(fields, updates);
+        return 0;
+    }
+
+    const auto interval = std::chrono::milliseconds(intervalMs);
+    bool waiting = false;
+    uint64_t lastUpdates = 0;
+    auto lastTime = std::chrono::steady_clock::now();
+    while (true) {
+        // The simulator may not have started yet, or may have been restarted
+        if (!reader.open(name)) {
+            if (!waiting) std::cout << "\033[H\033[2JWaiting for " << name << "..." << std::endl;
+            waiting = true;
+            std::this_thread::sleep_for(interval);
+            continue;
+        }
+        waiting = false;
+        lastUpdates = 0;
+        while (true) {
+            auto now = std::chrono::steady_clock::now();
+            if (reader.sample(fields, updates)) {
+                double seconds = std::chrono::duration<double>(now - lastTime).count();
+                double rate = lastUpdates && seconds > 0.0 ? (updates - lastUpdates) / seconds : 0.0;
+                lastUpdates = updates;
+                lastTime = now;
+                bool alive = writerAlive(reader.writer());
+                printScreen(name, fields, updates, rate, alive);
+                if (!alive) break;
+            }
+            std::this_thread::sleep_for(interval);
+        }
+        reader.close();
+        std::this_thread::sleep_for(interval);
+    }
+}